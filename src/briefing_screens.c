@@ -30,6 +30,7 @@
 #include <cdogs/files.h>
 #include <cdogs/grafx_bg.h>
 #include <cdogs/log.h>
+#include <cdogs/map_prep.h>
 #include <cdogs/music.h>
 #include <cdogs/objective.h>
 
@@ -227,9 +228,54 @@ static void MissionBriefingTerminate(GameLoopData *data)
 	CFREE(mData->TypewriterBuf);
 	CFREE(mData);
 }
+static void PrewarmWeaponSounds(const WeaponClass *wc)
+{
+	if (wc == NULL || wc->Type == GUNTYPE_MULTI)
+	{
+		return;
+	}
+	SoundPrewarmAdd(&gSoundDevice, wc->u.Normal.Sound);
+	SoundPrewarmAdd(&gSoundDevice, wc->u.Normal.ReloadSound);
+	SoundPrewarmAdd(&gSoundDevice, wc->SwitchSound);
+	CA_FOREACH(const BulletClass *, bc, wc->u.Normal.Bullets)
+	SoundPrewarmAddName(&gSoundDevice, (*bc)->Hit.Object.Sound);
+	SoundPrewarmAddName(&gSoundDevice, (*bc)->Hit.Flesh.Sound);
+	SoundPrewarmAddName(&gSoundDevice, (*bc)->Hit.Wall.Sound);
+	CA_FOREACH_END()
+}
+static void PrewarmCharacterSounds(const CampaignSetting *c, const int idx)
+{
+	const Character *ch = CArrayGet(&c->characters.OtherChars, idx);
+	char buf[CDOGS_PATH_MAX];
+	CharacterClassGetSound(ch->Class, buf, "alert");
+	SoundPrewarmAddName(&gSoundDevice, buf);
+	CharacterClassGetSound(ch->Class, buf, "die");
+	SoundPrewarmAddName(&gSoundDevice, buf);
+	PrewarmWeaponSounds(ch->Gun);
+}
+// Decode the sounds that the mission is likely to use, while the players
+// are reading the briefing, so they don't hitch when first played
+static void PrewarmMissionSounds(
+	const CampaignSetting *c, const struct MissionOptions *m)
+{
+	CA_FOREACH(const WeaponClass *, wc, m->Weapons)
+	PrewarmWeaponSounds(*wc);
+	CA_FOREACH_END()
+	CA_FOREACH(const int, idx, m->missionData->Enemies)
+	PrewarmCharacterSounds(c, *idx);
+	CA_FOREACH_END()
+	CA_FOREACH(const int, idx, m->missionData->SpecialChars)
+	PrewarmCharacterSounds(c, *idx);
+	CA_FOREACH_END()
+	SoundPrewarmStart(&gSoundDevice);
+}
 static void MissionBriefingOnEnter(GameLoopData *data)
 {
 	MissionBriefingScreenData *mData = data->Data;
+	PrewarmMissionSounds(mData->C, mData->bData->MissionOptions);
+	// Generate the map while the players are reading the briefing and
+	// choosing their equipment
+	MapPrepStart(&gMapPrep, &gCampaign, mData->bData->MissionOptions);
 	if (IsMissionBriefingNeeded(gCampaign.Entry.Mode, mData->bData->Description))
 	{
 		MusicPlayFromChunk(
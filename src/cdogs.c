@@ -55,6 +55,8 @@
 #include <SDL.h>
 
 #include <cdogs/SDL_JoystickButtonNames/SDL_joystickbuttonnames.h>
+#include <cdogs/ai_context.h>
+#include <cdogs/alloc.h>
 #include <cdogs/ammo.h>
 #include <cdogs/campaigns.h>
 #include <cdogs/character_class.h>
@@ -66,6 +68,7 @@
 #include <cdogs/font_utils.h>
 #include <cdogs/grafx.h>
 #include <cdogs/handle_game_events.h>
+#include <cdogs/job_system.h>
 #include <cdogs/joystick.h>
 #include <cdogs/keyboard.h>
 #include <cdogs/log.h>
@@ -76,10 +79,13 @@
 #include <cdogs/objs.h>
 #include <cdogs/palette.h>
 #include <cdogs/particle.h>
+#include <cdogs/path_cache.h>
 #include <cdogs/pic_manager.h>
 #include <cdogs/pickup.h>
 #include <cdogs/pics.h>
 #include <cdogs/player_template.h>
+#include <cdogs/profiler.h>
+#include <cdogs/replay.h>
 #include <cdogs/sounds.h>
 #include <cdogs/triggers.h>
 #include <cdogs/utils.h>
@@ -88,6 +94,7 @@
 #include "briefing_screens.h"
 #include "command_line.h"
 #include "credits.h"
+#include "game.h"
 #include "loading_screens.h"
 #include "mainmenu.h"
 #include "prep.h"
@@ -106,7 +113,7 @@ int main(int argc, char *argv[])
 	ENetAddress connectAddr;
 	memset(&connectAddr, 0, sizeof connectAddr);
 
-	srand((unsigned int)time(NULL));
+	RandSeed((uint64_t)time(NULL));
 	LogInit();
 
 	PrintTitle();
@@ -140,6 +147,10 @@ int main(int argc, char *argv[])
 	ProcessCommandLine(buf, argc, argv);
 	LOG(LM_MAIN, LL_INFO, "Command line (%d args):%s", argc, buf);
 	int demoQuitTimer = 0;
+	ReplayInit(&gReplay);
+	ProfilerInit(&gProfiler);
+	JobSystemInit(&gJobSystem);
+	FrameAllocInit(&gFrameAlloc);
 	if (!ParseArgs(argc, argv, &connectAddr, &loadCampaign, &demoQuitTimer))
 	{
 		goto bail;
@@ -165,6 +176,7 @@ int main(int argc, char *argv[])
 		goto bail;
 	}
 	SDL_EventState(SDL_DROPFILE, SDL_DISABLE);
+	JobSystemStart(&gJobSystem);
 
 	PicManagerInit(&gPicManager);
 	GraphicsInit(&gGraphicsDevice, &gConfig);
@@ -251,9 +263,26 @@ int main(int argc, char *argv[])
 
 	LoadingScreenDraw(&gLoadingScreen, "Loading main menu...", 1.0f);
 	LoopRunner l = LoopRunnerNew();
-	LoopRunnerPush(&l, MainMenu(&gGraphicsDevice, &l));
-	LoopRunnerPush(
-		&l, ScreenLoading("Loading main menu...", false, NULL, false));
+	if (gReplay.Mode == REPLAY_MODE_PLAY)
+	{
+		// Replays skip the menus and quit once the mission is over
+		LOG(LM_MAIN, LL_INFO, "Loading replay %s...", gReplay.Filename);
+		l.Headless = gReplay.Headless;
+		GameEventsInit(&gGameEvents);
+		if (!ReplayLoad(&gReplay, gReplay.Filename) ||
+			!ReplayPlayStart(&gReplay, &gCampaign, &gMission))
+		{
+			err = EXIT_FAILURE;
+			goto bail;
+		}
+		LoopRunnerPush(&l, RunGame(&gCampaign, &gMission, &gMap));
+	}
+	else
+	{
+		LoopRunnerPush(&l, MainMenu(&gGraphicsDevice, &l));
+		LoopRunnerPush(
+			&l, ScreenLoading("Loading main menu...", false, NULL, false));
+	}
 	if (connectAddr.host != 0)
 	{
 		if (NetClientTryScanAndConnect(&gNetClient, connectAddr.host))
@@ -265,7 +294,7 @@ int main(int argc, char *argv[])
 			printf("Failed to connect\n");
 		}
 	}
-	else
+	else if (gReplay.Mode != REPLAY_MODE_PLAY)
 	{
 		// Attempt to pre-load campaign if requested
 		if (loadCampaign != NULL)
@@ -299,6 +328,14 @@ int main(int argc, char *argv[])
 	LoopRunnerTerminate(&l);
 
 bail:
+	if (gProfiler.Enabled)
+	{
+		ProfilerSaveTrace(&gProfiler, GetConfigFilePath(PROFILER_TRACE_FILE));
+	}
+	ProfilerTerminate(&gProfiler);
+	JobSystemTerminate(&gJobSystem);
+	FrameAllocTerminate(&gFrameAlloc);
+	ReplayTerminate(&gReplay);
 	NetServerTerminate(&gNetServer);
 	PlayerDataTerminate(&gPlayerDatas);
 	MapObjectsTerminate(&gMapObjects);
@@ -310,6 +347,8 @@ bail:
 	CharacterClassesTerminate(&gCharacterClasses);
 	MissionOptionsTerminate(&gMission);
 	MapTerminate(&gMap);
+	AIContextsTerminate();
+	CachedPathsTerminate();
 	NetClientTerminate(&gNetClient);
 	atexit(enet_deinitialize);
 	EventTerminate(&gEventHandlers);
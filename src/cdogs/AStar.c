@@ -33,6 +33,9 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <SDL_atomic.h>
+#include <SDL_thread.h>
+
 #include "sys_specifics.h"
 #include "utils.h"
 
@@ -86,21 +89,71 @@ static const Node NodeNull = {NULL, -1};
 
 /********************************************/
 
-static VisitedNodes VisitedNodesCreate(const ASPathNodeSource *source, void *context)
+// The visited nodes and neighbour list are reused between searches, so that
+// their buffers only grow to the largest search instead of being allocated
+// and freed every time
+// Each thread has its own, so searches can run from jobs
+typedef struct {
+    struct __VisitedNodes nodes;
+    struct __ASNeighborList neighbors;
+    // Node size the buffers were sized for
+    size_t nodeSize;
+} SearchBuffers;
+static SDL_TLSID sBuffersTLS = 0;
+static SDL_SpinLock sBuffersLock = 0;
+
+static void SearchBuffersFree(void *data)
+{
+    SearchBuffers *b = data;
+    CFREE(b->nodes.nodeRecords);
+    CFREE(b->nodes.nodeRecordsIndex);
+    CFREE(b->nodes.openNodes);
+    CFREE(b->neighbors.costs);
+    CFREE(b->neighbors.nodeKeys);
+    CFREE(b);
+}
+
+static SearchBuffers *GetSearchBuffers(void)
 {
-	VisitedNodes nodes;
-	CCALLOC(nodes, sizeof(struct __VisitedNodes));
+    SDL_AtomicLock(&sBuffersLock);
+    if (sBuffersTLS == 0) {
+        sBuffersTLS = SDL_TLSCreate();
+    }
+    SDL_AtomicUnlock(&sBuffersLock);
+    SearchBuffers *b = SDL_TLSGet(sBuffersTLS);
+    if (b == NULL) {
+        CCALLOC(b, sizeof *b);
+        SDL_TLSSet(sBuffersTLS, b, SearchBuffersFree);
+    }
+    return b;
+}
+
+static VisitedNodes VisitedNodesCreate(SearchBuffers *b, const ASPathNodeSource *source, void *context)
+{
+    VisitedNodes nodes = &b->nodes;
+    if (b->nodeSize != source->nodeSize) {
+        // Record size has changed; start again
+        CFREE(nodes->nodeRecords);
+        nodes->nodeRecords = NULL;
+        nodes->nodeRecordsCapacity = 0;
+        CFREE(b->neighbors.costs);
+        CFREE(b->neighbors.nodeKeys);
+        b->neighbors.costs = NULL;
+        b->neighbors.nodeKeys = NULL;
+        b->neighbors.capacity = 0;
+        b->nodeSize = source->nodeSize;
+    }
     nodes->source = source;
     nodes->context = context;
+    nodes->nodeRecordsCount = 0;
+    nodes->openNodesCount = 0;
     return nodes;
 }
 
 static void VisitedNodesDestroy(VisitedNodes visitedNodes)
 {
-    CFREE(visitedNodes->nodeRecordsIndex);
-	CFREE(visitedNodes->nodeRecords);
-	CFREE(visitedNodes->openNodes);
-	CFREE(visitedNodes);
+    // Keep the buffers for the next search
+    visitedNodes->context = NULL;
 }
 
 static int NodeIsNull(Node n)
@@ -263,7 +316,7 @@ static Node GetNode(VisitedNodes nodes, void *nodeKey)
     node = NodeMake(nodes, nodes->nodeRecordsCount);
     nodes->nodeRecordsCount++;
     
-    memmove(&nodes->nodeRecordsIndex[first+1], &nodes->nodeRecordsIndex[first], (nodes->nodeRecordsCapacity - first - 1) * sizeof(size_t));
+    memmove(&nodes->nodeRecordsIndex[first+1], &nodes->nodeRecordsIndex[first], (nodes->nodeRecordsCount - first - 1) * sizeof(size_t));
     nodes->nodeRecordsIndex[first] = node.index;
     
     record = NodeGetRecord(node);
@@ -386,19 +439,18 @@ static Node GetOpenNode(VisitedNodes nodes)
     return NodeMake(nodes, nodes->openNodes[0]);
 }
 
-static ASNeighborList NeighborListCreate(const ASPathNodeSource *source)
+static ASNeighborList NeighborListCreate(SearchBuffers *b, const ASPathNodeSource *source)
 {
-	ASNeighborList list;
-	CCALLOC(list, sizeof(struct __ASNeighborList));
+    ASNeighborList list = &b->neighbors;
     list->source = source;
+    list->count = 0;
     return list;
 }
 
 static void NeighborListDestroy(ASNeighborList list)
 {
-    CFREE(list->costs);
-	CFREE(list->nodeKeys);
-	CFREE(list);
+    // Keep the buffers for the next search
+    UNUSED(list);
 }
 
 static float NeighborListGetEdgeCost(ASNeighborList list, size_t idx)
@@ -427,6 +479,7 @@ void ASNeighborListAdd(ASNeighborList list, void *node, float edgeCost)
 
 ASPath ASPathCreate(const ASPathNodeSource *source, void *context, void *startNodeKey, void *goalNodeKey)
 {
+    SearchBuffers *buffers;
     VisitedNodes visitedNodes;
     ASNeighborList neighborList;
     Node current;
@@ -435,9 +488,10 @@ ASPath ASPathCreate(const ASPathNodeSource *source, void *context, void *startNo
     if (!startNodeKey || !source || !source->nodeNeighbors || source->nodeSize == 0) {
         return NULL;
     }
-    
-    visitedNodes = VisitedNodesCreate(source, context);
-    neighborList = NeighborListCreate(source);
+
+    buffers = GetSearchBuffers();
+    visitedNodes = VisitedNodesCreate(buffers, source, context);
+    neighborList = NeighborListCreate(buffers, source);
     current = GetNode(visitedNodes, startNodeKey);
     goalNode = GetNode(visitedNodes, goalNodeKey);
  
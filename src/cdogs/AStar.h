@@ -51,6 +51,7 @@ void ASNeighborListAdd(ASNeighborList neighbors, void *node, float edgeCost);
 // context is optional and is simply passed through to the callback functions
 // startNode and nodeSource is required
 // as a path is created, the relevant nodes are copied into the path
+// search buffers are kept per thread and reused between calls
 ASPath ASPathCreate(const ASPathNodeSource *nodeSource, void *context, void *startNode, void *goalNode);
 
 // paths created with ASPathCreate() must be destroyed or else it will leak memory
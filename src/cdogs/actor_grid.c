@@ -0,0 +1,310 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "actor_grid.h"
+
+#include "actors.h"
+#include "utils.h"
+
+#define CELL_W (TILE_WIDTH * ACTOR_GRID_CELL_TILES)
+#define CELL_H (TILE_HEIGHT * ACTOR_GRID_CELL_TILES)
+
+ActorGrid gActorGrid;
+
+void ActorGridInit(ActorGrid *g, const struct vec2i mapSize)
+{
+	g->size = svec2i(
+		(mapSize.x + ACTOR_GRID_CELL_TILES - 1) / ACTOR_GRID_CELL_TILES,
+		(mapSize.y + ACTOR_GRID_CELL_TILES - 1) / ACTOR_GRID_CELL_TILES);
+	CArrayInit(&g->cells, sizeof(CArray));
+	for (int i = 0; i < g->size.x * g->size.y; i++)
+	{
+		CArray c;
+		CArrayInit(&c, sizeof(int));
+		CArrayPushBack(&g->cells, &c);
+	}
+	g->count = 0;
+	// Index any actors that were placed before the grid was initialised,
+	// so that removing them later finds them
+	CA_FOREACH(const TActor, a, gActors)
+	if (a->isInUse && a->thing.Pos.x >= 0 && a->thing.Pos.y >= 0)
+	{
+		ActorGridAdd(g, a->thing.id, a->thing.Pos);
+	}
+	CA_FOREACH_END()
+}
+void ActorGridTerminate(ActorGrid *g)
+{
+	CA_FOREACH(CArray, c, g->cells)
+	CArrayTerminate(c);
+	CA_FOREACH_END()
+	CArrayTerminate(&g->cells);
+	g->size = svec2i_zero();
+	g->count = 0;
+}
+
+static struct vec2i PosToCell(const ActorGrid *g, const struct vec2 pos)
+{
+	const struct vec2i tile = Vec2ToTile(pos);
+	return svec2i(
+		CLAMP(tile.x / ACTOR_GRID_CELL_TILES, 0, g->size.x - 1),
+		CLAMP(tile.y / ACTOR_GRID_CELL_TILES, 0, g->size.y - 1));
+}
+static CArray *GetCell(const ActorGrid *g, const struct vec2i cell)
+{
+	return CArrayGet(&g->cells, cell.y * g->size.x + cell.x);
+}
+
+void ActorGridAdd(ActorGrid *g, const int id, const struct vec2 pos)
+{
+	if (g->cells.size == 0)
+	{
+		return;
+	}
+	CArrayPushBack(GetCell(g, PosToCell(g, pos)), &id);
+	g->count++;
+}
+void ActorGridRemove(ActorGrid *g, const int id, const struct vec2 pos)
+{
+	if (g->cells.size == 0)
+	{
+		return;
+	}
+	CArray *c = GetCell(g, PosToCell(g, pos));
+	CA_FOREACH(int, cid, *c)
+	if (*cid == id)
+	{
+		// Order doesn't matter; swap with last
+		*cid = *(const int *)CArrayGet(c, c->size - 1);
+		CArrayPopBack(c);
+		g->count--;
+		return;
+	}
+	CA_FOREACH_END()
+	CASSERT(false, "Did not find actor in grid");
+}
+
+typedef struct
+{
+	TActor *a;
+	float distance2;
+} NearestResult;
+static void AddNearestResult(
+	NearestResult *results, int *count, const int k, TActor *a,
+	const float distance2)
+{
+	// Insertion sort into the k-best list
+	int i = MIN(*count, k - 1);
+	if (*count == k && distance2 >= results[i].distance2)
+	{
+		return;
+	}
+	for (; i > 0 && results[i - 1].distance2 > distance2; i--)
+	{
+		results[i] = results[i - 1];
+	}
+	results[i].a = a;
+	results[i].distance2 = distance2;
+	if (*count < k)
+	{
+		(*count)++;
+	}
+}
+static void SearchCell(
+	const ActorGrid *g, const struct vec2i cell, const struct vec2 pos,
+	const float maxDistance2, ActorGridFilterFunc filter, const void *data,
+	NearestResult *results, int *count, const int k)
+{
+	if (cell.x < 0 || cell.y < 0 || cell.x >= g->size.x ||
+		cell.y >= g->size.y)
+	{
+		return;
+	}
+	const CArray *c = GetCell(g, cell);
+	CA_FOREACH(const int, id, *c)
+	TActor *a = CArrayGet(&gActors, *id);
+	if (!a->isInUse || (filter != NULL && !filter(a, data)))
+	{
+		continue;
+	}
+	const float distance2 = svec2_distance_squared(pos, a->Pos);
+	if (maxDistance2 >= 0 && distance2 > maxDistance2)
+	{
+		continue;
+	}
+	AddNearestResult(results, count, k, a, distance2);
+	CA_FOREACH_END()
+}
+// Search the parts of ring r around center that lie within the grid
+static void SearchRing(
+	const ActorGrid *g, const struct vec2i center, const int r,
+	const struct vec2 pos, const float maxDistance2, ActorGridFilterFunc filter,
+	const void *data, NearestResult *results, int *count, const int k)
+{
+	if (r == 0)
+	{
+		SearchCell(
+			g, center, pos, maxDistance2, filter, data, results, count, k);
+		return;
+	}
+	const int xMin = MAX(center.x - r, 0);
+	const int xMax = MIN(center.x + r, g->size.x - 1);
+	// Top and bottom edges
+	for (int x = xMin; x <= xMax; x++)
+	{
+		SearchCell(
+			g, svec2i(x, center.y - r), pos, maxDistance2, filter, data,
+			results, count, k);
+		SearchCell(
+			g, svec2i(x, center.y + r), pos, maxDistance2, filter, data,
+			results, count, k);
+	}
+	// Left and right edges, excluding corners
+	const int yMin = MAX(center.y - r + 1, 0);
+	const int yMax = MIN(center.y + r - 1, g->size.y - 1);
+	for (int y = yMin; y <= yMax; y++)
+	{
+		SearchCell(
+			g, svec2i(center.x - r, y), pos, maxDistance2, filter, data,
+			results, count, k);
+		SearchCell(
+			g, svec2i(center.x + r, y), pos, maxDistance2, filter, data,
+			results, count, k);
+	}
+}
+static int GetNearest(
+	const ActorGrid *g, const struct vec2 pos, const int k,
+	const float maxDistance, ActorGridFilterFunc filter, const void *data,
+	NearestResult *results)
+{
+	int count = 0;
+	if (k <= 0 || g->cells.size == 0 || g->count == 0)
+	{
+		return count;
+	}
+	const float maxDistance2 = maxDistance >= 0 ? SQUARED(maxDistance) : -1;
+	const struct vec2i center = PosToCell(g, pos);
+	// Rings past the furthest grid edge are empty
+	int maxRing = MAX(
+		MAX(center.x, g->size.x - 1 - center.x),
+		MAX(center.y, g->size.y - 1 - center.y));
+	if (maxDistance >= 0)
+	{
+		// Rings further than this are entirely out of range
+		// (see ringDistance below)
+		const int rangeRing =
+			(int)((maxDistance + TILE_WIDTH) / MIN(CELL_W, CELL_H)) + 1;
+		maxRing = MIN(maxRing, rangeRing);
+	}
+	for (int r = 0; r <= maxRing; r++)
+	{
+		// Any actor in ring r is at least this far away; stop once we have
+		// enough results closer than that
+		// Allow a tile of slack since the actor's position may lead its
+		// thing's position, which is what the grid is keyed on
+		const float ringDistance =
+			(float)MAX((r - 1) * MIN(CELL_W, CELL_H) - TILE_WIDTH, 0);
+		const float ringDistance2 = SQUARED(ringDistance);
+		if (count == k && results[count - 1].distance2 <= ringDistance2)
+		{
+			break;
+		}
+		SearchRing(
+			g, center, r, pos, maxDistance2, filter, data, results, &count,
+			k);
+	}
+	return count;
+}
+void ActorGridGetNearest(
+	const ActorGrid *g, const struct vec2 pos, const int k,
+	const float maxDistance, ActorGridFilterFunc filter, const void *data,
+	CArray *out)
+{
+	if (k <= 0)
+	{
+		return;
+	}
+	NearestResult *results;
+	CMALLOC(results, k * sizeof *results);
+	const int count =
+		GetNearest(g, pos, k, maxDistance, filter, data, results);
+	for (int i = 0; i < count; i++)
+	{
+		CArrayPushBack(out, &results[i].a);
+	}
+	CFREE(results);
+}
+
+TActor *ActorGridGetClosest(
+	const ActorGrid *g, const struct vec2 pos, const float maxDistance,
+	ActorGridFilterFunc filter, const void *data)
+{
+	NearestResult result;
+	if (GetNearest(g, pos, 1, maxDistance, filter, data, &result) == 0)
+	{
+		return NULL;
+	}
+	return result.a;
+}
+
+void ActorGridGetInRadius(
+	const ActorGrid *g, const struct vec2 pos, const float radius,
+	ActorGridFilterFunc filter, const void *data, CArray *out)
+{
+	if (g->cells.size == 0)
+	{
+		return;
+	}
+	if (g->count == 0)
+	{
+		return;
+	}
+	const float radius2 = SQUARED(radius);
+	const struct vec2i cMin =
+		PosToCell(g, svec2(pos.x - radius, pos.y - radius));
+	const struct vec2i cMax =
+		PosToCell(g, svec2(pos.x + radius, pos.y + radius));
+	struct vec2i v;
+	for (v.y = cMin.y; v.y <= cMax.y; v.y++)
+	{
+		for (v.x = cMin.x; v.x <= cMax.x; v.x++)
+		{
+			const CArray *c = GetCell(g, v);
+			CA_FOREACH(const int, id, *c)
+			TActor *a = CArrayGet(&gActors, *id);
+			if (!a->isInUse || (filter != NULL && !filter(a, data)))
+			{
+				continue;
+			}
+			if (svec2_distance_squared(pos, a->Pos) <= radius2)
+			{
+				CArrayPushBack(out, &a);
+			}
+			CA_FOREACH_END()
+		}
+	}
+}
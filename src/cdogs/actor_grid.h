@@ -0,0 +1,79 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+
+#include "c_array.h"
+#include "vector.h"
+
+// Size of each grid cell, in tiles
+#define ACTOR_GRID_CELL_TILES 4
+
+typedef struct
+{
+	CArray cells; // of CArray of int (actor ids, i.e. index into gActors)
+	struct vec2i size;
+	int count; // total actors in the grid
+} ActorGrid;
+
+// Coarse spatial index of actors, for proximity queries such as finding the
+// closest enemy, without scanning all of gActors
+// Kept in sync as actors move between tiles (see MapTryMoveThing)
+// Note: lifetime managed by Map
+extern ActorGrid gActorGrid;
+
+void ActorGridInit(ActorGrid *g, const struct vec2i mapSize);
+void ActorGridTerminate(ActorGrid *g);
+
+void ActorGridAdd(ActorGrid *g, const int id, const struct vec2 pos);
+void ActorGridRemove(ActorGrid *g, const int id, const struct vec2 pos);
+
+// Actors are usually filtered by team, e.g. "good guys only"
+// Team membership can change at runtime (e.g. rescued prisoners) so it is
+// evaluated at query time rather than baked into the index
+struct Actor;
+typedef bool (*ActorGridFilterFunc)(const struct Actor *, const void *);
+
+// Find the k closest actors to pos that satisfy the filter, sorted by
+// increasing distance.
+// maxDistance: ignore actors further than this; use < 0 for no limit
+// Pass a limit where possible; with no limit, a query that matches nothing
+// searches the whole grid
+// Results (TActor *) are pushed into out, which must be initialised
+void ActorGridGetNearest(
+	const ActorGrid *g, const struct vec2 pos, const int k,
+	const float maxDistance, ActorGridFilterFunc filter, const void *data,
+	CArray *out);
+struct Actor *ActorGridGetClosest(
+	const ActorGrid *g, const struct vec2 pos, const float maxDistance,
+	ActorGridFilterFunc filter, const void *data);
+// Push all actors within radius of pos that satisfy the filter, unsorted
+void ActorGridGetInRadius(
+	const ActorGrid *g, const struct vec2 pos, const float radius,
+	ActorGridFilterFunc filter, const void *data, CArray *out);
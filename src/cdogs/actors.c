@@ -137,8 +137,9 @@ void UpdateActorState(TActor *actor, int ticks)
 			AddParticle ap;
 			memset(&ap, 0, sizeof ap);
 			ap.Pos = svec2_add(
-				actor->Pos, svec2(RAND_FLOAT(-8, 8), RAND_FLOAT(-6, 6)));
-			ap.Z = RAND_FLOAT(0, 14);
+				actor->Pos,
+				svec2(RandFloat(RNG_FX, -8, 8), RandFloat(RNG_FX, -6, 6)));
+			ap.Z = RandFloat(RNG_FX, 0, 14);
 			ap.ActorUID = actor->uid;
 			EmitterUpdate(&actor->flameEffect, &ap, ticks);
 		}
@@ -156,7 +157,8 @@ void UpdateActorState(TActor *actor, int ticks)
 			AddParticle ap;
 			memset(&ap, 0, sizeof ap);
 			ap.Pos = svec2_add(
-				actor->Pos, svec2(RAND_FLOAT(-6, 6), RAND_FLOAT(-4, 4)));
+				actor->Pos,
+				svec2(RandFloat(RNG_FX, -6, 6), RandFloat(RNG_FX, -4, 4)));
 			ap.Z = 10;
 			ap.ActorUID = actor->uid;
 			EmitterUpdate(&actor->poisonEffect, &ap, ticks);
@@ -171,8 +173,9 @@ void UpdateActorState(TActor *actor, int ticks)
 			AddParticle ap;
 			memset(&ap, 0, sizeof ap);
 			ap.Pos = svec2_add(
-				actor->Pos, svec2(RAND_FLOAT(-8, 8), RAND_FLOAT(-6, 6)));
-			ap.Z = RAND_FLOAT(0, 14);
+				actor->Pos,
+				svec2(RandFloat(RNG_FX, -8, 8), RandFloat(RNG_FX, -6, 6)));
+			ap.Z = RandFloat(RNG_FX, 0, 14);
 			ap.ActorUID = actor->uid;
 			EmitterUpdate(&actor->iceEffect, &ap, ticks);
 		}
@@ -695,6 +698,10 @@ static void CheckTrigger(const TActor *a, const Map *map)
 		return;
 	}
 	const struct vec2i tilePos = Vec2ToTile(a->Pos);
+	if (!MapTileHasTriggers(map, tilePos))
+	{
+		return;
+	}
 	const bool showLocked = ActorIsLocalPlayer(a->uid);
 	const Tile *t = MapGetTile(map, tilePos);
 	const int keyFlags =
@@ -812,7 +819,8 @@ void ActorHeal(TActor *actor, const int amount, const bool exceedMax)
 	ap.Z = 10;
 	for (int i = 0; i < MAX(amount / 20, 1); i++)
 	{
-		ap.Vel = svec2(RAND_FLOAT(-0.2f, 0.2f), RAND_FLOAT(-0.2f, 0.2f));
+		ap.Vel = svec2(
+			RandFloat(RNG_FX, -0.2f, 0.2f), RandFloat(RNG_FX, -0.2f, 0.2f));
 		EmitterStart(&actor->healEffect, &ap);
 	}
 }
@@ -2287,6 +2295,45 @@ static void ActorTakeSpecialDamage(
 	}
 }
 
+// Damage text is cosmetic; it must not draw from the simulation stream,
+// or replays and network games would diverge
+// Returns the combined damage shown
+static int ActorAddDamageText(TActor *a, const int power)
+{
+	// See if there is one already; if so remove it and add a new one,
+	// combining the damage numbers
+	int damage = power;
+	struct vec2 pos = svec2_add(
+		a->Pos, svec2(RandFloat(RNG_FX, -3, 3), RandFloat(RNG_FX, -3, 3)));
+	CA_FOREACH(const int, pid, gParticles.live)
+	const Particle *p = ParticleGet(&gParticles, *pid);
+	if (p->ActorUID == a->uid)
+	{
+		damage += a->accumulatedDamage;
+		if (svec2_distance(pos, p->Pos) <
+			DAMAGE_TEXT_DISTANCE_RESET_THRESHOLD)
+		{
+			pos = p->Pos;
+		}
+		ParticleDestroy(&gParticles, *pid);
+		break;
+	}
+	CA_FOREACH_END()
+	a->accumulatedDamage = damage;
+	a->damageCooldownTicks = 0;
+
+	AddParticle ap;
+	memset(&ap, 0, sizeof ap);
+	ap.Class = StrParticleClass(&gParticleClasses, "damage_text");
+	ap.ActorUID = a->uid;
+	ap.Pos = pos;
+	ap.Z = BULLET_Z * Z_FACTOR;
+	ap.DZ = 3;
+	sprintf(ap.Text, "-%d", damage);
+	ParticleAdd(&gParticles, ap);
+	return damage;
+}
+
 static void ActorTakeHit(TActor *actor, const NThingDamage d);
 void ActorHit(const NThingDamage d)
 {
@@ -2299,39 +2346,7 @@ void ActorHit(const NThingDamage d)
 	{
 		DamageActor(a, d.Power, d.SourceActorUID);
 
-		// Add damage text
-		// See if there is one already; if so remove it and add a new one,
-		// combining the damage numbers
-		int damage = (int)d.Power;
-		struct vec2 pos =
-			svec2_add(a->Pos, svec2(RAND_FLOAT(-3, 3), RAND_FLOAT(-3, 3)));
-		CA_FOREACH(const Particle, p, gParticles)
-		if (p->isInUse && p->ActorUID == a->uid)
-		{
-			damage += a->accumulatedDamage;
-			if (svec2_distance(pos, p->Pos) <
-				DAMAGE_TEXT_DISTANCE_RESET_THRESHOLD)
-			{
-				pos = p->Pos;
-			}
-			GameEvent e = GameEventNew(GAME_EVENT_PARTICLE_REMOVE);
-			e.u.ParticleRemoveId = _ca_index;
-			GameEventsEnqueue(&gGameEvents, e);
-			break;
-		}
-		CA_FOREACH_END()
-		a->accumulatedDamage = damage;
-		a->damageCooldownTicks = 0;
-
-		GameEvent s = GameEventNew(GAME_EVENT_ADD_PARTICLE);
-		s.u.AddParticle.Class =
-			StrParticleClass(&gParticleClasses, "damage_text");
-		s.u.AddParticle.ActorUID = a->uid;
-		s.u.AddParticle.Pos = pos;
-		s.u.AddParticle.Z = BULLET_Z * Z_FACTOR;
-		s.u.AddParticle.DZ = 3;
-		sprintf(s.u.AddParticle.Text, "-%d", damage);
-		GameEventsEnqueue(&gGameEvents, s);
+		const int damage = ActorAddDamageText(a, (int)d.Power);
 
 		ActorAddBloodSplatters(a, d.Power, d.Mass, NetToVec2(d.Vel));
 
@@ -2355,7 +2370,8 @@ void ActorHit(const NThingDamage d)
 		const char *hat = c->HeadParts[HEAD_PART_HAT];
 		if (sourceWC && sourceWC->Type == GUNTYPE_NORMAL &&
 			!a->isHatDetached && damage > 0 && a->health < c->maxHealth / 2 &&
-			a->health > 0 && RAND_INT(0, 3) == 0 && hat && strlen(hat) > 0)
+			a->health > 0 && RandInt(RNG_SIM, 0, 3) == 0 && hat &&
+			strlen(hat) > 0)
 		{
 			char buf[256];
 			sprintf(buf, "hat/%s", c->HeadParts[HEAD_PART_HAT]);
@@ -2370,7 +2386,7 @@ void ActorHit(const NThingDamage d)
 				e.u.AddParticle.DZ = 12;
 				e.u.AddParticle.Vel =
 					svec2_scale(svec2_normalize(NetToVec2(d.Vel)), 0.4f);
-				e.u.AddParticle.Spin = RAND_DOUBLE(-0.5, 0.5);
+				e.u.AddParticle.Spin = RandDouble(RNG_FX, -0.5, 0.5);
 				e.u.AddParticle.ActorUID = a->uid;
 				GameEventsEnqueue(&gGameEvents, e);
 
@@ -2490,7 +2506,7 @@ static void ActorAddBloodSplatters(
 			bloodSize = 1;
 		}
 		const struct vec2 vel =
-			svec2_scale(hitVNorm, speedBase * RAND_FLOAT(0.5f, 1));
+			svec2_scale(hitVNorm, speedBase * RandFloat(RNG_FX, 0.5f, 1));
 		AddParticle ap;
 		memset(&ap, 0, sizeof ap);
 		ap.Pos = a->Pos;
@@ -61,6 +61,8 @@
 #include "game_events.h"
 #include "gamedata.h"
 #include "handle_game_events.h"
+#include "job_system.h"
+#include "los.h"
 #include "mission.h"
 #include "net_util.h"
 #include "sys_specifics.h"
@@ -69,8 +71,26 @@
 #define AI_WAKE_SOUND_RANGE (8 * TILE_WIDTH)
 #define AI_WAKE_SOUND_RANGE_INDIRECT (4 * TILE_WIDTH)
 
+// AI level of detail
+// Decisions are made every AI update for AI that players can see or are
+// close to, and less often the further away they are
+#define AI_LOD_NEAR_DISTANCE (12 * TILE_WIDTH)
+#define AI_LOD_FAR_DISTANCE (40 * TILE_WIDTH)
+// Max number of off-screen decisions per AI update; the rest are carried over
+#define AI_DECISION_BUDGET 48
+// AI perceive the world in parallel, in batches of this many actors
+#define AI_THINK_BATCH 32
+
 static int gBaddieCount = 0;
 static bool sAreGoodGuysPresent = false;
+// Where to start round-robin scheduling of decisions, so that AI over the
+// budget go first in the next update
+static int sThinkCursor = 0;
+AIStats gAIStats;
+AIStats gAIPlayerStats;
+// Number of AI updates between decisions, per LOD; dormant AI don't make
+// decisions until they are woken
+static const int sLODIntervals[AI_LOD_COUNT] = {1, 2, 0};
 
 static bool IsFacingPlayer(TActor *actor, direction_e d)
 {
@@ -90,33 +110,34 @@ static bool IsFacingPlayer(TActor *actor, direction_e d)
 
 #define Distance(a, b) CHEBYSHEV_DISTANCE(a->x, a->y, b->x, b->y)
 
-static bool IsCloseToPlayer(const struct vec2 pos, const float distance)
+// Read-only view of the world for the AI think phase, gathered once per
+// AI update before any actor moves
+typedef struct
 {
-	const TActor *closestPlayer = AIGetClosestPlayer(pos);
-	const float distance2 = distance * distance;
-	return closestPlayer &&
-		   svec2_distance_squared(pos, closestPlayer->Pos) < distance2;
-}
-
-static bool CanSeeActor(const TActor *a, const TActor *target)
+	CArray Players;	 // of const TActor *, alive players
+	CArray Attacked; // of const TActor *, being attacked or dying
+	CArray Thinkers; // of TActor *, AI making a decision this update
+	// Config is read here rather than by the perception jobs
+	int SightRange;
+} AIThinkWork;
+static AIThinkWork sThink;
+
+static bool CanSeeActor(
+	const AIThinkWork *w, const TActor *a, const TActor *target)
 {
 	// Can see if:
 	// - They are close
 	// - Or if they can see them with line of sight
 	const float distance2 = svec2_distance_squared(a->Pos, target->Pos);
 	const bool isClose = distance2 < SQUARED(16 * 2);
-	return isClose || AICanSee(a, target->Pos, a->direction);
+	return isClose ||
+		   AICanSee(a, target->Pos, a->direction, w->SightRange);
 }
 
-static bool CanSeeAPlayer(const TActor *a)
+static bool CanSeeAPlayer(const AIThinkWork *w, const TActor *a)
 {
-	CA_FOREACH(const PlayerData, p, gPlayerDatas)
-	if (!IsPlayerAlive(p))
-	{
-		continue;
-	}
-	const TActor *player = ActorGetByUID(p->ActorUID);
-	if (CanSeeActor(a, player))
+	CA_FOREACH(const TActor *const, player, w->Players)
+	if (CanSeeActor(w, a, *player))
 	{
 		return true;
 	}
@@ -124,19 +145,32 @@ static bool CanSeeAPlayer(const TActor *a)
 	return false;
 }
 
-static bool CanSeeActorBeingAttacked(const TActor *a)
+// The closest player, or for AI players, the closest that joined before
+// them, which is the one they follow
+static const TActor *GetClosestPlayer(const AIThinkWork *w, const TActor *a)
 {
-	CA_FOREACH(const TActor, target, gActors)
-	if (!target->isInUse)
+	const TActor *closest = NULL;
+	float minDistance2 = -1;
+	CA_FOREACH(const TActor *const, player, w->Players)
+	if (a->PlayerUID >= 0 &&
+		(IsPVP(gCampaign.Entry.Mode) || (*player)->PlayerUID >= a->PlayerUID))
 	{
 		continue;
 	}
-	// Use grimacing as a proxy to being attacked / being aggressive
-	if (!ActorIsGrimacing(target) && target->dead == 0)
+	const float distance2 = svec2_distance_squared(a->Pos, (*player)->Pos);
+	if (closest == NULL || distance2 < minDistance2)
 	{
-		continue;
+		closest = *player;
+		minDistance2 = distance2;
 	}
-	if (CanSeeActor(a, target))
+	CA_FOREACH_END()
+	return closest;
+}
+
+static bool CanSeeActorBeingAttacked(const AIThinkWork *w, const TActor *a)
+{
+	CA_FOREACH(const TActor *const, target, w->Attacked)
+	if (CanSeeActor(w, a, *target))
 	{
 		return true;
 	}
@@ -303,6 +337,9 @@ static bool IsAIEnabled(const TActor *a)
 }
 
 static int Follow(TActor *a);
+static void TakeSnapshot(AIThinkWork *w);
+static void ScheduleDecisions(const AIThinkWork *w);
+static void Perceive(AIThinkWork *w);
 static int GetCmd(TActor *actor, const int delayModifier, const int rollLimit);
 int AICommand(const int ticks)
 {
@@ -334,6 +371,10 @@ int AICommand(const int ticks)
 		break;
 	}
 
+	TakeSnapshot(&sThink);
+	ScheduleDecisions(&sThink);
+	Perceive(&sThink);
+
 	CA_FOREACH(TActor, actor, gActors)
 	if (!IsAIEnabled(actor))
 	{
@@ -346,7 +387,16 @@ int AICommand(const int ticks)
 		{
 			sAreGoodGuysPresent = true;
 		}
-		cmd = GetCmd(actor, delayModifier, rollLimit);
+		if (actor->aiContext->IsThinking)
+		{
+			cmd = GetCmd(actor, delayModifier, rollLimit);
+			actor->aiContext->Perception.IsValid = false;
+			gAIStats.Decisions++;
+		}
+		else
+		{
+			cmd = actor->aiContext->LastCmd;
+		}
 		actor->aiContext->Delay = MAX(0, actor->aiContext->Delay - ticks);
 	}
 	actor->aiContext->LastCmd = CommandActor(actor, cmd, ticks);
@@ -354,16 +404,258 @@ int AICommand(const int ticks)
 	CA_FOREACH_END()
 	return count;
 }
+// AI that are asleep and far from all players can only wake by seeing
+// someone nearby being attacked, or through an event (being hurt or hearing
+// something) which wakes them directly
+static bool IsDormant(const AIThinkWork *w, const TActor *a)
+{
+	if (!(a->flags & FLAGS_SLEEPING))
+	{
+		return false;
+	}
+	CA_FOREACH(const TActor *const, target, w->Attacked)
+	if (svec2_distance_squared(a->Pos, (*target)->Pos) <
+		SQUARED(w->SightRange))
+	{
+		return false;
+	}
+	CA_FOREACH_END()
+	return true;
+}
+static AILOD GetLOD(const AIThinkWork *w, const TActor *a)
+{
+	const bool isPlayer = a->PlayerUID >= 0;
+	// Followers, and anything on screen, need to react immediately
+	if (!isPlayer &&
+		((a->flags & (FLAGS_FOLLOWER | FLAGS_RESCUED)) ||
+		 LOSTileIsVisible(&gMap, Vec2ToTile(a->Pos))))
+	{
+		return AI_LOD_NEAR;
+	}
+	// AI players go by the distance to the player they follow, and are
+	// never dormant so they can catch up
+	const TActor *player = GetClosestPlayer(w, a);
+	if (player == NULL && isPlayer)
+	{
+		return AI_LOD_NEAR;
+	}
+	const float distance2 =
+		player ? svec2_distance_squared(a->Pos, player->Pos) : -1;
+	if (player && distance2 < SQUARED(AI_LOD_NEAR_DISTANCE))
+	{
+		return AI_LOD_NEAR;
+	}
+	if (isPlayer || (player && distance2 < SQUARED(AI_LOD_FAR_DISTANCE)))
+	{
+		return AI_LOD_FAR;
+	}
+	return IsDormant(w, a) ? AI_LOD_DORMANT : AI_LOD_FAR;
+}
+// Whether the AI is due to make a decision by its LOD
+static bool IsDue(AIStats *stats, AIContext *c, const AILOD lod)
+{
+	c->LOD = lod;
+	stats->LODs[lod]++;
+	if (lod == AI_LOD_DORMANT)
+	{
+		// Decide as soon as it is woken
+		c->ThinkCounter = 0;
+		stats->Skipped++;
+		return false;
+	}
+	c->ThinkCounter = MAX(0, c->ThinkCounter - 1);
+	if (c->ThinkCounter > 0)
+	{
+		stats->Skipped++;
+		return false;
+	}
+	return true;
+}
+// Choose which AI make a decision this update; the rest repeat their last
+// command
+static void ScheduleDecisions(const AIThinkWork *w)
+{
+	memset(&gAIStats, 0, sizeof gAIStats);
+	int budget = AI_DECISION_BUDGET;
+	int nextCursor = -1;
+	const int n = (int)gActors.size;
+	for (int i = 0; i < n; i++)
+	{
+		const int idx = (sThinkCursor + i) % n;
+		TActor *actor = CArrayGet(&gActors, idx);
+		if (!IsAIEnabled(actor))
+		{
+			continue;
+		}
+		AIContext *c = actor->aiContext;
+		c->IsThinking = false;
+		if (actor->flags & FLAGS_PRISONER)
+		{
+			continue;
+		}
+		if (!IsDue(&gAIStats, c, GetLOD(w, actor)))
+		{
+			continue;
+		}
+		// Always let AI near players think, but limit the rest
+		if (c->LOD != AI_LOD_NEAR)
+		{
+			if (budget == 0)
+			{
+				gAIStats.Deferred++;
+				if (nextCursor < 0)
+				{
+					nextCursor = idx;
+				}
+				continue;
+			}
+			budget--;
+		}
+		c->IsThinking = true;
+		c->ThinkCounter = sLODIntervals[c->LOD];
+	}
+	if (nextCursor >= 0)
+	{
+		sThinkCursor = nextCursor;
+	}
+}
+// Perception only reads the snapshot and the map, and writes to its own AI
+// context, so the AI can perceive in parallel and the result does not
+// depend on the number of threads
+static void PerceiveActor(const AIThinkWork *w, TActor *a)
+{
+	AIPerception *p = &a->aiContext->Perception;
+	const bool isPlayer = a->PlayerUID >= 0;
+	p->IsValid = true;
+	p->Pos = a->Pos;
+	p->CanSeeTarget = !isPlayer && (a->flags & FLAGS_SLEEPING) &&
+					  (a->flags & FLAGS_VISIBLE) && a->aiContext->Delay == 0 &&
+					  (CanSeeAPlayer(w, a) || CanSeeActorBeingAttacked(w, a));
+
+	const TActor *player = GetClosestPlayer(w, a);
+	p->PlayerId = player ? player->thing.id : -1;
+	p->PlayerPos = player ? player->Pos : a->Pos;
+	p->IsNearPlayer =
+		player && svec2_distance_squared(a->Pos, player->Pos) <
+					  SQUARED(AI_LOD_FAR_DISTANCE);
+	// Only followers and AI players walk to players
+	p->HasClearPathToPlayer =
+		player && (isPlayer || (a->flags & FLAGS_FOLLOWER)) &&
+		AIHasClearPath(a->Pos, player->Pos, true);
+
+	// Only AI players and AI the players can see look for enemies
+	const TActor *enemy = NULL;
+	if (isPlayer || (a->flags & FLAGS_VISIBLE))
+	{
+		enemy = AIGetClosestVisibleEnemy(a, isPlayer);
+	}
+	p->EnemyId = enemy ? enemy->thing.id : -1;
+	p->EnemyPos = enemy ? enemy->Pos : a->Pos;
+	// Only AI players check for a clear shot before attacking
+	p->HasClearShot = isPlayer && enemy && AIHasClearShot(a->Pos, enemy->Pos);
+}
+static void PerceiveBatch(
+	JobContext *ctx, void *data, const int start, const int end)
+{
+	UNUSED(ctx);
+	const AIThinkWork *w = data;
+	for (int i = start; i < end; i++)
+	{
+		TActor **a = CArrayGet(&w->Thinkers, i);
+		PerceiveActor(w, *a);
+	}
+}
+// Gather the alive players and actors under attack, for the AI about to
+// make decisions
+static void TakeSnapshot(AIThinkWork *w)
+{
+	if (w->Thinkers.elemSize == 0)
+	{
+		CArrayInit(&w->Players, sizeof(const TActor *));
+		CArrayInit(&w->Attacked, sizeof(const TActor *));
+		CArrayInit(&w->Thinkers, sizeof(TActor *));
+	}
+	CArrayClear(&w->Players);
+	CArrayClear(&w->Attacked);
+	CArrayClear(&w->Thinkers);
+	w->SightRange = AIGetSightRange();
+	CA_FOREACH(const PlayerData, p, gPlayerDatas)
+	if (!IsPlayerAlive(p))
+	{
+		continue;
+	}
+	const TActor *player = ActorGetByUID(p->ActorUID);
+	CArrayPushBack(&w->Players, &player);
+	CA_FOREACH_END()
+	CA_FOREACH(const TActor, a, gActors)
+	if (!a->isInUse)
+	{
+		continue;
+	}
+	// Use grimacing as a proxy to being attacked / being aggressive
+	if (ActorIsGrimacing(a) || a->dead != 0)
+	{
+		CArrayPushBack(&w->Attacked, &a);
+	}
+	CA_FOREACH_END()
+}
+static void Perceive(AIThinkWork *w)
+{
+	CA_FOREACH(TActor, a, gActors)
+	if (IsAIEnabled(a) && a->aiContext->IsThinking)
+	{
+		CArrayPushBack(&w->Thinkers, &a);
+	}
+	CA_FOREACH_END()
+
+	JobSystemParallelFor(
+		&gJobSystem, (int)w->Thinkers.size, AI_THINK_BATCH, PerceiveBatch, w);
+}
+void AIThinkPlayers(void)
+{
+	AIThinkWork *w = &sThink;
+	TakeSnapshot(w);
+	memset(&gAIPlayerStats, 0, sizeof gAIPlayerStats);
+	CA_FOREACH(const PlayerData, p, gPlayerDatas)
+	if (!p->IsLocal || p->inputDevice != INPUT_DEVICE_AI || !IsPlayerAlive(p))
+	{
+		continue;
+	}
+	TActor *a = ActorGetByUID(p->ActorUID);
+	// Co-op AIs don't have the character bot property, so their contexts
+	// are created lazily
+	if (a->aiContext == NULL)
+	{
+		a->aiContext = AIContextNew();
+	}
+	AIContext *c = a->aiContext;
+	c->IsThinking = IsDue(&gAIPlayerStats, c, GetLOD(w, a));
+	if (!c->IsThinking)
+	{
+		continue;
+	}
+	c->ThinkCounter = sLODIntervals[c->LOD];
+	gAIPlayerStats.Decisions++;
+	CArrayPushBack(&w->Thinkers, &a);
+	CA_FOREACH_END()
+	if (w->Thinkers.size == 0)
+	{
+		return;
+	}
+
+	JobSystemParallelFor(
+		&gJobSystem, (int)w->Thinkers.size, AI_THINK_BATCH, PerceiveBatch, w);
+}
+
 static int GetCmd(TActor *actor, const int delayModifier, const int rollLimit)
 {
 	const CharBot *bot = ActorGetCharacter(actor)->bot;
+	const AIPerception *perception = &actor->aiContext->Perception;
 
 	int cmd = 0;
 
 	// Wake up if it can see a player or someone dying
-	if ((actor->flags & FLAGS_SLEEPING) && (actor->flags & FLAGS_VISIBLE) &&
-		actor->aiContext->Delay == 0 &&
-		(CanSeeAPlayer(actor) || CanSeeActorBeingAttacked(actor)))
+	if ((actor->flags & FLAGS_SLEEPING) && perception->CanSeeTarget)
 	{
 		AIWake(actor, delayModifier);
 	}
@@ -376,7 +668,7 @@ static int GetCmd(TActor *actor, const int delayModifier, const int rollLimit)
 	if (!(actor->flags & FLAGS_SLEEPING) && actor->aiContext->Delay == 0 &&
 		!(actor->flags & FLAGS_AWAKEALWAYS))
 	{
-		if (!IsCloseToPlayer(actor->Pos, 40 * 16))
+		if (!perception->IsNearPlayer)
 		{
 			actor->flags |= FLAGS_SLEEPING;
 			actor->flags &= ~FLAGS_WAKING;
@@ -391,7 +683,7 @@ static int GetCmd(TActor *actor, const int delayModifier, const int rollLimit)
 	}
 
 	bool bypass = false;
-	const int roll = rand() % rollLimit;
+	const int roll = RAND_INT(0, rollLimit);
 	if (actor->flags & FLAGS_FOLLOWER)
 	{
 		cmd = Follow(actor);
@@ -444,7 +736,7 @@ static int GetCmd(TActor *actor, const int delayModifier, const int rollLimit)
 		}
 		else if (roll < bot->probabilityToMove)
 		{
-			cmd = DirectionToCmd(rand() & 7);
+			cmd = DirectionToCmd(RAND_INT(0, 8));
 			ActorSetAIState(actor, AI_STATE_TRACK);
 		}
 		actor->aiContext->Delay = bot->actionDelay * delayModifier;
@@ -460,7 +752,7 @@ static int GetCmd(TActor *actor, const int delayModifier, const int rollLimit)
 				// Shoot in a random direction away
 				for (int j = 0; j < 10; j++)
 				{
-					direction_e d = (direction_e)(rand() % DIRECTION_COUNT);
+					direction_e d = (direction_e)RAND_INT(0, DIRECTION_COUNT);
 					if (!IsFacingPlayer(actor, d))
 					{
 						cmd = DirectionToCmd(d) | CMD_BUTTON1;
@@ -547,7 +839,8 @@ static int Follow(TActor *a)
 			CA_FOREACH_END()
 		}
 	}
-	if (IsCloseToPlayer(a->Pos, 32))
+	const TActor *player = AIGetPerceivedPlayer(a);
+	if (player && svec2_distance_squared(a->Pos, player->Pos) < SQUARED(32))
 	{
 		ActorSetAIState(a, AI_STATE_IDLE);
 		return 0;
@@ -555,7 +848,7 @@ static int Follow(TActor *a)
 	else
 	{
 		ActorSetAIState(a, AI_STATE_FOLLOW);
-		return AIGoto(a, AIGetClosestPlayerPos(a->Pos), true);
+		return AIGoto(a, player ? player->Pos : a->Pos, true);
 	}
 }
 
@@ -616,6 +909,7 @@ void AIAddRandomEnemies(const int enemies, const Mission *m)
 
 void InitializeBadGuys(void)
 {
+	sThinkCursor = 0;
 	CA_FOREACH(Objective, o, gMission.missionData->Objectives)
 	const PlacementAccessFlags paFlags = ObjectiveGetPlacementAccessFlags(o);
 	if (o->Type == OBJECTIVE_KILL &&
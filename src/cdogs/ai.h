@@ -51,8 +51,25 @@
 #include "actors.h"
 #include "mission.h"
 
+typedef struct
+{
+	// Counts for the last AI update, or for AI players, the last frame
+	int Decisions;
+	// Not due to make a decision, because of their LOD
+	int Skipped;
+	// Due, but over the decision budget; carried over to the next update
+	int Deferred;
+	int LODs[AI_LOD_COUNT];
+} AIStats;
+extern AIStats gAIStats;
+extern AIStats gAIPlayerStats;
+
 void InitializeBadGuys(void);
 void CreateEnemies(void);
+// Schedule decisions for local AI players, and perceive the world in
+// parallel for those due to decide, before their commands are read
+// Between decisions, AICoopGetCmd repeats the last command
+void AIThinkPlayers(void);
 // Returns number of random enemies
 int AICommand(const int ticks);
 void AICommandLast(const int ticks);
@@ -27,11 +27,18 @@
 */
 #include "ai_context.h"
 
+#include "alloc.h"
+
+// AI contexts are created and destroyed with actors
+static Pool sContextPool;
 
 AIContext *AIContextNew(void)
 {
-	AIContext *c;
-	CCALLOC(c, sizeof *c);
+	if (sContextPool.elemSize == 0)
+	{
+		PoolInit(&sContextPool, sizeof(AIContext), 64);
+	}
+	AIContext *c = PoolAlloc(&sContextPool);
 	c->EnemyId = -1;
 	c->GunRangeScalar = 1.0;
 	return c;
@@ -42,7 +49,14 @@ void AIContextDestroy(AIContext *c)
 	{
 		CachedPathDestroy(&c->Goto.Path);
 	}
-	CFREE(c);
+	PoolFree(&sContextPool, c);
+}
+void AIContextsTerminate(void)
+{
+	if (sContextPool.elemSize != 0)
+	{
+		PoolTerminate(&sContextPool);
+	}
 }
 
 const char *AIStateGetChatterText(const AIState s)
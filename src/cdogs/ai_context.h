@@ -88,9 +88,42 @@ typedef struct
 	int PathIndex;
 	bool IsFollowing;
 } AIGotoContext;
+// How often the AI makes decisions, depending on how close it is to players
+typedef enum
+{
+	AI_LOD_NEAR,	// every AI update
+	AI_LOD_FAR,		// off-screen
+	AI_LOD_DORMANT, // asleep far from all players; no decisions until woken
+	AI_LOD_COUNT
+} AILOD;
+// What the AI perceived at the start of the AI update, before anyone moved
+// Perception runs in parallel; decisions read it instead of searching the
+// world themselves, and it is only valid until the AI's next decision
+typedef struct
+{
+	bool IsValid;
+	// Where the AI was when perceiving
+	struct vec2 Pos;
+	bool CanSeeTarget; // can see a player or someone being attacked
+	bool IsNearPlayer; // close enough to stay awake
+	// Player to hunt or follow: the closest, or for AI players, the closest
+	// that joined before them; index into gActors or -1
+	int PlayerId;
+	struct vec2 PlayerPos;
+	bool HasClearPathToPlayer; // walking, ignoring objects
+	// Closest visible enemy; index into gActors or -1
+	int EnemyId;
+	struct vec2 EnemyPos;
+	bool HasClearShot; // at the enemy
+} AIPerception;
 typedef struct
 {
 	int LastCmd;
+	AILOD LOD;
+	// AI updates until the next decision; LastCmd is repeated until then
+	int ThinkCounter;
+	bool IsThinking;
+	AIPerception Perception;
 	// Delay in executing consecutive actions;
 	// Used to let the AI perform one action for a set amount of time
 	int Delay;
@@ -109,6 +142,8 @@ typedef struct
 
 AIContext *AIContextNew(void);
 void AIContextDestroy(AIContext *c);
+// Free the memory for all AI contexts; call after all actors are destroyed
+void AIContextsTerminate(void);
 
 const char *AIStateGetChatterText(const AIState s);
 bool AIContextShowChatter(const AIChatterFrequency f);
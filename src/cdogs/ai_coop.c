@@ -29,6 +29,7 @@
 #include "ai_coop.h"
 
 #include "ai_utils.h"
+#include "alloc.h"
 #include "gamedata.h"
 #include "pickup.h"
 
@@ -48,6 +49,16 @@ int AICoopGetCmd(TActor *actor, const int ticks)
 	{
 		actor->aiContext = AIContextNew();
 	}
+	// Between decisions (see AIThinkPlayers), keep moving, but don't repeat
+	// one-off actions like switching weapons
+	if (!actor->aiContext->IsThinking)
+	{
+		if (actor->confused)
+		{
+			actor->aiContext->Delay = MAX(0, actor->aiContext->Delay - ticks);
+		}
+		return actor->aiContext->LastCmd & ~CMD_BUTTON2;
+	}
 
 	int cmd = 0;
 
@@ -63,8 +74,9 @@ int AICoopGetCmd(TActor *actor, const int ticks)
 		actor->aiContext->Delay = MAX(0, actor->aiContext->Delay - ticks);
 		if (actor->aiContext->Delay == 0)
 		{
-			actor->aiContext->Delay = CONFUSION_STATE_TICKS_MIN +
-									  (rand() % CONFUSION_STATE_TICKS_RANGE);
+			actor->aiContext->Delay =
+				CONFUSION_STATE_TICKS_MIN +
+				RAND_INT(0, CONFUSION_STATE_TICKS_RANGE);
 			if (s->Type == AI_CONFUSION_CONFUSED)
 			{
 				s->Type = AI_CONFUSION_CORRECT;
@@ -74,8 +86,9 @@ int AICoopGetCmd(TActor *actor, const int ticks)
 				ActorSetAIState(actor, AI_STATE_CONFUSED);
 				s->Type = AI_CONFUSION_CONFUSED;
 				// Generate the confused action
-				s->Cmd = rand() & (CMD_LEFT | CMD_RIGHT | CMD_UP | CMD_DOWN |
-								   CMD_BUTTON1 | CMD_BUTTON2);
+				s->Cmd = RAND_INT(
+					0, (CMD_LEFT | CMD_RIGHT | CMD_UP | CMD_DOWN |
+						CMD_BUTTON1 | CMD_BUTTON2) + 1);
 			}
 		}
 		// Choose confusion action based on state
@@ -105,6 +118,8 @@ int AICoopGetCmd(TActor *actor, const int ticks)
 		// Act normally
 		cmd = AICoopGetCmdNormal(actor);
 	}
+	actor->aiContext->Perception.IsValid = false;
+	actor->aiContext->LastCmd = cmd;
 	return cmd;
 }
 
@@ -271,7 +286,7 @@ static int AICoopGetCmdNormal(TActor *actor)
 	}
 
 	// Check if closest enemy is close enough, and visible
-	const TActor *closestEnemy = AIGetClosestVisibleEnemy(actor, true);
+	const TActor *closestEnemy = AIGetPerceivedEnemy(actor);
 	if (closestEnemy)
 	{
 		const float minEnemyDistance = CHEBYSHEV_DISTANCE(
@@ -279,7 +294,7 @@ static int AICoopGetCmdNormal(TActor *actor)
 			closestEnemy->Pos.y);
 		// Also only engage if there's a clear shot
 		if (minEnemyDistance > 0 && minEnemyDistance < 12 * 16 &&
-			AIHasClearShot(actor->Pos, closestEnemy->Pos))
+			AIHasPerceivedClearShot(actor, closestEnemy->Pos))
 		{
 			ActorSetAIState(actor, AI_STATE_HUNT);
 			if (closestEnemy->uid != actor->aiContext->EnemyId)
@@ -336,7 +351,8 @@ static int SmartGoto(
 	int cmd = AIGoto(actor, pos, true);
 	// Try to slide if there is a clear path and we are far enough away
 	if (CMD_HAS_DIRECTION(cmd) &&
-		AIHasClearPath(actor->Pos, pos, !actor->aiContext->IsStuckTooLong) &&
+		AIHasPerceivedClearPath(
+			actor, pos, !actor->aiContext->IsStuckTooLong) &&
 		minDistance2 > SQUARED(7 * 16))
 	{
 		cmd |= CMD_BUTTON2;
@@ -390,8 +406,9 @@ typedef struct
 	bool IsDestructible;
 	AIObjectiveType Type;
 } ClosestObjective;
-static void FindObjectivesSortedByDistance(
-	CArray *objectives, const TActor *actor, const TActor *closestPlayer);
+static int FindObjectivesSortedByDistance(
+	ClosestObjective **objectives, const TActor *actor,
+	const TActor *closestPlayer);
 static bool CanGetObjective(
 	const struct vec2 objPos, const struct vec2 actorPos, const TActor *player,
 	const float distanceTooFarFromPlayer);
@@ -471,15 +488,19 @@ static bool TryCompleteNearbyObjective(
 	}
 
 	// Find all the objective/key locations, sort according to distance
-	// TODO: reuse this array, don't recreate it
-	CArray objectives;
-	FindObjectivesSortedByDistance(&objectives, actor, closestPlayer);
+	ClosestObjective *objectives;
+	const int numObjectives =
+		FindObjectivesSortedByDistance(&objectives, actor, closestPlayer);
 
 	// Starting from the closest objectives, find one we can go to
-	CA_FOREACH(ClosestObjective, c, objectives)
-	if (CanGetObjective(
-			c->Pos, actor->Pos, closestPlayer, distanceTooFarFromPlayer))
+	for (int i = 0; i < numObjectives; i++)
 	{
+		const ClosestObjective *c = &objectives[i];
+		if (!CanGetObjective(
+				c->Pos, actor->Pos, closestPlayer, distanceTooFarFromPlayer))
+		{
+			continue;
+		}
 		ActorSetAIState(actor, AI_STATE_NEXT_OBJECTIVE);
 		objState->Type = c->Type;
 		objState->IsDestructible = c->IsDestructible;
@@ -506,7 +527,6 @@ static bool TryCompleteNearbyObjective(
 		*cmdOut = GotoObjective(actor, c->Distance2);
 		return true;
 	}
-	CA_FOREACH_END()
 	return false;
 }
 static bool ShouldPickupGun(
@@ -575,15 +595,22 @@ static AIObjectiveType GetPickupObjectiveType(
 	return AI_OBJECTIVE_TYPE_NORMAL;
 }
 static int CompareClosestObjective(const void *v1, const void *v2);
-static void FindObjectivesSortedByDistance(
-	CArray *objectives, const TActor *actor, const TActor *closestPlayer)
+static int FindObjectivesSortedByDistance(
+	ClosestObjective **objectives, const TActor *actor,
+	const TActor *closestPlayer)
 {
-	CArrayInit(objectives, sizeof(ClosestObjective));
+	// At most one objective per enemy, pickup, object, actor and objective
+	const size_t maxObjectives = 1 + gPickups.size + gObjs.size +
+								 gActors.size +
+								 gMission.missionData->Objectives.size;
+	ClosestObjective *objs =
+		FrameAlloc(&gFrameAlloc, maxObjectives * sizeof *objs);
+	int n = 0;
 
 	// If PVP, find the closest enemy and go to them
 	if (IsPVP(gCampaign.Entry.Mode))
 	{
-		const TActor *closestEnemy = AIGetClosestVisibleEnemy(actor, true);
+		const TActor *closestEnemy = AIGetPerceivedEnemy(actor);
 		if (closestEnemy != NULL)
 		{
 			ClosestObjective co;
@@ -593,7 +620,7 @@ static void FindObjectivesSortedByDistance(
 			co.Type = AI_OBJECTIVE_TYPE_KILL;
 			co.Distance2 = svec2_distance_squared(actor->Pos, co.Pos);
 			co.u.UID = closestEnemy->uid;
-			CArrayPushBack(objectives, &co);
+			objs[n++] = co;
 		}
 	}
 
@@ -615,7 +642,7 @@ static void FindObjectivesSortedByDistance(
 	// Check if the pickup is actually accessible
 	// This is because random spawning may cause some pickups to be spawned
 	// in inaccessible areas
-	if (!TileCanWalk(MapGetTile(&gMap, Vec2ToTile(co.Pos))))
+	if (!MapTileCanWalk(&gMap, Vec2ToTile(co.Pos)))
 	{
 		continue;
 	}
@@ -626,7 +653,7 @@ static void FindObjectivesSortedByDistance(
 		co.u.Objective =
 			CArrayGet(&gMission.missionData->Objectives, objective);
 	}
-	CArrayPushBack(objectives, &co);
+	objs[n++] = co;
 	CA_FOREACH_END()
 
 	// Look for destructibles
@@ -652,7 +679,7 @@ static void FindObjectivesSortedByDistance(
 		co.u.Objective =
 			CArrayGet(&gMission.missionData->Objectives, objective);
 	}
-	CArrayPushBack(objectives, &co);
+	objs[n++] = co;
 	CA_FOREACH_END()
 
 	// Look for kill or rescue objectives
@@ -685,7 +712,7 @@ static void FindObjectivesSortedByDistance(
 	co.Type = AI_OBJECTIVE_TYPE_NORMAL;
 	co.Distance2 = svec2_distance_squared(actor->Pos, co.Pos);
 	co.u.Objective = o;
-	CArrayPushBack(objectives, &co);
+	objs[n++] = co;
 	CA_FOREACH_END()
 
 	// Look for explore objectives
@@ -709,13 +736,13 @@ static void FindObjectivesSortedByDistance(
 	co.Type = AI_OBJECTIVE_TYPE_NORMAL;
 	co.Distance2 = svec2_distance_squared(actor->Pos, co.Pos);
 	co.u.Objective = o;
-	CArrayPushBack(objectives, &co);
+	objs[n++] = co;
 	CA_FOREACH_END()
 
 	// Sort according to distance
-	qsort(
-		objectives->data, objectives->size, objectives->elemSize,
-		CompareClosestObjective);
+	qsort(objs, n, sizeof *objs, CompareClosestObjective);
+	*objectives = objs;
+	return n;
 }
 static bool ShouldPickupGun(
 	const PickupEffect *pe, const TActor *actor, const TActor *closestPlayer)
@@ -846,7 +873,7 @@ static int GotoObjective(TActor *actor, const float objDistance2)
 		ActorGetCanFireBarrel(actor, ACTOR_GET_WEAPON(actor)) >= 0)
 	{
 		cmd = AIHunt(actor, goal);
-		if (AIHasClearShot(actor->Pos, goal))
+		if (AIHasPerceivedClearShot(actor, goal))
 		{
 			cmd |= CMD_BUTTON1;
 		}
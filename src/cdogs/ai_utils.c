@@ -50,6 +50,7 @@
 
 #include <assert.h>
 
+#include "actor_grid.h"
 #include "algorithms.h"
 #include "collision/collision.h"
 #include "gamedata.h"
@@ -58,55 +59,52 @@
 #include "path_cache.h"
 #include "weapon.h"
 
-TActor *AIGetClosestPlayer(const struct vec2 pos)
+static bool IsAlivePlayer(const TActor *a, const void *data)
 {
-	float minDistance2 = -1;
-	TActor *closestPlayer = NULL;
-	CA_FOREACH(const PlayerData, pd, gPlayerDatas)
-	if (!IsPlayerAlive(pd))
-	{
-		continue;
-	}
-	TActor *p = ActorGetByUID(pd->ActorUID);
-	const float distance2 = svec2_distance_squared(pos, p->Pos);
-	if (!closestPlayer || distance2 < minDistance2)
+	UNUSED(data);
+	if (a->PlayerUID < 0 || a->dead)
 	{
-		closestPlayer = p;
-		minDistance2 = distance2;
+		return false;
 	}
-	CA_FOREACH_END()
-	return closestPlayer;
+	// Make sure this is the player's current actor
+	const PlayerData *pd = PlayerDataGetByUID(a->PlayerUID);
+	return pd != NULL && pd->ActorUID == a->uid;
+}
+TActor *AIGetClosestPlayer(const struct vec2 pos)
+{
+	return ActorGridGetClosest(&gActorGrid, pos, -1, IsAlivePlayer, NULL);
 }
 
-static TActor *AIGetClosestActor(
-	const struct vec2 fromPos, const TActor *from,
-	bool (*compFunc)(const TActor *, const TActor *))
+typedef struct
 {
-	// Search all the actors and find the closest one that
-	// satisfies the condition
-	TActor *closest = NULL;
-	float minDistance2 = -1;
-	CA_FOREACH(TActor, a, gActors)
-	if (!a->isInUse || a->dead)
+	const TActor *from;
+	bool (*compFunc)(const TActor *, const TActor *);
+} ClosestActorData;
+static bool IsClosestActorCandidate(const TActor *a, const void *data)
+{
+	const ClosestActorData *cad = data;
+	if (a->dead)
 	{
-		continue;
+		return false;
 	}
 	// Never target invulnerables or civilians
 	if (a->flags & (FLAGS_INVULNERABLE | FLAGS_PENALTY))
 	{
-		continue;
-	}
-	if (compFunc(a, from))
-	{
-		const float distance2 = svec2_distance_squared(fromPos, a->Pos);
-		if (!closest || distance2 < minDistance2)
-		{
-			minDistance2 = distance2;
-			closest = a;
-		}
+		return false;
 	}
-	CA_FOREACH_END()
-	return closest;
+	return cad->compFunc(a, cad->from);
+}
+static TActor *AIGetClosestActor(
+	const struct vec2 fromPos, const TActor *from,
+	bool (*compFunc)(const TActor *, const TActor *), const float maxDistance)
+{
+	// Search the nearby actors and find the closest one that
+	// satisfies the condition
+	ClosestActorData cad;
+	cad.from = from;
+	cad.compFunc = compFunc;
+	return ActorGridGetClosest(
+		&gActorGrid, fromPos, maxDistance, IsClosestActorCandidate, &cad);
 }
 
 static bool IsGood(const TActor *a, const TActor *b)
@@ -123,22 +121,23 @@ static bool IsDifferent(const TActor *a, const TActor *b)
 	return a != b;
 }
 const TActor *AIGetClosestEnemy(
-	const struct vec2 from, const TActor *a, const int flags)
+	const struct vec2 from, const TActor *a, const int flags,
+	const float maxDistance)
 {
 	if (IsPVP(gCampaign.Entry.Mode))
 	{
 		// free for all; look for anybody else
-		return AIGetClosestActor(from, a, IsDifferent);
+		return AIGetClosestActor(from, a, IsDifferent, maxDistance);
 	}
 	else if ((!a || a->PlayerUID < 0) && !(flags & FLAGS_GOOD_GUY))
 	{
 		// we are bad; look for good guys
-		return AIGetClosestActor(from, a, IsGood);
+		return AIGetClosestActor(from, a, IsGood, maxDistance);
 	}
 	else
 	{
 		// we are good; look for bad guys
-		return AIGetClosestActor(from, a, IsBad);
+		return AIGetClosestActor(from, a, IsBad, maxDistance);
 	}
 }
 
@@ -155,17 +154,17 @@ const TActor *AIGetClosestVisibleEnemy(const TActor *from, const bool isPlayer)
 	if (IsPVP(gCampaign.Entry.Mode))
 	{
 		// free for all; look for anybody
-		return AIGetClosestActor(from->Pos, from, IsDifferent);
+		return AIGetClosestActor(from->Pos, from, IsDifferent, -1);
 	}
 	else if (!isPlayer && !(from->flags & FLAGS_GOOD_GUY))
 	{
 		// we are bad; look for good guys
-		return AIGetClosestActor(from->Pos, from, IsGoodAndVisible);
+		return AIGetClosestActor(from->Pos, from, IsGoodAndVisible, -1);
 	}
 	else
 	{
 		// we are good; look for bad guys
-		return AIGetClosestActor(from->Pos, from, IsBadAndVisible);
+		return AIGetClosestActor(from->Pos, from, IsBadAndVisible, -1);
 	}
 }
 
@@ -182,6 +181,57 @@ struct vec2 AIGetClosestPlayerPos(const struct vec2 pos)
 	}
 }
 
+static const TActor *GetPerceivedActor(const int id)
+{
+	if (id < 0)
+	{
+		return NULL;
+	}
+	const TActor *a = CArrayGet(&gActors, id);
+	return a->isInUse && !a->dead ? a : NULL;
+}
+const TActor *AIGetPerceivedPlayer(const TActor *a)
+{
+	const AIPerception *p = &a->aiContext->Perception;
+	if (p->IsValid)
+	{
+		return GetPerceivedActor(p->PlayerId);
+	}
+	return AIGetClosestPlayer(a->Pos);
+}
+const TActor *AIGetPerceivedEnemy(const TActor *a)
+{
+	const AIPerception *p = &a->aiContext->Perception;
+	if (p->IsValid)
+	{
+		return GetPerceivedActor(p->EnemyId);
+	}
+	return AIGetClosestVisibleEnemy(a, a->PlayerUID >= 0);
+}
+bool AIHasPerceivedClearShot(const TActor *a, const struct vec2 to)
+{
+	const AIPerception *p = &a->aiContext->Perception;
+	if (p->IsValid && p->EnemyId >= 0 && svec2_is_equal(a->Pos, p->Pos) &&
+		svec2_is_equal(to, p->EnemyPos))
+	{
+		return p->HasClearShot;
+	}
+	return AIHasClearShot(a->Pos, to);
+}
+bool AIHasPerceivedClearPath(
+	const TActor *a, const struct vec2 to, const bool ignoreObjects)
+{
+	// Paths are checked between tiles
+	const AIPerception *p = &a->aiContext->Perception;
+	if (p->IsValid && p->PlayerId >= 0 && ignoreObjects &&
+		svec2i_is_equal(Vec2ToTile(a->Pos), Vec2ToTile(p->Pos)) &&
+		svec2i_is_equal(Vec2ToTile(to), Vec2ToTile(p->PlayerPos)))
+	{
+		return p->HasClearPathToPlayer;
+	}
+	return AIHasClearPath(a->Pos, to, ignoreObjects);
+}
+
 int AIReverseDirection(int cmd)
 {
 	if (cmd & (CMD_LEFT | CMD_RIGHT))
@@ -289,16 +339,11 @@ static bool IsTileNoWalkAroundObjects(void *data, const struct vec2i pos)
 }
 static bool IsTileWalkableOrOpenable(Map *map, struct vec2i pos)
 {
-	const Tile *tile = MapGetTile(map, pos);
-	if (tile == NULL)
-	{
-		return false;
-	}
-	if (TileCanWalk(tile))
+	if (MapTileCanWalk(map, pos))
 	{
 		return true;
 	}
-	if (tile->Class->Type == TILE_CLASS_DOOR)
+	if (MapTileIsDoor(map, pos))
 	{
 		// A door; check if we can open it
 		int keycard = MapGetDoorKeycardFlag(map, pos);
@@ -313,10 +358,6 @@ static bool IsTileWalkableOrOpenable(Map *map, struct vec2i pos)
 	return false;
 }
 
-static bool IsPosNoSee(void *data, struct vec2i pos)
-{
-	return TileIsOpaque(MapGetTile(data, Vec2iToTile(pos)));
-}
 bool AIHasClearView(
 	const TActor *a, const struct vec2 to, const int sightRange)
 {
@@ -324,13 +365,18 @@ bool AIHasClearView(
 	{
 		return false;
 	}
-	return AIHasClearLine(
-		svec2i_assign_vec2(a->Pos), svec2i_assign_vec2(to), IsPosNoSee);
+	return HasClearLineJMRaytraceGrid(
+		&gMap.opaque, svec2i(TILE_WIDTH, TILE_HEIGHT),
+		svec2i_assign_vec2(a->Pos), svec2i_assign_vec2(to));
+}
+int AIGetSightRange(void)
+{
+	return ConfigGetInt(&gConfig, "Game.SightRange") * TILE_WIDTH;
 }
-bool AICanSee(const TActor *a, const struct vec2 target, const direction_e d)
+bool AICanSee(
+	const TActor *a, const struct vec2 target, const direction_e d,
+	const int sightRange)
 {
-	const int sightRange =
-		ConfigGetInt(&gConfig, "Game.SightRange") * TILE_WIDTH;
 	if ((a->flags & FLAGS_ALL_SEEING) || AIIsFacing(a, target, d))
 	{
 		return AIHasClearView(a, target, sightRange * 2 / 3);
@@ -345,9 +391,11 @@ bool AICanSee(const TActor *a, const struct vec2 target, const direction_e d)
 	return false;
 }
 
-static bool IsPosShootable(void *data, const struct vec2i pos)
+static bool HasClearShotLine(const struct vec2 from, const struct vec2 to)
 {
-	return TileIsShootable(MapGetTile(data, Vec2iToTile(pos)));
+	return HasClearLineJMRaytraceGrid(
+		&gMap.shootable, svec2i(TILE_WIDTH, TILE_HEIGHT),
+		svec2i_assign_vec2(from), svec2i_assign_vec2(to));
 }
 bool AIHasClearShot(const struct vec2 from, const struct vec2 to)
 {
@@ -357,35 +405,25 @@ bool AIHasClearShot(const struct vec2 from, const struct vec2 to)
 
 	const int pad = 2;
 	fromOffset.x = from.x - (ACTOR_W + pad) / 2;
-	if (Vec2ToTile(fromOffset).x >= 0 &&
-		!AIHasClearLine(
-			svec2i_assign_vec2(fromOffset), svec2i_assign_vec2(to),
-			IsPosShootable))
+	if (Vec2ToTile(fromOffset).x >= 0 && !HasClearShotLine(fromOffset, to))
 	{
 		return false;
 	}
 	fromOffset.x = from.x + (ACTOR_W + pad) / 2;
 	if (Vec2ToTile(fromOffset).x < gMap.Size.x &&
-		!AIHasClearLine(
-			svec2i_assign_vec2(fromOffset), svec2i_assign_vec2(to),
-			IsPosShootable))
+		!HasClearShotLine(fromOffset, to))
 	{
 		return false;
 	}
 	fromOffset.x = from.x;
 	fromOffset.y = from.y - (ACTOR_H + pad) / 2;
-	if (Vec2ToTile(fromOffset).y >= 0 &&
-		!AIHasClearLine(
-			svec2i_assign_vec2(fromOffset), svec2i_assign_vec2(to),
-			IsPosShootable))
+	if (Vec2ToTile(fromOffset).y >= 0 && !HasClearShotLine(fromOffset, to))
 	{
 		return false;
 	}
 	fromOffset.y = from.y + (ACTOR_H + pad) / 2;
 	if (Vec2ToTile(fromOffset).y < gMap.Size.y &&
-		!AIHasClearLine(
-			svec2i_assign_vec2(fromOffset), svec2i_assign_vec2(to),
-			IsPosShootable))
+		!HasClearShotLine(fromOffset, to))
 	{
 		return false;
 	}
@@ -604,11 +642,53 @@ static int AStarCloseToPath(
 	}
 	return 1;
 }
+static const TActor *GetPlayerAtTile(const struct vec2i tile)
+{
+	CA_FOREACH(const PlayerData, pd, gPlayerDatas)
+	if (!IsPlayerAlive(pd))
+	{
+		continue;
+	}
+	const TActor *a = ActorGetByUID(pd->ActorUID);
+	if (svec2i_is_equal(Vec2ToTile(a->Pos), tile))
+	{
+		return a;
+	}
+	CA_FOREACH_END()
+	return NULL;
+}
+static bool AIGotoPlayer(
+	const TActor *actor, const struct vec2i currentTile,
+	const struct vec2i goalTile, int *cmd)
+{
+	const TActor *player = GetPlayerAtTile(goalTile);
+	if (player == NULL)
+	{
+		return false;
+	}
+	const struct vec2i target =
+		MapSearchTileAround(&gMap, goalTile, IsTileWalkable);
+	struct vec2i next;
+	if (!PathCacheFlowStep(
+			&gPathCache, player->uid, target, currentTile, &next))
+	{
+		return false;
+	}
+	// Make sure the actor is fully within the current tile before heading
+	// for the next, otherwise it may get stuck at corners
+	if (!IsThingInsideTile(&actor->thing, currentTile))
+	{
+		next = currentTile;
+	}
+	*cmd = AIGotoDirect(actor->Pos, Vec2CenterOfTile(next));
+	return true;
+}
 int AIGoto(const TActor *actor, const struct vec2 p, const bool ignoreObjects)
 {
 	const struct vec2i currentTile = Vec2ToTile(actor->Pos);
 	const struct vec2i goalTile = Vec2ToTile(p);
 	AIGotoContext *c = &actor->aiContext->Goto;
+	int cmd;
 
 	CASSERT(c != NULL, "no AI context");
 
@@ -627,12 +707,19 @@ int AIGoto(const TActor *actor, const struct vec2 p, const bool ignoreObjects)
 	{
 		return AStarFollow(c, currentTile, &actor->thing, actor->Pos);
 	}
-	else if (AIHasClearPath(actor->Pos, p, ignoreObjects))
+	else if (AIHasPerceivedClearPath(actor, p, ignoreObjects))
 	{
 		// Simple case: if there's a clear line between AI and target,
 		// walk straight towards it
 		return AIGotoDirect(actor->Pos, p);
 	}
+	else if (ignoreObjects && AIGotoPlayer(actor, currentTile, goalTile, &cmd))
+	{
+		// Heading for a player; use the flow field shared by everyone
+		// else heading for the same player
+		c->IsFollowing = false;
+		return cmd;
+	}
 	else
 	{
 		// We need to recalculate A*
@@ -703,13 +790,16 @@ int AIHuntClosest(TActor *actor)
 	struct vec2 targetPos = actor->Pos;
 	if (!(actor->PlayerUID >= 0 || (actor->flags & FLAGS_GOOD_GUY)))
 	{
-		targetPos = AIGetClosestPlayerPos(actor->Pos);
+		const TActor *player = AIGetPerceivedPlayer(actor);
+		if (player)
+		{
+			targetPos = player->Pos;
+		}
 	}
 
 	if (actor->flags & FLAGS_VISIBLE)
 	{
-		const TActor *a =
-			AIGetClosestVisibleEnemy(actor, actor->PlayerUID >= 0);
+		const TActor *a = AIGetPerceivedEnemy(actor);
 		if (a)
 		{
 			targetPos = a->Pos;
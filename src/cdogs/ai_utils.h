@@ -54,11 +54,21 @@
 #include "objs.h"
 
 TActor *AIGetClosestPlayer(const struct vec2 pos);
+// maxDistance: ignore enemies further than this; use < 0 for no limit
 const TActor *AIGetClosestEnemy(
-	const struct vec2 from, const TActor *a, const int flags);
+	const struct vec2 from, const TActor *a, const int flags,
+	const float maxDistance);
 const TActor *AIGetClosestVisibleEnemy(
 	const TActor *from, const bool isPlayer);
 struct vec2 AIGetClosestPlayerPos(const struct vec2 pos);
+// Targets and line checks from the AI's perception (see AIPerception), if
+// it is still valid and for the same positions; otherwise these search the
+// world like the functions above
+const TActor *AIGetPerceivedPlayer(const TActor *a);
+const TActor *AIGetPerceivedEnemy(const TActor *a);
+bool AIHasPerceivedClearShot(const TActor *a, const struct vec2 to);
+bool AIHasPerceivedClearPath(
+	const TActor *a, const struct vec2 to, const bool ignoreObjects);
 int AIReverseDirection(int cmd);
 bool AIHasClearView(const TActor *a, const struct vec2 to, const int sightRange);
 bool AIHasClearShot(const struct vec2 from, const struct vec2 to);
@@ -69,8 +79,12 @@ bool AIHasPath(
 TObject *AIGetObjectRunningInto(TActor *a, int cmd);
 // AI is facing something within a 90 degree arc
 bool AIIsFacing(const TActor *a, const struct vec2 target, const direction_e d);
+// Configured sight range, in pixels
+int AIGetSightRange(void);
 // AI can see something in view or in periphery
-bool AICanSee(const TActor *a, const struct vec2 target, const direction_e d);
+bool AICanSee(
+	const TActor *a, const struct vec2 target, const direction_e d,
+	const int sightRange);
 
 // Find path to target
 // destroyObjects - if true, ignore obstructing objects
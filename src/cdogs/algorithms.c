@@ -139,6 +139,98 @@ static bool JMRaytrace(int x0, int y0, int x1, int y1, AlgoLineData *data)
 	return true;
 }
 
+// JMRaytrace over a grid of blocking cells
+// The cell and the point's position within it are stepped along with the
+// point, so each point costs a few integer ops, and cells are only checked
+// when the line enters them
+typedef struct
+{
+	const BitGrid *blocked;
+	BitGrid *visited;
+	struct vec2i cellSize;
+	// Start point, as a cell and the position within it
+	struct vec2i cell;
+	struct vec2i sub;
+} GridRaytrace;
+static int FloorDiv(const int a, const int b)
+{
+	return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+static void GridRaytraceInit(
+	GridRaytrace *r, const BitGrid *blocked, BitGrid *visited,
+	const struct vec2i cellSize, const struct vec2i from)
+{
+	r->blocked = blocked;
+	r->visited = visited;
+	r->cellSize = cellSize;
+	r->cell = svec2i(
+		FloorDiv(from.x, cellSize.x), FloorDiv(from.y, cellSize.y));
+	r->sub = svec2i(
+		from.x - r->cell.x * cellSize.x, from.y - r->cell.y * cellSize.y);
+}
+// Returns whether the cell is blocked, and marks it as visited
+static bool GridRaytraceEnter(const GridRaytrace *r, const struct vec2i cell)
+{
+	if (r->visited != NULL && cell.x >= 0 && cell.y >= 0 &&
+		cell.x < r->visited->size.x && cell.y < r->visited->size.y)
+	{
+		BitGridSet(r->visited, cell, true);
+	}
+	return BitGridGet(r->blocked, cell);
+}
+// The start cell must already have been entered
+static bool JMRaytraceGrid(
+	const GridRaytrace *r, const struct vec2i from, const struct vec2i to)
+{
+	int dx = abs(to.x - from.x);
+	int dy = abs(to.y - from.y);
+	int n = dx + dy;
+	const int xInc = (to.x > from.x) ? 1 : -1;
+	const int yInc = (to.y > from.y) ? 1 : -1;
+	int error = dx - dy;
+	dx *= 2;
+	dy *= 2;
+	struct vec2i cell = r->cell;
+	struct vec2i sub = r->sub;
+
+	for (; n > 0; --n)
+	{
+		if (error > 0)
+		{
+			error -= dy;
+			sub.x += xInc;
+			if (sub.x < 0 || sub.x == r->cellSize.x)
+			{
+				sub.x -= xInc * r->cellSize.x;
+				cell.x += xInc;
+			}
+			else
+			{
+				continue;
+			}
+		}
+		else
+		{
+			error += dx;
+			sub.y += yInc;
+			if (sub.y < 0 || sub.y == r->cellSize.y)
+			{
+				sub.y -= yInc * r->cellSize.y;
+				cell.y += yInc;
+			}
+			else
+			{
+				continue;
+			}
+		}
+		if (GridRaytraceEnter(r, cell))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
 bool HasClearLineBresenham(
 	struct vec2i from, struct vec2i to, HasClearLineData *data)
 {
@@ -157,6 +249,32 @@ bool HasClearLineJMRaytrace(
 	bData.data = data->data;
 	return JMRaytrace(from.x, from.y, to.x, to.y, &bData);
 }
+bool HasClearLineJMRaytraceGrid(
+	const BitGrid *blocked, const struct vec2i cellSize,
+	const struct vec2i from, const struct vec2i to)
+{
+	GridRaytrace r;
+	GridRaytraceInit(&r, blocked, NULL, cellSize, from);
+	return !GridRaytraceEnter(&r, r.cell) && JMRaytraceGrid(&r, from, to);
+}
+void JMRaytraceGridBatch(
+	const BitGrid *blocked, const struct vec2i cellSize,
+	const struct vec2i from, const struct vec2i *ends, const int count,
+	bool *clear, BitGrid *visited)
+{
+	// All the lines start in the same cell, so only check it once
+	GridRaytrace r;
+	GridRaytraceInit(&r, blocked, visited, cellSize, from);
+	const bool startBlocked = GridRaytraceEnter(&r, r.cell);
+	for (int i = 0; i < count; i++)
+	{
+		const bool isClear = !startBlocked && JMRaytraceGrid(&r, from, ends[i]);
+		if (clear != NULL)
+		{
+			clear[i] = isClear;
+		}
+	}
+}
 
 void BresenhamLineDraw(
 	struct vec2i from, struct vec2i to, AlgoLineDrawData *data)
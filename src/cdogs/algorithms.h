@@ -29,6 +29,7 @@
 
 #include <stdbool.h>
 
+#include "bit_grid.h"
 #include "vector.h"
 
 typedef struct
@@ -42,6 +43,23 @@ bool HasClearLineBresenham(
 bool HasClearLineJMRaytrace(
 	const struct vec2i from, const struct vec2i to, HasClearLineData *data);
 
+// Same as HasClearLineJMRaytrace, but checks a grid of blocking cells
+// directly instead of calling back for each point
+// Points are in units where each cell is cellSize, e.g. pixels with
+// svec2i(TILE_WIDTH, TILE_HEIGHT), or svec2i(1, 1) for cells
+// Out of bounds cells are not blocking
+bool HasClearLineJMRaytraceGrid(
+	const BitGrid *blocked, const struct vec2i cellSize,
+	const struct vec2i from, const struct vec2i to);
+// Cast lines from one point to many, e.g. for line of sight
+// If clear is not NULL, clear[i] is whether the line to ends[i] is clear
+// If visited is not NULL, the in-bounds cells that each line passes
+// through, up to and including the first blocking cell, are set in it
+void JMRaytraceGridBatch(
+	const BitGrid *blocked, const struct vec2i cellSize,
+	const struct vec2i from, const struct vec2i *ends, const int count,
+	bool *clear, BitGrid *visited);
+
 typedef struct
 {
 	void (*Draw)(void *, struct vec2i);
@@ -0,0 +1,162 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "alloc.h"
+
+#include <string.h>
+
+#include "utils.h"
+
+#define ALLOC_ALIGN 16
+#define ALIGN_UP(_x) (((_x) + ALLOC_ALIGN - 1) & ~(size_t)(ALLOC_ALIGN - 1))
+
+FrameAllocator gFrameAlloc;
+
+void FrameAllocInit(FrameAllocator *fa)
+{
+	memset(fa, 0, sizeof *fa);
+	CArrayInit(&fa->blocks, sizeof(FrameAllocBlock));
+}
+void FrameAllocTerminate(FrameAllocator *fa)
+{
+	CA_FOREACH(FrameAllocBlock, b, fa->blocks)
+	CFREE(b->data);
+	CA_FOREACH_END()
+	CArrayTerminate(&fa->blocks);
+	memset(fa, 0, sizeof *fa);
+}
+
+void FrameAllocReset(FrameAllocator *fa)
+{
+	fa->block = 0;
+	fa->used = 0;
+	fa->LastStats = fa->stats;
+	fa->stats.HeapAllocs = 0;
+	fa->stats.FrameAllocs = 0;
+	fa->stats.FrameBytes = 0;
+	fa->stats.PoolAllocs = 0;
+}
+
+void *FrameAlloc(FrameAllocator *fa, const size_t size)
+{
+	if (fa->blocks.elemSize == 0)
+	{
+		// Used before init, e.g. by tools that don't run the game loop
+		FrameAllocInit(fa);
+	}
+	fa->stats.FrameAllocs++;
+	fa->stats.FrameBytes += size;
+	// Find the first block from the current one with enough room
+	for (; fa->block < (int)fa->blocks.size; fa->block++, fa->used = 0)
+	{
+		FrameAllocBlock *b = CArrayGet(&fa->blocks, fa->block);
+		const size_t start = ALIGN_UP(fa->used);
+		if (start + size <= b->size)
+		{
+			fa->used = start + size;
+			return b->data + start;
+		}
+	}
+	// Out of blocks; add another, big enough for this allocation
+	FrameAllocBlock b;
+	b.size = MAX(size, (size_t)FRAME_ALLOC_BLOCK_SIZE);
+	CMALLOC(b.data, b.size);
+	fa->stats.HeapAllocs++;
+	CArrayPushBack(&fa->blocks, &b);
+	fa->block = (int)fa->blocks.size - 1;
+	fa->used = size;
+	return b.data;
+}
+void *FrameCalloc(FrameAllocator *fa, const size_t size)
+{
+	void *p = FrameAlloc(fa, size);
+	memset(p, 0, size);
+	return p;
+}
+char *FrameStrDup(FrameAllocator *fa, const char *s)
+{
+	const size_t len = strlen(s) + 1;
+	char *p = FrameAlloc(fa, len);
+	memcpy(p, s, len);
+	return p;
+}
+
+void PoolInit(Pool *p, const size_t elemSize, const int blockElems)
+{
+	memset(p, 0, sizeof *p);
+	// Free objects store the free list link in place
+	p->elemSize = ALIGN_UP(MAX(elemSize, sizeof(void *)));
+	p->blockElems = MAX(blockElems, 1);
+	CArrayInit(&p->blocks, sizeof(char *));
+}
+void PoolTerminate(Pool *p)
+{
+	CASSERT(p->numLive == 0, "pool objects still in use");
+	gFrameAlloc.stats.PoolLive -= p->numLive;
+	CA_FOREACH(char *, block, p->blocks)
+	CFREE(*block);
+	CA_FOREACH_END()
+	CArrayTerminate(&p->blocks);
+	memset(p, 0, sizeof *p);
+}
+
+void *PoolAlloc(Pool *p)
+{
+	if (p->freeList == NULL)
+	{
+		char *block;
+		CMALLOC(block, p->elemSize * p->blockElems);
+		gFrameAlloc.stats.HeapAllocs++;
+		CArrayPushBack(&p->blocks, &block);
+		// Thread the new objects onto the free list, in address order
+		for (int i = p->blockElems - 1; i >= 0; i--)
+		{
+			void *elem = block + i * p->elemSize;
+			*(void **)elem = p->freeList;
+			p->freeList = elem;
+		}
+	}
+	void *elem = p->freeList;
+	p->freeList = *(void **)elem;
+	memset(elem, 0, p->elemSize);
+	p->numLive++;
+	gFrameAlloc.stats.PoolAllocs++;
+	gFrameAlloc.stats.PoolLive++;
+	return elem;
+}
+void PoolFree(Pool *p, void *elem)
+{
+	if (elem == NULL)
+	{
+		return;
+	}
+	CASSERT(p->numLive > 0, "pool free without alloc");
+	*(void **)elem = p->freeList;
+	p->freeList = elem;
+	p->numLive--;
+	gFrameAlloc.stats.PoolLive--;
+}
@@ -0,0 +1,96 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "c_array.h"
+
+#define FRAME_ALLOC_BLOCK_SIZE (64 * 1024)
+
+typedef struct
+{
+	int FrameAllocs;
+	size_t FrameBytes;
+	int PoolAllocs;
+	// Objects currently allocated from all pools
+	int PoolLive;
+	// Blocks allocated from the heap for frame allocations and pools
+	int HeapAllocs;
+} AllocStats;
+
+typedef struct
+{
+	char *data;
+	size_t size;
+} FrameAllocBlock;
+
+// Bump allocator for memory that is only needed until the end of the frame,
+// e.g. scratch arrays in per-frame AI and game logic
+// Everything is released at once when the loop runner starts a new frame;
+// the blocks are kept for reuse so a steady state makes no heap allocations
+// Note: not thread-safe; only use from the main thread (jobs have their own
+// scratch memory, see JobScratchAlloc)
+typedef struct
+{
+	CArray blocks; // of FrameAllocBlock
+	int block;
+	size_t used;
+	// Counts for the current and last complete frame
+	AllocStats stats;
+	AllocStats LastStats;
+} FrameAllocator;
+extern FrameAllocator gFrameAlloc;
+
+void FrameAllocInit(FrameAllocator *fa);
+void FrameAllocTerminate(FrameAllocator *fa);
+// Release all frame allocations and record the frame's stats
+void FrameAllocReset(FrameAllocator *fa);
+void *FrameAlloc(FrameAllocator *fa, const size_t size);
+void *FrameCalloc(FrameAllocator *fa, const size_t size);
+char *FrameStrDup(FrameAllocator *fa, const char *s);
+
+// Fixed-size object pool, for objects that are created and destroyed often
+// Objects are carved out of blocks of blockElems objects and recycled through
+// a free list; blocks are only freed when the pool is terminated
+// Note: not thread-safe
+typedef struct
+{
+	size_t elemSize;
+	int blockElems;
+	CArray blocks; // of char *
+	void *freeList;
+	int numLive;
+} Pool;
+
+void PoolInit(Pool *p, const size_t elemSize, const int blockElems);
+void PoolTerminate(Pool *p);
+// Returns zeroed memory
+void *PoolAlloc(Pool *p);
+void PoolFree(Pool *p, void *elem);
@@ -81,7 +81,7 @@ void AnimationUpdate(Animation *a, const float ticks)
 				// Note: -1 means frame not used, so pick another frame
 				do
 				{
-					a->frame = (rand() % (ANIMATION_MAX_FRAMES - 1)) + 1;
+					a->frame = RandInt(RNG_FX, 1, ANIMATION_MAX_FRAMES);
 				} while (a->ticksPerFrame[a->frame] < 0);
 			}
 			else
@@ -0,0 +1,307 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "bit_grid.h"
+
+#include <string.h>
+
+#include "utils.h"
+
+#define WORD_BITS 64
+
+void BitGridInit(BitGrid *g, const struct vec2i size)
+{
+	g->size = size;
+	g->stride = (size.x + WORD_BITS - 1) / WORD_BITS;
+	CCALLOC(g->words, MAX(g->stride * size.y, 1) * sizeof *g->words);
+}
+void BitGridTerminate(BitGrid *g)
+{
+	CFREE(g->words);
+	memset(g, 0, sizeof *g);
+}
+void BitGridClear(BitGrid *g)
+{
+	memset(g->words, 0, g->stride * g->size.y * sizeof *g->words);
+}
+
+// Mask of bits [b0, b1) of a word
+static uint64_t BitRangeMask(const int b0, const int b1)
+{
+	const uint64_t hi =
+		b1 == WORD_BITS ? ~(uint64_t)0 : ((uint64_t)1 << b1) - 1;
+	return hi & ~(((uint64_t)1 << b0) - 1);
+}
+bool BitGridRowAll(const BitGrid *g, const int y, const int x0, const int x1)
+{
+	if (x0 >= x1)
+	{
+		return true;
+	}
+	if (y < 0 || y >= g->size.y || x0 < 0 || x1 > g->size.x)
+	{
+		return false;
+	}
+	const uint64_t *row = &g->words[y * g->stride];
+	const int k0 = x0 / WORD_BITS;
+	const int k1 = (x1 - 1) / WORD_BITS;
+	for (int k = k0; k <= k1; k++)
+	{
+		const int b0 = k == k0 ? x0 % WORD_BITS : 0;
+		const int b1 = k == k1 ? (x1 - 1) % WORD_BITS + 1 : WORD_BITS;
+		const uint64_t mask = BitRangeMask(b0, b1);
+		if ((row[k] & mask) != mask)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+bool BitGridRowAny(const BitGrid *g, const int y, const int x0, const int x1)
+{
+	if (y < 0 || y >= g->size.y)
+	{
+		return false;
+	}
+	const int xMin = MAX(x0, 0);
+	const int xMax = MIN(x1, g->size.x);
+	if (xMin >= xMax)
+	{
+		return false;
+	}
+	const uint64_t *row = &g->words[y * g->stride];
+	const int k0 = xMin / WORD_BITS;
+	const int k1 = (xMax - 1) / WORD_BITS;
+	for (int k = k0; k <= k1; k++)
+	{
+		const int b0 = k == k0 ? xMin % WORD_BITS : 0;
+		const int b1 = k == k1 ? (xMax - 1) % WORD_BITS + 1 : WORD_BITS;
+		if (row[k] & BitRangeMask(b0, b1))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+bool BitGridRectAll(
+	const BitGrid *g, const struct vec2i min, const struct vec2i max)
+{
+	for (int y = min.y; y <= max.y; y++)
+	{
+		if (!BitGridRowAll(g, y, min.x, max.x + 1))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Mask of the in-bounds cells of the last word of each row
+static uint64_t LastWordMask(const BitGrid *g)
+{
+	const int rem = g->size.x % WORD_BITS;
+	return rem == 0 ? ~(uint64_t)0 : ((uint64_t)1 << rem) - 1;
+}
+// Word k of row y, with out of bounds cells set
+static uint64_t WordOrSet(const BitGrid *g, const int y, const int k)
+{
+	if (y < 0 || y >= g->size.y || k < 0 || k >= g->stride)
+	{
+		return ~(uint64_t)0;
+	}
+	uint64_t w = g->words[y * g->stride + k];
+	if (k == g->stride - 1)
+	{
+		w |= ~LastWordMask(g);
+	}
+	return w;
+}
+// Word k of row y, where bit i is the cell at x + s
+static uint64_t WordShifted(
+	const BitGrid *g, const int y, const int k, const int s)
+{
+	const uint64_t w = WordOrSet(g, y, k);
+	if (s > 0)
+	{
+		return (w >> s) | (WordOrSet(g, y, k + 1) << (WORD_BITS - s));
+	}
+	if (s < 0)
+	{
+		return (w << -s) | (WordOrSet(g, y, k - 1) >> (WORD_BITS + s));
+	}
+	return w;
+}
+
+// Counters are bit-sliced: plane i holds bit i of the count of each of the
+// 64 cells in the word
+static void SlicedAdd(
+	uint64_t *acc, const int accBits, const uint64_t *v, const int vBits)
+{
+	uint64_t carry = 0;
+	for (int i = 0; i < accBits; i++)
+	{
+		const uint64_t a = acc[i];
+		const uint64_t b = i < vBits ? v[i] : 0;
+		acc[i] = a ^ b ^ carry;
+		carry = (a & b) | (carry & (a ^ b));
+	}
+}
+// Mask of cells whose count >= k
+static uint64_t SlicedGreaterEqual(
+	const uint64_t *planes, const int bits, const int k)
+{
+	if (k <= 0)
+	{
+		return ~(uint64_t)0;
+	}
+	if (k >= (1 << bits))
+	{
+		return 0;
+	}
+	uint64_t gt = 0;
+	uint64_t eq = ~(uint64_t)0;
+	for (int i = bits - 1; i >= 0; i--)
+	{
+		const uint64_t kb = ((k >> i) & 1) ? ~(uint64_t)0 : 0;
+		gt |= eq & planes[i] & ~kb;
+		eq &= ~(planes[i] ^ kb);
+	}
+	return gt | eq;
+}
+
+// Up to 9 and 25 cells respectively
+#define COUNT1_BITS 4
+#define COUNT2_BITS 5
+void BitGridAutomatonStep(
+	BitGrid *dst, const BitGrid *src, const int r1, const int r2,
+	const int y0, const int y1)
+{
+	const uint64_t lastMask = LastWordMask(src);
+	for (int y = y0; y < y1; y++)
+	{
+		for (int k = 0; k < src->stride; k++)
+		{
+			uint64_t count1[COUNT1_BITS] = {0, 0, 0, 0};
+			uint64_t count2[COUNT2_BITS] = {0, 0, 0, 0, 0};
+			for (int dy = -2; dy <= 2; dy++)
+			{
+				// Sum the row horizontally, for the inner 3 then outer 5
+				uint64_t h[3] = {0, 0, 0};
+				for (int s = -1; s <= 1; s++)
+				{
+					const uint64_t w = WordShifted(src, y + dy, k, s);
+					SlicedAdd(h, 2, &w, 1);
+				}
+				if (dy >= -1 && dy <= 1)
+				{
+					SlicedAdd(count1, COUNT1_BITS, h, 2);
+				}
+				const uint64_t wl = WordShifted(src, y + dy, k, -2);
+				const uint64_t wr = WordShifted(src, y + dy, k, 2);
+				SlicedAdd(h, 3, &wl, 1);
+				SlicedAdd(h, 3, &wr, 1);
+				SlicedAdd(count2, COUNT2_BITS, h, 3);
+			}
+			uint64_t w = SlicedGreaterEqual(count1, COUNT1_BITS, r1) |
+						 ~SlicedGreaterEqual(count2, COUNT2_BITS, r2 + 1);
+			if (k == src->stride - 1)
+			{
+				w &= lastMask;
+			}
+			dst->words[y * dst->stride + k] = w;
+		}
+	}
+}
+
+static int UFFind(int *parents, int i)
+{
+	while (parents[i] != i)
+	{
+		// Path halving
+		parents[i] = parents[parents[i]];
+		i = parents[i];
+	}
+	return i;
+}
+static void UFUnion(int *parents, const int a, const int b)
+{
+	const int ra = UFFind(parents, a);
+	const int rb = UFFind(parents, b);
+	// Keep the lowest index as the root, so that it is the first cell of the
+	// area in scan order
+	if (ra < rb)
+	{
+		parents[rb] = ra;
+	}
+	else if (rb < ra)
+	{
+		parents[ra] = rb;
+	}
+}
+int BitGridLabelClear(const BitGrid *g, int *labels)
+{
+	const int w = g->size.x;
+	const int n = w * g->size.y;
+	int *parents;
+	CMALLOC(parents, MAX(n, 1) * sizeof *parents);
+	struct vec2i v;
+	for (v.y = 0; v.y < g->size.y; v.y++)
+	{
+		for (v.x = 0; v.x < w; v.x++)
+		{
+			const int i = v.y * w + v.x;
+			if (BitGridGet(g, v))
+			{
+				parents[i] = -1;
+				continue;
+			}
+			parents[i] = i;
+			if (v.x > 0 && parents[i - 1] >= 0)
+			{
+				UFUnion(parents, i, i - 1);
+			}
+			if (v.y > 0 && parents[i - w] >= 0)
+			{
+				UFUnion(parents, i, i - w);
+			}
+		}
+	}
+	// Roots come first in their area, so they are numbered in scan order
+	int count = 0;
+	for (int i = 0; i < n; i++)
+	{
+		if (parents[i] < 0)
+		{
+			labels[i] = -1;
+			continue;
+		}
+		const int root = UFFind(parents, i);
+		labels[i] = root == i ? ++count : labels[root];
+	}
+	CFREE(parents);
+	return count;
+}
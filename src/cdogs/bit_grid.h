@@ -0,0 +1,96 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "vector.h"
+
+// Grid of bools packed 64 to a word, row by row, for operations that can
+// work on a whole word of cells at once
+typedef struct
+{
+	struct vec2i size;
+	int stride; // words per row
+	uint64_t *words;
+} BitGrid;
+
+void BitGridInit(BitGrid *g, const struct vec2i size);
+void BitGridTerminate(BitGrid *g);
+void BitGridClear(BitGrid *g);
+
+// Out of bounds cells are false
+// Inline as these are used for per-tile map queries in hot paths
+static inline bool BitGridGet(const BitGrid *g, const struct vec2i v)
+{
+	if (v.x < 0 || v.y < 0 || v.x >= g->size.x || v.y >= g->size.y)
+	{
+		return false;
+	}
+	const uint64_t w = g->words[v.y * g->stride + v.x / 64];
+	return (w >> (v.x % 64)) & 1;
+}
+static inline void BitGridSet(
+	BitGrid *g, const struct vec2i v, const bool value)
+{
+	uint64_t *w = &g->words[v.y * g->stride + v.x / 64];
+	const uint64_t bit = (uint64_t)1 << (v.x % 64);
+	if (value)
+	{
+		*w |= bit;
+	}
+	else
+	{
+		*w &= ~bit;
+	}
+}
+
+// Whether all cells in [x0, x1) of row y are set, checking a word at a time
+// Out of bounds cells are false, and an empty range is all set
+bool BitGridRowAll(const BitGrid *g, const int y, const int x0, const int x1);
+// Whether any cell in [x0, x1) of row y is set
+bool BitGridRowAny(const BitGrid *g, const int y, const int x0, const int x1);
+// Whether all cells in the inclusive rectangle min-max are set
+bool BitGridRectAll(
+	const BitGrid *g, const struct vec2i min, const struct vec2i max);
+
+// One generation of a cellular automaton: a cell becomes set if the number
+// of set cells within 1 distance (3x3) is at least r1, or the number within
+// 2 distance (5x5) is at most r2. Out of bounds cells count as set.
+// Only rows [y0, y1) of dst are written, so that bands of rows can be run
+// on different threads.
+void BitGridAutomatonStep(
+	BitGrid *dst, const BitGrid *src, const int r1, const int r2,
+	const int y0, const int y1);
+
+// Label the 4-connected areas of clear cells 1, 2, ... in the order they
+// are first found scanning row by row; set cells are labelled -1
+// labels must have size.x * size.y elements
+// Returns the number of areas
+int BitGridLabelClear(const BitGrid *g, int *labels);
@@ -55,6 +55,7 @@
 #include "collision/collision.h"
 #include "draw/drawtools.h"
 #include "game_events.h"
+#include "json_stream.h"
 #include "json_utils.h"
 #include "log.h"
 #include "net_util.h"
@@ -156,6 +157,20 @@ static struct vec2 SeekTowards(
 		combinedY * magnitude / (seekFactor + 1));
 }
 
+static const TActor *GetSeekTarget(const TMobileObject *obj)
+{
+	if (obj->seekTargetId < 0 || obj->seekTargetId >= (int)gActors.size)
+	{
+		return NULL;
+	}
+	const TActor *a = CArrayGet(&gActors, obj->seekTargetId);
+	if (!a->isInUse || a->uid != obj->seekTargetUID)
+	{
+		return NULL;
+	}
+	return a;
+}
+
 static void FireGuns(const TMobileObject *obj, const CArray *guns);
 static void AddTrail(
 	TMobileObject *obj, const struct vec2 from, const struct vec2 to,
@@ -198,13 +213,29 @@ bool BulletUpdate(struct MobileObject *obj, const int ticks)
 	if (obj->bulletClass->SeekFactor > 0)
 	{
 		// Find the closest target to this bullet and steer towards it
-		const TActor *owner = ActorGetByUID(obj->ActorUID);
-		if (owner == NULL)
+		// Only retarget periodically as this requires a search
+		obj->seekCounter -= ticks;
+		if (obj->seekCounter <= 0)
 		{
-			return false;
+			obj->seekCounter = obj->bulletClass->SeekInterval;
+			const TActor *owner = ActorGetByUID(obj->ActorUID);
+			if (owner == NULL)
+			{
+				return false;
+			}
+			// Don't look further than the bullet can still travel
+			const float seekRange =
+				obj->range >= 0
+					? (float)(obj->range - obj->count) *
+						  MAX(svec2_length(obj->thing.Vel),
+							  obj->bulletClass->SpeedHigh)
+					: -1;
+			const TActor *target = AIGetClosestEnemy(
+				obj->thing.Pos, owner, obj->flags, seekRange);
+			obj->seekTargetId = target != NULL ? target->thing.id : -1;
+			obj->seekTargetUID = target != NULL ? target->uid : -1;
 		}
-		const TActor *target =
-			AIGetClosestEnemy(obj->thing.Pos, owner, obj->flags);
+		const TActor *target = GetSeekTarget(obj);
 		if (target && !target->dead)
 		{
 			for (int i = 0; i < ticks; i++)
@@ -265,8 +296,8 @@ bool BulletUpdate(struct MobileObject *obj, const int ticks)
 				}
 				// Leave a wall mark if hitting a south-facing wall
 				if (hit.Type == HIT_WALL && vel.y < 0 &&
-					!TileIsOpaque(MapGetTile(
-						&gMap, Vec2ToTile(svec2(hit.Pos.x, hit.Pos.y + 1)))))
+					!MapTileIsOpaque(
+						&gMap, Vec2ToTile(svec2(hit.Pos.x, hit.Pos.y + 1))))
 				{
 					b.u.BulletBounce.WallMark = true;
 				}
@@ -396,7 +427,8 @@ bool BulletUpdate(struct MobileObject *obj, const int ticks)
 			obj->thing.Vel = svec2_add(
 				obj->thing.Vel,
 				svec2_scale(
-					svec2((float)(rand() % 3) - 1, (float)(rand() % 3) - 1),
+					svec2(
+						(float)RAND_INT(-1, 2), (float)RAND_INT(-1, 2)),
 					0.5f));
 		}
 	}
@@ -599,8 +631,7 @@ static HitType GetHitType(
 }
 static bool CheckWall(const struct vec2i tilePos)
 {
-	const Tile *t = MapGetTile(&gMap, tilePos);
-	return t == NULL || TileIsShootable(t);
+	return !MapIsTileIn(&gMap, tilePos) || MapTileIsShootable(&gMap, tilePos);
 }
 static bool HitWallFunc(
 	const struct vec2i tilePos, void *data, const struct vec2 col,
@@ -653,9 +684,6 @@ static void OnHit(HitItemData *data, Thing *target)
 }
 
 #define VERSION 5
-static void LoadBullet(
-	BulletClass *b, json_t *node, const BulletClass *defaultBullet,
-	const int version);
 void BulletInitialize(BulletClasses *bullets)
 {
 	memset(bullets, 0, sizeof *bullets);
@@ -663,80 +691,138 @@ void BulletInitialize(BulletClasses *bullets)
 	CArrayInit(&bullets->CustomClasses, sizeof(BulletClass));
 }
 static void BulletClassFree(BulletClass *b);
-void BulletLoadJSON(
-	BulletClasses *bullets, CArray *classes, json_t *bulletNode)
+static void LoadBulletNode(BulletClass *b, const int version);
+static const JSONField bulletFields[] = {
+	JSON_FIELD("Name", JSON_FIELD_STRING, BulletClass, Name),
+	JSON_FIELD("Delay", JSON_FIELD_INT, BulletClass, Delay),
+	JSON_FIELD("SpeedScale", JSON_FIELD_BOOL, BulletClass, SpeedScale),
+	JSON_FIELD("Power", JSON_FIELD_INT, BulletClass, Power),
+	JSON_FIELD("Mass", JSON_FIELD_FLOAT, BulletClass, Mass),
+	JSON_FIELD("HurtAlways", JSON_FIELD_BOOL, BulletClass, HurtAlways),
+	JSON_FIELD("Persists", JSON_FIELD_BOOL, BulletClass, Persists),
+	JSON_FIELD("WallBounces", JSON_FIELD_BOOL, BulletClass, WallBounces),
+	JSON_FIELD("SeekFactor", JSON_FIELD_INT, BulletClass, SeekFactor),
+	JSON_FIELD("SeekInterval", JSON_FIELD_INT, BulletClass, SeekInterval),
+	JSON_FIELD("Erratic", JSON_FIELD_BOOL, BulletClass, Erratic),
+	// Nested, version-dependent or cross-referencing fields,
+	// loaded by LoadBulletNode and BulletLoadWeapons
+	JSON_FIELD("Pic", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELD("Trail", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELD("ShadowSize", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELD("Speed", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELD("SpeedLow", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELD("SpeedHigh", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELD("Friction", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELD("Range", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELD("RangeLow", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELD("RangeHigh", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELD("Size", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELD("Special", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELD("Spark", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELD("OutOfRangeSpark", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELD("WallMark", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELD("HitSounds", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELD("HitsObjects", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELD("Hit", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELD("Falling", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELD("OutOfRangeGuns", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELD("HitGuns", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELD("ProximityGuns", JSON_FIELD_NODE, BulletClass, node),
+	JSON_FIELDS_END};
+typedef struct
 {
-	LOG(LM_MAP, LL_DEBUG, "loading bullets");
-	int version;
-	LoadInt(&version, bulletNode, "Version");
-	if (version > VERSION || version <= 0)
+	BulletClasses *bullets;
+	CArray *classes;
+} BulletLoadData;
+static void BulletClassInit(void *data, void *loadData)
+{
+	BulletClass *b = data;
+	const BulletLoadData *d = loadData;
+	const BulletClass *defaultBullet = &d->bullets->Default;
+	memcpy(b, defaultBullet, sizeof *b);
+	if (defaultBullet->Name != NULL)
 	{
-		CASSERT(false, "cannot read bullets file version");
-		return;
+		CSTRDUP(b->Name, defaultBullet->Name);
 	}
-
-	// Defaults
-	json_t *defaultNode = json_find_first_label(bulletNode, "DefaultBullet");
-	if (defaultNode != NULL)
+	if (defaultBullet->Hit.Object.Sound != NULL)
 	{
-		BulletClassFree(&bullets->Default);
-		LoadBullet(&bullets->Default, defaultNode->child, NULL, version);
+		CSTRDUP(b->Hit.Object.Sound, defaultBullet->Hit.Object.Sound);
 	}
-
-	json_t *bulletsNode = json_find_first_label(bulletNode, "Bullets")->child;
-	for (json_t *child = bulletsNode->child; child; child = child->next)
+	if (defaultBullet->Hit.Flesh.Sound != NULL)
 	{
-		BulletClass b;
-		LoadBullet(&b, child, &bullets->Default, version);
-		CArrayPushBack(classes, &b);
+		CSTRDUP(b->Hit.Flesh.Sound, defaultBullet->Hit.Flesh.Sound);
 	}
-
-	bullets->root = bulletNode;
+	if (defaultBullet->Hit.Wall.Sound != NULL)
+	{
+		CSTRDUP(b->Hit.Wall.Sound, defaultBullet->Hit.Wall.Sound);
+	}
+	// TODO: enable default bullet guns?
+	memset(&b->Falling.DropGuns, 0, sizeof b->Falling.DropGuns);
+	memset(&b->OutOfRangeGuns, 0, sizeof b->OutOfRangeGuns);
+	memset(&b->HitGuns, 0, sizeof b->HitGuns);
+	memset(&b->ProximityGuns, 0, sizeof b->ProximityGuns);
+	b->node = NULL;
+}
+static void BulletClassSetDefault(
+	void *data, const int version, void *loadData)
+{
+	BulletClass *b = data;
+	BulletClasses *bullets = ((BulletLoadData *)loadData)->bullets;
+	LoadBulletNode(b, version);
+	// Default bullet guns aren't supported
+	json_free_value(&b->node);
+	BulletClassFree(&bullets->Default);
+	memcpy(&bullets->Default, b, sizeof *b);
+}
+static void BulletClassAdd(void *data, const int version, void *loadData)
+{
+	BulletClass *b = data;
+	LoadBulletNode(b, version);
+	CArrayPushBack(((BulletLoadData *)loadData)->classes, b);
+}
+static void BulletClassTerminate(void *data)
+{
+	BulletClassFree(data);
+}
+bool BulletLoadFile(BulletClasses *bullets, CArray *classes, const char *path)
+{
+	LOG(LM_MAP, LL_DEBUG, "loading bullets");
+	FILE *f = fopen(path, "r");
+	if (f == NULL)
+	{
+		return false;
+	}
+	BulletLoadData data = {bullets, classes};
+	const JSONClassSchema schema = {
+		"Bullets",
+		bulletFields,
+		sizeof(BulletClass),
+		VERSION,
+		BulletClassInit,
+		BulletClassAdd,
+		BulletClassTerminate,
+		&data,
+		"DefaultBullet",
+		BulletClassSetDefault};
+	const int version = JSONStreamLoadClasses(&schema, f);
+	fclose(f);
+	return version > 0;
 }
 static void LoadParticle(
 	const ParticleClass **p, json_t *node, const char *name);
 static void LoadHitsound(
 	char **hitsound, json_t *node, const char *name, const int version);
-static void LoadBullet(
-	BulletClass *b, json_t *node, const BulletClass *defaultBullet,
-	const int version)
+// Load the fields captured in the bullet's node, once the version is known
+static void LoadBulletNode(BulletClass *b, const int version)
 {
-	memset(b, 0, sizeof *b);
-	if (defaultBullet != NULL)
+	if (b->node == NULL)
 	{
-		memcpy(b, defaultBullet, sizeof *b);
-		if (defaultBullet->Name != NULL)
-		{
-			CSTRDUP(b->Name, defaultBullet->Name);
-		}
-		if (defaultBullet->Hit.Object.Sound != NULL)
-		{
-			CSTRDUP(b->Hit.Object.Sound, defaultBullet->Hit.Object.Sound);
-		}
-		if (defaultBullet->Hit.Flesh.Sound != NULL)
-		{
-			CSTRDUP(b->Hit.Flesh.Sound, defaultBullet->Hit.Flesh.Sound);
-		}
-		if (defaultBullet->Hit.Wall.Sound != NULL)
-		{
-			CSTRDUP(b->Hit.Wall.Sound, defaultBullet->Hit.Wall.Sound);
-		}
-		// TODO: enable default bullet guns?
-		memset(&b->Falling.DropGuns, 0, sizeof b->Falling.DropGuns);
-		memset(&b->OutOfRangeGuns, 0, sizeof b->OutOfRangeGuns);
-		memset(&b->HitGuns, 0, sizeof b->HitGuns);
-		memset(&b->ProximityGuns, 0, sizeof b->ProximityGuns);
+		b->node = json_new_object();
 	}
+	json_t *node = b->node;
 
 	char *tmp;
 
-	tmp = NULL;
-	LoadStr(&tmp, node, "Name");
-	if (tmp != NULL)
-	{
-		CFREE(b->Name);
-		b->Name = tmp;
-	}
 	if (json_find_first_label(node, "Pic"))
 	{
 		CPicLoadJSON(&b->CPic, json_find_first_label(node, "Pic")->child);
@@ -756,7 +842,6 @@ static void LoadBullet(
 		LoadInt(&b->Trail.TicksPerEmit, trail, "TicksPerEmit");
 	}
 	LoadVec2i(&b->ShadowSize, node, "ShadowSize");
-	LoadInt(&b->Delay, node, "Delay");
 	if (json_find_first_label(node, "Speed"))
 	{
 		LoadFullInt(&b->SpeedLow, node, "Speed");
@@ -766,7 +851,6 @@ static void LoadBullet(
 	LoadFullInt(&b->SpeedHigh, node, "SpeedHigh");
 	b->SpeedLow = MIN(b->SpeedLow, b->SpeedHigh);
 	b->SpeedHigh = MAX(b->SpeedLow, b->SpeedHigh);
-	LoadBool(&b->SpeedScale, node, "SpeedScale");
 	LoadFullInt(&b->Friction, node, "Friction");
 	if (json_find_first_label(node, "Range"))
 	{
@@ -777,17 +861,11 @@ static void LoadBullet(
 	LoadInt(&b->RangeHigh, node, "RangeHigh");
 	b->RangeLow = MIN(b->RangeLow, b->RangeHigh);
 	b->RangeHigh = MAX(b->RangeLow, b->RangeHigh);
-	LoadInt(&b->Power, node, "Power");
-
 	if (version < 2)
 	{
 		// Old version default mass = power
 		b->Mass = (float)b->Power;
 	}
-	else
-	{
-		LoadFloat(&b->Mass, node, "Mass");
-	}
 
 	LoadVec2i(&b->Size, node, "Size");
 
@@ -838,8 +916,6 @@ static void LoadBullet(
 		}
 	}
 
-	LoadBool(&b->HurtAlways, node, "HurtAlways");
-	LoadBool(&b->Persists, node, "Persists");
 	LoadParticle(&b->Spark, node, "Spark");
 	LoadParticle(&b->OutOfRangeSpark, node, "OutOfRangeSpark");
 	LoadParticle(&b->WallMark, node, "WallMark");
@@ -879,7 +955,6 @@ static void LoadBullet(
 			}
 		}
 	}
-	LoadBool(&b->WallBounces, node, "WallBounces");
 	if (json_find_first_label(node, "Falling"))
 	{
 		json_t *falling = json_find_first_label(node, "Falling")->child;
@@ -889,10 +964,6 @@ static void LoadBullet(
 		LoadBool(&b->Falling.DestroyOnDrop, falling, "DestroyOnDrop");
 		LoadBool(&b->Falling.Bounces, falling, "Bounces");
 	}
-	LoadInt(&b->SeekFactor, node, "SeekFactor");
-	LoadBool(&b->Erratic, node, "Erratic");
-
-	b->node = node;
 
 	LOG(LM_MAP, LL_DEBUG,
 		"loaded bullet name(%s) shadowSize(%d, %d) delay(%d) speed(%f-%f)...",
@@ -923,8 +994,9 @@ static void LoadBullet(
 		b->Falling.GravityFactor, b->Falling.FallsDown ? "true" : "false",
 		b->Falling.DestroyOnDrop ? "true" : "false");
 	LOG(LM_MAP, LL_DEBUG,
-		"...dropGuns(%d) seekFactor(%d) erratic(%s) trail(%s@%f per %d)...",
-		(int)b->Falling.DropGuns.size, b->SeekFactor,
+		"...dropGuns(%d) seekFactor(%d) seekInterval(%d) erratic(%s) "
+		"trail(%s@%f per %d)...",
+		(int)b->Falling.DropGuns.size, b->SeekFactor, b->SeekInterval,
 		b->Erratic ? "true" : "false",
 		b->Trail.P != NULL ? b->Trail.P->Name : "", b->Trail.Width,
 		b->Trail.TicksPerEmit);
@@ -978,7 +1050,6 @@ void BulletLoadWeapons(BulletClasses *bullets)
 {
 	BulletClassesLoadWeapons(&bullets->Classes);
 	BulletClassesLoadWeapons(&bullets->CustomClasses);
-	json_free_value(&bullets->root);
 }
 static void BulletClassesLoadWeapons(CArray *classes)
 {
@@ -1000,7 +1071,7 @@ static void BulletClassesLoadWeapons(CArray *classes)
 		LoadBulletGuns(&b->HitGuns, b->node, "HitGuns");
 		LoadBulletGuns(&b->ProximityGuns, b->node, "ProximityGuns");
 
-		b->node = NULL;
+		json_free_value(&b->node);
 	}
 }
 void BulletTerminate(BulletClasses *bullets)
@@ -1029,6 +1100,7 @@ static void BulletClassFree(BulletClass *b)
 	CArrayTerminate(&b->HitGuns);
 	CArrayTerminate(&b->Falling.DropGuns);
 	CArrayTerminate(&b->ProximityGuns);
+	json_free_value(&b->node);
 }
 
 void BulletAdd(const NAddBullet add)
@@ -1085,6 +1157,8 @@ void BulletAdd(const NAddBullet add)
 	}
 
 	obj->weapon = StrWeaponClass(add.Gun);
+	obj->seekTargetId = -1;
+	obj->seekTargetUID = -1;
 
 	obj->isInUse = true;
 	obj->thing.drawFunc = NULL;
@@ -1131,7 +1205,8 @@ void BulletBounce(const NBulletBounce bb)
 		s.u.AddParticle.Class = o->bulletClass->WallMark;
 		s.u.AddParticle.Pos = bouncePos;
 		// Randomise Z on the wall
-		s.u.AddParticle.Z = o->z + (int)RAND_FLOAT(-WALL_MARK_Z, WALL_MARK_Z);
+		s.u.AddParticle.Z =
+			o->z + (int)RandFloat(RNG_FX, -WALL_MARK_Z, WALL_MARK_Z);
 		GameEventsEnqueue(&gGameEvents, s);
 	}
 	MapTryMoveThing(&gMap, &o->thing, NetToVec2(bb.Pos));
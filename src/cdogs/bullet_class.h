@@ -112,6 +112,7 @@ typedef struct
 		CArray DropGuns;	// of const WeaponClass *
 	} Falling;
 	int SeekFactor;	// -1 to disable; higher = less seeking
+	int SeekInterval;	// ticks between seeking bullets choosing targets
 	bool Erratic;
 
 	// Special weapons to fire if certain events occur
@@ -127,7 +128,6 @@ typedef struct
 	CArray Classes;	// of BulletClass
 	BulletClass Default;
 	CArray CustomClasses;	// of BulletClass
-	json_t *root;
 } BulletClasses;
 extern BulletClasses gBulletClasses;
 
@@ -136,8 +136,7 @@ int BulletClassesCount(const BulletClasses *classes);
 BulletClass *StrBulletClass(const char *s);
 
 void BulletInitialize(BulletClasses *bullets);
-void BulletLoadJSON(
-	BulletClasses *bullets, CArray *classes, json_t *bulletNode);
+bool BulletLoadFile(BulletClasses *bullets, CArray *classes, const char *path);
 // 2-step initialisation since bullet and weapon reference each other
 void BulletLoadWeapons(BulletClasses *bullets);
 void BulletClassesClear(CArray *classes);
@@ -201,12 +201,12 @@ void CArrayConcat(CArray *a, const CArray *a2)
 	a->size += a2->size;
 }
 
-void CArrayShuffle(CArray *a)
+void CArrayShuffle(CArray *a, PRNG *r)
 {
 	void *buf;
 	CMALLOC(buf, a->elemSize);
 	CA_FOREACH(void, e, *a)
-	const int j = rand() % (_ca_index + 1);
+	const int j = PRNGInt(r, 0, _ca_index + 1);
 	void *je = CArrayGet(a, j);
 	// Swap index and j elements
 	memcpy(buf, e, a->elemSize);
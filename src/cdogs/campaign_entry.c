@@ -30,6 +30,7 @@
 
 #include <stdio.h>
 
+#include <cdogs/campaign_index.h>
 #include <cdogs/cwolfmap/cwolfmap.h>
 #include <cdogs/files.h>
 #include <cdogs/map_new.h>
@@ -42,11 +43,17 @@ bool IsCampaignOK(const char *path, char **title, int *numMissions)
 	if (strcmp(StrGetFileExt(path), "cdogscpn") == 0 ||
 		strcmp(StrGetFileExt(path), "CDOGSCPN") == 0)
 	{
-		return MapNewScanArchive(path, title, numMissions) == 0;
+		// Archive title and missions come from campaign.json
+		char statPath[CDOGS_PATH_MAX];
+		sprintf(statPath, "%s/campaign.json", path);
+		return CampaignIndexScan(
+			&gCampaignIndex, path, statPath, MapNewScanArchive, title,
+			numMissions);
 	}
 	if (IsCampaignOldFile(path))
 	{
-		return ScanCampaignOld(path, title, numMissions) == 0;
+		return CampaignIndexScan(
+			&gCampaignIndex, path, path, ScanCampaignOld, title, numMissions);
 	}
 	int spearMission = 1;
 	char buf[CDOGS_PATH_MAX];
@@ -0,0 +1,287 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "campaign_index.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "files.h"
+#include "log.h"
+#include "utils.h"
+
+#define CAMPAIGN_INDEX_MAGIC 0x58444943 // "CIDX"
+#define CAMPAIGN_INDEX_VERSION 1
+
+CampaignIndex gCampaignIndex;
+
+typedef struct
+{
+	const char *data;
+	size_t size;
+	size_t pos;
+	bool ok;
+} IndexReader;
+static void ReadValue(IndexReader *r, void *value, const size_t size)
+{
+	if (!r->ok || r->size - r->pos < size)
+	{
+		r->ok = false;
+		memset(value, 0, size);
+		return;
+	}
+	memcpy(value, r->data + r->pos, size);
+	r->pos += size;
+}
+static char *ReadStr(IndexReader *r)
+{
+	uint32_t len;
+	ReadValue(r, &len, sizeof len);
+	if (!r->ok || r->size - r->pos < len)
+	{
+		r->ok = false;
+		return NULL;
+	}
+	char *s;
+	CMALLOC(s, len + 1);
+	memcpy(s, r->data + r->pos, len);
+	s[len] = '\0';
+	r->pos += len;
+	return s;
+}
+
+static void EntryTerminate(CampaignIndexEntry *e)
+{
+	CFREE(e->Path);
+	CFREE(e->Title);
+}
+
+void CampaignIndexLoad(CampaignIndex *ci, const char *filename)
+{
+	memset(ci, 0, sizeof *ci);
+	CArrayInit(&ci->entries, sizeof(CampaignIndexEntry));
+	ci->isLoaded = true;
+
+	FileMapping m;
+	if (!FileMapOpen(&m, filename))
+	{
+		return;
+	}
+	IndexReader r = {m.Data, m.Size, 0, true};
+	uint32_t magic, version, count;
+	ReadValue(&r, &magic, sizeof magic);
+	ReadValue(&r, &version, sizeof version);
+	ReadValue(&r, &count, sizeof count);
+	if (!r.ok || magic != CAMPAIGN_INDEX_MAGIC ||
+		version != CAMPAIGN_INDEX_VERSION)
+	{
+		LOG(LM_MAIN, LL_WARN, "Ignoring invalid campaign index %s", filename);
+		goto bail;
+	}
+	for (uint32_t i = 0; i < count; i++)
+	{
+		CampaignIndexEntry e;
+		memset(&e, 0, sizeof e);
+		e.Path = ReadStr(&r);
+		ReadValue(&r, &e.MTime, sizeof e.MTime);
+		ReadValue(&r, &e.FileSize, sizeof e.FileSize);
+		uint32_t isOK;
+		ReadValue(&r, &isOK, sizeof isOK);
+		e.IsOK = isOK != 0;
+		int32_t numMissions;
+		ReadValue(&r, &numMissions, sizeof numMissions);
+		e.NumMissions = numMissions;
+		e.Title = ReadStr(&r);
+		if (!r.ok)
+		{
+			EntryTerminate(&e);
+			LOG(LM_MAIN, LL_WARN, "Truncated campaign index %s", filename);
+			break;
+		}
+		// Entries are saved in sorted order
+		CArrayPushBack(&ci->entries, &e);
+	}
+	LOG(LM_MAIN, LL_DEBUG, "Loaded campaign index with %d entries",
+		(int)ci->entries.size);
+
+bail:
+	FileMapClose(&m);
+}
+
+static void WriteStr(FILE *f, const char *s)
+{
+	const uint32_t len = s != NULL ? (uint32_t)strlen(s) : 0;
+	fwrite(&len, sizeof len, 1, f);
+	fwrite(s != NULL ? s : "", 1, len, f);
+}
+void CampaignIndexSave(CampaignIndex *ci, const char *filename)
+{
+	// Drop entries for campaigns that have gone away
+	for (int i = (int)ci->entries.size - 1; i >= 0; i--)
+	{
+		CampaignIndexEntry *e = CArrayGet(&ci->entries, i);
+		if (!e->isUsed)
+		{
+			EntryTerminate(e);
+			CArrayDelete(&ci->entries, i);
+			ci->isDirty = true;
+		}
+	}
+	if (!ci->isDirty)
+	{
+		return;
+	}
+
+	FILE *f = fopen(filename, "wb");
+	if (f == NULL)
+	{
+		LOG(LM_MAIN, LL_ERROR, "Cannot write campaign index %s", filename);
+		return;
+	}
+	const uint32_t header[] = {
+		CAMPAIGN_INDEX_MAGIC, CAMPAIGN_INDEX_VERSION,
+		(uint32_t)ci->entries.size};
+	fwrite(header, sizeof header, 1, f);
+	CA_FOREACH(const CampaignIndexEntry, e, ci->entries)
+	WriteStr(f, e->Path);
+	fwrite(&e->MTime, sizeof e->MTime, 1, f);
+	fwrite(&e->FileSize, sizeof e->FileSize, 1, f);
+	const uint32_t isOK = e->IsOK;
+	fwrite(&isOK, sizeof isOK, 1, f);
+	const int32_t numMissions = e->NumMissions;
+	fwrite(&numMissions, sizeof numMissions, 1, f);
+	WriteStr(f, e->Title);
+	CA_FOREACH_END()
+	if (fclose(f) != 0)
+	{
+		LOG(LM_MAIN, LL_ERROR, "Cannot write campaign index %s", filename);
+		remove(filename);
+		return;
+	}
+	ci->isDirty = false;
+}
+
+void CampaignIndexTerminate(CampaignIndex *ci)
+{
+	if (!ci->isLoaded)
+	{
+		return;
+	}
+	CA_FOREACH(CampaignIndexEntry, e, ci->entries)
+	EntryTerminate(e);
+	CA_FOREACH_END()
+	CArrayTerminate(&ci->entries);
+	memset(ci, 0, sizeof *ci);
+}
+
+// Binary search for path; returns the index it would be inserted at if it
+// isn't found
+static size_t FindEntry(const CampaignIndex *ci, const char *path, bool *found)
+{
+	size_t lo = 0;
+	size_t hi = ci->entries.size;
+	*found = false;
+	while (lo < hi)
+	{
+		const size_t mid = lo + (hi - lo) / 2;
+		const CampaignIndexEntry *e = CArrayGet(&ci->entries, mid);
+		const int cmp = strcmp(e->Path, path);
+		if (cmp == 0)
+		{
+			*found = true;
+			return mid;
+		}
+		if (cmp < 0)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+bool CampaignIndexScan(
+	CampaignIndex *ci, const char *path, const char *statPath,
+	CampaignScanFunc scan, char **title, int *numMissions)
+{
+	struct stat st;
+	if (!ci->isLoaded || stat(statPath, &st) != 0)
+	{
+		return scan(path, title, numMissions) == 0;
+	}
+
+	bool found;
+	const size_t idx = FindEntry(ci, path, &found);
+	CampaignIndexEntry *e = NULL;
+	if (found)
+	{
+		e = CArrayGet(&ci->entries, idx);
+		if (e->MTime != (int64_t)st.st_mtime ||
+			e->FileSize != (uint64_t)st.st_size)
+		{
+			// Stale; rescan
+			EntryTerminate(e);
+			CArrayDelete(&ci->entries, idx);
+			e = NULL;
+		}
+	}
+	if (e == NULL)
+	{
+		CampaignIndexEntry newEntry;
+		memset(&newEntry, 0, sizeof newEntry);
+		CSTRDUP(newEntry.Path, path);
+		newEntry.MTime = (int64_t)st.st_mtime;
+		newEntry.FileSize = (uint64_t)st.st_size;
+		newEntry.IsOK =
+			scan(path, &newEntry.Title, &newEntry.NumMissions) == 0;
+		if (!newEntry.IsOK)
+		{
+			CFREE(newEntry.Title);
+		}
+		e = CArrayInsert(&ci->entries, idx, &newEntry);
+		ci->isDirty = true;
+	}
+	e->isUsed = true;
+
+	if (!e->IsOK)
+	{
+		return false;
+	}
+	if (title != NULL)
+	{
+		CSTRDUP(*title, e->Title != NULL ? e->Title : "");
+	}
+	if (numMissions != NULL)
+	{
+		*numMissions = e->NumMissions;
+	}
+	return true;
+}
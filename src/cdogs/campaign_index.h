@@ -0,0 +1,76 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "c_array.h"
+
+// Persistent index of campaign metadata, so that listing campaigns at startup
+// doesn't need to parse every campaign
+// Entries are keyed on path and the source file's size and mtime, and are
+// updated incrementally as campaigns are scanned
+#define CAMPAIGN_INDEX_FILE "campaigns.index"
+
+typedef struct
+{
+	char *Path;
+	int64_t MTime;
+	uint64_t FileSize;
+	bool IsOK;
+	char *Title;
+	int NumMissions;
+	// Whether the entry was looked up since the index was loaded; entries
+	// that weren't are dropped on save
+	bool isUsed;
+} CampaignIndexEntry;
+
+typedef struct
+{
+	bool isLoaded;
+	bool isDirty;
+	CArray entries; // of CampaignIndexEntry, sorted by path
+} CampaignIndex;
+// Note: loaded and saved by LoadAllCampaigns
+extern CampaignIndex gCampaignIndex;
+
+void CampaignIndexLoad(CampaignIndex *ci, const char *filename);
+void CampaignIndexSave(CampaignIndex *ci, const char *filename);
+void CampaignIndexTerminate(CampaignIndex *ci);
+
+typedef int (*CampaignScanFunc)(
+	const char *path, char **title, int *numMissions);
+// Get the title and number of missions of the campaign at path, from the
+// index if it is up to date, otherwise by calling scan and recording the
+// result
+// statPath is the file whose changes invalidate the entry, which may differ
+// from path for campaign archives
+bool CampaignIndexScan(
+	CampaignIndex *ci, const char *path, const char *statPath,
+	CampaignScanFunc scan, char **title, int *numMissions);
@@ -32,6 +32,7 @@
 
 #include <tinydir/tinydir.h>
 
+#include <cdogs/campaign_index.h>
 #include <cdogs/files.h>
 #include <cdogs/log.h>
 #include <cdogs/map_new.h>
@@ -82,12 +83,29 @@ void CampaignSettingTerminate(CampaignSetting *c)
 	}
 	memset(c, 0, sizeof *c);
 }
+void CampaignSettingLoadMission(CampaignSetting *c, const int idx)
+{
+	if (c->CustomMissionLoad == NULL || idx < 0 ||
+		idx >= (int)c->Missions.size)
+	{
+		return;
+	}
+	c->CustomMissionLoad(c->CustomData, CArrayGet(&c->Missions, idx), idx);
+}
+void CampaignSettingLoadAllMissions(CampaignSetting *c)
+{
+	for (int i = 0; i < (int)c->Missions.size; i++)
+	{
+		CampaignSettingLoadMission(c, i);
+	}
+}
 void CampaignSettingTerminateAll(CampaignSetting *setting)
 {
+	// Clear sounds first, as the campaign may own the sample data they use
+	SoundClear(gSoundDevice.customSounds);
 	CampaignSettingTerminate(setting);
 
 	// Unload previous custom data
-	SoundClear(gSoundDevice.customSounds);
 	PicManagerClearCustom(&gPicManager);
 	ParticleClassesClear(&gParticleClasses.CustomClasses);
 	AmmoClassesClear(&gAmmo.CustomAmmo);
@@ -197,6 +215,9 @@ void LoadAllCampaigns(CustomCampaigns *campaigns)
 	CampaignListInit(&campaigns->campaignList);
 	CampaignListInit(&campaigns->dogfightList);
 
+	CampaignIndexTerminate(&gCampaignIndex);
+	CampaignIndexLoad(&gCampaignIndex, GetConfigFilePath(CAMPAIGN_INDEX_FILE));
+
 	LOG(LM_MAIN, LL_INFO, "Load campaigns from system...");
 	MapWolfLoadCampaignsFromSystem(&campaigns->campaignList);
 
@@ -210,6 +231,8 @@ void LoadAllCampaigns(CustomCampaigns *campaigns)
 	LoadCampaignsFromFolder(
 		&campaigns->dogfightList, "", buf, GAME_MODE_DOGFIGHT);
 
+	CampaignIndexSave(&gCampaignIndex, GetConfigFilePath(CAMPAIGN_INDEX_FILE));
+
 	LOG(LM_MAIN, LL_INFO, "Load quick play...");
 	LoadQuickPlayEntry(&campaigns->quickPlayEntry);
 }
@@ -217,6 +240,7 @@ void LoadAllCampaigns(CustomCampaigns *campaigns)
 void UnloadAllCampaigns(CustomCampaigns *campaigns)
 {
 	MapWolfTerminate();
+	CampaignIndexTerminate(&gCampaignIndex);
 	if (campaigns)
 	{
 		CampaignListTerminate(&campaigns->campaignList);
@@ -307,15 +331,20 @@ Mission *CampaignGetCurrentMission(Campaign *campaign)
 	{
 		return NULL;
 	}
+	CampaignSettingLoadMission(&campaign->Setting, campaign->MissionIndex);
 	return CArrayGet(&campaign->Setting.Missions, campaign->MissionIndex);
 }
 
+int CampaignGetRandomSeed(const Campaign *campaign)
+{
+	return 10 * campaign->MissionIndex +
+		   ConfigGetInt(&gConfig, "Game.RandomSeed");
+}
 void CampaignSeedRandom(const Campaign *campaign)
 {
-	const int seed = 10 * campaign->MissionIndex +
-					 ConfigGetInt(&gConfig, "Game.RandomSeed");
+	const int seed = CampaignGetRandomSeed(campaign);
 	LOG(LM_MAIN, LL_INFO, "Seeding with %d", seed);
-	srand((unsigned int)seed);
+	RandSeed((uint64_t)seed);
 }
 
 void CampaignAndMissionSetup(Campaign *campaign, struct MissionOptions *mo)
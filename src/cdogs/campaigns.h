@@ -68,6 +68,10 @@ typedef struct
 	MusicChunk CustomSongs[MUSIC_COUNT];
 	void *CustomData;
 	void (*CustomDataTerminate)(void *);
+	// Optional, for campaigns whose missions are placeholders until they are
+	// used, e.g. converted Wolf3D levels; fills in the mission in place
+	// Called with CustomData each time the mission is about to be used
+	void (*CustomMissionLoad)(void *, Mission *, const int);
 } CampaignSetting;
 
 typedef struct
@@ -83,6 +87,9 @@ typedef struct
 	bool OptionsSet;
 	bool IsComplete;
 	bool IsQuit;
+	// Seed used to generate quick play campaigns, so they can be regenerated
+	// e.g. for replays; picked at random if 0
+	uint32_t QuickPlaySeed;
 } Campaign;
 extern Campaign gCampaign;
 
@@ -91,6 +98,11 @@ void CampaignTerminate(Campaign *campaign);
 void CampaignSettingInit(CampaignSetting *setting);
 void CampaignSettingTerminate(CampaignSetting *c);
 void CampaignSettingTerminateAll(CampaignSetting *setting);
+// Make sure the mission's contents are loaded, for campaigns that load their
+// missions on demand
+void CampaignSettingLoadMission(CampaignSetting *c, const int idx);
+// Load all missions, e.g. for editing or saving
+void CampaignSettingLoadAllMissions(CampaignSetting *c);
 
 int CampaignGetMaxLives(const Campaign *c);
 int CampaignGetLives(const Campaign *c);
@@ -104,6 +116,7 @@ void LoadAllCampaigns(CustomCampaigns *campaigns);
 void UnloadAllCampaigns(CustomCampaigns *campaigns);
 
 Mission *CampaignGetCurrentMission(Campaign *campaign);
+int CampaignGetRandomSeed(const Campaign *campaign);
 void CampaignSeedRandom(const Campaign *campaign);
 
 void CampaignAndMissionSetup(Campaign *campaign, struct MissionOptions *mo);
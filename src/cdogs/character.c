@@ -483,7 +483,7 @@ void CharacterShuffleAppearance(Character *c)
 	// Choose a random character class
 	const int numCharClasses = (int)gCharacterClasses.Classes.size +
 							   (int)gCharacterClasses.CustomClasses.size;
-	const int charClass = rand() % numCharClasses;
+	const int charClass = RAND_INT(0, numCharClasses);
 	if (charClass < (int)gCharacterClasses.Classes.size)
 	{
 		c->Class = CArrayGet(&gCharacterClasses.Classes, charClass);
@@ -501,7 +501,7 @@ void CharacterShuffleAppearance(Character *c)
 		if (RAND_INT(0, 3) == 0)
 		{
 			const CArray *hpNames = &gPicManager.headPartNames[hp];
-			name = *(char **)CArrayGet(hpNames, rand() % hpNames->size);
+			name = *(char **)CArrayGet(hpNames, RAND_INT(0, hpNames->size));
 			if (hp == HEAD_PART_HAT)
 			{
 				for (size_t i = 0; i < sizeof(HAT_BLACKLIST) / sizeof(char *);
@@ -531,9 +531,9 @@ void CharacterShuffleAppearance(Character *c)
 static color_t RandomColor(void)
 {
 	color_t c;
-	c.r = rand() & 255;
-	c.g = rand() & 255;
-	c.b = rand() & 255;
+	c.r = (uint8_t)RAND_INT(0, 256);
+	c.g = (uint8_t)RAND_INT(0, 256);
+	c.b = (uint8_t)RAND_INT(0, 256);
 	c.a = 255;
 	return c;
 }
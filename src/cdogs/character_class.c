@@ -28,8 +28,9 @@
 */
 #include "character_class.h"
 
-#include "json_utils.h"
+#include "json_stream.h"
 #include "log.h"
+#include "sys_config.h"
 
 #define VERSION 2
 #define FOOTSTEP_DISTANCE_PLUS 250
@@ -361,92 +362,99 @@ void CharacterClassesInitialize(CharacterClasses *c, const char *filename)
 
 	char buf[CDOGS_PATH_MAX];
 	GetDataFilePath(buf, filename);
-	FILE *f = fopen(buf, "r");
-	json_t *root = NULL;
-	if (f == NULL)
+	if (!CharacterClassesLoadFile(&c->Classes, buf))
 	{
 		LOG(LM_MAIN, LL_ERROR, "cannot load characters file %s", buf);
-		goto bail;
-	}
-	enum json_error e = json_stream_parse(f, &root);
-	if (e != JSON_OK)
-	{
-		LOG(LM_MAIN, LL_ERROR, "error parsing characters file %s", buf);
-		goto bail;
-	}
-	CharacterClassesLoadJSON(&c->Classes, root);
-
-bail:
-	if (f != NULL)
-	{
-		fclose(f);
 	}
-	json_free_value(&root);
 }
-static void LoadCharacterClass(CharacterClass *c, json_t *node);
-void CharacterClassesLoadJSON(CArray *classes, json_t *root)
-{
-	int version;
-	LoadInt(&version, root, "Version");
-	if (version > VERSION || version <= 0)
-	{
-		LOG(LM_MAIN, LL_ERROR, "Cannot read character file version: %d",
-			version);
-		return;
-	}
 
-	json_t *charactersNode = json_find_first_label(root, "Characters")->child;
-	for (json_t *child = charactersNode->child; child; child = child->next)
-	{
-		CharacterClass cc;
-		LoadCharacterClass(&cc, child);
-		CArrayPushBack(classes, &cc);
-	}
-}
-static void LoadCharacterClass(CharacterClass *c, json_t *node)
-{
-	memset(c, 0, sizeof *c);
-	c->Name = GetString(node, "Name");
-	LoadBool(&c->Vehicle, node, "Vehicle");
+static const JSONField headPicsFields[] = {
+	JSON_FIELD("Sprites", JSON_FIELD_STRING, CharacterClass, HeadSprites),
+	JSON_FIELDS_END};
+static const JSONField characterClassFields[] = {
+	JSON_FIELD("Name", JSON_FIELD_STRING, CharacterClass, Name),
+	JSON_FIELD("Vehicle", JSON_FIELD_BOOL, CharacterClass, Vehicle),
 	// TODO: allow non-directional head sprites?
-	json_t *headPics = json_find_first_label(node, "HeadPics")->child;
-	c->HeadSprites = GetString(headPics, "Sprites");
-	LoadStr(&c->Body, node, "Body");
-	if (c->Body == NULL)
-	{
-		CSTRDUP(c->Body, "base");
-	}
-	LoadStr(&c->DeathSprites, node, "DeathSprites");
-	if (c->DeathSprites == NULL)
-	{
-		CSTRDUP(c->DeathSprites, "death");
-	}
+	JSON_FIELD_OBJ("HeadPics", headPicsFields),
+	JSON_FIELD("Body", JSON_FIELD_STRING, CharacterClass, Body),
+	JSON_FIELD(
+		"DeathSprites", JSON_FIELD_STRING, CharacterClass, DeathSprites),
+	JSON_FIELD("Mass", JSON_FIELD_INT, CharacterClass, Mass),
+	JSON_FIELD("Sounds", JSON_FIELD_STRING, CharacterClass, Sounds),
+	JSON_FIELD("Footsteps", JSON_FIELD_STRING, CharacterClass, Footsteps),
+	JSON_FIELD(
+		"FootstepsDistancePlus", JSON_FIELD_INT, CharacterClass,
+		FootstepsDistancePlus),
+	JSON_FIELD("BloodColor", JSON_FIELD_COLOR, CharacterClass, BloodColor),
+	JSON_FIELD(
+		"HasHair", JSON_FIELD_BOOL, CharacterClass,
+		HasHeadParts[HEAD_PART_HAIR]),
+	JSON_FIELD(
+		"HasFacehair", JSON_FIELD_BOOL, CharacterClass,
+		HasHeadParts[HEAD_PART_FACEHAIR]),
+	JSON_FIELD(
+		"HasHat", JSON_FIELD_BOOL, CharacterClass,
+		HasHeadParts[HEAD_PART_HAT]),
+	JSON_FIELD(
+		"HasGlasses", JSON_FIELD_BOOL, CharacterClass,
+		HasHeadParts[HEAD_PART_GLASSES]),
+	JSON_FIELD("Corpse", JSON_FIELD_STRING, CharacterClass, Corpse),
+	JSON_FIELDS_END};
+static void CharacterClassInit(void *data, void *classes)
+{
+	UNUSED(classes);
+	CharacterClass *c = data;
 	c->Mass = CHARACTER_DEFAULT_MASS;
-	LoadInt(&c->Mass, node, "Mass");
-	c->Sprites = StrCharSpriteClass(c->Body);
-
-	LoadStr(&c->Sounds, node, "Sounds");
-
-	LoadStr(&c->Footsteps, node, "Footsteps");
 	c->FootstepsDistancePlus = FOOTSTEP_DISTANCE_PLUS;
-	LoadInt(&c->FootstepsDistancePlus, node, "FootstepsDistancePlus");
-
 	c->BloodColor = colorRed;
-	LoadColor(&c->BloodColor, node, "BloodColor");
-
 	// By default player classes allow cranial accessories
 	// But some types can't/shouldn't have stuff like hair
 	// For example the alien
 	c->HasHeadParts[HEAD_PART_HAIR] = true;
-	LoadBool(&c->HasHeadParts[HEAD_PART_HAIR], node, "HasHair");
 	c->HasHeadParts[HEAD_PART_FACEHAIR] = true;
-	LoadBool(&c->HasHeadParts[HEAD_PART_FACEHAIR], node, "HasFacehair");
 	c->HasHeadParts[HEAD_PART_HAT] = true;
-	LoadBool(&c->HasHeadParts[HEAD_PART_HAT], node, "HasHat");
 	c->HasHeadParts[HEAD_PART_GLASSES] = true;
-	LoadBool(&c->HasHeadParts[HEAD_PART_GLASSES], node, "HasGlasses");
-
-	LoadStr(&c->Corpse, node, "Corpse");
+}
+static void CharacterClassAdd(void *data, const int version, void *classes)
+{
+	UNUSED(version);
+	CharacterClass *c = data;
+	if (c->Body == NULL)
+	{
+		CSTRDUP(c->Body, "base");
+	}
+	if (c->DeathSprites == NULL)
+	{
+		CSTRDUP(c->DeathSprites, "death");
+	}
+	c->Sprites = StrCharSpriteClass(c->Body);
+	CArrayPushBack(classes, c);
+}
+static void CharacterClassTerminate(void *data)
+{
+	CharacterClassFree(data);
+}
+bool CharacterClassesLoadFile(CArray *classes, const char *path)
+{
+	FILE *f = fopen(path, "r");
+	if (f == NULL)
+	{
+		return false;
+	}
+	const JSONClassSchema schema = {
+		"Characters",
+		characterClassFields,
+		sizeof(CharacterClass),
+		VERSION,
+		CharacterClassInit,
+		CharacterClassAdd,
+		CharacterClassTerminate,
+		classes,
+		NULL,
+		NULL};
+	const int version = JSONStreamLoadClasses(&schema, f);
+	fclose(f);
+	return version > 0;
 }
 void CharacterClassesClear(CArray *classes)
 {
@@ -76,6 +76,6 @@ void CharacterClassGetSound(
 	const CharacterClass *c, char *out, const char *sound);
 
 void CharacterClassesInitialize(CharacterClasses *c, const char *filename);
-void CharacterClassesLoadJSON(CArray *classes, json_t *root);
+bool CharacterClassesLoadFile(CArray *classes, const char *path);
 void CharacterClassesClear(CArray *classes);
 void CharacterClassesTerminate(CharacterClasses *c);
@@ -161,18 +161,14 @@ bool IsCollisionWithWall(const struct vec2 pos, const struct vec2i size2)
 	{
 		return true;
 	}
-	if (HitWall((int)pos.x - size.x, (int)pos.y - size.y) ||
-		HitWall((int)pos.x - size.x, (int)pos.y) ||
-		HitWall((int)pos.x - size.x, (int)pos.y + size.y) ||
-		HitWall((int)pos.x, (int)pos.y + size.y) ||
-		HitWall((int)pos.x + size.x, (int)pos.y + size.y) ||
-		HitWall((int)pos.x + size.x, (int)pos.y) ||
-		HitWall((int)pos.x + size.x, (int)pos.y - size.y) ||
-		HitWall((int)pos.x, (int)pos.y - size.y))
-	{
-		return true;
-	}
-	return false;
+	// Check all the tiles under the bounding box, a row at a time
+	const struct vec2i tMin = svec2i(
+		((int)pos.x - size.x) / TILE_WIDTH,
+		((int)pos.y - size.y) / TILE_HEIGHT);
+	const struct vec2i tMax = svec2i(
+		((int)pos.x + size.x) / TILE_WIDTH,
+		((int)pos.y + size.y) / TILE_HEIGHT);
+	return !BitGridRectAll(&gMap.walkable, tMin, tMax);
 }
 
 // Check collision with a diamond shape
@@ -65,8 +65,8 @@ void CollisionSystemReset(CollisionSystem *cs);
 void CollisionSystemTerminate(CollisionSystem *cs);
 
 #define HitWall(x, y)                                                         \
-	(!TileCanWalk(MapGetTile(                                                 \
-		&gMap, svec2i((int)(x) / TILE_WIDTH, (int)(y) / TILE_HEIGHT))))
+	(!MapTileCanWalk(                                                         \
+		&gMap, svec2i((int)(x) / TILE_WIDTH, (int)(y) / TILE_HEIGHT)))
 
 // Which "team" the actor's on, for collision
 // Actors on the same team don't have to collide
@@ -314,19 +314,23 @@ int ConfigGetVersion(FILE *f)
 
 Config *ConfigGet(Config *c, const char *name)
 {
-	char *nameCopy;
-	CSTRDUP(nameCopy, name);
-	char *pch = strtok(nameCopy, ".");
-	while (pch != NULL)
+	// Walk the dot-separated name segments in place; this is called often,
+	// including from job threads, so don't copy or strtok the name
+	const char *segment = name;
+	while (*segment != '\0')
 	{
+		const char *dot = strchr(segment, '.');
+		const size_t len =
+			dot != NULL ? (size_t)(dot - segment) : strlen(segment);
 		if (c->Type != CONFIG_TYPE_GROUP)
 		{
 			CASSERT(false, "Invalid config type");
-			goto bail;
+			break;
 		}
 		bool found = false;
 		CA_FOREACH(Config, child, c->u.Group)
-		if (strcmp(child->Name, pch) == 0)
+		if (strncmp(child->Name, segment, len) == 0 &&
+			child->Name[len] == '\0')
 		{
 			c = child;
 			found = true;
@@ -336,12 +340,14 @@ Config *ConfigGet(Config *c, const char *name)
 		if (!found)
 		{
 			CASSERT(false, "Config not found");
-			goto bail;
+			break;
+		}
+		if (dot == NULL)
+		{
+			break;
 		}
-		pch = strtok(NULL, ".");
+		segment = dot + 1;
 	}
-bail:
-	CFREE(nameCopy);
 	return c;
 }
 
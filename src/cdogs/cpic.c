@@ -121,7 +121,7 @@ void CPicLoadJSON(CPic *p, json_t *node)
 		if (p->Type == PICTYPE_ANIMATED_RANDOM)
 		{
 			// initialise frame with a random value
-			p->u.Animated.Frame = rand() % (int)p->u.Animated.Sprites->size;
+			p->u.Animated.Frame = RandInt(RNG_FX, 0, (int)p->u.Animated.Sprites->size);
 		}
 		break;
 	default:
@@ -220,7 +220,7 @@ void CPicCopyPic(CPic *dest, const CPic *src)
 	if (dest->Type == PICTYPE_ANIMATED_RANDOM)
 	{
 		// initialise frame with a random value
-		dest->u.Animated.Frame = rand() % (int)dest->u.Animated.Sprites->size;
+		dest->u.Animated.Frame = RandInt(RNG_FX, 0, (int)dest->u.Animated.Sprites->size);
 	}
 }
 
@@ -248,13 +248,13 @@ void CPicUpdate(CPic *p, const int ticks)
 		if (p->u.Animated.Count == 0)
 		{
 			// Initial frame
-			p->u.Animated.Frame = rand() % (int)p->u.Animated.Sprites->size;
+			p->u.Animated.Frame = RandInt(RNG_FX, 0, (int)p->u.Animated.Sprites->size);
 		}
 		p->u.Animated.Count += ticks;
 		if (p->u.Animated.TicksPerFrame > 0 &&
 			p->u.Animated.Count >= p->u.Animated.TicksPerFrame)
 		{
-			p->u.Animated.Frame = rand() % (int)p->u.Animated.Sprites->size;
+			p->u.Animated.Frame = RandInt(RNG_FX, 0, (int)p->u.Animated.Sprites->size);
 			p->u.Animated.Count = 0;
 		}
 		break;
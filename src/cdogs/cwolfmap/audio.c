@@ -12,7 +12,7 @@
 
 #define PATH_MAX 4096
 static int volume = 20;
-static const int oplChip = 0;
+static int numOplChips = 0;
 #define OPL_CHANNELS 9
 #define MUSIC_RATE 700
 #define SOUND_RATE 140 // Also affects PC Speaker sounds
@@ -45,7 +45,7 @@ static const AlInstrument ChannelRelease = {
 
 	0, 0, {0, 0, 0}};
 
-#define alOut(n, b) YM3812Write(oplChip, n, b, &volume)
+#define alOut(n, b) YM3812Write(chip, n, b, &volume)
 
 //      Register addresses
 // Operator stuff
@@ -61,7 +61,8 @@ static const AlInstrument ChannelRelease = {
 // Global stuff
 #define alEffects 0xbd
 
-static void AlSetChanInst(const AlInstrument *inst, unsigned int chan)
+static void AlSetChanInst(
+	const int chip, const AlInstrument *inst, unsigned int chan)
 {
 	static const uint8_t chanOps[OPL_CHANNELS] = {0,   1,	 2,	   8,	9,
 												  0xA, 0x10, 0x11, 0x12};
@@ -85,19 +86,37 @@ static void AlSetChanInst(const AlInstrument *inst, unsigned int chan)
 	alOut(chan + alFeedCon, 0);
 }
 
-bool CWAudioInit(void)
+// Put the chip in a known state before rendering, so the output doesn't
+// depend on what was rendered on it before
+static void AlReset(const int chip)
+{
+	YM3812ResetChip(chip);
+	for (int i = 1; i < 0xf6; i++)
+	{
+		alOut(i, 0);
+	}
+	alOut(1, 0x20); // Set WSE=1
+}
+
+bool CWAudioInit(const int numChips)
 {
 	// Init adlib
-	if (YM3812Init(1, 3579545, MUSIC_SAMPLE_RATE))
+	if (YM3812Init(numChips, 3579545, MUSIC_SAMPLE_RATE))
 	{
 		fprintf(stderr, "Unable to create virtual OPL\n");
 		return false;
 	}
+	numOplChips = numChips;
 	return true;
 }
+int CWAudioGetNumChips(void)
+{
+	return numOplChips;
+}
 void CWAudioTerminate(void)
 {
 	YM3812Shutdown();
+	numOplChips = 0;
 }
 
 int CWAudioLoadHead(CWAudioHead *head, const char *path)
@@ -126,12 +145,6 @@ int CWAudioLoadHead(CWAudioHead *head, const char *path)
 		goto bail;
 	}
 
-	for (int i = 1; i < 0xf6; i++)
-	{
-		YM3812Write(oplChip, i, 0, &volume);
-	}
-	YM3812Write(oplChip, 1, 0x20, &volume); // Set WSE=1
-
 bail:
 	if (f)
 	{
@@ -225,10 +238,15 @@ bail:
 }
 
 int CWAudioGetAdlibSound(
-	const CWAudio *audio, const int idx, char **data, size_t *len)
+	const CWAudio *audio, const int chip, const int idx, char **data,
+	size_t *len)
 {
 	*data = NULL;
 	*len = 0;
+	if (chip < 0 || chip >= numOplChips)
+	{
+		return -1;
+	}
 	const char *rawData;
 	size_t rawLen;
 	int err = CWAudioGetAdlibSoundRaw(audio, idx, &rawData, &rawLen);
@@ -239,7 +257,8 @@ int CWAudioGetAdlibSound(
 
 	const AdLibSound *sound = (const AdLibSound *)rawData;
 	const uint8_t alBlock = ((sound->block & 7) << 2) | 0x20;
-	AlSetChanInst(&sound->inst, 0);
+	AlReset(chip);
+	AlSetChanInst(chip, &sound->inst, 0);
 
 	const uint8_t *alSound = sound->data;
 	*len = sound->length * SAMPLES_PER_MUSIC_TICK * SOUND_TICKS *
@@ -261,7 +280,7 @@ int CWAudioGetAdlibSound(
 
 		for (int i = 0; i < SOUND_TICKS; i++)
 		{
-			YM3812UpdateOne(oplChip, stream16, SAMPLES_PER_MUSIC_TICK);
+			YM3812UpdateOne(chip, stream16, SAMPLES_PER_MUSIC_TICK);
 			stream16 += SAMPLES_PER_MUSIC_TICK * MUSIC_AUDIO_CHANNELS;
 		}
 	}
@@ -302,12 +321,16 @@ bail:
 }
 
 int CWAudioGetMusic(
-	CWAudio *audio, const CWMapType type, const int idx, char **data,
-	size_t *len)
+	CWAudio *audio, const CWMapType type, const int chip, const int idx,
+	char **data, size_t *len)
 {
 	*data = NULL;
 	*len = 0;
 	int err = 0;
+	if (chip < 0 || chip >= numOplChips)
+	{
+		return -1;
+	}
 
 	if (type == CWMAPTYPE_N3D)
 	{
@@ -330,9 +353,10 @@ int CWAudioGetMusic(
 			goto bail;
 		}
 
+		AlReset(chip);
 		for (int i = 0; i < OPL_CHANNELS; i++)
 		{
-			AlSetChanInst(&ChannelRelease, i);
+			AlSetChanInst(chip, &ChannelRelease, i);
 		}
 
 		// Measure length of music
@@ -395,7 +419,7 @@ int CWAudioGetMusic(
 				sqHackLen -= 4;
 			} while (sqHackLen > 0);
 
-			YM3812UpdateOne(oplChip, stream16, SAMPLES_PER_MUSIC_TICK);
+			YM3812UpdateOne(chip, stream16, SAMPLES_PER_MUSIC_TICK);
 
 			stream16 += SAMPLES_PER_MUSIC_TICK * MUSIC_AUDIO_CHANNELS;
 		}
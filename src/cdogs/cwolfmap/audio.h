@@ -11,8 +11,11 @@
 #define MUSIC_AUDIO_FMT AUDIO_S16SYS
 #define MUSIC_AUDIO_CHANNELS 2
 
-bool CWAudioInit(void);
+// Sounds and music are rendered with emulated OPL chips; each chip can only
+// be used by one thread at a time, so use one chip per rendering thread
+bool CWAudioInit(const int numChips);
 void CWAudioTerminate(void);
+int CWAudioGetNumChips(void);
 
 int CWAudioLoadHead(CWAudioHead *head, const char *path);
 void CWAudioHeadFree(CWAudioHead *head);
@@ -25,12 +28,13 @@ void CWAudioFree(CWAudio *audio);
 int CWAudioGetAdlibSoundRaw(
 	const CWAudio *audio, const int i, const char **data, size_t *len);
 int CWAudioGetAdlibSound(
-	const CWAudio *audio, const int i, char **data, size_t *len);
+	const CWAudio *audio, const int chip, const int i, char **data,
+	size_t *len);
 int CWAudioGetMusicRaw(
 	const CWAudio *audio, const int i, const char **data, size_t *len);
 int CWAudioGetMusic(
-	CWAudio *audio, const CWMapType type, const int idx, char **data,
-	size_t *len);
+	CWAudio *audio, const CWMapType type, const int chip, const int idx,
+	char **data, size_t *len);
 
 typedef enum
 {
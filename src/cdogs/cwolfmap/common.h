@@ -29,6 +29,8 @@ typedef struct
 	int startMusic;
 	char *data;
 	wad_t *wad;
+	// Hash of the audio data, to identify rendered sounds and music
+	uint64_t hash;
 } CWAudio;
 
 typedef struct
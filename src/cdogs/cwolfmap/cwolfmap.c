@@ -23,6 +23,9 @@
 
 // TODO: use map header magic value
 #define MAGIC 0xABCD
+// FNV-1a
+#define HASH_OFFSET 14695981039346656037ULL
+#define HASH_PRIME 1099511628211ULL
 
 #ifndef PATH_MAX
 #define PATH_MAX 4096
@@ -106,6 +109,7 @@ CWMapType CWGetType(
 
 static int LoadMapHead(CWolfMap *map, const char *path);
 static int LoadMapData(CWolfMap *map, const char *path);
+static uint64_t HashData(uint64_t h, const void *data, const size_t len);
 int CWLoad(CWolfMap *map, const char *path, const int spearMission)
 {
 	memset(map, 0, sizeof *map);
@@ -149,6 +153,15 @@ int CWLoad(CWolfMap *map, const char *path, const int spearMission)
 	_TRY_LOAD("AUDIOHED", CWAudioLoadHead, &map->audio.head, pathBuf);
 
 	_TRY_LOAD("AUDIOT", CWAudioLoadAudioT, &map->audio, map->type, pathBuf);
+	if (map->audio.data != NULL && map->audio.head.nOffsets > 0)
+	{
+		map->audio.hash = HashData(
+			HashData(
+				HASH_OFFSET, map->audio.head.offsets,
+				map->audio.head.nOffsets * sizeof(uint32_t)),
+			map->audio.data,
+			map->audio.head.offsets[map->audio.head.nOffsets - 1]);
+	}
 
 	if (map->type == CWMAPTYPE_N3D)
 	{
@@ -210,9 +223,6 @@ bail:
 
 static void LevelsFree(CWolfMap *map);
 
-static int LoadLevel(
-	const CWolfMap *map, CWLevel *level, const unsigned char *data,
-	const int off);
 static int LoadMapData(CWolfMap *map, const char *path)
 {
 	int err = 0;
@@ -241,17 +251,29 @@ static int LoadMapData(CWolfMap *map, const char *path)
 	{
 		map->nLevels++;
 	}
-	map->levels = malloc(sizeof(CWLevel) * map->nLevels);
+	map->levels = calloc(map->nLevels, sizeof(CWLevel));
+	// Only read the level headers here; the planes are expanded on demand
+	// https://moddingwiki.shikadi.net/wiki/GameMaps_Format#Level_headers
 	CWLevel *lPtr = map->levels;
 	for (const int32_t *ptr = &map->mapHead.ptr[0]; *ptr > 0; ptr++, lPtr++)
 	{
-		err = LoadLevel(map, lPtr, buf, *ptr);
-		if (err != 0)
+		if (*ptr + (long)sizeof lPtr->header > fsize)
 		{
+			err = -1;
+			fprintf(stderr, "Level header out of range\n");
 			goto bail;
 		}
+		memcpy(&lPtr->header, buf + *ptr, sizeof lPtr->header);
 	}
 
+	free(map->mapData);
+	map->mapData = buf;
+	map->mapDataLen = (size_t)fsize;
+	buf = NULL;
+	map->mapHash = HashData(
+		HashData(HASH_OFFSET, &map->mapHead, sizeof map->mapHead),
+		map->mapData, map->mapDataLen);
+
 bail:
 	if (f)
 	{
@@ -264,40 +286,55 @@ bail:
 	}
 	return err;
 }
+static uint64_t HashData(uint64_t h, const void *data, const size_t len)
+{
+	const unsigned char *p = data;
+	for (size_t i = 0; i < len; i++)
+	{
+		h ^= p[i];
+		h *= HASH_PRIME;
+	}
+	return h;
+}
+
 static int LoadPlane(
-	const CWolfMap *map, CWPlane *plane, const unsigned char *data,
-	const uint32_t off, unsigned char *buf, const int bufSize);
-// https://moddingwiki.shikadi.net/wiki/GameMaps_Format#Level_headers
-static int LoadLevel(
-	const CWolfMap *map, CWLevel *level, const unsigned char *data,
-	const int off)
+	const CWolfMap *map, CWLevel *level, const int planeIndex);
+int CWLevelLoad(CWolfMap *map, const int i)
 {
 	int err = 0;
-	unsigned char *buf = NULL;
-	level->description = NULL;
-	memcpy(&level->header, data + off, sizeof(level->header));
-
-	const int bufSize =
-		level->header.width * level->header.height * sizeof(uint16_t);
-	buf = malloc(bufSize);
-	for (int i = 0; i < NUM_PLANES; i++)
+	if (i < 0 || i >= map->nLevels)
 	{
-		const int32_t plen = *(&level->header.lenPlane0 + i);
-		if (plen <= 0)
-		{
-			memset(&level->planes[i], 0, sizeof level->planes[i]);
-			continue;
-		}
-		const uint32_t poff = *(&level->header.offPlane0 + i);
-		err = LoadPlane(map, &level->planes[i], data, poff, buf, bufSize);
+		return -1;
+	}
+	CWLevel *level = &map->levels[i];
+	for (int j = 0; j < NUM_PLANES; j++)
+	{
+		err = LoadPlane(map, level, j);
 		if (err != 0)
 		{
-			goto bail;
+			break;
 		}
 	}
+	return err;
+}
 
-	// Check if level has any player spawns
+bool CWLevelHasPlayerSpawn(CWolfMap *map, const int i)
+{
+	if (i < 0 || i >= map->nLevels)
+	{
+		return false;
+	}
+	CWLevel *level = &map->levels[i];
+	if (level->hasPlayerSpawnChecked)
+	{
+		return level->hasPlayerSpawn;
+	}
+	level->hasPlayerSpawnChecked = true;
 	level->hasPlayerSpawn = false;
+	if (LoadPlane(map, level, 1) != 0 || level->planes[1].plane == NULL)
+	{
+		return false;
+	}
 	for (int y = 0; y < level->header.height && !level->hasPlayerSpawn; y++)
 	{
 		for (int x = 0; x < level->header.width && !level->hasPlayerSpawn; x++)
@@ -313,23 +350,32 @@ static int LoadLevel(
 			}
 		}
 	}
-
-bail:
-	free(buf);
-	return err;
+	return level->hasPlayerSpawn;
 }
+
 static int LoadPlane(
-	const CWolfMap *map, CWPlane *plane, const unsigned char *data,
-	const uint32_t off, unsigned char *buf, const int bufSize)
+	const CWolfMap *map, CWLevel *level, const int planeIndex)
 {
 	int err = 0;
-
-	if (off == 0)
+	unsigned char *buf = NULL;
+	CWPlane *plane = &level->planes[planeIndex];
+	const int32_t plen = *(&level->header.lenPlane0 + planeIndex);
+	const uint32_t off = *(&level->header.offPlane0 + planeIndex);
+	if (plane->plane != NULL || plen <= 0 || off == 0)
+	{
+		goto bail;
+	}
+	if (map->mapData == NULL || off >= map->mapDataLen)
 	{
+		err = -1;
+		fprintf(stderr, "Plane out of range\n");
 		goto bail;
 	}
 
-	ExpandCarmack(data + off, buf);
+	const int bufSize =
+		level->header.width * level->header.height * sizeof(uint16_t);
+	buf = malloc(bufSize);
+	ExpandCarmack(map->mapData + off, buf);
 	plane->len = bufSize;
 	plane->plane = malloc(bufSize);
 	const bool hasFinalLength =
@@ -337,6 +383,7 @@ static int LoadPlane(
 	ExpandRLEW(buf, (unsigned char *)plane->plane, MAGIC, hasFinalLength);
 
 bail:
+	free(buf);
 	return err;
 }
 
@@ -346,10 +393,16 @@ void CWCopy(CWolfMap *dst, const CWolfMap *src)
 	const size_t levelsSize = sizeof(CWLevel) * dst->nLevels;
 	dst->levels = malloc(levelsSize);
 	memcpy(dst->levels, src->levels, levelsSize);
+	dst->mapData = malloc(dst->mapDataLen);
+	memcpy(dst->mapData, src->mapData, dst->mapDataLen);
 	for (int i = 0; i < dst->nLevels; i++)
 	{
 		for (int j = 0; j < NUM_PLANES; j++)
 		{
+			if (src->levels[i].planes[j].plane == NULL)
+			{
+				continue;
+			}
 			const int len = dst->levels[i].planes[j].len;
 			dst->levels[i].planes[j].plane = malloc(len);
 			memcpy(
@@ -384,6 +437,7 @@ void CWFree(CWolfMap *map)
 		return;
 	}
 	LevelsFree(map);
+	free(map->mapData);
 	CWAudioFree(&map->audio);
 	CWVSwapFree(&map->vswap);
 	for (int i = 0; i < map->nQuizzes; i++)
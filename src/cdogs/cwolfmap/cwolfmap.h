@@ -36,14 +36,21 @@ typedef struct
 typedef struct
 {
 	CWLevelHead header;
+	// Planes are expanded on demand; see CWLevelLoad
 	CWPlane planes[NUM_PLANES];
 	bool hasPlayerSpawn;
+	bool hasPlayerSpawnChecked;
 	char *description;
 } CWLevel;
 
 typedef struct
 {
 	CWMapHead mapHead;
+	// Compressed map data (GAMEMAPS), kept so levels can be expanded later
+	unsigned char *mapData;
+	size_t mapDataLen;
+	// Hash of the map head and data, to identify the levels
+	uint64_t mapHash;
 	CWLevel *levels;
 	int nLevels;
 	CWAudio audio;
@@ -60,6 +67,11 @@ int CWLoad(CWolfMap *map, const char *path, const int spearMission);
 void CWCopy(CWolfMap *dst, const CWolfMap *src);
 void CWFree(CWolfMap *map);
 
+// Expand the level's planes, if they haven't been already
+int CWLevelLoad(CWolfMap *map, const int i);
+// Only expands the object plane
+bool CWLevelHasPlayerSpawn(CWolfMap *map, const int i);
+
 const char *CWGetDescription(CWolfMap *map, const int spearMission);
 
 void CWN3DLoadQuizzes(CWolfMap *map, const char *languageBuf);
@@ -577,14 +577,21 @@ const INT8 lfo_pm_table[8*8*2] = {
 static int num_lock = 0;
 
 
-static void *cur_chip = NULL;	/* current chip pointer */
-OPL_SLOT *SLOT7_1, *SLOT7_2, *SLOT8_1, *SLOT8_2;
+/* working state while updating a chip; per thread, so that different
+   chips can be updated on different threads at the same time */
+#if defined(_MSC_VER)
+#define OPL_THREAD_LOCAL __declspec(thread)
+#else
+#define OPL_THREAD_LOCAL __thread
+#endif
+static OPL_THREAD_LOCAL void *cur_chip = NULL;	/* current chip pointer */
+static OPL_THREAD_LOCAL OPL_SLOT *SLOT7_1, *SLOT7_2, *SLOT8_1, *SLOT8_2;
 
-signed int phase_modulation;	/* phase modulation input (SLOT 2) */
-signed int output[1];
+static OPL_THREAD_LOCAL signed int phase_modulation;	/* phase modulation input (SLOT 2) */
+static OPL_THREAD_LOCAL signed int output[1];
 
-UINT32	LFO_AM;
-INT32	LFO_PM;
+static OPL_THREAD_LOCAL UINT32	LFO_AM;
+static OPL_THREAD_LOCAL INT32	LFO_PM;
 
 int limit( int val, int max, int min ) {
 	if ( val > max )
@@ -1811,7 +1818,7 @@ static int OPLTimerOver(FM_OPL *OPL,int c)
 }
 
 
-#define MAX_OPL_CHIPS 2
+#define MAX_OPL_CHIPS 16
 
 static FM_OPL *OPL_YM3812[MAX_OPL_CHIPS];	/* array of pointers to the YM3812's */
 static int YM3812NumChips = 0;				/* number of chips */
@@ -300,9 +300,15 @@ static TWatch *CreateCloseDoorWatch(
 
 		for (int j = -1; j <= 1; j++)
 		{
+			const struct vec2i vJ =
+				svec2i_add(vI, svec2i_scale(dAside, (float)j));
 			WatchAddCondition(
-				w, CONDITION_TILECLEAR, gCampaign.Setting.DoorOpenTicks,
-				svec2i_add(vI, svec2i_scale(dAside, (float)j)));
+				w, CONDITION_TILECLEAR, gCampaign.Setting.DoorOpenTicks, vJ);
+			if (MapIsTileIn(mb->Map, vJ))
+			{
+				BitGridSet(&mb->Map->watchTiles, vJ, true);
+				WatchAddTile(w, MapGetTile(mb->Map, vJ));
+			}
 		}
 	}
 
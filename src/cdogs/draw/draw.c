@@ -67,6 +67,7 @@
 #include "pic_manager.h"
 #include "pickup.h"
 #include "pics.h"
+#include "profiler.h"
 #include "texture.h"
 
 // #define DEBUG_DRAW_HITBOXES
@@ -179,25 +180,37 @@ static void DrawExtra(
 void DrawBufferDraw(
 	DrawBuffer *b, struct vec2i offset, const DrawBufferArgs *args)
 {
+	PROFILE_BEGIN("DrawBufferDraw");
 	// First draw the floor tiles (which do not obstruct anything)
+	PROFILE_BEGIN("DrawFloor");
 	DrawTiles(b, offset, DrawFloor);
+	PROFILE_END();
 	// Then draw things that are below everything like debris (wrecks)
+	PROFILE_BEGIN("DrawThingsBelow");
 	DrawTiles(b, offset, DrawThingsBelow);
+	PROFILE_END();
 	// Now draw walls and (non-wreck) things in proper order
+	PROFILE_BEGIN("DrawWallsAndThings");
 	DrawTiles(b, offset, DrawWallsAndThings);
+	PROFILE_END();
 	// Draw things that are above everything
+	PROFILE_BEGIN("DrawThingsAbove");
 	DrawTiles(b, offset, DrawThingsAbove);
+	PROFILE_END();
 	if (args->HUD)
 	{
+		PROFILE_BEGIN("DrawHUDTiles");
 		// Draw objective highlights, for visible and always-visible objectives
 		DrawTiles(b, offset, DrawObjectiveHighlights);
 		// Draw actor chatter
 		DrawTiles(b, offset, DrawChatters);
 		// Draw actor pickup menus
 		DrawTiles(b, offset, DrawPickupMenus);
+		PROFILE_END();
 	}
 	// Draw editor-only things
 	DrawExtra(b, offset, args);
+	PROFILE_END();
 }
 
 static void DrawFloor(
@@ -28,6 +28,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "emitter.h"
 
 #include "game_events.h"
+#include "particle.h"
 
 void EmitterInit(
 	Emitter *em, const ParticleClass *p, const struct vec2 offset,
@@ -50,31 +51,29 @@ void EmitterStart(Emitter *em, const AddParticle *data)
 {
 	const struct vec2 p = svec2_add(data->Pos, em->offset);
 
-	// TODO: single event multiple particles
-	GameEvent e = GameEventNew(GAME_EVENT_ADD_PARTICLE);
-	e.u.AddParticle = *data;
-	e.u.AddParticle.Pos = p;
-	e.u.AddParticle.Z *= Z_FACTOR;
-	if (e.u.AddParticle.Class == NULL)
+	// Particles are cosmetic and local-only so add them directly
+	AddParticle ap = *data;
+	ap.Pos = p;
+	ap.Z *= Z_FACTOR;
+	if (ap.Class == NULL)
 	{
-		e.u.AddParticle.Class = em->p;
+		ap.Class = em->p;
 	}
-	const float speed = RAND_FLOAT(em->minSpeed, em->maxSpeed);
+	const float speed = RandFloat(RNG_FX, em->minSpeed, em->maxSpeed);
 	const struct vec2 baseVel =
-		svec2_rotate(svec2(0, speed), RAND_FLOAT(0, MPI * 2));
-	e.u.AddParticle.Vel = svec2_add(data->Vel, baseVel);
+		svec2_rotate(svec2(0, speed), RandFloat(RNG_FX, 0, MPI * 2));
+	ap.Vel = svec2_add(data->Vel, baseVel);
 	if (isnan(data->Angle))
 	{
-		e.u.AddParticle.Angle = RAND_FLOAT(0, MPI * 2);
+		ap.Angle = RandFloat(RNG_FX, 0, MPI * 2);
 	}
-	e.u.AddParticle.DZ = RAND_FLOAT(em->minDZ, em->maxDZ);
-	e.u.AddParticle.Spin = RAND_DOUBLE(em->minRotation, em->maxRotation);
-	if (strlen(e.u.AddParticle.Text) == 0 &&
-		e.u.AddParticle.Class->Type == PARTICLE_TEXT)
+	ap.DZ = RandFloat(RNG_FX, em->minDZ, em->maxDZ);
+	ap.Spin = RandDouble(RNG_FX, em->minRotation, em->maxRotation);
+	if (strlen(ap.Text) == 0 && ap.Class->Type == PARTICLE_TEXT)
 	{
-		strcpy(e.u.AddParticle.Text, e.u.AddParticle.Class->u.Text.Value);
+		strcpy(ap.Text, ap.Class->u.Text.Value);
 	}
-	GameEventsEnqueue(&gGameEvents, e);
+	ParticleAdd(&gParticles, ap);
 }
 
 void EmitterUpdate(Emitter *em, const AddParticle *data, const int ticks)
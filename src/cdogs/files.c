@@ -56,6 +56,10 @@
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #include "door.h"
 #include "log.h"
@@ -762,3 +766,72 @@ color_t RangeToColor(const int range)
 		return colorBlack;
 	};
 }
+
+static bool ReadWholeFile(FileMapping *m, const char *path)
+{
+	FILE *f = fopen(path, "rb");
+	if (f == NULL)
+	{
+		return false;
+	}
+	bool res = false;
+	void *data = NULL;
+	if (fseek(f, 0, SEEK_END) != 0)
+	{
+		goto bail;
+	}
+	const long size = ftell(f);
+	if (size <= 0 || fseek(f, 0, SEEK_SET) != 0)
+	{
+		goto bail;
+	}
+	CMALLOC(data, size);
+	if (fread(data, 1, size, f) != (size_t)size)
+	{
+		CFREE(data);
+		goto bail;
+	}
+	m->Data = data;
+	m->Size = (size_t)size;
+	res = true;
+
+bail:
+	fclose(f);
+	return res;
+}
+bool FileMapOpen(FileMapping *m, const char *path)
+{
+	memset(m, 0, sizeof *m);
+#ifndef _WIN32
+	const int fd = open(path, O_RDONLY);
+	if (fd >= 0)
+	{
+		struct stat st;
+		if (fstat(fd, &st) == 0 && st.st_size > 0)
+		{
+			void *data =
+				mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data != MAP_FAILED)
+			{
+				m->Data = data;
+				m->Size = (size_t)st.st_size;
+				m->isMapped = true;
+			}
+		}
+		close(fd);
+	}
+#endif
+	return m->Data != NULL || ReadWholeFile(m, path);
+}
+void FileMapClose(FileMapping *m)
+{
+#ifndef _WIN32
+	if (m->isMapped)
+	{
+		munmap(m->Data, m->Size);
+		m->Data = NULL;
+	}
+#endif
+	CFREE(m->Data);
+	memset(m, 0, sizeof *m);
+}
@@ -225,3 +225,14 @@ color_t RangeToColor(const int range);
 #define COLORRANGE_COUNT 27
 
 bool mkdir_deep(const char *path);
+
+// Read-only view of a whole file, memory-mapped where possible and read into
+// memory otherwise
+typedef struct
+{
+	void *Data;
+	size_t Size;
+	bool isMapped;
+} FileMapping;
+bool FileMapOpen(FileMapping *m, const char *path);
+void FileMapClose(FileMapping *m);
@@ -228,7 +228,7 @@ GameEvent GameEventNew(GameEventType type)
 		e.u.ActorAdd.PilotUID = -1;
 		e.u.ActorAdd.VehicleUID = -1;
 		e.u.ActorAdd.PlayerUID = -1;
-		e.u.ActorAdd.Direction = rand() % DIRECTION_COUNT;
+		e.u.ActorAdd.Direction = RAND_INT(0, DIRECTION_COUNT);
 		e.u.ActorAdd.has_Pos = true;
 		break;
 	case GAME_EVENT_ACTOR_ADD_AMMO:
@@ -53,6 +53,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
 
 #include <tinydir/tinydir.h>
 
@@ -61,6 +62,7 @@
 #include "defs.h"
 #include "keyboard.h"
 #include "log.h"
+#include "map_prep.h"
 #include "music.h"
 #include "objs.h"
 #include "pickup.h"
@@ -87,6 +89,14 @@ bool CampaignLoad(Campaign *co, const CampaignEntry *entry)
 	CampaignSettingInit(&co->Setting);
 	if (entry->Mode == GAME_MODE_QUICK_PLAY)
 	{
+		if (co->QuickPlaySeed == 0)
+		{
+			co->QuickPlaySeed = (uint32_t)RandInt(RNG_FX, 1, INT_MAX);
+		}
+		LOG(LM_MAIN, LL_INFO, "quick play seed %u", co->QuickPlaySeed);
+		// The simulation stream is reseeded per mission, so it is safe to
+		// use it for generating the campaign
+		RandSeedStream(RNG_SIM, co->QuickPlaySeed);
 		SetupQuickPlayCampaign(&co->Setting, false);
 		co->IsLoaded = true;
 	}
@@ -114,11 +124,13 @@ bool CampaignLoad(Campaign *co, const CampaignEntry *entry)
 }
 void CampaignUnload(Campaign *co)
 {
+	MapPrepCancel(&gMapPrep);
 	co->MissionIndex = 0;
 	co->IsLoaded = false;
 	co->IsClient = false;	// TODO: select is client from menu
 	co->OptionsSet = false;
 	co->IsComplete = false;
+	co->QuickPlaySeed = 0;
 	gCampaign.IsQuit = false;
 	CampaignEntryTerminate(&co->Entry);
 }
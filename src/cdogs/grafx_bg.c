@@ -106,7 +106,8 @@ void GrafxRedrawBackground(GraphicsDevice *g, const struct vec2 pos)
 	memset(g->buf, 0, GraphicsGetMemSize(&g->cachedConfig));
 	DrawBuffer buffer;
 	DrawBufferInit(&buffer, svec2i(X_TILES, Y_TILES), g);
-	const HSV tint = {rand() * 360.0 / RAND_MAX, rand() * 1.0 / RAND_MAX, 0.5};
+	const HSV tint = {
+		RandDouble(RNG_FX, 0.0, 360.0), RandDouble(RNG_FX, 0.0, 1.0), 0.5};
 	DrawBufferArgs args;
 	memset(&args, 0, sizeof args);
 	GrafxDrawBackground(g, &buffer, tint, pos, &args);
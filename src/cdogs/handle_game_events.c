@@ -98,6 +98,7 @@ static void HandleGameEvent(
 			t->Door.Class = doorClass;
 			t->Door.Class2 = doorClass2;
 			DoorStateInit(&t->Door, false);
+			MapUpdateTileFlags(&gMap, pos);
 			pos.x++;
 			if (pos.x == gMap.Size.x)
 			{
@@ -527,8 +528,10 @@ static void HandleGameEvent(
 	}
 	break;
 	case GAME_EVENT_DOOR_TOGGLE: {
-		Tile *t = MapGetTile(&gMap, Net2Vec2i(e.u.DoorToggle.Pos));
+		const struct vec2i pos = Net2Vec2i(e.u.DoorToggle.Pos);
+		Tile *t = MapGetTile(&gMap, pos);
 		DoorStateInit(&t->Door, e.u.DoorToggle.IsOpen);
+		MapUpdateTileFlags(&gMap, pos);
 	}
 	break;
 	case GAME_EVENT_MISSION_COMPLETE:
@@ -31,6 +31,8 @@
 #include <math.h>
 
 #include "actors.h"
+#include "ai.h"
+#include "alloc.h"
 #include "automap.h"
 #include "draw/draw.h"
 #include "draw/draw_actor.h"
@@ -43,6 +45,7 @@
 #include "pic_manager.h"
 #include "player.h"
 #include "player_hud.h"
+#include "profiler.h"
 
 void HUDInit(HUD *hud, GraphicsDevice *device, struct MissionOptions *mission)
 {
@@ -125,6 +128,7 @@ static void DrawHUDMessage(HUD *hud);
 static void DrawKeycards(HUD *hud);
 static void DrawMissionTime(HUD *hud);
 static void DrawObjectiveCounts(HUD *hud);
+static void DrawProfilerOverlay(void);
 void HUDDraw(HUD *hud, const int numViews, const bool paused)
 {
 	if (ConfigGetBool(&gConfig, "Graphics.ShowHUD"))
@@ -153,6 +157,11 @@ void HUDDraw(HUD *hud, const int numViews, const bool paused)
 	{
 		DrawMissionState(hud);
 	}
+
+	if (gProfiler.ShowOverlay)
+	{
+		DrawProfilerOverlay();
+	}
 }
 
 static void DrawPlayerAreas(HUD *hud, const int numViews)
@@ -418,3 +427,43 @@ static void DrawObjectiveCounts(HUD *hud)
 	x += 40;
 	CA_FOREACH_END()
 }
+
+static void DrawProfilerOverlay(void)
+{
+	ProfilerZoneStats stats[PROFILER_MAX_ZONES];
+	const int numZones = ProfilerGetStats(&gProfiler, stats);
+	struct vec2i pos = svec2i(5, gGraphicsDevice.cachedConfig.Res.y / 4);
+	FontStrMask("Zone: avg/max ms", pos, colorYellow);
+	pos.y += FontH();
+	for (int i = 0; i < numZones; i++)
+	{
+		char s[128];
+		sprintf(
+			s, "%*s%s: %.2f/%.2f", stats[i].Depth * 2, "", stats[i].Name,
+			stats[i].AvgMs, stats[i].MaxMs);
+		FontStr(s, pos);
+		pos.y += FontH();
+	}
+	char s[128];
+	sprintf(
+		s, "AI: %d/%d/%d think/skip/defer, LOD %d/%d/%d",
+		gAIStats.Decisions, gAIStats.Skipped, gAIStats.Deferred,
+		gAIStats.LODs[AI_LOD_NEAR], gAIStats.LODs[AI_LOD_FAR],
+		gAIStats.LODs[AI_LOD_DORMANT]);
+	FontStr(s, pos);
+	pos.y += FontH();
+	sprintf(
+		s, "AI players: %d/%d think/skip, LOD %d/%d",
+		gAIPlayerStats.Decisions, gAIPlayerStats.Skipped,
+		gAIPlayerStats.LODs[AI_LOD_NEAR], gAIPlayerStats.LODs[AI_LOD_FAR]);
+	FontStr(s, pos);
+	pos.y += FontH();
+	const AllocStats *as = &gFrameAlloc.LastStats;
+	sprintf(
+		s,
+		"Mem: %d heap blocks, %d frame allocs (%.1f KB), %d pool allocs, "
+		"%d pooled",
+		as->HeapAllocs, as->FrameAllocs, as->FrameBytes / 1024.0,
+		as->PoolAllocs, gFrameAlloc.stats.PoolLive);
+	FontStr(s, pos);
+}
@@ -0,0 +1,372 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "job_system.h"
+
+#include "log.h"
+#include "utils.h"
+
+#define JOB_SCRATCH_ALIGN 16
+// How long a waiting thread sleeps before checking for jobs it can help with
+#define JOB_WAIT_TIMEOUT_MS 1
+
+JobSystem gJobSystem;
+
+// Each thread's JobContext, created on first use for threads outside the
+// job system
+static SDL_TLSID sContextTLS = 0;
+
+static void JobQueueInit(JobQueue *q)
+{
+	q->lock = SDL_CreateMutex();
+	CArrayInit(&q->jobs, sizeof(Job));
+	q->head = 0;
+}
+static void JobQueueTerminate(JobQueue *q)
+{
+	SDL_DestroyMutex(q->lock);
+	CArrayTerminate(&q->jobs);
+}
+static void JobQueuePush(JobQueue *q, const Job *job)
+{
+	SDL_LockMutex(q->lock);
+	CArrayPushBack(&q->jobs, job);
+	SDL_UnlockMutex(q->lock);
+}
+static bool JobQueuePop(JobQueue *q, Job *job, const bool steal)
+{
+	bool found = false;
+	SDL_LockMutex(q->lock);
+	if (q->head < (int)q->jobs.size)
+	{
+		if (steal)
+		{
+			*job = *(const Job *)CArrayGet(&q->jobs, q->head);
+			q->head++;
+		}
+		else
+		{
+			*job = *(const Job *)CArrayGet(&q->jobs, q->jobs.size - 1);
+			CArrayPopBack(&q->jobs);
+		}
+		if (q->head == (int)q->jobs.size)
+		{
+			CArrayClear(&q->jobs);
+			q->head = 0;
+		}
+		found = true;
+	}
+	SDL_UnlockMutex(q->lock);
+	return found;
+}
+
+static void FreeContext(void *data)
+{
+	JobContext *ctx = data;
+	CFREE(ctx->scratch);
+	CFREE(ctx);
+}
+static JobContext *GetContext(void)
+{
+	JobContext *ctx = SDL_TLSGet(sContextTLS);
+	if (ctx == NULL)
+	{
+		CCALLOC(ctx, sizeof *ctx);
+		SDL_TLSSet(sContextTLS, ctx, FreeContext);
+	}
+	return ctx;
+}
+static JobQueue *GetQueue(JobSystem *js, const JobContext *ctx)
+{
+	if (ctx->js != js || ctx->ThreadIndex == 0)
+	{
+		return &js->shared;
+	}
+	return &js->workers[ctx->ThreadIndex - 1].queue;
+}
+
+static void RunJob(JobSystem *js, JobContext *ctx, const Job *job)
+{
+	// Restore the scratch memory afterwards, in case this job is run while
+	// another job on this thread is waiting
+	const size_t scratchUsed = ctx->scratchUsed;
+	job->func(ctx, job->data);
+	ctx->scratchUsed = scratchUsed;
+	if (SDL_AtomicAdd(&job->group->pending, -1) == 1)
+	{
+		SDL_LockMutex(js->lock);
+		SDL_CondBroadcast(js->done);
+		SDL_UnlockMutex(js->lock);
+	}
+}
+static bool TryRunJob(JobSystem *js, JobContext *ctx)
+{
+	Job job;
+	JobQueue *own = GetQueue(js, ctx);
+	bool found = JobQueuePop(own, &job, own == &js->shared);
+	if (!found && own != &js->shared)
+	{
+		found = JobQueuePop(&js->shared, &job, true);
+	}
+	// Steal from the other workers, starting with the next one along so
+	// that thieves spread out
+	for (int i = 0; !found && i < js->numThreads; i++)
+	{
+		const int victim = (ctx->ThreadIndex + i) % js->numThreads;
+		JobQueue *q = &js->workers[victim].queue;
+		if (q != own)
+		{
+			found = JobQueuePop(q, &job, true);
+		}
+	}
+	if (!found)
+	{
+		return false;
+	}
+	SDL_AtomicAdd(&js->numQueued, -1);
+	RunJob(js, ctx, &job);
+	return true;
+}
+
+static int WorkerRun(void *data)
+{
+	JobWorker *w = data;
+	JobSystem *js = w->js;
+	SDL_TLSSet(sContextTLS, &w->ctx, NULL);
+	for (;;)
+	{
+		if (TryRunJob(js, &w->ctx))
+		{
+			continue;
+		}
+		SDL_LockMutex(js->lock);
+		while (SDL_AtomicGet(&js->numQueued) == 0 &&
+			   !SDL_AtomicGet(&js->quit))
+		{
+			SDL_CondWait(js->wake, js->lock);
+		}
+		SDL_UnlockMutex(js->lock);
+		if (SDL_AtomicGet(&js->quit))
+		{
+			break;
+		}
+	}
+	return 0;
+}
+
+void JobSystemInit(JobSystem *js)
+{
+	memset(js, 0, sizeof *js);
+	js->NumWorkers = -1;
+}
+void JobSystemStart(JobSystem *js)
+{
+	CASSERT(!js->isStarted, "job system already started");
+	if (sContextTLS == 0)
+	{
+		sContextTLS = SDL_TLSCreate();
+	}
+	JobQueueInit(&js->shared);
+	SDL_AtomicSet(&js->numQueued, 0);
+	SDL_AtomicSet(&js->quit, 0);
+	js->lock = SDL_CreateMutex();
+	js->wake = SDL_CreateCond();
+	js->done = SDL_CreateCond();
+	js->isStarted = true;
+
+	const int numWorkers = CLAMP(
+		js->NumWorkers < 0 ? SDL_GetCPUCount() - 1 : js->NumWorkers, 0,
+		JOB_SYSTEM_MAX_WORKERS);
+	for (int i = 0; i < numWorkers; i++)
+	{
+		JobWorker *w = &js->workers[i];
+		w->js = js;
+		JobQueueInit(&w->queue);
+		memset(&w->ctx, 0, sizeof w->ctx);
+		w->ctx.js = js;
+		w->ctx.ThreadIndex = i + 1;
+		// Thieves look at numThreads queues, so the queue must be ready first
+		js->numThreads = i + 1;
+		w->thread = SDL_CreateThread(WorkerRun, "Job", w);
+		if (w->thread == NULL)
+		{
+			LOG(LM_MAIN, LL_ERROR, "Failed to create job thread: %s",
+				SDL_GetError());
+			JobQueueTerminate(&w->queue);
+			js->numThreads = i;
+			break;
+		}
+	}
+	LOG(LM_MAIN, LL_DEBUG, "Job system started with %d worker threads",
+		js->numThreads);
+}
+void JobSystemTerminate(JobSystem *js)
+{
+	if (!js->isStarted)
+	{
+		return;
+	}
+	CASSERT(SDL_AtomicGet(&js->numQueued) == 0, "jobs still queued");
+	SDL_LockMutex(js->lock);
+	SDL_AtomicSet(&js->quit, 1);
+	SDL_CondBroadcast(js->wake);
+	SDL_UnlockMutex(js->lock);
+	for (int i = 0; i < js->numThreads; i++)
+	{
+		JobWorker *w = &js->workers[i];
+		SDL_WaitThread(w->thread, NULL);
+		JobQueueTerminate(&w->queue);
+		CFREE(w->ctx.scratch);
+	}
+	JobQueueTerminate(&js->shared);
+	SDL_DestroyCond(js->done);
+	SDL_DestroyCond(js->wake);
+	SDL_DestroyMutex(js->lock);
+	const int numWorkers = js->NumWorkers;
+	JobSystemInit(js);
+	js->NumWorkers = numWorkers;
+}
+int JobSystemGetConcurrency(const JobSystem *js)
+{
+	return js->numThreads + 1;
+}
+
+void JobGroupInit(JobGroup *g)
+{
+	SDL_AtomicSet(&g->pending, 0);
+}
+void JobSystemSubmit(
+	JobSystem *js, JobGroup *g, const JobFunc func, void *data)
+{
+	CASSERT(js->isStarted, "job system not started");
+	Job job;
+	job.func = func;
+	job.data = data;
+	job.group = g;
+	SDL_AtomicAdd(&g->pending, 1);
+	JobQueuePush(GetQueue(js, GetContext()), &job);
+	SDL_AtomicAdd(&js->numQueued, 1);
+	SDL_LockMutex(js->lock);
+	SDL_CondSignal(js->wake);
+	SDL_UnlockMutex(js->lock);
+}
+void JobSystemWait(JobSystem *js, JobGroup *g)
+{
+	JobContext *ctx = GetContext();
+	while (SDL_AtomicGet(&g->pending) > 0)
+	{
+		if (TryRunJob(js, ctx))
+		{
+			continue;
+		}
+		// The group's remaining jobs are running on other threads; wait for
+		// them, but wake up now and then in case they queue more jobs
+		SDL_LockMutex(js->lock);
+		if (SDL_AtomicGet(&g->pending) > 0)
+		{
+			SDL_CondWaitTimeout(js->done, js->lock, JOB_WAIT_TIMEOUT_MS);
+		}
+		SDL_UnlockMutex(js->lock);
+	}
+}
+
+typedef struct
+{
+	ParallelForFunc func;
+	void *data;
+	int count;
+	int batchSize;
+	SDL_atomic_t next;
+} ParallelFor;
+static void RunParallelFor(JobContext *ctx, void *data)
+{
+	ParallelFor *pf = data;
+	for (;;)
+	{
+		const int start = SDL_AtomicAdd(&pf->next, 1) * pf->batchSize;
+		if (start >= pf->count)
+		{
+			break;
+		}
+		pf->func(ctx, pf->data, start, MIN(start + pf->batchSize, pf->count));
+	}
+}
+void JobSystemParallelFor(
+	JobSystem *js, const int count, const int batchSize,
+	const ParallelForFunc func, void *data)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+	ParallelFor pf;
+	pf.func = func;
+	pf.data = data;
+	pf.count = count;
+	pf.batchSize = MAX(batchSize, 1);
+	SDL_AtomicSet(&pf.next, 0);
+	if (!js->isStarted)
+	{
+		// e.g. tools that don't start the job system; run everything here
+		JobContext ctx;
+		memset(&ctx, 0, sizeof ctx);
+		RunParallelFor(&ctx, &pf);
+		CFREE(ctx.scratch);
+		return;
+	}
+	// Batches are taken from a shared counter, so only submit as many jobs
+	// as there are threads to run them
+	const int numBatches = (count + pf.batchSize - 1) / pf.batchSize;
+	const int numJobs = MIN(numBatches, JobSystemGetConcurrency(js));
+	JobGroup g;
+	JobGroupInit(&g);
+	for (int i = 1; i < numJobs; i++)
+	{
+		JobSystemSubmit(js, &g, RunParallelFor, &pf);
+	}
+	JobContext *ctx = GetContext();
+	const size_t scratchUsed = ctx->scratchUsed;
+	RunParallelFor(ctx, &pf);
+	ctx->scratchUsed = scratchUsed;
+	JobSystemWait(js, &g);
+}
+
+void *JobScratchAlloc(JobContext *ctx, const size_t size)
+{
+	if (ctx->scratch == NULL)
+	{
+		CMALLOC(ctx->scratch, JOB_SCRATCH_SIZE);
+	}
+	const size_t start = (ctx->scratchUsed + JOB_SCRATCH_ALIGN - 1) &
+						 ~(size_t)(JOB_SCRATCH_ALIGN - 1);
+	if (start + size > JOB_SCRATCH_SIZE)
+	{
+		return NULL;
+	}
+	ctx->scratchUsed = start + size;
+	return ctx->scratch + start;
+}
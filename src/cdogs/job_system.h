@@ -0,0 +1,133 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <SDL.h>
+
+#include "c_array.h"
+
+#define JOB_SYSTEM_MAX_WORKERS 15
+// Scratch memory per thread, for allocations that only live as long as a job
+#define JOB_SCRATCH_SIZE (256 * 1024)
+
+struct JobSystem;
+typedef struct
+{
+	const struct JobSystem *js;
+	// 0 for threads outside the job system, such as the main thread,
+	// otherwise 1 + the worker index
+	int ThreadIndex;
+	char *scratch;
+	size_t scratchUsed;
+} JobContext;
+
+typedef void (*JobFunc)(JobContext *ctx, void *data);
+// Process items [start, end)
+typedef void (*ParallelForFunc)(
+	JobContext *ctx, void *data, const int start, const int end);
+
+// Jobs submitted with a group can be waited on together
+typedef struct
+{
+	SDL_atomic_t pending;
+} JobGroup;
+
+typedef struct
+{
+	JobFunc func;
+	void *data;
+	JobGroup *group;
+} Job;
+
+typedef struct
+{
+	SDL_mutex *lock;
+	// of Job; the owner takes from the back and thieves from the front
+	CArray jobs;
+	int head;
+} JobQueue;
+
+typedef struct
+{
+	struct JobSystem *js;
+	SDL_Thread *thread;
+	JobQueue queue;
+	JobContext ctx;
+} JobWorker;
+
+// Small work-stealing job system
+// Each worker thread has its own queue of jobs; jobs submitted from a worker
+// (e.g. by another job) go to its queue, and jobs submitted from other
+// threads go to a shared queue. Idle workers steal from the shared queue and
+// then from each other. Threads waiting on a group run queued jobs until the
+// group is done, so waiting from inside a job does not deadlock.
+typedef struct JobSystem
+{
+	// Number of worker threads; < 0 for one per extra CPU core, 0 to run
+	// jobs on the threads that wait on them
+	// Set before JobSystemStart
+	int NumWorkers;
+	int numThreads;
+	JobWorker workers[JOB_SYSTEM_MAX_WORKERS];
+	JobQueue shared;
+	SDL_atomic_t numQueued;
+	SDL_atomic_t quit;
+	SDL_mutex *lock;
+	SDL_cond *wake;
+	SDL_cond *done;
+	bool isStarted;
+} JobSystem;
+
+extern JobSystem gJobSystem;
+
+void JobSystemInit(JobSystem *js);
+void JobSystemStart(JobSystem *js);
+void JobSystemTerminate(JobSystem *js);
+// Number of threads that can run jobs, including the caller
+int JobSystemGetConcurrency(const JobSystem *js);
+
+void JobGroupInit(JobGroup *g);
+void JobSystemSubmit(
+	JobSystem *js, JobGroup *g, const JobFunc func, void *data);
+void JobSystemWait(JobSystem *js, JobGroup *g);
+
+// Call func over [0, count) in batches of batchSize items, and wait for all
+// of them; the calling thread takes part
+// Batches may run in any order, so func should only write to its own items
+// If the job system has not been started, all batches run on the caller
+void JobSystemParallelFor(
+	JobSystem *js, const int count, const int batchSize,
+	const ParallelForFunc func, void *data);
+
+// Allocate from the current thread's scratch memory, which is released when
+// the job that allocated it returns
+// Returns NULL if the scratch memory is exhausted
+void *JobScratchAlloc(JobContext *ctx, const size_t size);
@@ -0,0 +1,593 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "json_stream.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "c_array.h"
+#include "color.h"
+#include "log.h"
+#include "utils.h"
+#include "yajl/api/yajl_parse.h"
+
+// Max nesting of JSON_FIELD_OBJECTs within a class
+#define MAX_OBJECT_DEPTH 8
+#define READ_BUF_SIZE 4096
+#define NUMBER_BUF_SIZE 64
+
+typedef enum
+{
+	ROOT_KEY_NONE,
+	ROOT_KEY_VERSION,
+	ROOT_KEY_ARRAY,
+	ROOT_KEY_DEFAULT
+} RootKey;
+
+// Nesting levels of the document that we track
+// Deeper levels are nested objects within the class
+typedef enum
+{
+	LEVEL_START,
+	LEVEL_ROOT,
+	LEVEL_ARRAY,
+	LEVEL_CLASS
+} Level;
+
+typedef struct
+{
+	const JSONClassSchema *schema;
+	int version;
+	CArray classes; // of schema->ClassSize
+	int level;
+	RootKey rootKey;
+	// Field tables for the class and any nested objects
+	const JSONField *fields[MAX_OBJECT_DEPTH];
+	// The field that the next value belongs to, if any
+	const JSONField *pending;
+	// Nesting depth of the value being skipped
+	int skip;
+	// Open objects and arrays of the JSON_FIELD_NODE value being captured
+	CArray capture; // of json_t *
+	// Label within the innermost captured object awaiting its value
+	json_t *captureLabel;
+	// The schema's default class, while it is being loaded
+	void *defaultClass;
+	bool inDefault;
+	// Defaults loaded before "Version", waiting for it
+	bool defaultPending;
+} StreamState;
+
+static void *CurrentClass(StreamState *s)
+{
+	if (s->inDefault)
+	{
+		return s->defaultClass;
+	}
+	return CArrayGet(&s->classes, s->classes.size - 1);
+}
+static const JSONField *FindField(
+	const JSONField *fields, const unsigned char *key, const size_t len)
+{
+	for (const JSONField *f = fields; f->Name != NULL; f++)
+	{
+		if (strncmp(f->Name, (const char *)key, len) == 0 &&
+			f->Name[len] == '\0')
+		{
+			return f;
+		}
+	}
+	return NULL;
+}
+// Take the pending field if the current value should be loaded into it
+static const JSONField *TakePending(StreamState *s)
+{
+	const JSONField *f = s->pending;
+	s->pending = NULL;
+	if (s->skip > 0 || s->level < LEVEL_CLASS)
+	{
+		return NULL;
+	}
+	return f;
+}
+static void *FieldPtr(StreamState *s, const JSONField *f)
+{
+	return (char *)CurrentClass(s) + f->Offset;
+}
+
+// Hand the loaded defaults to the schema, once the version is known
+static bool SetDefault(StreamState *s)
+{
+	if (s->version <= 0 || s->version > s->schema->MaxVersion)
+	{
+		LOG(LM_MAIN, LL_ERROR, "cannot read %s defaults for version: %d",
+			s->schema->ArrayName, s->version);
+		return false;
+	}
+	s->schema->SetDefault(s->defaultClass, s->version, s->schema->Data);
+	s->defaultPending = false;
+	return true;
+}
+
+// Whether the current value belongs to a JSON_FIELD_NODE
+static bool IsCapturing(const StreamState *s)
+{
+	return s->capture.size > 0 ||
+		   (s->pending != NULL && s->pending->Type == JSON_FIELD_NODE &&
+			s->skip == 0 && s->level >= LEVEL_CLASS);
+}
+// Add a value to the node being captured; objects and arrays stay open
+// until their end event
+static void CaptureValue(StreamState *s, json_t *value)
+{
+	json_t *parent;
+	if (s->capture.size == 0)
+	{
+		// Start of a node field; add it to the class's node object
+		const JSONField *f = TakePending(s);
+		json_t **node = FieldPtr(s, f);
+		if (*node == NULL)
+		{
+			*node = json_new_object();
+		}
+		parent = json_new_string(f->Name);
+		json_insert_child(*node, parent);
+	}
+	else
+	{
+		parent = *(json_t **)CArrayGet(&s->capture, s->capture.size - 1);
+		if (parent->type == JSON_OBJECT)
+		{
+			parent = s->captureLabel;
+		}
+	}
+	json_insert_child(parent, value);
+	if (value->type == JSON_OBJECT || value->type == JSON_ARRAY)
+	{
+		CArrayPushBack(&s->capture, &value);
+	}
+}
+// Strings are stored escaped in the json DOM
+static json_t *NewCapturedString(const unsigned char *value, const size_t len)
+{
+	char *str;
+	CMALLOC(str, len + 1);
+	memcpy(str, value, len);
+	str[len] = '\0';
+	char *escaped = json_escape(str);
+	json_t *node = json_new_string(escaped);
+	CFREE(str);
+	free(escaped);
+	return node;
+}
+
+static void SetNumber(
+	StreamState *s, const JSONField *f, const long long i, const double d)
+{
+	switch (f->Type)
+	{
+	case JSON_FIELD_INT:
+		*(int *)FieldPtr(s, f) = (int)i;
+		break;
+	case JSON_FIELD_FLOAT:
+		*(float *)FieldPtr(s, f) = (float)d;
+		break;
+	default:
+		LOG(LM_MAIN, LL_WARN, "unexpected number for field %s", f->Name);
+		break;
+	}
+}
+static int OnNull(void *ctx)
+{
+	StreamState *s = ctx;
+	if (IsCapturing(s))
+	{
+		CaptureValue(s, json_new_null());
+		return 1;
+	}
+	TakePending(s);
+	return 1;
+}
+static int OnBool(void *ctx, int value)
+{
+	StreamState *s = ctx;
+	if (IsCapturing(s))
+	{
+		CaptureValue(s, json_new_bool(value));
+		return 1;
+	}
+	const JSONField *f = TakePending(s);
+	if (f == NULL)
+	{
+		return 1;
+	}
+	if (f->Type == JSON_FIELD_BOOL)
+	{
+		*(bool *)FieldPtr(s, f) = value != 0;
+	}
+	else
+	{
+		LOG(LM_MAIN, LL_WARN, "unexpected bool for field %s", f->Name);
+	}
+	return 1;
+}
+// Numbers arrive as text, so that captured nodes keep them verbatim
+static int OnNumber(void *ctx, const char *value, size_t len)
+{
+	StreamState *s = ctx;
+	char buf[NUMBER_BUF_SIZE];
+	len = MIN(len, sizeof buf - 1);
+	memcpy(buf, value, len);
+	buf[len] = '\0';
+	if (IsCapturing(s))
+	{
+		CaptureValue(s, json_new_number(buf));
+		return 1;
+	}
+	if (s->level == LEVEL_ROOT && s->skip == 0 &&
+		s->rootKey == ROOT_KEY_VERSION)
+	{
+		s->version = atoi(buf);
+		s->rootKey = ROOT_KEY_NONE;
+		return !s->defaultPending || SetDefault(s);
+	}
+	const JSONField *f = TakePending(s);
+	if (f != NULL)
+	{
+		const double d = strtod(buf, NULL);
+		SetNumber(s, f, (long long)d, d);
+	}
+	return 1;
+}
+static int OnString(void *ctx, const unsigned char *value, size_t len)
+{
+	StreamState *s = ctx;
+	if (IsCapturing(s))
+	{
+		CaptureValue(s, NewCapturedString(value, len));
+		return 1;
+	}
+	const JSONField *f = TakePending(s);
+	if (f == NULL)
+	{
+		return 1;
+	}
+	char *str;
+	CMALLOC(str, len + 1);
+	memcpy(str, value, len);
+	str[len] = '\0';
+	switch (f->Type)
+	{
+	case JSON_FIELD_STRING: {
+		char **p = FieldPtr(s, f);
+		CFREE(*p);
+		*p = str;
+		str = NULL;
+	}
+	break;
+	case JSON_FIELD_COLOR:
+		*(color_t *)FieldPtr(s, f) = StrColor(str);
+		break;
+	// Numbers as strings, which the DOM loader also accepts
+	case JSON_FIELD_INT:
+		*(int *)FieldPtr(s, f) = atoi(str);
+		break;
+	case JSON_FIELD_FLOAT:
+		*(float *)FieldPtr(s, f) = strtof(str, NULL);
+		break;
+	default:
+		LOG(LM_MAIN, LL_WARN, "unexpected string for field %s", f->Name);
+		break;
+	}
+	CFREE(str);
+	return 1;
+}
+static int OnStartMap(void *ctx)
+{
+	StreamState *s = ctx;
+	if (IsCapturing(s))
+	{
+		CaptureValue(s, json_new_object());
+		s->captureLabel = NULL;
+		return 1;
+	}
+	const JSONField *f = TakePending(s);
+	if (s->skip > 0)
+	{
+		s->skip++;
+		return 1;
+	}
+	switch (s->level)
+	{
+	case LEVEL_START:
+		s->level = LEVEL_ROOT;
+		break;
+	case LEVEL_ROOT:
+		if (s->rootKey == ROOT_KEY_DEFAULT)
+		{
+			// Classes copy the defaults in their Init
+			if (s->classes.size > 0 || s->defaultPending)
+			{
+				LOG(LM_MAIN, LL_ERROR, "%s must come before %s",
+					s->schema->DefaultName, s->schema->ArrayName);
+				return 0;
+			}
+			// Defaults are loaded like a class, minus the Init
+			if (s->defaultClass == NULL)
+			{
+				CMALLOC(s->defaultClass, s->schema->ClassSize);
+			}
+			memset(s->defaultClass, 0, s->schema->ClassSize);
+			s->inDefault = true;
+			s->fields[0] = s->schema->Fields;
+			s->level = LEVEL_CLASS;
+		}
+		else
+		{
+			s->skip = 1;
+		}
+		s->rootKey = ROOT_KEY_NONE;
+		break;
+	case LEVEL_ARRAY:
+		// Start of a class
+		CArrayResize(&s->classes, s->classes.size + 1, NULL);
+		memset(CurrentClass(s), 0, s->schema->ClassSize);
+		if (s->schema->Init)
+		{
+			s->schema->Init(CurrentClass(s), s->schema->Data);
+		}
+		s->fields[0] = s->schema->Fields;
+		s->level = LEVEL_CLASS;
+		break;
+	default:
+		if (f != NULL && f->Type == JSON_FIELD_OBJECT &&
+			s->level - LEVEL_CLASS + 1 < MAX_OBJECT_DEPTH)
+		{
+			s->level++;
+			s->fields[s->level - LEVEL_CLASS] = f->Fields;
+		}
+		else
+		{
+			s->skip = 1;
+		}
+		break;
+	}
+	return 1;
+}
+static int OnMapKey(void *ctx, const unsigned char *key, size_t len)
+{
+	StreamState *s = ctx;
+	if (s->capture.size > 0)
+	{
+		json_t *parent =
+			*(json_t **)CArrayGet(&s->capture, s->capture.size - 1);
+		s->captureLabel = NewCapturedString(key, len);
+		json_insert_child(parent, s->captureLabel);
+		return 1;
+	}
+	s->pending = NULL;
+	if (s->skip > 0)
+	{
+		return 1;
+	}
+	if (s->level == LEVEL_ROOT)
+	{
+		s->rootKey = ROOT_KEY_NONE;
+		if (len == strlen("Version") && memcmp(key, "Version", len) == 0)
+		{
+			s->rootKey = ROOT_KEY_VERSION;
+		}
+		else if (
+			len == strlen(s->schema->ArrayName) &&
+			memcmp(key, s->schema->ArrayName, len) == 0)
+		{
+			s->rootKey = ROOT_KEY_ARRAY;
+		}
+		else if (
+			s->schema->DefaultName != NULL &&
+			len == strlen(s->schema->DefaultName) &&
+			memcmp(key, s->schema->DefaultName, len) == 0)
+		{
+			s->rootKey = ROOT_KEY_DEFAULT;
+		}
+	}
+	else if (s->level >= LEVEL_CLASS)
+	{
+		s->pending = FindField(s->fields[s->level - LEVEL_CLASS], key, len);
+	}
+	return 1;
+}
+static int OnEndMap(void *ctx)
+{
+	StreamState *s = ctx;
+	if (s->capture.size > 0)
+	{
+		CArrayDelete(&s->capture, s->capture.size - 1);
+	}
+	else if (s->skip > 0)
+	{
+		s->skip--;
+	}
+	else if (s->level == LEVEL_CLASS && s->inDefault)
+	{
+		s->inDefault = false;
+		s->level = LEVEL_ROOT;
+		// The version may not have been read yet; hold on to the defaults
+		s->defaultPending = true;
+		if (s->version != -1)
+		{
+			return SetDefault(s);
+		}
+	}
+	else if (s->level == LEVEL_CLASS)
+	{
+		s->level = LEVEL_ARRAY;
+	}
+	else if (s->level > LEVEL_CLASS || s->level == LEVEL_ROOT)
+	{
+		s->level--;
+	}
+	return 1;
+}
+static int OnStartArray(void *ctx)
+{
+	StreamState *s = ctx;
+	if (IsCapturing(s))
+	{
+		CaptureValue(s, json_new_array());
+		return 1;
+	}
+	TakePending(s);
+	if (s->skip > 0)
+	{
+		s->skip++;
+	}
+	else if (s->level == LEVEL_ROOT && s->rootKey == ROOT_KEY_ARRAY)
+	{
+		if (s->defaultPending)
+		{
+			LOG(LM_MAIN, LL_ERROR, "%s must come after \"Version\"",
+				s->schema->ArrayName);
+			return 0;
+		}
+		s->level = LEVEL_ARRAY;
+	}
+	else
+	{
+		s->skip = 1;
+	}
+	s->rootKey = ROOT_KEY_NONE;
+	return 1;
+}
+static int OnEndArray(void *ctx)
+{
+	StreamState *s = ctx;
+	if (s->capture.size > 0)
+	{
+		CArrayDelete(&s->capture, s->capture.size - 1);
+	}
+	else if (s->skip > 0)
+	{
+		s->skip--;
+	}
+	else if (s->level == LEVEL_ARRAY)
+	{
+		s->level = LEVEL_ROOT;
+	}
+	return 1;
+}
+static const yajl_callbacks callbacks = {
+	OnNull,	   OnBool,	 NULL,	   NULL,		 OnNumber,	OnString,
+	OnStartMap, OnMapKey, OnEndMap, OnStartArray, OnEndArray};
+
+typedef struct
+{
+	FILE *f;
+	const char *text;
+	size_t len;
+} StreamSource;
+static int LoadClasses(const JSONClassSchema *schema, const StreamSource *src)
+{
+	StreamState s;
+	memset(&s, 0, sizeof s);
+	s.schema = schema;
+	s.version = -1;
+	CArrayInit(&s.classes, schema->ClassSize);
+	CArrayInit(&s.capture, sizeof(json_t *));
+	bool ok = false;
+	yajl_handle h = yajl_alloc(&callbacks, NULL, &s);
+	yajl_status status = yajl_status_ok;
+	if (src->f != NULL)
+	{
+		unsigned char buf[READ_BUF_SIZE];
+		size_t n;
+		while (status == yajl_status_ok &&
+			   (n = fread(buf, 1, sizeof buf, src->f)) > 0)
+		{
+			status = yajl_parse(h, buf, n);
+		}
+	}
+	else
+	{
+		status = yajl_parse(h, (const unsigned char *)src->text, src->len);
+	}
+	if (status == yajl_status_ok)
+	{
+		status = yajl_complete_parse(h);
+	}
+	if (status != yajl_status_ok)
+	{
+		unsigned char *err = yajl_get_error(h, 0, NULL, 0);
+		LOG(LM_MAIN, LL_ERROR, "cannot parse %s file: %s", schema->ArrayName,
+			(const char *)err);
+		yajl_free_error(h, err);
+		goto bail;
+	}
+	if (s.version <= 0 || s.version > schema->MaxVersion)
+	{
+		LOG(LM_MAIN, LL_ERROR, "cannot read %s file version: %d",
+			schema->ArrayName, s.version);
+		goto bail;
+	}
+	ok = true;
+
+bail:
+	yajl_free(h);
+	for (size_t i = 0; i < s.classes.size; i++)
+	{
+		void *c = CArrayGet(&s.classes, i);
+		if (ok)
+		{
+			schema->Add(c, s.version, schema->Data);
+		}
+		else if (schema->Terminate)
+		{
+			schema->Terminate(c);
+		}
+	}
+	CArrayTerminate(&s.classes);
+	// Captured nodes are owned by their classes
+	CArrayTerminate(&s.capture);
+	if ((s.inDefault || s.defaultPending) && schema->Terminate)
+	{
+		schema->Terminate(s.defaultClass);
+	}
+	CFREE(s.defaultClass);
+	return ok ? s.version : -1;
+}
+int JSONStreamLoadClasses(const JSONClassSchema *s, FILE *f)
+{
+	const StreamSource src = {f, NULL, 0};
+	return LoadClasses(s, &src);
+}
+int JSONStreamLoadClassesString(
+	const JSONClassSchema *s, const char *text, const size_t len)
+{
+	const StreamSource src = {NULL, text, len};
+	return LoadClasses(s, &src);
+}
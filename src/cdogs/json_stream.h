@@ -0,0 +1,100 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include <json/json.h>
+
+// Streaming, schema-driven loader for class definition files, i.e. files of
+// the form {"Version": n, "<Classes>": [{...}, {...}, ...]}
+// Uses yajl's event parser, so no DOM is built; each key is looked up in the
+// schema's field table and the value written straight into the class struct.
+// Fields not in the schema, including nested objects and arrays, are skipped.
+// Fields whose schema is too irregular for a field table (version-dependent
+// or deeply nested) can be captured as JSON_FIELD_NODEs and handed to the
+// class's Add callback to be loaded with the usual json_utils functions.
+
+typedef enum
+{
+	JSON_FIELD_INT,	   // int
+	JSON_FIELD_FLOAT,  // float
+	JSON_FIELD_BOOL,   // bool
+	JSON_FIELD_STRING, // char *, allocated
+	JSON_FIELD_COLOR,  // color_t, from a hex string
+	// Nested object, whose fields are members of the same class struct
+	JSON_FIELD_OBJECT,
+	// json_t *; the value is captured as a labelled pair into this object,
+	// which is shared by all the node fields with the same offset
+	JSON_FIELD_NODE
+} JSONFieldType;
+
+typedef struct JSONField
+{
+	const char *Name;
+	JSONFieldType Type;
+	size_t Offset;
+	// For JSON_FIELD_OBJECT
+	const struct JSONField *Fields;
+} JSONField;
+#define JSON_FIELD(_name, _type, _struct, _member)                            \
+	{_name, _type, offsetof(_struct, _member), NULL}
+#define JSON_FIELD_OBJ(_name, _fields) {_name, JSON_FIELD_OBJECT, 0, _fields}
+#define JSON_FIELDS_END {NULL, JSON_FIELD_INT, 0, NULL}
+
+typedef struct
+{
+	// Name of the root array of classes
+	const char *ArrayName;
+	// Terminated by JSON_FIELDS_END
+	const JSONField *Fields;
+	size_t ClassSize;
+	int MaxVersion;
+	// Set defaults before the fields are loaded; may be NULL
+	void (*Init)(void *c, void *data);
+	// Post-process each loaded class and take ownership of it (e.g. push it
+	// into an array), including any captured JSON_FIELD_NODE objects;
+	// only called if the whole file loaded successfully
+	void (*Add)(void *c, const int version, void *data);
+	// Free a class if the file failed to load
+	void (*Terminate)(void *c);
+	void *Data;
+	// Optional root object holding the defaults for the classes, loaded
+	// like a class without Init; it must come before the classes, and is
+	// held until "Version" is read if it comes first.
+	// SetDefault takes ownership of it.
+	const char *DefaultName;
+	void (*SetDefault)(void *c, const int version, void *data);
+} JSONClassSchema;
+
+// Returns the file version, or -1 on error
+int JSONStreamLoadClasses(const JSONClassSchema *s, FILE *f);
+int JSONStreamLoadClassesString(
+	const JSONClassSchema *s, const char *text, const size_t len);
@@ -29,6 +29,7 @@
 
 #include "actors.h"
 #include "algorithms.h"
+#include "alloc.h"
 #include "game_events.h"
 #include "net_util.h"
 
@@ -47,11 +48,13 @@ void LOSInit(Map *map)
 			CArrayPushBack(&map->LOS.Explored, &f);
 		}
 	}
+	BitGridInit(&map->LOS.rayVisited, map->Size);
 }
 void LOSTerminate(LineOfSight *los)
 {
 	CArrayTerminate(&los->LOS);
 	CArrayTerminate(&los->Explored);
+	BitGridTerminate(&los->rayVisited);
 }
 
 // Reset lines of sight by setting all cells to unseen
@@ -61,17 +64,9 @@ void LOSReset(LineOfSight *los)
 	CArrayFillZero(&los->Explored);
 }
 
-typedef struct
-{
-	Map *Map;
-	struct vec2i Center;
-	int SightRange2;
-	bool Explore;
-} LOSData;
 // Calculate LOS cells from a certain start position
 // Sight range based on config
 static void SetLOSVisible(Map *map, const struct vec2i pos, const bool explore);
-static bool IsNextTileBlockedAndSetVisibility(void *data, struct vec2i pos);
 static void SetObstructionVisible(
 	Map *map, const struct vec2i pos, const bool explore);
 
@@ -116,37 +111,51 @@ void LOSCalcFrom(Map *map, const struct vec2i pos, const bool explore)
 	const struct vec2i origin = svec2i(pos.x - sightRange, pos.y - sightRange);
 	const struct vec2i perimSize = svec2i_scale(svec2i_subtract(pos, origin), 2);
 
-	LOSData data;
-	data.Map = map;
-	data.Center = pos;
-	data.SightRange2 = sightRange * sightRange;
-	data.Explore = explore;
+	const int sightRange2 = sightRange * sightRange;
 
 	// Start from the top-left cell, and proceed clockwise around
+	const int numEnds = 2 * (perimSize.x + perimSize.y);
+	struct vec2i *ends = FrameAlloc(&gFrameAlloc, numEnds * sizeof *ends);
+	int n = 0;
 	end = origin;
-	HasClearLineData lineData;
-	lineData.IsBlocked = IsNextTileBlockedAndSetVisibility;
-	lineData.data = &data;
 	// Top edge
 	for (; end.x < origin.x + perimSize.x; end.x++)
 	{
-		HasClearLineJMRaytrace(pos, end, &lineData);
+		ends[n++] = end;
 	}
 	// right edge
 	for (; end.y < origin.y + perimSize.y; end.y++)
 	{
-		HasClearLineJMRaytrace(pos, end, &lineData);
+		ends[n++] = end;
 	}
 	// bottom edge
 	for (; end.x > origin.x; end.x--)
 	{
-		HasClearLineJMRaytrace(pos, end, &lineData);
+		ends[n++] = end;
 	}
 	// left edge
 	for (; end.y > origin.y; end.y--)
 	{
-		HasClearLineJMRaytrace(pos, end, &lineData);
+		ends[n++] = end;
+	}
+	// Rays stop at the first opaque tile, which is visible too
+	// Distance along a ray only increases, so the tiles a ray passes through
+	// beyond the sight range can simply be ignored
+	BitGrid *visited = &map->LOS.rayVisited;
+	JMRaytraceGridBatch(
+		&map->opaque, svec2i(1, 1), pos, ends, n, NULL, visited);
+	for (end.y = origin.y; end.y <= origin.y + perimSize.y; end.y++)
+	{
+		for (end.x = origin.x; end.x <= origin.x + perimSize.x; end.x++)
+		{
+			if (BitGridGet(visited, end) &&
+				svec2i_distance_squared(pos, end) < sightRange2)
+			{
+				SetLOSVisible(map, end, explore);
+			}
+		}
 	}
+	BitGridClear(visited);
 
 	// Second pass: make any non-visible obstructions that are adjacent to
 	// visible non-obstructions visible too
@@ -155,13 +164,12 @@ void LOSCalcFrom(Map *map, const struct vec2i pos, const bool explore)
 	{
 		for (end.x = origin.x; end.x < origin.x + perimSize.x; end.x++)
 		{
-			const Tile *tile = MapGetTile(map, end);
-			if (!tile || !TileIsOpaque(tile))
+			if (!MapTileIsOpaque(map, end))
 			{
 				continue;
 			}
 			// Check sight range
-			if (svec2i_distance_squared(pos, end) >= data.SightRange2)
+			if (svec2i_distance_squared(pos, end) >= sightRange2)
 			{
 				continue;
 			}
@@ -216,18 +224,6 @@ static void SetLOSVisible(Map *map, const struct vec2i pos, const bool explore)
 		}
 	CA_FOREACH_END()
 }
-static bool IsNextTileBlockedAndSetVisibility(void *data, struct vec2i pos)
-{
-	LOSData *lData = data;
-	// Check sight range
-	if (svec2i_distance_squared(lData->Center, pos) >= lData->SightRange2) return true;
-	// Check map range
-	const Tile *t = MapGetTile(lData->Map, pos);
-	if (t == NULL) return true;
-	SetLOSVisible(lData->Map, pos, lData->Explore);
-	// Check if this tile is an obstruction
-	return TileIsOpaque(t);
-}
 static bool IsTileVisibleNonObstruction(Map *map, const struct vec2i pos);
 static void SetObstructionVisible(
 	Map *map, const struct vec2i pos, const bool explore)
@@ -247,9 +243,8 @@ static void SetObstructionVisible(
 }
 static bool IsTileVisibleNonObstruction(Map *map, const struct vec2i pos)
 {
-	const Tile *t = MapGetTile(map, pos);
-	if (t == NULL) return false;
-	return !TileIsOpaque(t) && LOSTileIsVisible(map, pos);
+	return MapIsTileIn(map, pos) && !MapTileIsOpaque(map, pos) &&
+		   LOSTileIsVisible(map, pos);
 }
 
 bool LOSAddRun(
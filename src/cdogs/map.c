@@ -52,6 +52,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "actor_grid.h"
 #include "actors.h"
 #include "algorithms.h"
 #include "ammo.h"
@@ -124,6 +125,26 @@ bool MapIsTileIn(const Map *map, const struct vec2i pos)
 	// Check that the tile pos is within the interior of the map
 	return Rect2iIsInside(Rect2iNew(svec2i_zero(), map->Size), pos);
 }
+
+void MapUpdateTileFlags(Map *map, const struct vec2i pos)
+{
+	const Tile *t = MapGetTile(map, pos);
+	if (t == NULL)
+	{
+		return;
+	}
+	BitGridSet(&map->walkable, pos, TileCanWalk(t));
+	BitGridSet(&map->opaque, pos, TileIsOpaque(t));
+	BitGridSet(&map->shootable, pos, TileIsShootable(t));
+	BitGridSet(&map->door, pos, t->Class->Type == TILE_CLASS_DOOR);
+	BitGridSet(&map->triggerTiles, pos, t->triggers.size > 0);
+}
+void MapUpdateAllTileFlags(Map *map)
+{
+	RECT_FOREACH(Rect2iNew(svec2i_zero(), map->Size))
+	MapUpdateTileFlags(map, _v);
+	RECT_FOREACH_END()
+}
 static bool MapIsPosIn(const Map *map, const struct vec2 pos)
 {
 	// Check that the pos is within the interior of the map
@@ -159,7 +180,7 @@ static Tile *MapGetTileOfItem(Map *map, Thing *t)
 	return MapGetTile(map, pos);
 }
 
-static void AddItemToTile(Thing *t, Tile *tile);
+static void AddItemToTile(Map *map, Thing *t, const struct vec2i pos);
 bool MapTryMoveThing(Map *map, Thing *t, const struct vec2 pos)
 {
 	// Check if we can move to new position
@@ -185,17 +206,29 @@ bool MapTryMoveThing(Map *map, Thing *t, const struct vec2 pos)
 	}
 	// ...move and add to new tile
 	t->Pos = pos;
-	AddItemToTile(t, MapGetTile(map, t2));
+	AddItemToTile(map, t, t2);
 	return true;
 }
-static void AddItemToTile(Thing *t, Tile *tile)
+static void AddItemToTile(Map *map, Thing *t, const struct vec2i pos)
 {
+	Tile *tile = MapGetTile(map, pos);
 	ThingId tid;
 	tid.Id = t->id;
 	tid.Kind = t->kind;
 	CASSERT(tid.Id >= 0, "invalid ThingId");
 	CASSERT(tid.Kind >= 0 && tid.Kind <= KIND_PICKUP, "unknown thing kind");
 	CArrayPushBack(&tile->things, &tid);
+	if (t->kind == KIND_CHARACTER)
+	{
+		if (map == &gMap)
+		{
+			ActorGridAdd(&gActorGrid, t->id, t->Pos);
+		}
+		if (BitGridGet(&map->watchTiles, pos))
+		{
+			WatchesOnTileChanged(tile, pos, true);
+		}
+	}
 }
 
 void MapRemoveThing(Map *map, Thing *t)
@@ -205,21 +238,25 @@ void MapRemoveThing(Map *map, Thing *t)
 		return;
 	}
 	Tile *tile = MapGetTileOfItem(map, t);
+	if (t->kind == KIND_CHARACTER && map == &gMap)
+	{
+		ActorGridRemove(&gActorGrid, t->id, t->Pos);
+	}
 	CA_FOREACH(ThingId, tid, tile->things)
 	if (tid->Id == t->id && tid->Kind == t->kind)
 	{
 		CArrayDelete(&tile->things, _ca_index);
+		const struct vec2i pos = Vec2ToTile(t->Pos);
+		if (t->kind == KIND_CHARACTER && BitGridGet(&map->watchTiles, pos))
+		{
+			WatchesOnTileChanged(tile, pos, TileHasCharacter(tile));
+		}
 		return;
 	}
 	CA_FOREACH_END()
 	CASSERT(false, "Did not find element to delete");
 }
 
-struct vec2i MapGetRandomTile(const Map *map)
-{
-	return svec2i(rand() % map->Size.x, rand() % map->Size.y);
-}
-
 struct vec2 MapGetRandomPos(const Map *map)
 {
 	for (;;)
@@ -255,6 +292,7 @@ static void MapChangeFloor(
 	{
 		t->Class = normal;
 	}
+	MapUpdateTileFlags(map, pos);
 }
 
 bool MapHasExits(const Map *m)
@@ -344,7 +382,7 @@ bool MapTryPlaceDestroyObject(
 {
 	const Objective *o = CArrayGet(&m->Objectives, objective);
 	// Pick a random map object out of the available ones
-	const int i = RAND_INT(0, (int)o->u.MapObjects.size - 1);
+	const int i = PRNGInt(&mb->rand, 0, (int)o->u.MapObjects.size - 1);
 	const MapObject *mo = *(const MapObject **)CArrayGet(&o->u.MapObjects, i);
 	return MapTryPlaceOneObject(mb, pos, mo, ObjectiveToThing(objective), strict);
 }
@@ -360,11 +398,11 @@ void MapPlacePickup(
 }
 
 void MapPlaceCollectible(
-	const Mission *m, const int objective, const struct vec2 pos)
+	MapBuilder *mb, const int objective, const struct vec2 pos)
 {
-	const Objective *o = CArrayGet(&m->Objectives, objective);
+	const Objective *o = CArrayGet(&mb->mission->Objectives, objective);
 	// Pick a random pickup out of the available ones
-	const int i = RAND_INT(0, (int)o->u.Pickups.size - 1);
+	const int i = PRNGInt(&mb->rand, 0, (int)o->u.Pickups.size - 1);
 	const PickupClass *p = *(const PickupClass **)CArrayGet(&o->u.Pickups, i);
 	MapPlacePickup(p, pos, ObjectiveToThing(objective));
 }
@@ -413,7 +451,7 @@ bool MapPlaceRandomTile(
 		GetPlacementRetries(mb->Map, paFlags, &locked, &unlocked);
 	for (int i = 0; i < retries; i++)
 	{
-		const struct vec2i tilePos = MapGetRandomTile(mb->Map);
+		const struct vec2i tilePos = MapBuilderGetRandomTile(mb);
 		const bool isInLocked = MapTileIsInLockedRoom(mb->Map, tilePos);
 		if ((!locked || isInLocked) && (!unlocked || !isInLocked))
 		{
@@ -498,10 +536,21 @@ void MapTerminate(Map *map)
 		}
 	}
 	CArrayTerminate(&map->Tiles);
+	BitGridTerminate(&map->walkable);
+	BitGridTerminate(&map->opaque);
+	BitGridTerminate(&map->shootable);
+	BitGridTerminate(&map->door);
+	BitGridTerminate(&map->triggerTiles);
+	BitGridTerminate(&map->watchTiles);
 	TileClassesTerminate(map->TileClasses);
 	LOSTerminate(&map->LOS);
 	CArrayTerminate(&map->access);
 	PathCacheTerminate(&gPathCache);
+	// The actor grid indexes the game map only
+	if (map == &gMap)
+	{
+		ActorGridTerminate(&gActorGrid);
+	}
 }
 
 void MapInit(Map *map, const struct vec2i size)
@@ -513,11 +562,21 @@ void MapInit(Map *map, const struct vec2i size)
 	map->TileClasses = TileClassesNew();
 	CArrayInit(&map->Tiles, sizeof(Tile));
 	map->Size = size;
+	BitGridInit(&map->walkable, size);
+	BitGridInit(&map->opaque, size);
+	BitGridInit(&map->shootable, size);
+	BitGridInit(&map->door, size);
+	BitGridInit(&map->triggerTiles, size);
+	BitGridInit(&map->watchTiles, size);
 	LOSInit(map);
 	CArrayInitFillZero(&map->access, sizeof(uint16_t), size.x * size.y);
 	CArrayInit(&map->triggers, sizeof(Trigger *));
 	CArrayInit(&map->exits, sizeof(Exit));
 	PathCacheInit(&gPathCache, map);
+	if (map == &gMap)
+	{
+		ActorGridInit(&gActorGrid, size);
+	}
 
 	struct vec2i v;
 	for (v.y = 0; v.y < map->Size.y; v.y++)
@@ -50,6 +50,7 @@
 
 #include <stdbool.h>
 
+#include "bit_grid.h"
 #include "map_object.h"
 #include "pic.h"
 #include "thing.h"
@@ -86,6 +87,9 @@ typedef struct
 	// Array of bools for tracking new tiles in line of sight, for delayed
 	// messaging
 	CArray Explored; // of bool
+
+	// Scratch grid of the tiles that sight rays pass through
+	BitGrid rayVisited;
 } LineOfSight;
 
 typedef struct
@@ -101,6 +105,19 @@ typedef struct
 	CArray Tiles; // of Tile
 	struct vec2i Size;
 
+	// Packed tile properties, so that hot queries like collision and line
+	// of sight don't need to go through each tile and its class
+	// Call MapUpdateTileFlags after changing a tile's class or door
+	BitGrid walkable;
+	BitGrid opaque;
+	BitGrid shootable;
+	BitGrid door;
+	// Tiles with triggers, so movement can skip empty tiles
+	BitGrid triggerTiles;
+	// Tiles that watch conditions depend on; changes in their occupants are
+	// passed to the watches (see WatchesOnTileChanged)
+	BitGrid watchTiles;
+
 	LineOfSight LOS;
 	CArray access; // of uint16_t
 
@@ -122,6 +139,33 @@ uint16_t GetAccessMask(const int k);
 
 Tile *MapGetTile(const Map *map, const struct vec2i pos);
 bool MapIsTileIn(const Map *map, const struct vec2i pos);
+
+// Update the packed tile properties from the tile at pos
+void MapUpdateTileFlags(Map *map, const struct vec2i pos);
+void MapUpdateAllTileFlags(Map *map);
+// Same as the Tile* functions, but using the packed tile properties
+// Out of bounds tiles are false
+static inline bool MapTileCanWalk(const Map *map, const struct vec2i pos)
+{
+	return BitGridGet(&map->walkable, pos);
+}
+static inline bool MapTileIsOpaque(const Map *map, const struct vec2i pos)
+{
+	return BitGridGet(&map->opaque, pos);
+}
+static inline bool MapTileIsShootable(const Map *map, const struct vec2i pos)
+{
+	return BitGridGet(&map->shootable, pos);
+}
+// Whether the tile is a door, open or not
+static inline bool MapTileIsDoor(const Map *map, const struct vec2i pos)
+{
+	return BitGridGet(&map->door, pos);
+}
+static inline bool MapTileHasTriggers(const Map *map, const struct vec2i pos)
+{
+	return BitGridGet(&map->triggerTiles, pos);
+}
 int MapIsTileInExit(const Map *map, const Thing *ti, const int exit);
 
 // TODO: remove this function
@@ -146,7 +190,6 @@ bool MapHasExits(const Map *m);
 void MapShowExitArea(Map *map, const int i);
 // Returns the center of the tile that's the middle of the exit area
 struct vec2 MapGetExitPos(const Map *m, const int i);
-struct vec2i MapGetRandomTile(const Map *map);
 struct vec2 MapGetRandomPos(const Map *map);
 bool MapPlaceRandomPos(
 	const Map *map, const PlacementAccessFlags paFlags,
@@ -34,6 +34,7 @@
 #include "files.h"
 #include "json_utils.h"
 #include "log.h"
+#include "map_compiled.h"
 #include "map_new.h"
 #include "pickup.h"
 #include "player_template.h"
@@ -42,7 +43,15 @@ static json_t *ReadArchiveJSON(const char *archive, const char *filename);
 int MapNewScanArchive(const char *filename, char **title, int *numMissions)
 {
 	int err = 0;
-	json_t *root = ReadArchiveJSON(filename, "campaign.json");
+	json_t *root = NULL;
+	MapCompiled mc;
+	if (MapCompiledOpen(&mc, filename))
+	{
+		err = MapCompiledScan(&mc, title, numMissions) ? 0 : -1;
+		MapCompiledClose(&mc);
+		goto bail;
+	}
+	root = ReadArchiveJSON(filename, "campaign.json");
 	if (root == NULL)
 	{
 		err = -1;
@@ -93,7 +102,17 @@ int MapNewLoadArchive(const char *filename, CampaignSetting *c)
 	int err = 0;
 	json_t *root = NULL;
 	int version = 0;
-	err = MapLoadCampaignJSON(filename, c, &version);
+	MapCompiled mc;
+	const bool isCompiled = MapCompiledOpen(&mc, filename);
+	if (isCompiled)
+	{
+		LOG(LM_MAP, LL_DEBUG, "Using compiled campaign");
+		err = MapCompiledLoadCampaign(&mc, c, &version) ? 0 : -1;
+	}
+	else
+	{
+		err = MapLoadCampaignJSON(filename, c, &version);
+	}
 	if (err != 0)
 	{
 		goto bail;
@@ -104,23 +123,15 @@ int MapNewLoadArchive(const char *filename, CampaignSetting *c)
 
 	LoadArchivePics(&gPicManager, gCharSpriteClasses.customClasses, filename);
 
-	root = ReadArchiveJSON(filename, "particles.json");
-	if (root != NULL)
-	{
-		ParticleClassesLoadJSON(&gParticleClasses.CustomClasses, root);
-	}
+	char path[CDOGS_PATH_MAX];
+	sprintf(path, "%s/particles.json", filename);
+	ParticleClassesLoadFile(&gParticleClasses.CustomClasses, path);
 
-	root = ReadArchiveJSON(filename, "character_classes.json");
-	if (root != NULL)
-	{
-		CharacterClassesLoadJSON(&gCharacterClasses.CustomClasses, root);
-	}
+	sprintf(path, "%s/character_classes.json", filename);
+	CharacterClassesLoadFile(&gCharacterClasses.CustomClasses, path);
 
-	root = ReadArchiveJSON(filename, "bullets.json");
-	if (root != NULL)
-	{
-		BulletLoadJSON(&gBulletClasses, &gBulletClasses.CustomClasses, root);
-	}
+	sprintf(path, "%s/bullets.json", filename);
+	BulletLoadFile(&gBulletClasses, &gBulletClasses.CustomClasses, path);
 
 	bool hasCustomAmmo = false;
 	root = ReadArchiveJSON(filename, "ammo.json");
@@ -131,23 +142,14 @@ int MapNewLoadArchive(const char *filename, CampaignSetting *c)
 		hasCustomAmmo = true;
 	}
 
-	bool hasCustomGuns = false;
-	root = ReadArchiveJSON(filename, "guns.json");
-	if (root != NULL)
-	{
-		WeaponClassesLoadJSON(
-			&gWeaponClasses, &gWeaponClasses.CustomGuns, root);
-		json_free_value(&root);
-		hasCustomGuns = true;
-	}
+	sprintf(path, "%s/guns.json", filename);
+	const bool hasCustomGuns = WeaponClassesLoadFile(
+		&gWeaponClasses, &gWeaponClasses.CustomGuns, path);
 
 	BulletLoadWeapons(&gBulletClasses);
 
-	root = ReadArchiveJSON(filename, "pickups.json");
-	if (root != NULL)
-	{
-		PickupClassesLoadJSON(&gPickupClasses.CustomClasses, root);
-	}
+	sprintf(path, "%s/pickups.json", filename);
+	PickupClassesLoadFile(&gPickupClasses.CustomClasses, path);
 	if (hasCustomAmmo)
 	{
 		PickupClassesLoadAmmo(
@@ -160,23 +162,32 @@ int MapNewLoadArchive(const char *filename, CampaignSetting *c)
 	}
 	PickupClassesLoadKeys(&gPickupClasses.KeyClasses);
 
-	root = ReadArchiveJSON(filename, "map_objects.json");
-	if (root != NULL)
-	{
-		MapObjectsLoadJSON(&gMapObjects.CustomClasses, root);
-	}
+	sprintf(path, "%s/map_objects.json", filename);
+	MapObjectsLoadFile(&gMapObjects.CustomClasses, path);
 	MapObjectsLoadAmmoAndGunSpawners(
 		&gMapObjects, &gAmmo, &gWeaponClasses, true);
 
-	root = ReadArchiveJSON(filename, "missions.json");
-	if (root == NULL)
+	if (isCompiled)
 	{
-		err = -1;
-		goto bail;
+		if (!MapCompiledLoadMissions(&mc, &c->Missions, version))
+		{
+			err = -1;
+			goto bail;
+		}
+	}
+	else
+	{
+		root = ReadArchiveJSON(filename, "missions.json");
+		if (root == NULL)
+		{
+			err = -1;
+			goto bail;
+		}
+		LoadMissions(
+			&c->Missions, json_find_first_label(root, "Missions")->child,
+			version);
+		json_free_value(&root);
 	}
-	LoadMissions(
-		&c->Missions, json_find_first_label(root, "Missions")->child, version);
-	json_free_value(&root);
 
 	// Note: some campaigns don't have characters (e.g. dogfights)
 	root = ReadArchiveJSON(filename, "characters.json");
@@ -187,6 +198,10 @@ int MapNewLoadArchive(const char *filename, CampaignSetting *c)
 	}
 
 bail:
+	if (isCompiled)
+	{
+		MapCompiledClose(&mc);
+	}
 	json_free_value(&root);
 	return err;
 }
@@ -231,7 +246,6 @@ static void LoadArchivePics(PicManager *pm, map_t cc, const char *archive)
 	CharSpriteClassesLoadDir(cc, archive);
 }
 
-static json_t *SaveMissions(CArray *a);
 int MapArchiveSave(const char *filename, CampaignSetting *c)
 {
 	int res = 1;
@@ -286,6 +300,10 @@ int MapArchiveSave(const char *filename, CampaignSetting *c)
 		res = 0;
 		goto bail;
 	}
+	// The compiled campaign is now out of date; remove it rather than rely on
+	// the file stats changing
+	sprintf(buf2, "%s/%s", buf, MAP_COMPILED_FILE);
+	remove(buf2);
 
 	if (!CharacterStoreSave(&c->characters, buf))
 	{
@@ -304,7 +322,7 @@ static json_t *SaveMissionTileClasses(const MissionTileClasses *mtc);
 static json_t *SaveRooms(const RoomParams r);
 static json_t *SaveDoors(const DoorParams d);
 static json_t *SavePillars(const PillarParams p);
-static json_t *SaveMissions(CArray *a)
+json_t *SaveMissions(CArray *a)
 {
 	json_t *missionsNode = json_new_array();
 	for (int i = 0; i < (int)a->size; i++)
@@ -27,6 +27,8 @@
 */
 #pragma once
 
+#include <json/json.h>
+
 #include "campaigns.h"
 
 #define MAP_VERSION 16
@@ -35,3 +37,5 @@ int MapNewScanArchive(const char *filename, char **title, int *numMissions);
 int MapLoadCampaignJSON(const char *filename, CampaignSetting *c, int *version);
 int MapNewLoadArchive(const char *filename, CampaignSetting *c);
 int MapArchiveSave(const char *filename, CampaignSetting *c);
+// Helper for saving missions as JSON; see LoadMissions
+json_t *SaveMissions(CArray *a);
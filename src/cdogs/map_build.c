@@ -67,86 +67,145 @@
 static void MapSetupTilesAndWalls(MapBuilder *mb);
 static void MapSetupDoors(MapBuilder *mb);
 static void MapAddDrains(MapBuilder *mb);
-static void MapGenerateRandomExitArea(Map *map, const int mission);
+static void MapGenerateRandomExitArea(MapBuilder *mb, const int mission);
 void MapBuild(
 	Map *m, const Mission *mission, const bool loadDynamic,
 	const int missionIndex, const GameMode mode,
 	const CharacterStore *characters)
 {
+	Map layout;
+	MapLayoutInit(&layout, mission->Size);
 	MapBuilder mb;
-	MapBuilderInit(&mb, m, mission, mode, characters);
-	MapInit(mb.Map, mb.mission->Size);
-
-	switch (mb.mission->Type)
+	MapBuilderInit(&mb, &layout, mission, mode, characters);
+	MapBuildLayout(&mb, missionIndex);
+	MapBuildCommit(&mb, m, loadDynamic, missionIndex);
+	MapBuilderTerminate(&mb);
+	MapLayoutTerminate(&layout);
+}
+void MapLayoutInit(Map *m, const struct vec2i size)
+{
+	memset(m, 0, sizeof *m);
+	m->Size = size;
+	CArrayInit(&m->exits, sizeof(Exit));
+}
+void MapLayoutTerminate(Map *m)
+{
+	CArrayTerminate(&m->exits);
+}
+void MapBuildLayout(MapBuilder *mb, const int missionIndex)
+{
+	switch (mb->mission->Type)
 	{
 	case MAPTYPE_CLASSIC:
-		MapClassicLoad(&mb);
+		MapClassicLoad(mb);
 		break;
 	case MAPTYPE_STATIC:
-		MapStaticLoad(&mb);
+		MapStaticLoad(mb);
 		break;
 	case MAPTYPE_CAVE:
-		MapCaveLoad(&mb);
+		MapCaveLoad(mb);
 		break;
 	case MAPTYPE_INTERIOR:
-		MapInteriorLoad(&mb, missionIndex);
+		MapInteriorLoad(mb, missionIndex);
 		break;
 	default:
 		CASSERT(false, "unknown map type");
 		break;
 	}
-	CArrayCopy(&mb.Map->access, &mb.access);
+}
+static void MapSetupTileClasses(MapBuilder *mb);
+void MapBuildCommit(
+	MapBuilder *mb, Map *m, const bool loadDynamic, const int missionIndex)
+{
+	const Map *layout = mb->Map;
+	MapInit(m, mb->mission->Size);
+	m->keyAccessCount = layout->keyAccessCount;
+	m->start = layout->start;
+	CArrayCopy(&m->exits, &layout->exits);
+	mb->Map = m;
+
+	// TODO: multiple tile types
+	MapSetupTileClasses(mb);
+	CA_FOREACH(const MapBuilderKey, k, mb->keys)
+	MapPlaceKey(mb, k->Pos, k->Index);
+	CA_FOREACH_END()
+	CArrayCopy(&mb->Map->access, &mb->access);
 
-	MapSetupTilesAndWalls(&mb);
-	MapSetupDoors(&mb);
-	MapPrintDebug(mb.Map);
+	MapSetupTilesAndWalls(mb);
+	MapSetupDoors(mb);
+	MapPrintDebug(mb->Map);
 
 	// Set exit now since we have set up all the tiles
-	switch (mb.mission->Type)
+	switch (mb->mission->Type)
 	{
 	case MAPTYPE_CLASSIC:
-		MapAddDrains(&mb);
-		if (HasExit(gCampaign.Entry.Mode) && mb.mission->u.Classic.ExitEnabled)
+		MapAddDrains(mb);
+		if (HasExit(gCampaign.Entry.Mode) && mb->mission->u.Classic.ExitEnabled)
 		{
-			MapGenerateRandomExitArea(mb.Map, missionIndex);
+			MapGenerateRandomExitArea(mb, missionIndex);
 		}
 		break;
 	case MAPTYPE_STATIC:
 		break;
 	case MAPTYPE_CAVE:
-		if (HasExit(gCampaign.Entry.Mode) && mb.mission->u.Cave.ExitEnabled)
+		if (HasExit(gCampaign.Entry.Mode) && mb->mission->u.Cave.ExitEnabled)
 		{
-			MapGenerateRandomExitArea(mb.Map, missionIndex);
+			MapGenerateRandomExitArea(mb, missionIndex);
 		}
 		break;
 	case MAPTYPE_INTERIOR:
-		MapAddDrains(&mb);
+		MapAddDrains(mb);
 		break;
 	default:
 		CASSERT(false, "unknown map type");
 		break;
 	}
+	MapUpdateAllTileFlags(mb->Map);
 
 	// Count total number of reachable tiles, for explored %
-	mb.Map->NumExplorableTiles = 0;
+	mb->Map->NumExplorableTiles = 0;
 	struct vec2i v;
-	for (v.y = 0; v.y < mb.Map->Size.y; v.y++)
+	for (v.y = 0; v.y < mb->Map->Size.y; v.y++)
 	{
-		for (v.x = 0; v.x < mb.Map->Size.x; v.x++)
+		for (v.x = 0; v.x < mb->Map->Size.x; v.x++)
 		{
-			if (TileCanWalk(MapGetTile(mb.Map, v)))
+			if (MapTileCanWalk(mb->Map, v))
 			{
-				mb.Map->NumExplorableTiles++;
+				mb->Map->NumExplorableTiles++;
 			}
 		}
 	}
 
 	if (loadDynamic)
 	{
-		MapLoadDynamic(&mb);
+		MapLoadDynamic(mb);
 		ActorsPilotVehicles();
 	}
-	MapBuilderTerminate(&mb);
+}
+static void MapSetupTileClasses(MapBuilder *mb)
+{
+	Map *m = mb->Map;
+	const Mission *mission = mb->mission;
+	switch (mission->Type)
+	{
+	case MAPTYPE_CLASSIC:
+		MissionSetupTileClasses(
+			m, &gPicManager, &mission->u.Classic.TileClasses);
+		break;
+	case MAPTYPE_STATIC:
+		MapStaticSetupTileClasses(m, mb);
+		break;
+	case MAPTYPE_CAVE:
+		MissionSetupTileClasses(m, &gPicManager, &mission->u.Cave.TileClasses);
+		break;
+	case MAPTYPE_INTERIOR:
+		MissionSetupTileClasses(
+			m, &gPicManager, &mission->u.Interior.TileClasses);
+		break;
+	default:
+		CASSERT(false, "unknown map type");
+		break;
+	}
 }
 void SetupWallTileClasses(Map *m, PicManager *pm, const TileClass *base)
 {
@@ -242,17 +301,24 @@ void MapBuilderInit(
 	mb->mission = mission;
 	mb->mode = mode;
 	mb->characters = characters;
+	mb->rand = gRandStreams[RNG_MAP];
 
 	const int mapSize = mission->Size.x * mission->Size.y;
 	CArrayInitFillZero(&mb->access, sizeof(uint16_t), mapSize);
 	CArrayInitFill(&mb->tiles, sizeof(TileClass), mapSize, &gTileNothing);
 	CArrayInitFillZero(&mb->leaveFree, sizeof(bool), mapSize);
+	CArrayInit(&mb->keys, sizeof(MapBuilderKey));
 }
 void MapBuilderTerminate(MapBuilder *mb)
 {
 	CArrayTerminate(&mb->access);
 	CArrayTerminate(&mb->tiles);
 	CArrayTerminate(&mb->leaveFree);
+	CArrayTerminate(&mb->keys);
+	if (mb->tileClasses != NULL)
+	{
+		hashmap_destroy(mb->tileClasses, TileClassDestroy);
+	}
 }
 
 uint16_t MapBuildGetAccess(const MapBuilder *mb, const struct vec2i pos)
@@ -285,6 +351,12 @@ void MapBuilderSetTile(MapBuilder *mb, struct vec2i pos, const TileClass *t)
 			*t;
 	}
 }
+struct vec2i MapBuilderGetRandomTile(MapBuilder *mb)
+{
+	return svec2i(
+		PRNGInt(&mb->rand, 0, mb->Map->Size.x),
+		PRNGInt(&mb->rand, 0, mb->Map->Size.y));
+}
 
 static bool IsTileOKStrict(
 	const MapObject *obj, const Tile *tile, const Tile *tileAbove,
@@ -437,7 +509,7 @@ void MapLoadDynamic(MapBuilder *mb)
 	for (int j = 0;
 		 j < (mod->Density * mb->Map->Size.x * mb->Map->Size.y) / 1000; j++)
 	{
-		MapTryPlaceOneObject(mb, MapGetRandomTile(mb->Map), mod->M, 0, true);
+		MapTryPlaceOneObject(mb, MapBuilderGetRandomTile(mb), mod->M, 0, true);
 	}
 	CA_FOREACH_END()
 
@@ -530,7 +602,7 @@ static int MapTryPlaceCollectible(MapBuilder *mb, const int objective)
 			if ((!hasLockedRooms || MapPosIsInLockedRoom(mb->Map, v)) &&
 				(!noaccess || !MapPosIsInLockedRoom(mb->Map, v)))
 			{
-				MapPlaceCollectible(mb->mission, objective, v);
+				MapPlaceCollectible(mb, objective, v);
 				return 1;
 			}
 		}
@@ -564,7 +636,7 @@ static void MapPlaceCard(
 {
 	for (;;)
 	{
-		const struct vec2i v = MapGetRandomTile(mb->Map);
+		const struct vec2i v = MapBuilderGetRandomTile(mb);
 		const Tile *t = MapGetTile(mb->Map, v);
 		if (t->Class->IsRoom && TileIsClear(t) && TileCanWalk(t) &&
 			MapBuildGetAccess(mb, v) == mapAccess &&
@@ -610,6 +682,12 @@ void MapBuilderSetLeaveFree(
 		return;
 	CArraySet(&mb->leaveFree, tile.y * mb->Map->Size.x + tile.x, &value);
 }
+void MapBuilderAddKey(
+	MapBuilder *mb, const struct vec2i tilePos, const int keyIndex)
+{
+	const MapBuilderKey k = {tilePos, keyIndex};
+	CArrayPushBack(&mb->keys, &k);
+}
 bool MapBuilderIsLeaveFree(const MapBuilder *mb, const struct vec2i tile)
 {
 	if (!MapIsTileIn(mb->Map, tile))
@@ -633,6 +711,7 @@ void MapBuildTile(
 	MapSetupTile(mb, pos);
 	RECT_FOREACH(Rect2iNew(svec2i_subtract(pos, svec2i(1, 1)), svec2i(3, 3)))
 	MapSetupTile(mb, _v);
+	MapUpdateTileFlags(mb->Map, _v);
 	RECT_FOREACH_END()
 	CArrayCopy(&mb->Map->access, &mb->access);
 }
@@ -666,7 +745,7 @@ static void MapSetupTilesAndWalls(MapBuilder *mb)
 		// Randomly change normal floor tiles to alternative floor tiles
 		for (int i = 0; i < mb->Map->Size.x * mb->Map->Size.y / 22; i++)
 		{
-			const struct vec2i pos = MapGetRandomTile(mb->Map);
+			const struct vec2i pos = MapBuilderGetRandomTile(mb);
 			if (MapTileIsNormalFloor(mb, pos))
 			{
 				Tile *t = MapGetTile(mb->Map, pos);
@@ -677,7 +756,7 @@ static void MapSetupTilesAndWalls(MapBuilder *mb)
 		}
 		for (int i = 0; i < mb->Map->Size.x * mb->Map->Size.y / 16; i++)
 		{
-			const struct vec2i pos = MapGetRandomTile(mb->Map);
+			const struct vec2i pos = MapBuilderGetRandomTile(mb);
 			if (MapTileIsNormalFloor(mb, pos))
 			{
 				Tile *t = MapGetTile(mb->Map, pos);
@@ -831,13 +910,16 @@ static bool MapIsValidStartForWall(
 	return true;
 }
 
-struct vec2i MapGetRoomSize(const RoomParams r, const int doorMin)
+struct vec2i MapGetRoomSize(
+	MapBuilder *mb, const RoomParams r, const int doorMin)
 {
 	// Work out dimensions of room
 	// make sure room is large enough to accommodate doors
 	const int roomMin = MAX(r.Min, doorMin + 2);
 	const int roomMax = MAX(r.Max, doorMin + 2);
-	return svec2i(RAND_INT(roomMin, roomMax), RAND_INT(roomMin, roomMax));
+	return svec2i(
+		PRNGInt(&mb->rand, roomMin, roomMax),
+		PRNGInt(&mb->rand, roomMin, roomMax));
 }
 
 static bool MapBuilderGetIsRoom(const MapBuilder *mb, const struct vec2i pos);
@@ -924,12 +1006,16 @@ bool MapTryBuildWall(
 {
 	const struct vec2i v =
 		Rect2iIsZero(r)
-			? MapGetRandomTile(mb->Map)
-			: svec2i_add(r.Pos, svec2i(rand() % r.Size.x, rand() % r.Size.y));
+			? MapBuilderGetRandomTile(mb)
+			: svec2i_add(
+				  r.Pos, svec2i(
+							 PRNGInt(&mb->rand, 0, r.Size.x),
+							 PRNGInt(&mb->rand, 0, r.Size.y)));
 	if (MapIsValidStartForWall(mb, v, isRoom, pad))
 	{
 		MapBuilderSetTile(mb, v, wall);
-		MapGrowWall(mb, v, isRoom, pad, rand() & 3, wallLength, wall);
+		MapGrowWall(
+			mb, v, isRoom, pad, PRNGInt(&mb->rand, 0, 4), wallLength, wall);
 		return true;
 	}
 	return false;
@@ -1027,11 +1113,11 @@ static void MapGrowWall(
 	}
 	MapBuilderSetTile(mb, pos, wall);
 	length--;
-	if (length > 0 && (rand() & 3) == 0)
+	if (length > 0 && PRNGInt(&mb->rand, 0, 4) == 0)
 	{
 		// Randomly try to grow the wall in a different direction
-		l = rand() % length;
-		MapGrowWall(mb, pos, isRoom, pad, rand() & 3, l, wall);
+		l = PRNGInt(&mb->rand, 0, length);
+		MapGrowWall(mb, pos, isRoom, pad, PRNGInt(&mb->rand, 0, 4), l, wall);
 		length -= l;
 	}
 	// Keep growing wall in same direction
@@ -1115,7 +1201,7 @@ void MapPlaceDoors(
 			continue;
 		}
 		const int doorSize =
-			doorMax > doorMin ? RAND_INT(doorMin, doorMax) : doorMin;
+			doorMax > doorMin ? PRNGInt(&mb->rand, doorMin, doorMax) : doorMin;
 		int roomDim;
 		struct vec2i d;
 		struct vec2i doorStart;
@@ -1167,7 +1253,8 @@ static void PlaceDoors(
 	{
 		start = svec2i_add(
 			start,
-			svec2i_scale(dAcross, (float)RAND_INT(1, roomDim - size - 1)));
+			svec2i_scale(
+				dAcross, (float)PRNGInt(&mb->rand, 1, roomDim - size - 1)));
 	}
 	else
 	{
@@ -1465,10 +1552,10 @@ void MapFillRect(
 	RECT_FOREACH_END()
 }
 
-uint16_t GenerateAccessMask(int *accessLevel)
+uint16_t GenerateAccessMask(MapBuilder *mb, int *accessLevel)
 {
 	uint16_t accessMask = 0;
-	switch (rand() % 20)
+	switch (PRNGInt(&mb->rand, 0, 20))
 	{
 	case 0:
 		if (*accessLevel >= 4)
@@ -1521,8 +1608,9 @@ uint16_t GenerateAccessMask(int *accessLevel)
 	return accessMask;
 }
 
-static void MapGenerateRandomExitArea(Map *map, const int mission)
+static void MapGenerateRandomExitArea(MapBuilder *mb, const int mission)
 {
+	Map *map = mb->Map;
 	const Tile *t = NULL;
 	Exit exit;
 	exit.Mission = mission + 1;
@@ -1530,9 +1618,11 @@ static void MapGenerateRandomExitArea(Map *map, const int mission)
 	for (int i = 0; i < 10000 && (t == NULL || !TileCanWalk(t)); i++)
 	{
 		exit.R.Size.x = MIN(map->Size.x - 2, EXIT_WIDTH + 1);
-		exit.R.Pos.x = (rand() % (abs(map->Size.x) - exit.R.Size.x));
+		exit.R.Pos.x =
+			PRNGInt(&mb->rand, 0, abs(map->Size.x) - exit.R.Size.x);
 		exit.R.Size.y = MIN(map->Size.y - 2, EXIT_HEIGHT + 1);
-		exit.R.Pos.y = (rand() % (abs(map->Size.y) - exit.R.Size.y));
+		exit.R.Pos.y =
+			PRNGInt(&mb->rand, 0, abs(map->Size.y) - exit.R.Size.y);
 		// Check that the exit area is walkable
 		t = MapGetTile(map, Rect2iCenter(exit.R));
 	}
@@ -1551,7 +1641,7 @@ static void MapAddDrains(MapBuilder *mb)
 	for (int i = 0; i < mb->Map->Size.x * mb->Map->Size.y / 45; i++)
 	{
 		// Make sure drain tiles aren't next to each other
-		struct vec2i v = MapGetRandomTile(mb->Map);
+		struct vec2i v = MapBuilderGetRandomTile(mb);
 		v.x &= 0xFFFFFE;
 		v.y &= 0xFFFFFE;
 		if (MapTileIsNormalFloor(mb, v))
@@ -51,6 +51,13 @@
 #include "game_mode.h"
 #include "map.h"
 #include "mission.h"
+#include "prng.h"
+
+typedef struct
+{
+	struct vec2i Pos;
+	int Index;
+} MapBuilderKey;
 
 typedef struct
 {
@@ -58,15 +65,33 @@ typedef struct
 	const Mission *mission;
 	GameMode mode;
 	const CharacterStore *characters;
+	// Random numbers for building the map; starts from the RNG_MAP stream
+	PRNG rand;
 
 	// internal data structures to help build the map
 	CArray access;	  // of uint16_t
 	CArray tiles;	  // of TileClass
 	CArray leaveFree; // of bool
+	CArray keys;	  // of MapBuilderKey; placed when the map is committed
+	// Static maps: the layout's own copy of the mission's tile classes
+	map_t tileClasses;
 } MapBuilder;
 
 void MapBuild(
 	Map *m, const Mission *mission, const bool loadDynamic, const int missionIndex, const GameMode mode, const CharacterStore *characters);
+// MapBuild is done in two phases:
+// - Layout: generate the tiles and access levels into the builder. This only
+// reads the mission and uses the builder's own random numbers, and the
+// builder's map only needs the fields set up by MapLayoutInit, so it can run
+// off the main thread
+// - Commit: set up the map from the layout; tile classes (which create
+// textures), walls, doors and exits, plus objects and actors if loadDynamic.
+// Main thread only.
+void MapLayoutInit(Map *m, const struct vec2i size);
+void MapLayoutTerminate(Map *m);
+void MapBuildLayout(MapBuilder *mb, const int missionIndex);
+void MapBuildCommit(
+	MapBuilder *mb, Map *m, const bool loadDynamic, const int missionIndex);
 void MapBuilderInit(
 	MapBuilder *mb, Map *m, const Mission *mission, const GameMode mode, const CharacterStore *characters);
 void MapBuilderTerminate(MapBuilder *mb);
@@ -78,11 +103,15 @@ void MapBuildSetAccess(MapBuilder *mb, struct vec2i pos, const uint16_t v);
 const TileClass *MapBuilderGetTile(
 	const MapBuilder *mb, const struct vec2i pos);
 void MapBuilderSetTile(MapBuilder *mb, struct vec2i pos, const TileClass *t);
+struct vec2i MapBuilderGetRandomTile(MapBuilder *mb);
 
 // Mark a tile so that it is left free of other map objects
 void MapBuilderSetLeaveFree(
 	MapBuilder *mb, const struct vec2i tile, const bool value);
 bool MapBuilderIsLeaveFree(const MapBuilder *mb, const struct vec2i tile);
+// Place a key when the map is committed, since layout can't add pickups
+void MapBuilderAddKey(
+	MapBuilder *mb, const struct vec2i tilePos, const int keyIndex);
 
 bool MapTryPlaceOneObject(
 	MapBuilder *mb, const struct vec2i v, const MapObject *mo,
@@ -93,7 +122,7 @@ void MapPlacePickup(
 	const PickupClass *p, const struct vec2 pos, const int flags);
 // TODO: refactor
 void MapPlaceCollectible(
-	const Mission *m, const int objective, const struct vec2 pos);
+	MapBuilder *mb, const int objective, const struct vec2 pos);
 // TODO: refactor
 void MapPlaceKey(
 	MapBuilder *mb, const struct vec2i tilePos, const int keyIndex);
@@ -118,7 +147,8 @@ bool MapGetRoomOverlapSize(
 bool MapIsLessThanTwoWallOverlaps(
 	const MapBuilder *mb, struct vec2i pos, struct vec2i size);
 void MapFillRect(MapBuilder *mb, const Rect2i r, const TileClass *edge, const TileClass *fill);
-struct vec2i MapGetRoomSize(const RoomParams r, const int doorMin);
+struct vec2i MapGetRoomSize(
+	MapBuilder *mb, const RoomParams r, const int doorMin);
 void MapMakeRoom(
 	MapBuilder *mb, const struct vec2i pos, const struct vec2i size,
 	const bool walls, const TileClass *wall, const TileClass *room,
@@ -141,7 +171,7 @@ void MapPlaceDoors(
 void MapBuildTile(
 	MapBuilder *mb, const struct vec2i pos, const TileClass *tile);
 
-uint16_t GenerateAccessMask(int *accessLevel);
+uint16_t GenerateAccessMask(MapBuilder *mb, int *accessLevel);
 
 void SetupWallTileClasses(Map *m, PicManager *pm, const TileClass *base);
 void SetupFloorTileClasses(Map *m, PicManager *pm, const TileClass *base);
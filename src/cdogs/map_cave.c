@@ -27,21 +27,21 @@
 */
 #include "map_cave.h"
 
+#include <SDL.h>
+
 #include "algorithms.h"
+#include "bit_grid.h"
 #include "log.h"
 #include "map_build.h"
 
-static void CaveRep(MapBuilder *mb, const int r1, const int r2);
+static void CaveAutomaton(
+	MapBuilder *mb, const int repeat, const int r1, const int r2);
 static void LinkDisconnectedAreas(MapBuilder *mb);
 static void FixCorridors(MapBuilder *mb, const int corridorWidth);
 static void PlaceSquares(MapBuilder *mb, const int squares);
 static void PlaceRooms(MapBuilder *mb);
 void MapCaveLoad(MapBuilder *mb)
 {
-	// TODO: multiple tile types
-	MissionSetupTileClasses(
-		mb->Map, &gPicManager, &mb->mission->u.Cave.TileClasses);
-
 	// Randomly set a percentage of the tiles as walls
 	for (int i = 0; i < mb->mission->u.Cave.FillPercent * mb->Map->Size.x *
 							mb->Map->Size.y / 100;
@@ -52,12 +52,11 @@ void MapCaveLoad(MapBuilder *mb)
 		MapBuilderSetTile(mb, pos, &mb->mission->u.Cave.TileClasses.Wall);
 	}
 	// Shuffle
-	CArrayShuffle(&mb->tiles);
+	CArrayShuffle(&mb->tiles, &mb->rand);
 	// Repetitions
-	for (int i = 0; i < mb->mission->u.Cave.Repeat; i++)
-	{
-		CaveRep(mb, mb->mission->u.Cave.R1, mb->mission->u.Cave.R2);
-	}
+	CaveAutomaton(
+		mb, mb->mission->u.Cave.Repeat, mb->mission->u.Cave.R1,
+		mb->mission->u.Cave.R2);
 
 	LinkDisconnectedAreas(mb);
 
@@ -68,79 +67,118 @@ void MapCaveLoad(MapBuilder *mb)
 	PlaceRooms(mb);
 }
 
-// Perform one generation of cellular automata
-// If the number of walls within 1 distance is at least R1, OR
-// if the number of walls within 2 distance is at most R2, then the tile
-// becomes a wall; otherwise it is a floor
-static int CountWallsAround(
-	const MapBuilder *mb, const struct vec2i pos, const int d);
-static void CaveRep(MapBuilder *mb, const int r1, const int r2)
+static void BitGridFromWalls(BitGrid *g, const MapBuilder *mb)
 {
-	CArray buf;
-	CArrayInitFill(
-		&buf, mb->tiles.elemSize, mb->tiles.size,
-		&mb->mission->u.Cave.TileClasses.Floor);
+	BitGridInit(g, mb->Map->Size);
 	RECT_FOREACH(Rect2iNew(svec2i_zero(), mb->Map->Size))
-	TileClass *tile = CArrayGet(&buf, _i);
-	if (CountWallsAround(mb, _v, 1) >= r1 || CountWallsAround(mb, _v, 2) <= r2)
+	if (MapBuilderGetTile(mb, _v)->Type == TILE_CLASS_WALL)
 	{
-		*tile = mb->mission->u.Cave.TileClasses.Wall;
+		BitGridSet(g, _v, true);
 	}
-	else
+	RECT_FOREACH_END()
+}
+
+// Split large maps into bands of rows, one per thread
+#define CAVE_BAND_ROWS 64
+#define CAVE_MAX_THREADS 8
+typedef struct
+{
+	BitGrid *dst;
+	const BitGrid *src;
+	int r1;
+	int r2;
+	SDL_atomic_t next;
+} CaveStepWork;
+static int CaveStepWorker(void *data)
+{
+	CaveStepWork *w = data;
+	for (;;)
 	{
-		*tile = mb->mission->u.Cave.TileClasses.Floor;
+		const int y0 = SDL_AtomicAdd(&w->next, 1) * CAVE_BAND_ROWS;
+		if (y0 >= w->src->size.y)
+		{
+			break;
+		}
+		BitGridAutomatonStep(
+			w->dst, w->src, w->r1, w->r2, y0,
+			MIN(y0 + CAVE_BAND_ROWS, w->src->size.y));
 	}
-	RECT_FOREACH_END()
-	RECT_FOREACH(Rect2iNew(svec2i_zero(), mb->Map->Size))
-	MapBuilderSetTile(mb, _v, CArrayGet(&buf, _i));
-	RECT_FOREACH_END()
-	CArrayTerminate(&buf);
+	return 0;
 }
-static int CountWallsAround(
-	const MapBuilder *mb, const struct vec2i pos, const int d)
+static void CaveStep(
+	BitGrid *dst, const BitGrid *src, const int r1, const int r2)
 {
-	int c = 0;
-	RECT_FOREACH(Rect2iNew(
-		svec2i_subtract(pos, svec2i(d, d)), svec2i(2 * d + 1, 2 * d + 1)))
-	// Also count edge of maps
-	if (!MapIsTileIn(mb->Map, _v) ||
-		MapBuilderGetTile(mb, _v)->Type == TILE_CLASS_WALL)
+	CaveStepWork w;
+	w.dst = dst;
+	w.src = src;
+	w.r1 = r1;
+	w.r2 = r2;
+	SDL_AtomicSet(&w.next, 0);
+	// Each band only writes its own rows of dst, so the result is the same
+	// however many threads there are
+	const int numBands = (src->size.y + CAVE_BAND_ROWS - 1) / CAVE_BAND_ROWS;
+	const int numWorkers = CLAMP(
+		MIN(SDL_GetCPUCount(), numBands) - 1, 0, CAVE_MAX_THREADS - 1);
+	SDL_Thread *threads[CAVE_MAX_THREADS];
+	int numThreads = 0;
+	for (int i = 0; i < numWorkers; i++)
+	{
+		SDL_Thread *t = SDL_CreateThread(CaveStepWorker, "CaveStep", &w);
+		if (t == NULL)
+		{
+			break;
+		}
+		threads[numThreads++] = t;
+	}
+	CaveStepWorker(&w);
+	for (int i = 0; i < numThreads; i++)
 	{
-		c++;
+		SDL_WaitThread(threads[i], NULL);
 	}
+}
+// Perform generations of cellular automata
+// If the number of walls within 1 distance is at least R1, OR
+// if the number of walls within 2 distance is at most R2, then the tile
+// becomes a wall; otherwise it is a floor
+// The walls are packed into bit grids so that neighbours are counted a word
+// of tiles at a time
+static void CaveAutomaton(
+	MapBuilder *mb, const int repeat, const int r1, const int r2)
+{
+	if (repeat <= 0)
+	{
+		return;
+	}
+	BitGrid grids[2];
+	BitGridFromWalls(&grids[0], mb);
+	BitGridInit(&grids[1], mb->Map->Size);
+	for (int i = 0; i < repeat; i++)
+	{
+		CaveStep(&grids[(i + 1) % 2], &grids[i % 2], r1, r2);
+	}
+	const BitGrid *result = &grids[repeat % 2];
+	RECT_FOREACH(Rect2iNew(svec2i_zero(), mb->Map->Size))
+	MapBuilderSetTile(
+		mb, _v,
+		BitGridGet(result, _v) ? &mb->mission->u.Cave.TileClasses.Wall
+							   : &mb->mission->u.Cave.TileClasses.Floor);
 	RECT_FOREACH_END()
-	return c;
+	BitGridTerminate(&grids[0]);
+	BitGridTerminate(&grids[1]);
 }
 
-static void MapFloodFill(
-	CArray *fl, const struct vec2i size, const int idx, const int elem);
 static void AddCorridor(
 	MapBuilder *mb, const struct vec2i v1, const struct vec2i v2,
 	const struct vec2i dInit, const TileClass *tile);
 static void LinkDisconnectedAreas(MapBuilder *mb)
 {
-	// Use flood fill to identify disconnected areas
+	// Label the disconnected areas in one pass; walls are -1
 	CArray fl;
 	CArrayInitFillZero(&fl, sizeof(int), mb->tiles.size);
-	// First copy across the wall tiles (as -1)
-	RECT_FOREACH(Rect2iNew(svec2i_zero(), mb->Map->Size))
-	const TileClass *tile = MapBuilderGetTile(mb, _v);
-	if (tile->Type == TILE_CLASS_WALL)
-	{
-		*(int *)CArrayGet(&fl, _i) = -1;
-	}
-	RECT_FOREACH_END()
-	// Then perform flood fill conditionally on the flood layer
-	int idx = 1;
-	CA_FOREACH(int, i, fl)
-	if (*i == 0)
-	{
-		MapFloodFill(&fl, mb->Map->Size, _ca_index, idx);
-		idx++;
-	}
-	CA_FOREACH_END()
-
-	const int numAreas = idx - 1;
+	BitGrid walls;
+	BitGridFromWalls(&walls, mb);
+	const int numAreas = BitGridLabelClear(&walls, fl.data);
+	BitGridTerminate(&walls);
 	// Connect the disconnected areas, first to second, second to third etc.
 	// Select random tile from each area, using index shuffle
 	CArray areaTiles;
@@ -149,7 +187,7 @@ static void LinkDisconnectedAreas(MapBuilder *mb)
 	UNUSED(i);
 	CArrayPushBack(&areaTiles, &_ca_index);
 	CA_FOREACH_END()
-	CArrayShuffle(&areaTiles);
+	CArrayShuffle(&areaTiles, &mb->rand);
 	CArray areaStarts;
 	CArrayInitFillZero(&areaStarts, sizeof(int), numAreas);
 	CA_FOREACH(int, areaIdx, areaTiles)
@@ -184,50 +222,6 @@ static void LinkDisconnectedAreas(MapBuilder *mb)
 	CArrayTerminate(&areaStarts);
 }
 
-static void MapFloodFill(
-	CArray *fl, const struct vec2i size, const int idx, const int elem)
-{
-	CArray indices;
-	CArrayInit(&indices, sizeof(int));
-	CArrayPushBack(&indices, &idx);
-	const int floodTile = *(int *)CArrayGet(fl, idx);
-	*(int *)CArrayGet(fl, idx) = elem;
-	CA_FOREACH(int, i, indices)
-	const int x = *i % size.x;
-	const int y = *i / size.x;
-	int next;
-	// top
-	next = (y - 1) * size.x + x;
-	if (y > 0 && *(int *)CArrayGet(fl, next) == floodTile)
-	{
-		CArrayPushBack(&indices, &next);
-		*(int *)CArrayGet(fl, next) = elem;
-	}
-	// bottom
-	next = (y + 1) * size.x + x;
-	if (y < size.y - 1 && *(int *)CArrayGet(fl, next) == floodTile)
-	{
-		CArrayPushBack(&indices, &next);
-		*(int *)CArrayGet(fl, next) = elem;
-	}
-	// left
-	next = y * size.x + x - 1;
-	if (x > 0 && *(int *)CArrayGet(fl, next) == floodTile)
-	{
-		CArrayPushBack(&indices, &next);
-		*(int *)CArrayGet(fl, next) = elem;
-	}
-	// right
-	next = y * size.x + x + 1;
-	if (x < size.x - 1 && *(int *)CArrayGet(fl, next) == floodTile)
-	{
-		CArrayPushBack(&indices, &next);
-		*(int *)CArrayGet(fl, next) = elem;
-	}
-	CA_FOREACH_END()
-	CArrayTerminate(&indices);
-}
-
 // Add an S-shaped corridor from one point to another, filling it with a
 // certain tile value. The corridor starts in a specific direction d, then
 // makes a turn in the middle, then turns back to the original direction.
@@ -398,8 +392,9 @@ static void PlaceSquares(MapBuilder *mb, const int squares)
 	int count = 0;
 	for (int i = 0; i < 1000 && count < squares; i++)
 	{
-		const struct vec2i v = MapGetRandomTile(mb->Map);
-		const struct vec2i size = svec2i(rand() % 9 + 8, rand() % 9 + 8);
+		const struct vec2i v = MapBuilderGetRandomTile(mb);
+		const struct vec2i size =
+			svec2i(PRNGInt(&mb->rand, 8, 17), PRNGInt(&mb->rand, 8, 17));
 		if (!MapIsAreaClearForCaveSquare(mb, v, size))
 		{
 			continue;
@@ -462,8 +457,8 @@ static void PlaceRooms(MapBuilder *mb)
 		 i < 1000 && (int)rooms.size < mb->mission->u.Cave.Rooms.Count; i++)
 	{
 		Rect2i room;
-		room.Pos = MapGetRandomTile(mb->Map);
-		room.Size = MapGetRoomSize(mb->mission->u.Cave.Rooms, 1);
+		room.Pos = MapBuilderGetRandomTile(mb);
+		room.Size = MapGetRoomSize(mb, mb->mission->u.Cave.Rooms, 1);
 		if (!MapIsAreaClearForCaveRoom(mb, room))
 		{
 			continue;
@@ -480,7 +475,7 @@ static void PlaceRooms(MapBuilder *mb)
 		{
 			// generate an access level for this room
 			const uint16_t accessMask =
-				GenerateAccessMask(&mb->Map->keyAccessCount);
+				GenerateAccessMask(mb, &mb->Map->keyAccessCount);
 			MapSetRoomAccessMaskOverlap(mb, &rooms, accessMask);
 		}
 	}
@@ -79,10 +79,6 @@ void MapClassicLoad(MapBuilder *mb)
 	// they overlap with other incompatible features, or it may
 	// create inaccessible areas on the map.
 
-	// TODO: multiple tile types
-	MissionSetupTileClasses(
-		mb->Map, &gPicManager, &mb->mission->u.Classic.TileClasses);
-
 	MapFillRect(
 		mb, Rect2iNew(svec2i_zero(), mb->mission->Size),
 		&mb->mission->u.Classic.TileClasses.Wall,
@@ -106,12 +102,12 @@ void MapClassicLoad(MapBuilder *mb)
 	count = 0;
 	for (i = 0; i < 1000 && count < mb->mission->u.Classic.Rooms.Count; i++)
 	{
-		const struct vec2i v = MapGetRandomTile(mb->Map);
+		const struct vec2i v = MapBuilderGetRandomTile(mb);
 		const int doorMin = CLAMP(mb->mission->u.Classic.Doors.Min, 1, 6);
 		const int doorMax =
 			CLAMP(mb->mission->u.Classic.Doors.Max, doorMin, 6);
 		const struct vec2i size =
-			MapGetRoomSize(mb->mission->u.Classic.Rooms, doorMin);
+			MapGetRoomSize(mb, mb->mission->u.Classic.Rooms, doorMin);
 		bool isOverlapRoom;
 		uint16_t overlapAccess;
 		if (!MapIsAreaClearForClassicRoom(
@@ -154,8 +150,9 @@ void MapClassicLoad(MapBuilder *mb)
 
 static int MapTryBuildSquare(MapBuilder *mb)
 {
-	const struct vec2i v = MapGetRandomTile(mb->Map);
-	struct vec2i size = svec2i(rand() % 9 + 8, rand() % 9 + 8);
+	const struct vec2i v = MapBuilderGetRandomTile(mb);
+	struct vec2i size =
+		svec2i(PRNGInt(&mb->rand, 8, 17), PRNGInt(&mb->rand, 8, 17));
 	if (MapIsAreaClear(mb, v, size))
 	{
 		const Rect2i area = Rect2iNew(v, size);
@@ -240,7 +237,7 @@ static void MapBuildRoom(
 	const int doorMin, const int doorMax, const bool hasKeys,
 	const bool isOverlapRoom, const uint16_t overlapAccess)
 {
-	int doormask = rand() % 15 + 1;
+	int doormask = PRNGInt(&mb->rand, 1, 16);
 	bool doors[4];
 	int doorsUnplaced = 0;
 	int i;
@@ -295,7 +292,7 @@ static void MapBuildRoom(
 		else
 		{
 			// Otherwise, generate an access level for this room
-			accessMask = GenerateAccessMask(&mb->Map->keyAccessCount);
+			accessMask = GenerateAccessMask(mb, &mb->Map->keyAccessCount);
 		}
 	}
 
@@ -316,9 +313,9 @@ static bool MapTryBuildPillar(MapBuilder *mb, const int pad)
 	const int pillarMin = mb->mission->u.Classic.Pillars.Min;
 	const int pillarMax = mb->mission->u.Classic.Pillars.Max;
 	struct vec2i size = svec2i(
-		rand() % (pillarMax - pillarMin + 1) + pillarMin,
-		rand() % (pillarMax - pillarMin + 1) + pillarMin);
-	const struct vec2i pos = MapGetRandomTile(mb->Map);
+		PRNGInt(&mb->rand, pillarMin, pillarMax + 1),
+		PRNGInt(&mb->rand, pillarMin, pillarMax + 1));
+	const struct vec2i pos = MapBuilderGetRandomTile(mb);
 	struct vec2i clearPos = svec2i(pos.x - pad, pos.y - pad);
 	struct vec2i clearSize = svec2i(size.x + 2 * pad, size.y + 2 * pad);
 	int isEdge = 0;
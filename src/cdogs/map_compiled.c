@@ -0,0 +1,687 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "map_compiled.h"
+
+#include <sys/stat.h>
+
+#include "json_utils.h"
+#include "log.h"
+#include "map_archive.h"
+#include "map_new.h"
+#include "utils.h"
+
+// File layout, all little-endian:
+// - header: magic, version, section count
+// - section table: id, offset, size for each section
+// - sections, each aligned to 4 bytes
+// Strings are a u32 length, the bytes and a terminating nul
+#define MAP_COMPILED_MAGIC 0x43504443 // "CDPC"
+#define MAP_COMPILED_VERSION 1
+#define SECTION_ID(a, b, c, d)                                                \
+	((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) |           \
+	 ((uint32_t)(d) << 24))
+// Sizes and mtimes of the source JSON files
+#define SECTION_SOURCES SECTION_ID('S', 'R', 'C', 'S')
+// Campaign settings, from campaign.json
+#define SECTION_CAMPAIGN SECTION_ID('C', 'A', 'M', 'P')
+// Mission JSON, minus static tiles and access
+#define SECTION_MISSIONS SECTION_ID('M', 'I', 'S', 'N')
+// Static tiles and access grids for each mission
+#define SECTION_GRIDS SECTION_ID('G', 'R', 'I', 'D')
+#define NUM_SECTIONS 4
+
+typedef enum
+{
+	GRID_RAW,
+	// Pairs of run length and value
+	GRID_RLE
+} GridEncoding;
+
+static const char *sourceFiles[] = {"campaign.json", "missions.json"};
+#define NUM_SOURCES (sizeof sourceFiles / sizeof sourceFiles[0])
+
+typedef struct
+{
+	const uint8_t *data;
+	size_t size;
+	size_t pos;
+	bool ok;
+} Reader;
+static Reader MakeReader(const uint8_t *data, const size_t size)
+{
+	Reader r;
+	r.data = data;
+	r.size = size;
+	r.pos = 0;
+	r.ok = data != NULL;
+	return r;
+}
+static const uint8_t *ReadBytes(Reader *r, const size_t n)
+{
+	if (!r->ok || r->size - r->pos < n)
+	{
+		r->ok = false;
+		return NULL;
+	}
+	const uint8_t *p = r->data + r->pos;
+	r->pos += n;
+	return p;
+}
+static uint32_t ReadU32(Reader *r)
+{
+	const uint8_t *p = ReadBytes(r, 4);
+	if (p == NULL)
+	{
+		return 0;
+	}
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+		   ((uint32_t)p[3] << 24);
+}
+static int32_t ReadI32(Reader *r)
+{
+	return (int32_t)ReadU32(r);
+}
+static uint64_t ReadU64(Reader *r)
+{
+	const uint64_t lo = ReadU32(r);
+	return lo | ((uint64_t)ReadU32(r) << 32);
+}
+static const char *ReadStr(Reader *r)
+{
+	const uint32_t len = ReadU32(r);
+	if (!r->ok || r->size - r->pos <= len)
+	{
+		r->ok = false;
+		return NULL;
+	}
+	const char *s = (const char *)ReadBytes(r, (size_t)len + 1);
+	if (s[len] != '\0')
+	{
+		r->ok = false;
+		return NULL;
+	}
+	return s;
+}
+
+static void WriteBytes(CArray *b, const void *data, const size_t n)
+{
+	const size_t size = b->size;
+	if (size + n > b->capacity)
+	{
+		CArrayReserve(b, MAX(b->capacity * 2, size + n));
+	}
+	CArrayResize(b, size + n, NULL);
+	memcpy((uint8_t *)b->data + size, data, n);
+}
+static void WriteU32(CArray *b, const uint32_t v)
+{
+	const uint8_t p[4] = {
+		(uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16),
+		(uint8_t)(v >> 24)};
+	WriteBytes(b, p, sizeof p);
+}
+static void WriteI32(CArray *b, const int32_t v)
+{
+	WriteU32(b, (uint32_t)v);
+}
+static void WriteU64(CArray *b, const uint64_t v)
+{
+	WriteU32(b, (uint32_t)v);
+	WriteU32(b, (uint32_t)(v >> 32));
+}
+static void WriteStr(CArray *b, const char *s)
+{
+	const size_t len = s != NULL ? strlen(s) : 0;
+	WriteU32(b, (uint32_t)len);
+	WriteBytes(b, s != NULL ? s : "", len + 1);
+}
+
+static bool StatSources(uint64_t *stats, const char *archive)
+{
+	for (size_t i = 0; i < NUM_SOURCES; i++)
+	{
+		char path[CDOGS_PATH_MAX];
+		sprintf(path, "%s/%s", archive, sourceFiles[i]);
+		struct stat st;
+		if (stat(path, &st) != 0)
+		{
+			return false;
+		}
+		stats[i * 2] = (uint64_t)st.st_mtime;
+		stats[i * 2 + 1] = (uint64_t)st.st_size;
+	}
+	return true;
+}
+
+bool MapCompiledOpen(MapCompiled *mc, const char *archive)
+{
+	memset(mc, 0, sizeof *mc);
+	char path[CDOGS_PATH_MAX];
+	sprintf(path, "%s/%s", archive, MAP_COMPILED_FILE);
+	if (!FileMapOpen(&mc->file, path))
+	{
+		return false;
+	}
+
+	Reader r = MakeReader(mc->file.Data, mc->file.Size);
+	if (ReadU32(&r) != MAP_COMPILED_MAGIC ||
+		ReadU32(&r) != MAP_COMPILED_VERSION)
+	{
+		LOG(LM_MAP, LL_WARN, "Invalid compiled campaign %s", path);
+		goto bail;
+	}
+	const uint32_t numSections = ReadU32(&r);
+	for (uint32_t i = 0; i < numSections && r.ok; i++)
+	{
+		const uint32_t id = ReadU32(&r);
+		const uint32_t offset = ReadU32(&r);
+		const uint32_t size = ReadU32(&r);
+		if (offset > mc->file.Size || mc->file.Size - offset < size)
+		{
+			r.ok = false;
+			break;
+		}
+		const uint8_t *data = (const uint8_t *)mc->file.Data + offset;
+		switch (id)
+		{
+		case SECTION_SOURCES:
+			mc->sources = data;
+			mc->sourcesSize = size;
+			break;
+		case SECTION_CAMPAIGN:
+			mc->campaign = data;
+			mc->campaignSize = size;
+			break;
+		case SECTION_MISSIONS:
+			mc->missions = data;
+			mc->missionsSize = size;
+			break;
+		case SECTION_GRIDS:
+			mc->grids = data;
+			mc->gridsSize = size;
+			break;
+		default:
+			// Unknown sections are skipped
+			break;
+		}
+	}
+	if (!r.ok || mc->sources == NULL || mc->campaign == NULL ||
+		mc->missions == NULL || mc->grids == NULL)
+	{
+		LOG(LM_MAP, LL_WARN, "Invalid compiled campaign %s", path);
+		goto bail;
+	}
+
+	// Check that the JSON hasn't changed since it was compiled
+	uint64_t stats[NUM_SOURCES * 2];
+	if (!StatSources(stats, archive))
+	{
+		goto bail;
+	}
+	r = MakeReader(mc->sources, mc->sourcesSize);
+	for (size_t i = 0; i < NUM_SOURCES * 2; i++)
+	{
+		if (ReadU64(&r) != stats[i] || !r.ok)
+		{
+			LOG(LM_MAP, LL_DEBUG, "Compiled campaign %s is out of date", path);
+			goto bail;
+		}
+	}
+	return true;
+
+bail:
+	MapCompiledClose(mc);
+	return false;
+}
+void MapCompiledClose(MapCompiled *mc)
+{
+	FileMapClose(&mc->file);
+	memset(mc, 0, sizeof *mc);
+}
+
+bool MapCompiledScan(const MapCompiled *mc, char **title, int *numMissions)
+{
+	Reader r = MakeReader(mc->campaign, mc->campaignSize);
+	const int version = ReadI32(&r);
+	const int n = ReadI32(&r);
+	const char *t = ReadStr(&r);
+	if (!r.ok || version > MAP_VERSION || version <= 0)
+	{
+		return false;
+	}
+	if (title != NULL)
+	{
+		CSTRDUP(*title, t);
+	}
+	if (numMissions != NULL)
+	{
+		*numMissions = n;
+	}
+	return true;
+}
+
+bool MapCompiledLoadCampaign(
+	const MapCompiled *mc, CampaignSetting *c, int *version)
+{
+	Reader r = MakeReader(mc->campaign, mc->campaignSize);
+	const int v = ReadI32(&r);
+	ReadI32(&r); // number of missions
+	const char *title = ReadStr(&r);
+	const char *author = ReadStr(&r);
+	const char *description = ReadStr(&r);
+	const bool ammo = ReadU32(&r);
+	const bool skipWeaponMenu = ReadU32(&r);
+	const bool buyAndSell = ReadU32(&r);
+	const bool randomPickups = ReadU32(&r);
+	const int doorOpenTicks = ReadI32(&r);
+	const int lives = ReadI32(&r);
+	const int maxLives = ReadI32(&r);
+	const int playerHP = ReadI32(&r);
+	const int playerMaxHP = ReadI32(&r);
+	const int playerExcessHP = ReadI32(&r);
+	if (!r.ok || v > MAP_VERSION || v <= 2)
+	{
+		return false;
+	}
+	if (version != NULL)
+	{
+		*version = v;
+	}
+	CFREE(c->Title);
+	CSTRDUP(c->Title, title);
+	CFREE(c->Author);
+	CSTRDUP(c->Author, author);
+	CFREE(c->Description);
+	CSTRDUP(c->Description, description);
+	c->Ammo = ammo;
+	c->SkipWeaponMenu = skipWeaponMenu;
+	c->BuyAndSell = buyAndSell;
+	c->RandomPickups = randomPickups;
+	c->DoorOpenTicks = doorOpenTicks;
+	c->Lives = lives;
+	c->MaxLives = maxLives;
+	c->PlayerHP = playerHP;
+	c->PlayerMaxHP = playerMaxHP;
+	c->PlayerExcessHP = playerExcessHP;
+	return true;
+}
+
+// maxValues: the most values the grid can have, i.e. the mission's size;
+// checked before reserving so that a corrupt file can't request a huge
+// allocation
+static bool ReadGrid(
+	Reader *r, CArray *values, const bool isAccess, const uint64_t maxValues)
+{
+	const GridEncoding encoding = (GridEncoding)ReadU32(r);
+	const uint32_t numValues = ReadU32(r);
+	const uint32_t numItems = ReadU32(r);
+	const size_t itemSize = encoding == GRID_RLE ? 8 : 4;
+	if (!r->ok || (encoding != GRID_RAW && encoding != GRID_RLE) ||
+		(r->size - r->pos) / itemSize < numItems || numValues > maxValues ||
+		(encoding == GRID_RAW && numValues != numItems))
+	{
+		return false;
+	}
+	CArrayReserve(values, values->size + numValues);
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < numItems; i++)
+	{
+		const uint32_t run = encoding == GRID_RLE ? ReadU32(r) : 1;
+		const int32_t v = ReadI32(r);
+		if (run > numValues - count)
+		{
+			return false;
+		}
+		const int tile = v;
+		const uint16_t access = (uint16_t)v;
+		for (uint32_t j = 0; j < run; j++)
+		{
+			CArrayPushBack(values, isAccess ? (const void *)&access : &tile);
+		}
+		count += run;
+	}
+	return r->ok && count == numValues;
+}
+bool MapCompiledLoadMissions(
+	const MapCompiled *mc, CArray *missions, const int version)
+{
+	bool res = false;
+	json_t *missionsNode = json_new_array();
+	Reader r = MakeReader(mc->missions, mc->missionsSize);
+	const uint32_t numMissions = ReadU32(&r);
+	for (uint32_t i = 0; i < numMissions; i++)
+	{
+		const char *text = ReadStr(&r);
+		json_t *missionNode = NULL;
+		if (!r.ok || json_parse_document(&missionNode, text) != JSON_OK)
+		{
+			goto bail;
+		}
+		json_insert_child(missionsNode, missionNode);
+	}
+	const size_t first = missions->size;
+	LoadMissions(missions, missionsNode, version);
+	if (missions->size - first != numMissions)
+	{
+		goto bail;
+	}
+
+	// Static tiles are loaded straight from the grids, bypassing CSV parsing
+	r = MakeReader(mc->grids, mc->gridsSize);
+	if (ReadU32(&r) != numMissions)
+	{
+		goto bail;
+	}
+	for (uint32_t i = 0; i < numMissions; i++)
+	{
+		const bool hasGrids = ReadU32(&r);
+		if (!r.ok)
+		{
+			goto bail;
+		}
+		if (!hasGrids)
+		{
+			continue;
+		}
+		Mission *m = CArrayGet(missions, first + i);
+		const uint64_t maxValues =
+			m->Size.x > 0 && m->Size.y > 0
+				? (uint64_t)m->Size.x * (uint64_t)m->Size.y
+				: 0;
+		if (m->Type != MAPTYPE_STATIC ||
+			!ReadGrid(&r, &m->u.Static.Tiles, false, maxValues) ||
+			!ReadGrid(&r, &m->u.Static.Access, true, maxValues))
+		{
+			goto bail;
+		}
+	}
+	res = true;
+
+bail:
+	if (!res)
+	{
+		LOG(LM_MAP, LL_ERROR, "Cannot load compiled campaign missions");
+	}
+	json_free_value(&missionsNode);
+	return res;
+}
+
+static json_t *ReadJSON(const char *archive, const char *filename)
+{
+	char path[CDOGS_PATH_MAX];
+	sprintf(path, "%s/%s", archive, filename);
+	char *buf = ReadFileIntoBuf(path, "rb");
+	if (buf == NULL)
+	{
+		return NULL;
+	}
+	json_t *root = NULL;
+	if (json_parse_document(&root, buf) != JSON_OK)
+	{
+		LOG(LM_MAP, LL_ERROR, "Invalid syntax in JSON file (%s)", path);
+		root = NULL;
+	}
+	CFREE(buf);
+	return root;
+}
+static void WriteCampaign(CArray *b, json_t *root)
+{
+	int version = 0;
+	int numMissions = 0;
+	LoadInt(&version, root, "Version");
+	MapNewScanJSON(root, NULL, &numMissions);
+	// Note: don't use CampaignSettingInit as it needs the game data loaded
+	CampaignSetting c;
+	memset(&c, 0, sizeof c);
+	MapNewLoadCampaignJSON(root, &c);
+	WriteI32(b, version);
+	WriteI32(b, numMissions);
+	WriteStr(b, c.Title);
+	WriteStr(b, c.Author);
+	WriteStr(b, c.Description);
+	WriteU32(b, c.Ammo);
+	WriteU32(b, c.SkipWeaponMenu);
+	WriteU32(b, c.BuyAndSell);
+	WriteU32(b, c.RandomPickups);
+	WriteI32(b, c.DoorOpenTicks);
+	WriteI32(b, c.Lives);
+	WriteI32(b, c.MaxLives);
+	WriteI32(b, c.PlayerHP);
+	WriteI32(b, c.PlayerMaxHP);
+	WriteI32(b, c.PlayerExcessHP);
+	CFREE(c.Title);
+	CFREE(c.Author);
+	CFREE(c.Description);
+}
+// Parse the CSV row strings under label into ints
+static bool ParseCSVRows(CArray *values, const json_t *label)
+{
+	if (label == NULL || label->child == NULL)
+	{
+		return false;
+	}
+	for (const json_t *row = label->child->child; row; row = row->next)
+	{
+		const char *p = row->text;
+		while (p != NULL && *p != '\0')
+		{
+			char *end;
+			const int v = (int)strtol(p, &end, 10);
+			if (end == p)
+			{
+				return false;
+			}
+			CArrayPushBack(values, &v);
+			p = *end == ',' ? end + 1 : end;
+		}
+	}
+	return true;
+}
+static void WriteGrid(CArray *b, const CArray *values)
+{
+	uint32_t numRuns = 0;
+	for (size_t i = 0; i < values->size; i++)
+	{
+		if (i == 0 || *(const int *)CArrayGet(values, i) !=
+						  *(const int *)CArrayGet(values, i - 1))
+		{
+			numRuns++;
+		}
+	}
+	// Use whichever is smaller
+	const bool useRLE = numRuns * 8 < values->size * 4;
+	WriteU32(b, useRLE ? GRID_RLE : GRID_RAW);
+	WriteU32(b, (uint32_t)values->size);
+	WriteU32(b, useRLE ? numRuns : (uint32_t)values->size);
+	for (size_t i = 0; i < values->size;)
+	{
+		const int v = *(const int *)CArrayGet(values, i);
+		size_t j = i + 1;
+		if (useRLE)
+		{
+			while (j < values->size && *(const int *)CArrayGet(values, j) == v)
+			{
+				j++;
+			}
+			WriteU32(b, (uint32_t)(j - i));
+		}
+		WriteI32(b, v);
+		i = j;
+	}
+}
+static bool WriteMissions(
+	CArray *missions, CArray *grids, json_t *root, const int version)
+{
+	const json_t *missionsNode = json_find_first_label(root, "Missions");
+	if (missionsNode == NULL || missionsNode->child == NULL)
+	{
+		return false;
+	}
+	uint32_t numMissions = 0;
+	for (const json_t *m = missionsNode->child->child; m; m = m->next)
+	{
+		numMissions++;
+	}
+	WriteU32(missions, numMissions);
+	WriteU32(grids, numMissions);
+	bool res = true;
+	CArray tiles, access;
+	CArrayInit(&tiles, sizeof(int));
+	CArrayInit(&access, sizeof(int));
+	for (json_t *m = missionsNode->child->child; m && res; m = m->next)
+	{
+		// Older formats have tiles in other forms; leave them in the JSON
+		json_t *tilesNode = json_find_first_label(m, "Tiles");
+		json_t *accessNode = json_find_first_label(m, "Access");
+		CArrayClear(&tiles);
+		CArrayClear(&access);
+		// Grids larger than the mission would be rejected by the loader
+		int width = 0, height = 0;
+		LoadInt(&width, m, "Width");
+		LoadInt(&height, m, "Height");
+		const size_t maxValues =
+			width > 0 && height > 0 ? (size_t)width * (size_t)height : 0;
+		const bool hasGrids = version > 14 && tilesNode != NULL &&
+							  accessNode != NULL &&
+							  ParseCSVRows(&tiles, tilesNode) &&
+							  ParseCSVRows(&access, accessNode) &&
+							  tiles.size <= maxValues &&
+							  access.size <= maxValues;
+		WriteU32(grids, hasGrids);
+		if (hasGrids)
+		{
+			WriteGrid(grids, &tiles);
+			WriteGrid(grids, &access);
+			json_free_value(&tilesNode);
+			json_free_value(&accessNode);
+		}
+		char *text = NULL;
+		if (json_tree_to_string(m, &text) != JSON_OK)
+		{
+			res = false;
+		}
+		WriteStr(missions, text);
+		CFREE(text);
+	}
+	CArrayTerminate(&tiles);
+	CArrayTerminate(&access);
+	return res;
+}
+bool MapCompiledSave(const char *archive)
+{
+	bool res = false;
+	json_t *campaignRoot = ReadJSON(archive, "campaign.json");
+	json_t *missionsRoot = ReadJSON(archive, "missions.json");
+	CArray sections[NUM_SECTIONS];
+	const uint32_t ids[NUM_SECTIONS] = {
+		SECTION_SOURCES, SECTION_CAMPAIGN, SECTION_MISSIONS, SECTION_GRIDS};
+	for (int i = 0; i < NUM_SECTIONS; i++)
+	{
+		CArrayInit(&sections[i], sizeof(uint8_t));
+	}
+	CArray out;
+	CArrayInit(&out, sizeof(uint8_t));
+	FILE *f = NULL;
+	char path[CDOGS_PATH_MAX];
+	sprintf(path, "%s/%s", archive, MAP_COMPILED_FILE);
+	char tmpPath[CDOGS_PATH_MAX];
+	sprintf(tmpPath, "%s.tmp", path);
+
+	int version = 0;
+	if (campaignRoot == NULL || missionsRoot == NULL ||
+		MapNewScanJSON(campaignRoot, NULL, NULL) != 0)
+	{
+		LOG(LM_MAP, LL_ERROR, "Cannot compile campaign %s", archive);
+		goto bail;
+	}
+	LoadInt(&version, campaignRoot, "Version");
+
+	uint64_t stats[NUM_SOURCES * 2];
+	if (!StatSources(stats, archive))
+	{
+		goto bail;
+	}
+	for (size_t i = 0; i < NUM_SOURCES * 2; i++)
+	{
+		WriteU64(&sections[0], stats[i]);
+	}
+	WriteCampaign(&sections[1], campaignRoot);
+	if (!WriteMissions(&sections[2], &sections[3], missionsRoot, version))
+	{
+		LOG(LM_MAP, LL_ERROR, "Cannot compile missions in %s", archive);
+		goto bail;
+	}
+
+	WriteU32(&out, MAP_COMPILED_MAGIC);
+	WriteU32(&out, MAP_COMPILED_VERSION);
+	WriteU32(&out, NUM_SECTIONS);
+	uint32_t offset = (3 + NUM_SECTIONS * 3) * 4;
+	for (int i = 0; i < NUM_SECTIONS; i++)
+	{
+		WriteU32(&out, ids[i]);
+		WriteU32(&out, offset);
+		WriteU32(&out, (uint32_t)sections[i].size);
+		offset += ((uint32_t)sections[i].size + 3) & ~3u;
+	}
+	for (int i = 0; i < NUM_SECTIONS; i++)
+	{
+		WriteBytes(&out, sections[i].data, sections[i].size);
+		const uint8_t pad[3] = {0, 0, 0};
+		WriteBytes(&out, pad, (4 - sections[i].size % 4) % 4);
+	}
+
+	f = fopen(tmpPath, "wb");
+	if (f == NULL)
+	{
+		LOG(LM_MAP, LL_ERROR, "Cannot write %s", tmpPath);
+		goto bail;
+	}
+	const bool written = fwrite(out.data, 1, out.size, f) == out.size;
+	fclose(f);
+	f = NULL;
+	remove(path);
+	if (!written || rename(tmpPath, path) != 0)
+	{
+		LOG(LM_MAP, LL_ERROR, "Cannot write %s", path);
+		remove(tmpPath);
+		goto bail;
+	}
+	LOG(LM_MAP, LL_INFO, "Compiled campaign %s (%d bytes)", path,
+		(int)out.size);
+	res = true;
+
+bail:
+	json_free_value(&campaignRoot);
+	json_free_value(&missionsRoot);
+	for (int i = 0; i < NUM_SECTIONS; i++)
+	{
+		CArrayTerminate(&sections[i]);
+	}
+	CArrayTerminate(&out);
+	return res;
+}
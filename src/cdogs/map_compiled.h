@@ -0,0 +1,73 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "c_array.h"
+#include "campaigns.h"
+#include "files.h"
+
+// Optional compiled form of a campaign archive, stored alongside the JSON
+// files inside the .cdogscpn dir
+// It is sectioned and little-endian; static mission tiles and access are
+// stored as raw or run-length encoded int grids instead of CSV strings, and
+// the campaign header can be read without building a JSON DOM.
+// The file records the sizes and modification times of the JSON it was
+// compiled from and is ignored if those have changed.
+#define MAP_COMPILED_FILE "campaign.bin"
+
+typedef struct
+{
+	FileMapping file;
+	// Sections; pointers into file
+	const uint8_t *sources;
+	size_t sourcesSize;
+	const uint8_t *campaign;
+	size_t campaignSize;
+	const uint8_t *missions;
+	size_t missionsSize;
+	const uint8_t *grids;
+	size_t gridsSize;
+} MapCompiled;
+
+// Returns false if the archive has no compiled file, or it is invalid or
+// out of date with the archive's JSON
+bool MapCompiledOpen(MapCompiled *mc, const char *archive);
+void MapCompiledClose(MapCompiled *mc);
+
+bool MapCompiledScan(const MapCompiled *mc, char **title, int *numMissions);
+bool MapCompiledLoadCampaign(
+	const MapCompiled *mc, CampaignSetting *c, int *version);
+bool MapCompiledLoadMissions(
+	const MapCompiled *mc, CArray *missions, const int version);
+
+// Compile the archive's campaign.json and missions.json into its
+// MAP_COMPILED_FILE
+bool MapCompiledSave(const char *archive);
@@ -139,10 +139,6 @@ static void AddPillars(
 static void AddRoomWalls(MapBuilder *mb, const CArray *areas);
 void MapInteriorLoad(MapBuilder *mb, const int missionIndex)
 {
-	// TODO: multiple tile types
-	MissionSetupTileClasses(
-		mb->Map, &gPicManager, &mb->mission->u.Interior.TileClasses);
-
 	CArray areas;
 	CArrayInit(&areas, sizeof(BSPArea));
 	BSPArea a = BSPAreaRoot(mb->Map->Size);
@@ -198,11 +194,11 @@ void MapInteriorLoad(MapBuilder *mb, const int missionIndex)
 }
 
 static bool BSPAreaTrySplit(
-	const CArray *areas, const bool horizontal, const int idx,
+	MapBuilder *mb, const CArray *areas, const bool horizontal, const int idx,
 	const int minSize, BSPArea *r1, BSPArea *r2);
 static void SplitAreas(MapBuilder *mb, CArray *areas)
 {
-	const int hcount = RAND_INT(0, 2);
+	const int hcount = PRNGInt(&mb->rand, 0, 2);
 
 	// Need to allow at least one split
 	const int minSize =
@@ -214,7 +210,8 @@ static void SplitAreas(MapBuilder *mb, CArray *areas)
 	const bool horizontal = ((hcount + a->level) % 2) == 1;
 	BSPArea a1 = BSPAreaRoot(svec2i_zero());
 	BSPArea a2 = BSPAreaRoot(svec2i_zero());
-	if (BSPAreaTrySplit(areas, horizontal, _ca_index, minSize, &a1, &a2))
+	if (BSPAreaTrySplit(
+			mb, areas, horizontal, _ca_index, minSize, &a1, &a2))
 	{
 		// Resize rooms to allow space for street
 		for (int i = 0; i < mb->mission->u.Interior.CorridorWidth; i++)
@@ -269,7 +266,7 @@ static void SplitAreas(MapBuilder *mb, CArray *areas)
 	CA_FOREACH_END()
 }
 static bool BSPAreaTrySplit(
-	const CArray *areas, const bool horizontal, const int idx,
+	MapBuilder *mb, const CArray *areas, const bool horizontal, const int idx,
 	const int minSize, BSPArea *a1, BSPArea *a2)
 {
 	const BSPArea *area = CArrayGet(areas, idx);
@@ -286,7 +283,7 @@ static bool BSPAreaTrySplit(
 	if (horizontal)
 	{
 		// Left/right children
-		const int x = RAND_INT(0, r) + minSize;
+		const int x = PRNGInt(&mb->rand, 0, r) + minSize;
 		a1->r = Rect2iNew(area->r.Pos, svec2i(x, area->r.Size.y));
 		a2->r = Rect2iNew(
 			svec2i(area->r.Pos.x + x, area->r.Pos.y),
@@ -295,7 +292,7 @@ static bool BSPAreaTrySplit(
 	else
 	{
 		// Top/bottom children
-		const int y = RAND_INT(0, r) + minSize;
+		const int y = PRNGInt(&mb->rand, 0, r) + minSize;
 		a1->r = Rect2iNew(area->r.Pos, svec2i(area->r.Size.x, y));
 		a2->r = Rect2iNew(
 			svec2i(area->r.Pos.x, area->r.Pos.y + y),
@@ -321,8 +318,8 @@ static void SplitLeafRooms(MapBuilder *mb, CArray *areas)
 	BSPArea a1 = BSPAreaRoot(svec2i_zero());
 	BSPArea a2 = BSPAreaRoot(svec2i_zero());
 	if (BSPAreaTrySplit(
-			areas, horizontal, _ca_index, mb->mission->u.Interior.Rooms.Min,
-			&a1, &a2))
+			mb, areas, horizontal, _ca_index,
+			mb->mission->u.Interior.Rooms.Min, &a1, &a2))
 	{
 		// Resize rooms so they share a splitting wall
 		if (a1.horizontal)
@@ -816,7 +813,8 @@ static void PlaceKeys(
 	while (lockedRoomCandidates.size > KEY_COUNT)
 	{
 		CArrayDelete(
-			&lockedRoomCandidates, RAND_INT(0, lockedRoomCandidates.size));
+			&lockedRoomCandidates,
+			PRNGInt(&mb->rand, 0, (int)lockedRoomCandidates.size));
 	}
 
 	CA_FOREACH(const int, idx, lockedRoomCandidates)
@@ -861,7 +859,7 @@ static void PlaceKeys(
 	// Place key in a child room before the locked corridor, but far away
 	CArray furthestChildren =
 		FindRoomsFurthestFromCriticalPath(areas, am, dCriticalPath, *idx);
-	CArrayShuffle(&furthestChildren);
+	CArrayShuffle(&furthestChildren, &mb->rand);
 	CASSERT(furthestChildren.size > 0, "Cannot find child for locked street");
 
 	const int child = *(int *)CArrayGet(&furthestChildren, 0);
@@ -913,7 +911,7 @@ static void AddLockedRooms(
 	{
 		continue;
 	}
-	if (RAND_BOOL())
+	if (PRNGBool(&mb->rand))
 	{
 		const BSPArea *room = CArrayGet(areas, *idx);
 		MapSetRoomAccessMask(
@@ -933,7 +931,7 @@ static void PlaceKey(
 	BSPArea *room = CArrayGet(areas, idx);
 	const struct vec2i keyPos =
 		svec2i_add(room->r.Pos, svec2i_divide(room->r.Size, svec2i(2, 2)));
-	MapPlaceKey(mb, keyPos, keyIndex);
+	MapBuilderAddKey(mb, keyPos, keyIndex);
 	// Prevent items being placed over the key
 	MapBuilderSetLeaveFree(mb, keyPos, true);
 	// Add room to critical path to avoid room walls here
@@ -1000,7 +998,7 @@ static void AddPillars(
 		{
 			break;
 		}
-		CArrayShuffle(&allChildren);
+		CArrayShuffle(&allChildren, &mb->rand);
 		CA_FOREACH(const int, idx, allChildren)
 		if (count == mb->mission->u.Interior.Pillars.Count)
 		{
@@ -48,6 +48,7 @@
 */
 #include "map_object.h"
 
+#include "json_stream.h"
 #include "json_utils.h"
 #include "log.h"
 #include "map.h"
@@ -194,7 +195,7 @@ int DestructibleMapObjectIndex(const MapObject *mo)
 }
 const MapObject *GetRandomBloodPool(void)
 {
-	const int idx = rand() % (int)gMapObjects.Bloods.size;
+	const int idx = RandInt(RNG_FX, 0, (int)gMapObjects.Bloods.size);
 	const char **name = CArrayGet(&gMapObjects.Bloods, idx);
 	return StrMapObject(*name);
 }
@@ -230,51 +231,96 @@ void MapObjectsInit(
 
 	char buf[CDOGS_PATH_MAX];
 	GetDataFilePath(buf, filename);
-	FILE *f = fopen(buf, "r");
-	json_t *root = NULL;
-	if (f == NULL)
+	if (!MapObjectsLoadFile(&classes->Classes, buf))
 	{
 		LOG(LM_MAIN, LL_ERROR, "Error: cannot load map objects file %s", buf);
-		goto bail;
-	}
-	enum json_error e = json_stream_parse(f, &root);
-	if (e != JSON_OK)
-	{
-		LOG(LM_MAIN, LL_ERROR, "Error parsing map objects file %s", buf);
-		goto bail;
+		return;
 	}
-	MapObjectsLoadJSON(&classes->Classes, root);
 
 	// Load initial ammo/weapon spawners
 	MapObjectsLoadAmmoAndGunSpawners(classes, ammo, guns, false);
+}
 
-bail:
-	if (f != NULL)
+// Map object being streamed, with its nested and version-dependent fields
+typedef struct
+{
+	MapObject m;
+	json_t *node;
+} MapObjectLoad;
+static const JSONField mapObjectFields[] = {
+	JSON_FIELD("Name", JSON_FIELD_STRING, MapObjectLoad, m.Name),
+	JSON_FIELD("Health", JSON_FIELD_INT, MapObjectLoad, m.Health),
+	JSON_FIELD("DrawBelow", JSON_FIELD_BOOL, MapObjectLoad, m.DrawBelow),
+	JSON_FIELD("DrawAbove", JSON_FIELD_BOOL, MapObjectLoad, m.DrawAbove),
+	JSON_FIELD(
+		"FootstepSound", JSON_FIELD_STRING, MapObjectLoad, m.FootstepSound),
+	JSON_FIELD(
+		"FootprintMask", JSON_FIELD_COLOR, MapObjectLoad, m.FootprintMask),
+	// Loaded by TryLoadMapObject
+	JSON_FIELD("Pic", JSON_FIELD_NODE, MapObjectLoad, node),
+	JSON_FIELD("Offset", JSON_FIELD_NODE, MapObjectLoad, node),
+	JSON_FIELD("WreckPic", JSON_FIELD_NODE, MapObjectLoad, node),
+	JSON_FIELD("Wreck", JSON_FIELD_NODE, MapObjectLoad, node),
+	JSON_FIELD("Size", JSON_FIELD_NODE, MapObjectLoad, node),
+	JSON_FIELD("PosOffset", JSON_FIELD_NODE, MapObjectLoad, node),
+	JSON_FIELD("DestroyGuns", JSON_FIELD_NODE, MapObjectLoad, node),
+	JSON_FIELD("Flags", JSON_FIELD_NODE, MapObjectLoad, node),
+	JSON_FIELD("Type", JSON_FIELD_NODE, MapObjectLoad, node),
+	JSON_FIELD("Pickup", JSON_FIELD_NODE, MapObjectLoad, node),
+	JSON_FIELD("CharId", JSON_FIELD_NODE, MapObjectLoad, node),
+	JSON_FIELD("Counter", JSON_FIELD_NODE, MapObjectLoad, node),
+	JSON_FIELD("DestroySpawn", JSON_FIELD_NODE, MapObjectLoad, node),
+	JSON_FIELD("DamageSmoke", JSON_FIELD_NODE, MapObjectLoad, node),
+	JSON_FIELDS_END};
+static void MapObjectFree(MapObject *m);
+static bool TryLoadMapObject(MapObject *m, json_t *node, const int version);
+static void MapObjectLoadAdd(void *data, const int version, void *classes)
+{
+	MapObjectLoad *l = data;
+	if (l->node == NULL)
+	{
+		l->node = json_new_object();
+	}
+	if (TryLoadMapObject(&l->m, l->node, version))
+	{
+		CArrayPushBack(classes, &l->m);
+	}
+	else
 	{
-		fclose(f);
+		MapObjectFree(&l->m);
 	}
-	json_free_value(&root);
+	json_free_value(&l->node);
+}
+static void MapObjectLoadTerminate(void *data)
+{
+	MapObjectLoad *l = data;
+	MapObjectFree(&l->m);
+	json_free_value(&l->node);
 }
-static bool TryLoadMapObject(MapObject *m, json_t *node, const int version);
 static void ReloadDestructibles(MapObjects *mo);
-void MapObjectsLoadJSON(CArray *classes, json_t *root)
+bool MapObjectsLoadFile(CArray *classes, const char *path)
 {
-	int version;
-	LoadInt(&version, root, "Version");
-	if (version > VERSION || version <= 0)
+	FILE *f = fopen(path, "r");
+	if (f == NULL)
 	{
-		CASSERT(false, "cannot read map objects file version");
-		return;
+		return false;
 	}
-
-	json_t *pickupsNode = json_find_first_label(root, "MapObjects")->child;
-	for (json_t *child = pickupsNode->child; child; child = child->next)
+	const JSONClassSchema schema = {
+		"MapObjects",
+		mapObjectFields,
+		sizeof(MapObjectLoad),
+		VERSION,
+		NULL,
+		MapObjectLoadAdd,
+		MapObjectLoadTerminate,
+		classes,
+		NULL,
+		NULL};
+	const int version = JSONStreamLoadClasses(&schema, f);
+	fclose(f);
+	if (version <= 0)
 	{
-		MapObject m;
-		if (TryLoadMapObject(&m, child, version))
-		{
-			CArrayPushBack(classes, &m);
-		}
+		return false;
 	}
 
 	ReloadDestructibles(&gMapObjects);
@@ -292,13 +338,13 @@ void MapObjectsLoadJSON(CArray *classes, json_t *root)
 		CSTRDUP(tmp, buf);
 		CArrayPushBack(&gMapObjects.Bloods, &tmp);
 	}
+	return true;
 }
+// Load the fields captured in the map object's node, once the version is
+// known
 static bool TryLoadMapObject(MapObject *m, json_t *node, const int version)
 {
 	char *tmp = NULL;
-	memset(m, 0, sizeof *m);
-
-	m->Name = GetString(node, "Name");
 
 	// Pic
 	json_t *normalNode = json_find_first_label(node, "Pic");
@@ -378,7 +424,6 @@ static bool TryLoadMapObject(MapObject *m, json_t *node, const int version)
 	m->Size = TILE_SIZE;
 	LoadVec2i(&m->Size, node, "Size");
 	LoadVec2(&m->PosOffset, node, "PosOffset");
-	LoadInt(&m->Health, node, "Health");
 	LoadBulletGuns(&m->DestroyGuns, node, "DestroyGuns");
 
 	// Flags
@@ -392,12 +437,6 @@ static bool TryLoadMapObject(MapObject *m, json_t *node, const int version)
 		}
 	}
 
-	LoadBool(&m->DrawBelow, node, "DrawBelow");
-	LoadBool(&m->DrawAbove, node, "DrawAbove");
-
-	LoadStr(&m->FootstepSound, node, "FootstepSound");
-	LoadColor(&m->FootprintMask, node, "FootprintMask");
-
 	// Special types
 	JSON_UTILS_LOAD_ENUM(m->Type, node, "Type", StrMapObjectType);
 	switch (m->Type)
@@ -561,17 +600,20 @@ void MapObjectsClear(CArray *classes)
 {
 	for (int i = 0; i < (int)classes->size; i++)
 	{
-		MapObject *c = CArrayGet(classes, i);
-		CFREE(c->Name);
-		CFREE(c->Wreck.MO);
-		CFREE(c->Wreck.Bullet);
-		CFREE(c->FootstepSound);
-		CFREE(c->DamageSmoke.ParticleClass);
-		CArrayTerminate(&c->DestroyGuns);
-		CArrayTerminate(&c->DestroySpawn);
+		MapObjectFree(CArrayGet(classes, i));
 	}
 	CArrayClear(classes);
 }
+static void MapObjectFree(MapObject *m)
+{
+	CFREE(m->Name);
+	CFREE(m->Wreck.MO);
+	CFREE(m->Wreck.Bullet);
+	CFREE(m->FootstepSound);
+	CFREE(m->DamageSmoke.ParticleClass);
+	CArrayTerminate(&m->DestroyGuns);
+	CArrayTerminate(&m->DestroySpawn);
+}
 void MapObjectsTerminate(MapObjects *classes)
 {
 	MapObjectsClear(&classes->Classes);
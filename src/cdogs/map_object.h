@@ -150,7 +150,7 @@ int MapObjectGetFlags(const MapObject *mo);
 void MapObjectsInit(
 	MapObjects *classes, const char *filename, const AmmoClasses *ammo,
 	const WeaponClasses *guns);
-void MapObjectsLoadJSON(CArray *classes, json_t *root);
+bool MapObjectsLoadFile(CArray *classes, const char *path);
 void MapObjectsLoadAmmoAndGunSpawners(
 	MapObjects *classes, const AmmoClasses *ammo, const WeaponClasses *guns,
 	const bool isCustom);
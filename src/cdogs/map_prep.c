@@ -0,0 +1,126 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "map_prep.h"
+
+#include "log.h"
+
+MapPrep gMapPrep;
+
+static int ToMs(const Uint64 ticks)
+{
+	return (int)(ticks * 1000 / SDL_GetPerformanceFrequency());
+}
+
+static int PrepThread(void *data)
+{
+	MapPrep *p = data;
+	// Note: no logging from this thread
+	const Uint64 start = SDL_GetPerformanceCounter();
+	MapBuildLayout(&p->mb, p->missionIndex);
+	p->elapsed = SDL_GetPerformanceCounter() - start;
+	return 0;
+}
+void MapPrepStart(
+	MapPrep *p, const Campaign *co, const struct MissionOptions *mo)
+{
+	MapPrepCancel(p);
+	if (mo->missionData == NULL)
+	{
+		return;
+	}
+	p->mission = mo->missionData;
+	p->missionIndex = mo->index;
+	p->mode = co->Entry.Mode;
+	p->seed = CampaignGetRandomSeed(co);
+	p->elapsed = 0;
+	MapLayoutInit(&p->layout, p->mission->Size);
+	MapBuilderInit(
+		&p->mb, &p->layout, p->mission, p->mode, &co->Setting.characters);
+	// Start from RNG_MAP as seeded by CampaignSeedRandom, without reseeding
+	// the stream itself
+	PRNGSeedStream(&p->mb.rand, RNG_MAP, (uint64_t)p->seed);
+	p->thread = SDL_CreateThread(PrepThread, "MapPrep", p);
+	if (p->thread == NULL)
+	{
+		LOG(LM_MAP, LL_WARN, "Cannot create map prep thread: %s",
+			SDL_GetError());
+		MapPrepCancel(p);
+	}
+}
+
+void MapPrepCancel(MapPrep *p)
+{
+	if (p->thread != NULL)
+	{
+		SDL_WaitThread(p->thread, NULL);
+		p->thread = NULL;
+	}
+	if (p->mission != NULL)
+	{
+		MapBuilderTerminate(&p->mb);
+		MapLayoutTerminate(&p->layout);
+		p->mission = NULL;
+	}
+}
+
+void MapPrepBuild(
+	MapPrep *p, Map *m, const Campaign *co, const struct MissionOptions *mo,
+	const bool loadDynamic)
+{
+	Uint64 start = SDL_GetPerformanceCounter();
+	if (p->thread != NULL)
+	{
+		SDL_WaitThread(p->thread, NULL);
+		p->thread = NULL;
+	}
+	const Uint64 waited = SDL_GetPerformanceCounter() - start;
+
+	CampaignSeedRandom(co);
+	const bool isPrepared =
+		p->mission != NULL && p->mission == mo->missionData &&
+		p->missionIndex == mo->index && p->mode == co->Entry.Mode &&
+		p->seed == CampaignGetRandomSeed(co);
+	start = SDL_GetPerformanceCounter();
+	if (isPrepared)
+	{
+		MapBuildCommit(&p->mb, m, loadDynamic, mo->index);
+		LOG(LM_MAP, LL_INFO,
+			"Map layout prepared in %dms (waited %dms), committed in %dms",
+			ToMs(p->elapsed), ToMs(waited),
+			ToMs(SDL_GetPerformanceCounter() - start));
+	}
+	else
+	{
+		MapBuild(
+			m, mo->missionData, loadDynamic, mo->index, co->Entry.Mode,
+			&co->Setting.characters);
+		LOG(LM_MAP, LL_INFO, "Map built in %dms (not prepared)",
+			ToMs(SDL_GetPerformanceCounter() - start));
+	}
+	MapPrepCancel(p);
+}
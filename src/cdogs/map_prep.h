@@ -0,0 +1,63 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <SDL.h>
+
+#include "campaigns.h"
+#include "map_build.h"
+
+// Generates a mission's map layout on a worker thread, e.g. while the players
+// are on the briefing and equip screens, so that starting the mission only
+// needs the (short) commit phase of MapBuild
+// Note: while the worker is running it reads the mission, so cancel it before
+// changing it
+typedef struct
+{
+	SDL_Thread *thread;
+	// Layouts are only reused for the same mission, mode and seed
+	const Mission *mission;
+	int missionIndex;
+	GameMode mode;
+	int seed;
+	Map layout;
+	MapBuilder mb;
+	Uint64 elapsed;
+} MapPrep;
+
+extern MapPrep gMapPrep;
+
+void MapPrepStart(
+	MapPrep *p, const Campaign *co, const struct MissionOptions *mo);
+// Wait for any layout in progress and discard it
+void MapPrepCancel(MapPrep *p);
+// Seed the random streams and build the mission's map, using the prepared
+// layout if there is a matching one, otherwise building it from scratch
+void MapPrepBuild(
+	MapPrep *p, Map *m, const Campaign *co, const struct MissionOptions *mo,
+	const bool loadDynamic);
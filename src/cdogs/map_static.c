@@ -37,14 +37,17 @@
 #include "map_build.h"
 #include "net_util.h"
 
-static int AddTileClass(any_t data, any_t item);
+static int SetTileClassStyleType(any_t data, any_t item);
 void MapStaticLoad(MapBuilder *mb)
 {
-	// Tile classes
-	if (hashmap_iterate(
-			mb->mission->u.Static.TileClasses, AddTileClass, mb->Map) != MAP_OK)
+	// Layout may run off the main thread, so work on a copy of the tile
+	// classes instead of writing to the mission's
+	mb->tileClasses = hashmap_copy(
+		mb->mission->u.Static.TileClasses, TileClassCopyHashMap);
+	if (hashmap_iterate(mb->tileClasses, SetTileClassStyleType, NULL) !=
+		MAP_OK)
 	{
-		CASSERT(false, "failed to add static tile classes");
+		CASSERT(false, "failed to set static tile classes");
 	}
 
 	// Tiles
@@ -57,12 +60,27 @@ void MapStaticLoad(MapBuilder *mb)
 	mb->Map->start = mb->mission->u.Static.Start;
 	CArrayCopy(&mb->Map->exits, &mb->mission->u.Static.Exits);
 }
-static int AddTileClass(any_t data, any_t item)
+static int SetTileClassStyleType(any_t data, any_t item)
 {
-	Map *m = data;
+	UNUSED(data);
 	TileClass *t = item;
 	// Attach base style to tile class for convenience in editors etc
+	CFREE(t->StyleType);
 	CSTRDUP(t->StyleType, TileClassBaseStyleType(t->Type));
+	return MAP_OK;
+}
+static int AddTileClass(any_t data, any_t item);
+void MapStaticSetupTileClasses(Map *m, const MapBuilder *mb)
+{
+	if (hashmap_iterate(mb->tileClasses, AddTileClass, m) != MAP_OK)
+	{
+		CASSERT(false, "failed to add static tile classes");
+	}
+}
+static int AddTileClass(any_t data, any_t item)
+{
+	Map *m = data;
+	const TileClass *t = item;
 	TileClassesAdd(
 		m->TileClasses, &gPicManager, t, t->Style, t->StyleType, t->Mask,
 		t->MaskAlt);
@@ -83,6 +101,30 @@ static int AddTileClass(any_t data, any_t item)
 	return MAP_OK;
 }
 
+static const TileClass *GetTileClass(
+	const MapBuilder *mb, const struct vec2i v)
+{
+	const MissionStatic *ms = &mb->mission->u.Static;
+	if (mb->tileClasses == NULL)
+	{
+		// Editor builders paint tiles straight from the mission
+		return MissionStaticGetTileClass(ms, mb->Map->Size, v);
+	}
+	const int tile = MissionStaticGetTile(ms, mb->Map->Size, v);
+	if (tile < 0)
+	{
+		return NULL;
+	}
+	char keyBuf[6];
+	sprintf(keyBuf, "%d", tile);
+	TileClass *tc = NULL;
+	const int error = hashmap_get(mb->tileClasses, keyBuf, (any_t)&tc);
+	if (error != MAP_OK && error != MAP_MISSING)
+	{
+		CASSERT(false, "error getting tile id");
+	}
+	return tc;
+}
 void MapStaticLoadTile(MapBuilder *mb, const struct vec2i v)
 {
 	if (!MapIsTileIn(mb->Map, v))
@@ -94,8 +136,7 @@ void MapStaticLoadTile(MapBuilder *mb, const struct vec2i v)
 	{
 		tileAccess = 0;
 	}
-	const TileClass *tc =
-		MissionStaticGetTileClass(&mb->mission->u.Static, mb->Map->Size, v);
+	const TileClass *tc = GetTileClass(mb, v);
 	MapBuilderSetTile(mb, v, tc);
 	MapBuildSetAccess(mb, v, tileAccess);
 }
@@ -192,7 +233,7 @@ static void AddObjective(MapBuilder *mb, const ObjectivePositions *op)
 	}
 	break;
 	case OBJECTIVE_COLLECT:
-		MapPlaceCollectible(mb->mission, op->Index, pos);
+		MapPlaceCollectible(mb, op->Index, pos);
 		break;
 	case OBJECTIVE_DESTROY:
 		MapTryPlaceDestroyObject(mb, mb->mission, op->Index, pi->Position, false);
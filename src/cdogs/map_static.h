@@ -30,5 +30,7 @@
 #include "map_build.h"
 
 void MapStaticLoad(MapBuilder *mb);
+// Add the mission's tile classes and their textures to the map
+void MapStaticSetupTileClasses(Map *m, const MapBuilder *mb);
 void MapStaticLoadTile(MapBuilder *mb, const struct vec2i v);
 void MapStaticLoadDynamic(MapBuilder *mb);
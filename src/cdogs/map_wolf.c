@@ -28,13 +28,18 @@
 #include "map_wolf.h"
 
 #include <find_steam_game.h>
+#include <tinydir/tinydir.h>
 
 #include "log.h"
 
 #include "actors.h"
 #include "cwolfmap/audio.h"
 #include "cwolfmap/cwolfmap.h"
+#include "files.h"
+#include "job_system.h"
+#include "json_utils.h"
 #include "map_archive.h"
+#include "map_new.h"
 #include "player_template.h"
 
 CWolfMap *defaultWolfMap = NULL;
@@ -48,6 +53,8 @@ CWolfMap *defaultSpearMap = NULL;
 #define SPEAR_GOG_ID "1441705126"
 #define N3D_GOG_ID "1672565562"
 #define WOLF_DATA_DIR "data/.wolf3d/"
+// Converted missions and rendered audio are cached here, in the config dir
+#define WOLF_CACHE_DIR "wolf_cache"
 
 #define TILE_CLASS_WALL_OFFSET 63
 
@@ -58,7 +65,7 @@ typedef struct
 	CArray indices;
 	int idx;
 } IdxShuffler;
-static void IdxShufflerInit(IdxShuffler *s, const int n)
+static void IdxShufflerInit(IdxShuffler *s, const int n, PRNG *r)
 {
 	CArrayInit(&s->indices, sizeof(int));
 	s->idx = 0;
@@ -66,7 +73,7 @@ static void IdxShufflerInit(IdxShuffler *s, const int n)
 	{
 		CArrayPushBack(&s->indices, &i);
 	}
-	CArrayShuffle(&s->indices);
+	CArrayShuffle(&s->indices, r);
 }
 static int IdxShufflerDraw(IdxShuffler *s)
 {
@@ -87,7 +94,8 @@ void MapWolfInit(void)
 {
 	defaultWolfMap = NULL;
 	defaultSpearMap = NULL;
-	if (!CWAudioInit())
+	// Sounds are rendered in parallel; one OPL chip per job thread
+	if (!CWAudioInit(JOB_SYSTEM_MAX_WORKERS + 1))
 	{
 		CASSERT(false, "failed to init wolf audio!");
 	}
@@ -554,21 +562,169 @@ static const CWSongType songsCampaign[] = {
 	SONG_ROSTER,  // lose
 	SONG_VICTORY, // victory
 };
+static uint64_t HashParams(uint64_t key, const int *params, const int n)
+{
+	for (int i = 0; i < n; i++)
+	{
+		key = (key ^ (uint64_t)params[i]) * 1099511628211ULL;
+	}
+	return key;
+}
+
+// Rendered adlib sounds and music are cached, keyed by a hash of the audio
+// data, as rendering them through the OPL emulator is slow
+// The samples are stored in native byte order
+#define WOLF_PCM_CACHE_MAGIC 0x4d435043 // "CPCM"
+// Bump this when changing the rendering, to invalidate cached audio
+#define WOLF_PCM_CACHE_VERSION 1
+static void GetAudioCachePath(
+	char *buf, const CWolfMap *map, const char *name)
+{
+	const int params[] = {
+		WOLF_PCM_CACHE_VERSION, MUSIC_SAMPLE_RATE, MUSIC_AUDIO_CHANNELS,
+		(int)map->type};
+	const uint64_t key = HashParams(
+		map->audio.hash, params, (int)(sizeof params / sizeof params[0]));
+	sprintf(
+		buf, "%s/%016llx_%016llx_%s.pcm", GetConfigFilePath(WOLF_CACHE_DIR),
+		(unsigned long long)map->audio.hash, (unsigned long long)key, name);
+}
+// Cache files are named <data hash>_<key>_<name>, where the key covers how
+// the data was converted; when writing one, remove those for the same data
+// under other keys, as they were made by other versions and won't be read
+#define CACHE_HASH_LEN 17 // 16 hex digits and a separator
+static void EvictStaleCache(const char *path)
+{
+	const char *name = PathGetBasename(path);
+	tinydir_dir dir;
+	if (tinydir_open(&dir, GetConfigFilePath(WOLF_CACHE_DIR)) == -1)
+	{
+		return;
+	}
+	for (; dir.has_next; tinydir_next(&dir))
+	{
+		tinydir_file file;
+		if (tinydir_readfile(&dir, &file) == -1)
+		{
+			break;
+		}
+		if (!file.is_reg || strlen(file.name) < CACHE_HASH_LEN * 2 ||
+			strncmp(file.name, name, CACHE_HASH_LEN) != 0 ||
+			strncmp(file.name, name, CACHE_HASH_LEN * 2) == 0)
+		{
+			continue;
+		}
+		LOG(LM_MAP, LL_DEBUG, "removing stale cache %s", file.name);
+		remove(file.path);
+	}
+	tinydir_close(&dir);
+}
+// Read count buffers, which are stored back to back in the returned block
+// Returns NULL if there is no valid cache
+static char *ReadPCMCache(const char *path, const int count, size_t *lens)
+{
+	char *data = NULL;
+	uint32_t *header = NULL;
+	FILE *f = fopen(path, "rb");
+	if (f == NULL)
+	{
+		goto bail;
+	}
+	const size_t headerLen = 3 + (size_t)count;
+	CMALLOC(header, headerLen * sizeof *header);
+	if (fread(header, sizeof *header, headerLen, f) != headerLen ||
+		header[0] != WOLF_PCM_CACHE_MAGIC ||
+		header[1] != WOLF_PCM_CACHE_VERSION || header[2] != (uint32_t)count)
+	{
+		LOG(LM_MAP, LL_WARN, "invalid cached audio %s", path);
+		goto bail;
+	}
+	size_t total = 0;
+	for (int i = 0; i < count; i++)
+	{
+		lens[i] = header[3 + i];
+		total += lens[i];
+	}
+	CMALLOC(data, MAX(total, 1));
+	if (fread(data, 1, total, f) != total)
+	{
+		LOG(LM_MAP, LL_WARN, "invalid cached audio %s", path);
+		CFREE(data);
+		data = NULL;
+	}
+
+bail:
+	CFREE(header);
+	if (f != NULL)
+	{
+		fclose(f);
+	}
+	return data;
+}
+static void WritePCMCache(
+	const char *path, const char *const *data, const size_t *lens,
+	const int count)
+{
+	char dir[CDOGS_PATH_MAX];
+	strcpy(dir, GetConfigFilePath(WOLF_CACHE_DIR));
+	// Ignore errors; the dir may already exist
+	mkdir_deep(dir);
+	EvictStaleCache(path);
+	FILE *f = fopen(path, "wb");
+	if (f == NULL)
+	{
+		LOG(LM_MAP, LL_WARN, "failed to cache audio %s", path);
+		return;
+	}
+	const uint32_t header[] = {
+		WOLF_PCM_CACHE_MAGIC, WOLF_PCM_CACHE_VERSION, (uint32_t)count};
+	bool ok = fwrite(header, sizeof header, 1, f) == 1;
+	for (int i = 0; i < count; i++)
+	{
+		const uint32_t len = (uint32_t)lens[i];
+		ok = ok && fwrite(&len, sizeof len, 1, f) == 1;
+	}
+	for (int i = 0; i < count; i++)
+	{
+		ok = ok && fwrite(data[i], 1, lens[i], f) == lens[i];
+	}
+	fclose(f);
+	if (!ok)
+	{
+		LOG(LM_MAP, LL_WARN, "failed to cache audio %s", path);
+		remove(path);
+	}
+}
+
 static bool LoadMusic(CWolfMap *map, MusicChunk *chunk, const int i)
 {
 	char *data;
 	size_t len;
-	const int err = CWAudioGetMusic(&map->audio, map->type, i, &data, &len);
-	if (err != 0)
-	{
-		return false;
-	}
 	if (map->type == CWMAPTYPE_N3D)
 	{
+		// N3D music is MIDI, which SDL_mixer plays directly
+		if (CWAudioGetMusic(&map->audio, map->type, 0, i, &data, &len) != 0)
+		{
+			return false;
+		}
 		SDL_RWops *rwops = SDL_RWFromMem(data, (int)len);
 		chunk->u.Music = Mix_LoadMUS_RW(rwops, 1);
 		return true;
 	}
+	char path[CDOGS_PATH_MAX];
+	char name[32];
+	sprintf(name, "music%d", i);
+	GetAudioCachePath(path, map, name);
+	data = ReadPCMCache(path, 1, &len);
+	if (data == NULL)
+	{
+		// Music is only loaded on the main thread, so use its chip
+		if (CWAudioGetMusic(&map->audio, map->type, 0, i, &data, &len) != 0)
+		{
+			return false;
+		}
+		WritePCMCache(path, (const char *const *)&data, &len, 1);
+	}
 	chunk->u.Chunk = Mix_QuickLoad_RAW((Uint8 *)data, (Uint32)len);
 	return false;
 }
@@ -673,8 +829,7 @@ int MapWolfScan(
 		*numMissions = 0;
 		for (int i = 0; i < map.nLevels; i++)
 		{
-			const CWLevel *level = &map.levels[i];
-			if (level->hasPlayerSpawn)
+			if (CWLevelHasPlayerSpawn(&map, i))
 			{
 				(*numMissions)++;
 			}
@@ -717,12 +872,47 @@ bail:
 	return err;
 }
 
-static void LoadSounds(const SoundDevice *s, const CWolfMap *map);
+// Levels are only converted into missions when they are first used, as
+// converting them all makes loading the campaign slow
+// Converted missions are also cached in the config dir, keyed by a hash of
+// the level data
+typedef struct
+{
+	CWolfMap Map;
+	int SpearMission;
+	int NumMissions;
+	map_t TileClasses;
+	// Scrolls are dealt out over the levels in order; each level starts
+	// drawing where the previous ones left off, so the quiz a level gets
+	// doesn't depend on which levels were converted first
+	IdxShuffler ScrollShuffler;
+	CArray ScrollStarts; // of int, per level
+	CArray Converted;	 // of bool
+	uint64_t CacheKey;
+	// Sample data that the sound chunks point into
+	// VSWAP sounds with aliases share the same buffer
+	CArray SoundBuffers; // of char *
+} WolfCampaign;
+static void WolfCampaignTerminate(WolfCampaign *wc)
+{
+	CWFree(&wc->Map);
+	hashmap_destroy(wc->TileClasses, TileClassDestroy);
+	IdxShufflerTerminate(&wc->ScrollShuffler);
+	CArrayTerminate(&wc->ScrollStarts);
+	CArrayTerminate(&wc->Converted);
+	CA_FOREACH(char *, buf, wc->SoundBuffers)
+	CFREE(*buf);
+	CA_FOREACH_END()
+	CArrayTerminate(&wc->SoundBuffers);
+	CFREE(wc);
+}
+
+static void LoadSounds(const SoundDevice *s, WolfCampaign *wc);
 static void LoadN3DScrolls(const CWolfMap *map);
-static void LoadMission(
-	CampaignSetting *c, const map_t tileClasses, CWolfMap *map,
-	const int spearMission, const int missionIndex, const int numMissions,
-	IdxShuffler *scrollShuffler);
+static void AssignN3DScrolls(WolfCampaign *wc);
+static void LoadMissionStub(Mission *m, CWolfMap *map, const int missionIndex);
+static void LoadMissionOnDemand(void *data, Mission *m, const int idx);
+static uint64_t GetCacheKey(const WolfCampaign *wc);
 typedef struct
 {
 	CWolfMap *Map;
@@ -739,15 +929,17 @@ int MapWolfLoad(
 	const char *filename, const int spearMission, CampaignSetting *c)
 {
 	int err = 0;
-	CWolfMap *map = NULL;
-	CMALLOC(map, sizeof *map);
-	c->CustomData = map;
-	c->CustomDataTerminate = (void (*)(void *))CWFree;
-	map_t tileClasses = NULL;
+	WolfCampaign *wc;
+	CCALLOC(wc, sizeof *wc);
+	c->CustomData = wc;
+	c->CustomDataTerminate = (void (*)(void *))WolfCampaignTerminate;
+	CWolfMap *map = &wc->Map;
+	wc->SpearMission = spearMission;
+	CArrayInit(&wc->ScrollStarts, sizeof(int));
+	CArrayInit(&wc->Converted, sizeof(bool));
+	CArrayInit(&wc->SoundBuffers, sizeof(char *));
 	CharacterStore cs;
 	memset(&cs, 0, sizeof cs);
-	IdxShuffler scrollShuffler;
-	memset(&scrollShuffler, 0, sizeof scrollShuffler);
 
 	const bool loadedFromDefault = LoadDefault(map, filename);
 	err = CWLoad(map, filename, spearMission);
@@ -760,7 +952,7 @@ int MapWolfLoad(
 		goto bail;
 	}
 
-	LoadSounds(&gSoundDevice, map);
+	LoadSounds(&gSoundDevice, wc);
 	for (int i = 0; i < MUSIC_COUNT; i++)
 	{
 		CampaignSongData *csd;
@@ -803,7 +995,8 @@ int MapWolfLoad(
 		goto bail;
 	}
 	Mission *m = CArrayGet(&cCommon.Missions, 0);
-	tileClasses = hashmap_copy(m->u.Static.TileClasses, TileClassCopyHashMap);
+	wc->TileClasses =
+		hashmap_copy(m->u.Static.TileClasses, TileClassCopyHashMap);
 	CharacterStoreCopy(
 		&cs, &cCommon.characters, &gPlayerTemplates.CustomClasses);
 	CampaignSettingTerminate(&cCommon);
@@ -812,7 +1005,7 @@ int MapWolfLoad(
 	{
 		TileClass *orig;
 		sprintf(buf, "%d", i);
-		if (hashmap_get(tileClasses, buf, (any_t *)&orig) != MAP_OK)
+		if (hashmap_get(wc->TileClasses, buf, (any_t *)&orig) != MAP_OK)
 		{
 			LOG(LM_MAP, LL_ERROR, "failed to get tile class for copying");
 			break;
@@ -824,7 +1017,7 @@ int MapWolfLoad(
 		// Slightly modify tile color because they are referenced by mask
 		tc->Mask.a--;
 		sprintf(buf, "%d", i + TILE_CLASS_WALL_OFFSET);
-		if (hashmap_put(tileClasses, buf, tc) != MAP_OK)
+		if (hashmap_put(wc->TileClasses, buf, tc) != MAP_OK)
 		{
 			LOG(LM_MAP, LL_ERROR, "failed to save tile class copy");
 			break;
@@ -855,7 +1048,7 @@ int MapWolfLoad(
 	if (map->type == CWMAPTYPE_N3D && map->nQuizzes > 0)
 	{
 		LoadN3DScrolls(map);
-		IdxShufflerInit(&scrollShuffler, map->nQuizzes);
+		AssignN3DScrolls(wc);
 	}
 	// Special case for N3D: copy enemies and make goodguy versions for the end
 	// cast
@@ -876,38 +1069,72 @@ int MapWolfLoad(
 		}
 	}
 
+	wc->NumMissions = numMissions;
+	wc->CacheKey = GetCacheKey(wc);
 	for (int i = 0; i < map->nLevels; i++)
 	{
-		LoadMission(
-			c, tileClasses, map, spearMission, i, numMissions,
-			&scrollShuffler);
+		Mission stub;
+		LoadMissionStub(&stub, map, i);
+		CArrayPushBack(&c->Missions, &stub);
+		const bool converted = false;
+		CArrayPushBack(&wc->Converted, &converted);
 	}
+	c->CustomMissionLoad = LoadMissionOnDemand;
 
 bail:
-	if (err != 0)
-	{
-		CWFree(map);
-	}
-	hashmap_destroy(tileClasses, TileClassDestroy);
 	CharacterStoreTerminate(&cs);
-	IdxShufflerTerminate(&scrollShuffler);
 	return err;
 }
 
-static Mix_Chunk *LoadSoundData(const CWolfMap *map, const int i);
-static Mix_Chunk *LoadAdlibSoundData(const CWolfMap *map, const int i);
-static void AddNormalSound(
-	const SoundDevice *s, const char *name, Mix_Chunk *data);
-static void AddRandomSound(
-	const SoundDevice *s, const char *name, Mix_Chunk *data);
-static void LoadSounds(const SoundDevice *s, const CWolfMap *map)
+static void AssignN3DScrolls(WolfCampaign *wc)
+{
+	const CWolfMap *map = &wc->Map;
+	// Shuffle the same way every time, so cached levels stay valid
+	PRNG r;
+	PRNGSeed(&r, map->mapHash);
+	IdxShufflerInit(&wc->ScrollShuffler, map->nQuizzes, &r);
+	// Count the scrolls, which replace hanging skeletons, in every level
+	// that will be converted
+	int start = 0;
+	for (int i = 0; i < map->nLevels; i++)
+	{
+		CArrayPushBack(&wc->ScrollStarts, &start);
+		if (!CWLevelHasPlayerSpawn(&wc->Map, i))
+		{
+			continue;
+		}
+		const CWLevel *level = &map->levels[i];
+		for (int y = 0; y < level->header.height; y++)
+		{
+			for (int x = 0; x < level->header.width; x++)
+			{
+				const uint16_t ch = CWLevelGetCh(level, 1, x, y);
+				if (CWChToEntity(ch) == CWENT_HANGING_SKELETON)
+				{
+					start = (start + 1) % map->nQuizzes;
+				}
+			}
+		}
+	}
+}
+
+static void LoadAdlibSounds(WolfCampaign *wc, char **data, size_t *lens);
+static char *LoadSoundData(const CWolfMap *map, const int i, size_t *len);
+static void AddSound(const SoundDevice *s, const char *name, Mix_Chunk *data);
+static void LoadSounds(const SoundDevice *s, WolfCampaign *wc)
 {
 	if (!s->isInitialised)
 	{
 		return;
 	}
+	const CWolfMap *map = &wc->Map;
 
 	// Load adlib sounds
+	char **adlibData;
+	CCALLOC(adlibData, map->audio.nSound * sizeof *adlibData);
+	size_t *adlibLens;
+	CCALLOC(adlibLens, map->audio.nSound * sizeof *adlibLens);
+	LoadAdlibSounds(wc, adlibData, adlibLens);
 	for (int i = 0; i < map->audio.nSound; i++)
 	{
 		const char *name = GetAdlibSound(map->type, i);
@@ -915,59 +1142,128 @@ static void LoadSounds(const SoundDevice *s, const CWolfMap *map)
 		{
 			continue;
 		}
-		Mix_Chunk *data = LoadAdlibSoundData(map, i);
-		if (name[strlen(name) - 1] == '/')
+		Mix_Chunk *data = NULL;
+		if (adlibLens[i] == 0)
 		{
-			AddRandomSound(s, name, data);
+			LOG(LM_MAP, LL_ERROR, "Failed to load adlib wolf sound %d\n", i);
 		}
 		else
 		{
-			AddNormalSound(s, name, data);
+			data = Mix_QuickLoad_RAW(
+				(Uint8 *)adlibData[i], (Uint32)adlibLens[i]);
 		}
+		AddSound(s, name, data);
 	}
+	CFREE(adlibData);
+	CFREE(adlibLens);
 
 	// Load digi sounds
 	for (int i = 0; i < map->vswap.nSounds; i++)
 	{
 		const char *names = GetSound(map->type, i);
-		if (names == NULL)
+		if (names == NULL || names[0] == '\0')
 		{
 			continue;
 		}
-		// Tokenise names
-		char *namesCopy;
-		CSTRDUP(namesCopy, names);
-		char *name = strtok(namesCopy, "|");
-		while (name != NULL)
+		// Decode once; all the names share the same sample data, but each
+		// needs its own chunk as the sounds are freed separately
+		size_t dataLen;
+		char *data = LoadSoundData(map, i, &dataLen);
+		if (data == NULL)
 		{
-			Mix_Chunk *data = LoadSoundData(map, i);
-			if (data != NULL)
+			continue;
+		}
+		CArrayPushBack(&wc->SoundBuffers, &data);
+		// Names are separated by '|'; copy each one out in turn
+		const char *name = names;
+		while (*name != '\0')
+		{
+			const char *bar = strchr(name, '|');
+			const size_t len =
+				bar != NULL ? (size_t)(bar - name) : strlen(name);
+			char buf[CDOGS_FILENAME_MAX];
+			strncpy(buf, name, MIN(len, sizeof buf - 1));
+			buf[MIN(len, sizeof buf - 1)] = '\0';
+			if (buf[0] != '\0')
 			{
-				if (name[strlen(name) - 1] == '/')
-				{
-					AddRandomSound(s, name, data);
-				}
-				else
-				{
-					AddNormalSound(s, name, data);
-				}
+				AddSound(
+					s, buf, Mix_QuickLoad_RAW((Uint8 *)data, (Uint32)dataLen));
 			}
-			name = strtok(NULL, "|");
+			if (bar == NULL)
+			{
+				break;
+			}
+			name = bar + 1;
 		}
-		CFREE(namesCopy);
 	}
 }
-static Mix_Chunk *LoadSoundData(const CWolfMap *map, const int i)
+typedef struct
+{
+	const CWolfMap *Map;
+	char **Data;
+	size_t *Lens;
+} AdlibRenderData;
+static void RenderAdlibSounds(
+	JobContext *ctx, void *data, const int start, const int end)
+{
+	AdlibRenderData *ard = data;
+	for (int i = start; i < end; i++)
+	{
+		if (GetAdlibSound(ard->Map->type, i) == NULL)
+		{
+			continue;
+		}
+		// Each thread renders with its own chip
+		if (CWAudioGetAdlibSound(
+				&ard->Map->audio, ctx->ThreadIndex, i, &ard->Data[i],
+				&ard->Lens[i]) != 0)
+		{
+			ard->Lens[i] = 0;
+		}
+	}
+}
+static void LoadAdlibSounds(WolfCampaign *wc, char **data, size_t *lens)
+{
+	const CWolfMap *map = &wc->Map;
+	char path[CDOGS_PATH_MAX];
+	GetAudioCachePath(path, map, "sounds");
+	char *cached = ReadPCMCache(path, map->audio.nSound, lens);
+	if (cached != NULL)
+	{
+		CArrayPushBack(&wc->SoundBuffers, &cached);
+		size_t offset = 0;
+		for (int i = 0; i < map->audio.nSound; i++)
+		{
+			data[i] = cached + offset;
+			offset += lens[i];
+		}
+		return;
+	}
+
+	// Rendering through the OPL emulator is slow; do it in parallel
+	AdlibRenderData ard = {map, data, lens};
+	JobSystemParallelFor(
+		&gJobSystem, map->audio.nSound, 4, RenderAdlibSounds, &ard);
+	for (int i = 0; i < map->audio.nSound; i++)
+	{
+		if (data[i] != NULL)
+		{
+			CArrayPushBack(&wc->SoundBuffers, &data[i]);
+		}
+	}
+	WritePCMCache(path, (const char *const *)data, lens, map->audio.nSound);
+}
+static char *LoadSoundData(const CWolfMap *map, const int i, size_t *len)
 {
 	const char *data;
-	size_t len;
-	const int err = CWVSwapGetSound(&map->vswap, i, &data, &len);
+	size_t dataLen;
+	const int err = CWVSwapGetSound(&map->vswap, i, &data, &dataLen);
 	if (err != 0)
 	{
 		LOG(LM_MAP, LL_ERROR, "Failed to load wolf sound %d: %d\n", i, err);
 		return NULL;
 	}
-	if (len == 0)
+	if (dataLen == 0)
 	{
 		LOG(LM_MAP, LL_ERROR, "Wolf sound %d has 0 len\n", i);
 		return NULL;
@@ -976,29 +1272,27 @@ static Mix_Chunk *LoadSoundData(const CWolfMap *map, const int i)
 	SDL_BuildAudioCVT(
 		&cvt, AUDIO_U8, 1, CWGetAudioSampleRate(map), CDOGS_SND_FMT,
 		CDOGS_SND_CHANNELS, CDOGS_SND_RATE);
-	cvt.len = (int)len;
-	cvt.buf = (Uint8 *)SDL_malloc(cvt.len * cvt.len_mult);
-	memcpy(cvt.buf, data, len);
+	cvt.len = (int)dataLen;
+	CMALLOC(cvt.buf, cvt.len * cvt.len_mult);
+	memcpy(cvt.buf, data, dataLen);
 	SDL_ConvertAudio(&cvt);
-	return Mix_QuickLoad_RAW(cvt.buf, cvt.len_cvt);
+	*len = (size_t)cvt.len_cvt;
+	return (char *)cvt.buf;
 }
-static Mix_Chunk *LoadAdlibSoundData(const CWolfMap *map, const int i)
+static void AddNormalSound(
+	const SoundDevice *s, const char *name, Mix_Chunk *data);
+static void AddRandomSound(
+	const SoundDevice *s, const char *name, Mix_Chunk *data);
+static void AddSound(const SoundDevice *s, const char *name, Mix_Chunk *data)
 {
-	char *data;
-	size_t len;
-	const int err = CWAudioGetAdlibSound(&map->audio, i, &data, &len);
-	if (err != 0)
+	if (name[strlen(name) - 1] == '/')
 	{
-		LOG(LM_MAP, LL_ERROR, "Failed to load adlib wolf sound %d: %d\n", i,
-			err);
-		return NULL;
+		AddRandomSound(s, name, data);
 	}
-	if (len == 0)
+	else
 	{
-		LOG(LM_MAP, LL_ERROR, "Wolf sound %d has 0 len\n", i);
-		return NULL;
+		AddNormalSound(s, name, data);
 	}
-	return Mix_QuickLoad_RAW((Uint8 *)data, (Uint32)len);
 }
 static void AddNormalSound(
 	const SoundDevice *s, const char *name, Mix_Chunk *data)
@@ -1103,158 +1397,306 @@ static bool GetMissionSong(MusicChunk *chunk, void *data)
 		msd->Map, chunk,
 		CWAudioGetLevelMusic(msd->Map->type, msd->MissionIndex));
 }
-static void LoadMission(
-	CampaignSetting *c, const map_t tileClasses, CWolfMap *map,
-	const int spearMission, const int missionIndex, const int numMissions,
-	IdxShuffler *scrollShuffler)
+static void LoadMissionStub(Mission *m, CWolfMap *map, const int missionIndex)
 {
-	const CWLevel *level = &map->levels[missionIndex];
-	Mission m;
-	MissionInit(&m);
+	MissionInit(m);
 
 	// If level has no player spawn it is a blank level, don't bother loading
-	if (level->hasPlayerSpawn)
+	// Note: this also checks spawns for all levels up front, which the
+	// conversion relies on for exits
+	if (!CWLevelHasPlayerSpawn(map, missionIndex))
 	{
-		char titleBuf[17];
-		titleBuf[16] = '\0';
-		strncpy(titleBuf, level->header.name, 16);
-		CSTRDUP(m.Title, titleBuf);
-		m.Size = svec2i(level->header.width, level->header.height);
-		m.Type = MAPTYPE_STATIC;
-		strcpy(m.ExitStyle, "plate");
-		strcpy(m.KeyStyle, "plain2");
+		return;
+	}
+	// Only load what is needed to list and equip for the mission; the rest
+	// is converted when the mission is used
+	const CWLevel *level = &map->levels[missionIndex];
+	char titleBuf[17];
+	titleBuf[16] = '\0';
+	strncpy(titleBuf, level->header.name, 16);
+	CSTRDUP(m->Title, titleBuf);
+	m->Size = svec2i(level->header.width, level->header.height);
+	m->Type = MAPTYPE_STATIC;
+	strcpy(m->ExitStyle, "plate");
+	strcpy(m->KeyStyle, "plain2");
 
-		// TODO: objectives for treasure, kills (multiple items per obj)
-		int bossObjIdx = -1;
-		int spearObjIdx = -1;
+	const WeaponClass *wc;
+	switch (map->type)
+	{
+	case CWMAPTYPE_N3D:
+		wc = StrWeaponClass("Small Launcher");
+		break;
+	default:
+		wc = StrWeaponClass("Pistol");
+		break;
+	}
+	CArrayPushBack(&m->Weapons, &wc);
+	switch (map->type)
+	{
+	case CWMAPTYPE_N3D:
+		wc = StrWeaponClass("Hand Feed");
+		break;
+	default:
+		wc = StrWeaponClass("Knife");
+		break;
+	}
+	CArrayPushBack(&m->Weapons, &wc);
+	// Reset weapons at start of episodes
+	switch (map->type)
+	{
+	case CWMAPTYPE_SOD:
+		m->WeaponPersist = true;
+		break;
+	case CWMAPTYPE_N3D:
+		m->WeaponPersist = true;
+		break;
+	default:
+		m->WeaponPersist = (missionIndex % 10) != 0;
+		break;
+	}
 
-		const WeaponClass *wc;
-		switch (map->type)
-		{
-		case CWMAPTYPE_N3D:
-			wc = StrWeaponClass("Small Launcher");
-			break;
-		default:
-			wc = StrWeaponClass("Pistol");
-			break;
-		}
-		CArrayPushBack(&m.Weapons, &wc);
-		switch (map->type)
-		{
-		case CWMAPTYPE_N3D:
-			wc = StrWeaponClass("Hand Feed");
-			break;
-		default:
-			wc = StrWeaponClass("Knife");
-			break;
-		}
-		CArrayPushBack(&m.Weapons, &wc);
-		// Reset weapons at start of episodes
-		switch (map->type)
-		{
-		case CWMAPTYPE_SOD:
-			m.WeaponPersist = true;
-			break;
-		case CWMAPTYPE_N3D:
-			m.WeaponPersist = true;
-			break;
-		default:
-			m.WeaponPersist = (missionIndex % 10) != 0;
-			break;
-		}
+	m->Music.Type = MUSIC_SRC_CHUNK;
+	MissionSongData *msd;
+	CMALLOC(msd, sizeof *msd);
+	msd->Map = map;
+	msd->MissionIndex = missionIndex;
+	m->Music.Data.Chunk.Data = msd;
+	m->Music.Data.Chunk.GetData = GetMissionSong;
+	m->Music.Data.Chunk.isMusic = false;
+	m->Music.Data.Chunk.u.Chunk = NULL;
+}
+
+static bool TryLoadCachedMission(
+	const WolfCampaign *wc, Mission *m, const int missionIndex);
+static void SaveCachedMission(
+	const WolfCampaign *wc, Mission *m, const int missionIndex);
+static void ConvertLevel(Mission *m, WolfCampaign *wc, const int missionIndex);
+static void LoadMissionOnDemand(void *data, Mission *m, const int idx)
+{
+	WolfCampaign *wc = data;
+	bool *converted = CArrayGet(&wc->Converted, idx);
+	if (*converted)
+	{
+		return;
+	}
+	*converted = true;
+	if (!CWLevelHasPlayerSpawn(&wc->Map, idx))
+	{
+		return;
+	}
+	if (TryLoadCachedMission(wc, m, idx))
+	{
+		LOG(LM_MAP, LL_DEBUG, "loaded cached wolf level %d", idx);
+		return;
+	}
+	const Uint32 ticksStart = SDL_GetTicks();
+	if (CWLevelLoad(&wc->Map, idx) != 0)
+	{
+		LOG(LM_MAP, LL_ERROR, "failed to load wolf level %d", idx);
+		return;
+	}
+	ConvertLevel(m, wc, idx);
+	LOG(LM_MAP, LL_DEBUG, "converted wolf level %d in %dms", idx,
+		(int)(SDL_GetTicks() - ticksStart));
+	SaveCachedMission(wc, m, idx);
+}
 
-		m.Music.Type = MUSIC_SRC_CHUNK;
-		MissionSongData *msd;
-		CMALLOC(msd, sizeof *msd);
-		msd->Map = map;
-		msd->MissionIndex = missionIndex;
-		m.Music.Data.Chunk.Data = msd;
-		m.Music.Data.Chunk.GetData = GetMissionSong;
-		m.Music.Data.Chunk.isMusic = false;
-		m.Music.Data.Chunk.u.Chunk = NULL;
+static void ConvertLevel(Mission *m, WolfCampaign *wc, const int missionIndex)
+{
+	CWolfMap *map = &wc->Map;
+	const CWLevel *level = &map->levels[missionIndex];
+	// TODO: objectives for treasure, kills (multiple items per obj)
+	int bossObjIdx = -1;
+	int spearObjIdx = -1;
 
-		MissionStaticInit(&m.u.Static);
+	MissionStaticInit(&m->u.Static);
 
-		m.u.Static.TileClasses =
-			hashmap_copy(tileClasses, TileClassCopyHashMap);
+	m->u.Static.TileClasses =
+		hashmap_copy(wc->TileClasses, TileClassCopyHashMap);
 
-		RECT_FOREACH(Rect2iNew(svec2i_zero(), m.Size))
-		const uint16_t ch = CWLevelGetCh(level, 0, _v.x, _v.y);
-		LoadTile(&m.u.Static, ch, map, _v, missionIndex);
-		RECT_FOREACH_END()
-		// Load objects after all tiles are loaded
-		RECT_FOREACH(Rect2iNew(svec2i_zero(), m.Size))
-		const uint16_t ch = CWLevelGetCh(level, 0, _v.x, _v.y);
-		TryLoadWallObject(
-			&m.u.Static, ch, map, spearMission, _v, missionIndex);
-		const uint16_t ech = CWLevelGetCh(level, 1, _v.x, _v.y);
-		LoadEntity(
-			&m, ech, map, spearMission, _v, missionIndex, numMissions,
-			&bossObjIdx, &spearObjIdx, scrollShuffler);
-		RECT_FOREACH_END()
+	RECT_FOREACH(Rect2iNew(svec2i_zero(), m->Size))
+	const uint16_t ch = CWLevelGetCh(level, 0, _v.x, _v.y);
+	LoadTile(&m->u.Static, ch, map, _v, missionIndex);
+	RECT_FOREACH_END()
+	// Load objects after all tiles are loaded
+	// Draw from a copy of the shuffler; see ScrollStarts
+	IdxShuffler scrollShuffler = wc->ScrollShuffler;
+	if (wc->ScrollStarts.size > 0)
+	{
+		scrollShuffler.idx =
+			*(const int *)CArrayGet(&wc->ScrollStarts, missionIndex);
+	}
+	RECT_FOREACH(Rect2iNew(svec2i_zero(), m->Size))
+	const uint16_t ch = CWLevelGetCh(level, 0, _v.x, _v.y);
+	TryLoadWallObject(
+		&m->u.Static, ch, map, wc->SpearMission, _v, missionIndex);
+	const uint16_t ech = CWLevelGetCh(level, 1, _v.x, _v.y);
+	LoadEntity(
+		m, ech, map, wc->SpearMission, _v, missionIndex, wc->NumMissions,
+		&bossObjIdx, &spearObjIdx, &scrollShuffler);
+	RECT_FOREACH_END()
 
-		if (m.u.Static.Exits.size == 0)
+	if (m->u.Static.Exits.size == 0)
+	{
+		// This is a boss level where killing the boss ends the level
+		// Make sure to skip over the secret level
+		Exit e;
+		e.Hidden = true;
+		e.R.Pos = svec2i_zero();
+		e.R.Size = m->Size;
+		if (map->type == CWMAPTYPE_SOD)
 		{
-			// This is a boss level where killing the boss ends the level
-			// Make sure to skip over the secret level
-			Exit e;
-			e.Hidden = true;
-			e.R.Pos = svec2i_zero();
-			e.R.Size = m.Size;
-			if (map->type == CWMAPTYPE_SOD)
+			if (missionIndex == 17)
 			{
-				if (missionIndex == 17)
-				{
-					// Skip over the two secret levels
-					e.Mission = missionIndex + 3;
-				}
-				else
-				{
-					e.Mission = missionIndex + 1;
-				}
-			}
-			else if (map->type == CWMAPTYPE_N3D && missionIndex == 30)
-			{
-				// Create a custom exit near the top so the player can
-				// opt to exit the cast
-				e.R = Rect2iNew(svec2i(29, 20), svec2i(4, 0));
-				e.Mission = missionIndex + 1;
+				// Skip over the two secret levels
+				e.Mission = missionIndex + 3;
 			}
 			else
 			{
-				// Skip over the secret level to the next episode
-				e.Mission = missionIndex + 2;
+				e.Mission = missionIndex + 1;
 			}
-			CArrayPushBack(&m.u.Static.Exits, &e);
 		}
-		if (map->type == CWMAPTYPE_SOD && missionIndex == 17)
+		else if (map->type == CWMAPTYPE_N3D && missionIndex == 30)
 		{
-			// Skip debrief and cut directly to angel boss level
-			m.SkipDebrief = true;
+			// Create a custom exit near the top so the player can
+			// opt to exit the cast
+			e.R = Rect2iNew(svec2i(29, 20), svec2i(4, 0));
+			e.Mission = missionIndex + 1;
 		}
-		else if (map->type == CWMAPTYPE_N3D && missionIndex == 30)
+		else
 		{
-			// Add the good chars for end cast
-			for (int i = 20; i < 20 + 12; i++)
+			// Skip over the secret level to the next episode
+			e.Mission = missionIndex + 2;
+		}
+		CArrayPushBack(&m->u.Static.Exits, &e);
+	}
+	if (map->type == CWMAPTYPE_SOD && missionIndex == 17)
+	{
+		// Skip debrief and cut directly to angel boss level
+		m->SkipDebrief = true;
+	}
+	else if (map->type == CWMAPTYPE_N3D && missionIndex == 30)
+	{
+		// Add the good chars for end cast
+		for (int i = 20; i < 20 + 12; i++)
+		{
+			// Special case for bush bear: spawn it together with bear in a
+			// different location so the bear uses the bush as vehicle
+			if (i == 27)
 			{
-				// Special case for bush bear: spawn it together with bear in a
-				// different location so the bear uses the bush as vehicle
-				if (i == 27)
-				{
-					CharacterPlace cp = {svec2i(31, 21), DIRECTION_DOWN};
-					MissionStaticAddCharacter(&m.u.Static, i, cp);
-					MissionStaticAddCharacter(&m.u.Static, i + 1, cp);
-					continue;
-				}
-				CharacterPlace cp = {svec2i(31, 20), DIRECTION_DOWN};
-				MissionStaticAddCharacter(&m.u.Static, i, cp);
+				CharacterPlace cp = {svec2i(31, 21), DIRECTION_DOWN};
+				MissionStaticAddCharacter(&m->u.Static, i, cp);
+				MissionStaticAddCharacter(&m->u.Static, i + 1, cp);
+				continue;
 			}
+			CharacterPlace cp = {svec2i(31, 20), DIRECTION_DOWN};
+			MissionStaticAddCharacter(&m->u.Static, i, cp);
 		}
+	}
+
+	m->u.Static.AltFloorsEnabled = false;
+}
+
+// Bump this when changing the conversion, to invalidate cached missions
+#define WOLF_CACHE_VERSION 2
+static uint64_t GetCacheKey(const WolfCampaign *wc)
+{
+	// Missions depend on the level data, as well as how they are converted
+	const int params[] = {
+		WOLF_CACHE_VERSION, MAP_VERSION, (int)wc->Map.type,
+		wc->SpearMission, wc->NumMissions, wc->Map.nQuizzes};
+	uint64_t key = HashParams(
+		wc->Map.mapHash, params, (int)(sizeof params / sizeof params[0]));
+	// and which scrolls they get
+	key = HashParams(
+		key, wc->ScrollShuffler.indices.data,
+		(int)wc->ScrollShuffler.indices.size);
+	return HashParams(
+		key, wc->ScrollStarts.data, (int)wc->ScrollStarts.size);
+}
+static void GetCachePath(
+	char *buf, const WolfCampaign *wc, const int missionIndex)
+{
+	sprintf(
+		buf, "%s/%016llx_%016llx_%d.json", GetConfigFilePath(WOLF_CACHE_DIR),
+		(unsigned long long)wc->Map.mapHash, (unsigned long long)wc->CacheKey,
+		missionIndex);
+}
+static bool TryLoadCachedMission(
+	const WolfCampaign *wc, Mission *m, const int missionIndex)
+{
+	bool ok = false;
+	json_t *root = NULL;
+	CArray missions;
+	CArrayInit(&missions, sizeof(Mission));
+	char path[CDOGS_PATH_MAX];
+	GetCachePath(path, wc, missionIndex);
+	FILE *f = fopen(path, "r");
+	if (f == NULL)
+	{
+		goto bail;
+	}
+	if (json_stream_parse(f, &root) != JSON_OK)
+	{
+		LOG(LM_MAP, LL_WARN, "invalid cached mission %s", path);
+		goto bail;
+	}
+	json_t *missionsNode = json_find_first_label(root, "Missions");
+	if (missionsNode == NULL)
+	{
+		goto bail;
+	}
+	LoadMissions(&missions, missionsNode->child, MAP_VERSION);
+	if (missions.size != 1)
+	{
+		goto bail;
+	}
+	// Music can't be saved, so carry it over from the placeholder
+	Mission *cached = CArrayGet(&missions, 0);
+	CFREE(cached->Music.Data.Filename);
+	cached->Music = m->Music;
+	m->Music.Type = MUSIC_SRC_DYNAMIC;
+	m->Music.Data.Filename = NULL;
+	MissionTerminate(m);
+	memcpy(m, cached, sizeof *m);
+	CArrayClear(&missions);
+	ok = true;
 
-		m.u.Static.AltFloorsEnabled = false;
+bail:
+	CA_FOREACH(Mission, mission, missions)
+	MissionTerminate(mission);
+	CA_FOREACH_END()
+	CArrayTerminate(&missions);
+	json_free_value(&root);
+	if (f != NULL)
+	{
+		fclose(f);
 	}
+	return ok;
+}
+static void SaveCachedMission(
+	const WolfCampaign *wc, Mission *m, const int missionIndex)
+{
+	char path[CDOGS_PATH_MAX];
+	strcpy(path, GetConfigFilePath(WOLF_CACHE_DIR));
+	// Ignore errors; the dir may already exist
+	mkdir_deep(path);
+	GetCachePath(path, wc, missionIndex);
+	EvictStaleCache(path);
 
-	CArrayPushBack(&c->Missions, &m);
+	// Shallow copy; the mission is still owned by the campaign
+	CArray missions;
+	CArrayInit(&missions, sizeof(Mission));
+	CArrayPushBack(&missions, m);
+	json_t *root = json_new_object();
+	AddIntPair(root, "Version", MAP_VERSION);
+	json_insert_pair_into_object(root, "Missions", SaveMissions(&missions));
+	if (!TrySaveJSONFile(root, path))
+	{
+		LOG(LM_MAP, LL_WARN, "failed to cache mission %s", path);
+	}
+	json_free_value(&root);
+	CArrayTerminate(&missions);
 }
 
 static int LoadWall(const uint16_t ch);
@@ -137,14 +137,17 @@ bool MissionStaticTryLoadJSON(
 		LoadTileClasses(m->TileClasses, node);
 
 		// CSV string per row
-		const json_t *tile =
-			json_find_first_label(node, "Tiles")->child->child;
+		// Compiled campaigns have these stripped and load them directly (see
+		// map_compiled.h)
+		const json_t *tiles = json_find_first_label(node, "Tiles");
+		const json_t *tile = tiles != NULL ? tiles->child->child : NULL;
 		while (tile)
 		{
 			LoadStaticTileCSV(&m->Tiles, tile->text);
 			tile = tile->next;
 		}
-		const json_t *a = json_find_first_label(node, "Access")->child->child;
+		const json_t *access = json_find_first_label(node, "Access");
+		const json_t *a = access != NULL ? access->child->child : NULL;
 		while (a)
 		{
 			CArray mAccess;
@@ -375,7 +378,7 @@ static void LoadStaticCharacters(MissionStatic *m, json_t *node, char *name)
 			CA_FOREACH(const struct vec2i, pos, positions)
 			CharacterPlace cp;
 			cp.Pos = *pos;
-			cp.Dir = rand() % DIRECTION_COUNT;
+			cp.Dir = RandInt(RNG_MAP, 0, DIRECTION_COUNT);
 			CArrayPushBack(&cps.Places, &cp);
 			CA_FOREACH_END()
 		}
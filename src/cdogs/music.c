@@ -170,7 +170,7 @@ void MusicPlayGeneral(MusicPlayer *mp, const MusicType type)
 	{
 		while (mp->u.general == *(Mix_Music **)CArrayGet(tracks, 0))
 		{
-			CArrayShuffle(tracks);
+			CArrayShuffle(tracks, &gRandStreams[RNG_FX]);
 		}
 	}
 	PlayMusic(mp);
@@ -221,7 +221,8 @@ void MusicPlayChunk(MusicPlayer *mp, const MusicType type, MusicChunk *chunk)
 		{
 			mp->type = MUSIC_SRC_CHUNK;
 			mp->u.chunk.chunk = chunk->u.Chunk;
-			mp->u.chunk.channel = Mix_PlayChannel(-1, chunk->u.Chunk, -1);
+			mp->u.chunk.channel =
+				Mix_PlayChannel(MUSIC_CHUNK_CHANNEL, chunk->u.Chunk, -1);
 		}
 	}
 	else
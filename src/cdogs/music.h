@@ -58,6 +58,9 @@
 #include "c_array.h"
 
 #define MUSIC_REDUCTION_RATE 0.25
+// Music from chunks (e.g. Wolf3D) plays on this reserved mixer channel, so it
+// is never taken by sound effects
+#define MUSIC_CHUNK_CHANNEL 0
 
 typedef enum
 {
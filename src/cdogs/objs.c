@@ -99,7 +99,7 @@ void DamageObject(const NThingDamage d)
 	for (int i = 0; i < MIN(o->Health, d.Power); i++)
 	{
 		char buf[256];
-		sprintf(buf, "spall%d", rand() % NUM_SPALL_PARTICLES + 1);
+		sprintf(buf, "spall%d", RandInt(RNG_FX, 1, NUM_SPALL_PARTICLES + 1));
 		ap.Class = StrParticleClass(&gParticleClasses, buf);
 		// Choose random colour from object
 		ap.Mask = PicGetRandomColor(CPicGetPic(&o->Class->Pic, 0));
@@ -126,7 +126,7 @@ void DamageObject(const NThingDamage d)
 		for (int i = 0; i < 20; i++)
 		{
 			char buf[256];
-			sprintf(buf, "spall%d", rand() % NUM_SPALL_PARTICLES + 1);
+			sprintf(buf, "spall%d", RandInt(RNG_FX, 1, NUM_SPALL_PARTICLES + 1));
 			ap.Class = StrParticleClass(&gParticleClasses, buf);
 			// Choose random colour from object
 			ap.Mask = PicGetRandomColor(CPicGetPic(&o->Class->Pic, 0));
@@ -166,7 +166,7 @@ static void AddPickupAtObject(const TObject *o, const PickupType type)
 		}
 		// Pick a random ammo type and spawn it
 		{
-			const int ammoId = rand() % AmmoGetNumClasses(&gAmmo);
+			const int ammoId = RAND_INT(0, AmmoGetNumClasses(&gAmmo));
 			const Ammo *a = AmmoGetById(&gAmmo, ammoId);
 			sprintf(e.u.AddPickup.PickupClass, "ammo_%s", a->Name);
 		}
@@ -174,7 +174,7 @@ static void AddPickupAtObject(const TObject *o, const PickupType type)
 	case PICKUP_GUN:
 		// Pick a random mission gun type and spawn it
 		{
-			const int gunId = (int)(rand() % gMission.Weapons.size);
+			const int gunId = RAND_INT(0, gMission.Weapons.size);
 			const WeaponClass **wc = CArrayGet(&gMission.Weapons, gunId);
 			sprintf(e.u.AddPickup.PickupClass, "gun_%s", (*wc)->name);
 		}
@@ -222,7 +222,7 @@ void ObjRemove(const NMapObjectRemove mor)
 		{
 			CA_FOREACH(
 				const MapObjectDestroySpawn, mods, o->Class->DestroySpawn)
-			const double chance = (double)rand() / RAND_MAX;
+			const double chance = RAND_DOUBLE(0.0, 1.0);
 			if (chance < mods->SpawnChance)
 			{
 				AddPickupAtObject(o, mods->Type);
@@ -251,7 +251,7 @@ void ObjRemove(const NMapObjectRemove mor)
 	if (o->thing.flags & THING_IMPASSABLE)
 	{
 		// Update pathfinding cache if this object blocked a path before
-		PathCacheClear(&gPathCache);
+		PathCacheTileChanged(&gPathCache, Vec2ToTile(o->thing.Pos));
 	}
 }
 static void PlaceWreck(const char *wreckClass, const Thing *ti)
@@ -527,7 +527,7 @@ void ObjAdd(const NMapObjectAdd amo)
 	if (o->thing.flags & THING_IMPASSABLE)
 	{
 		// Update pathfinding cache if this object blocked a path before
-		PathCacheClear(&gPathCache);
+		PathCacheTileChanged(&gPathCache, Vec2ToTile(o->thing.Pos));
 	}
 }
 
@@ -565,9 +565,11 @@ void UpdateObjects(const int ticks)
 			ap.Pos = svec2_add(
 				obj->thing.Pos,
 				svec2(
-					RAND_FLOAT(-obj->thing.size.x / 4, obj->thing.size.x / 4),
-					RAND_FLOAT(
-						-obj->thing.size.y / 4, obj->thing.size.y / 4)));
+					RandFloat(
+						RNG_FX, -obj->thing.size.x / 4, obj->thing.size.x / 4),
+					RandFloat(
+						RNG_FX, -obj->thing.size.y / 4,
+						obj->thing.size.y / 4)));
 			ap.Z = obj->Class->DamageSmoke.Z;
 			ap.Mask = colorWhite;
 			EmitterUpdate(&obj->damageSmoke, &ap, ticks);
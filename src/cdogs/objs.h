@@ -86,6 +86,11 @@ typedef struct MobileObject
 	Thing thing;
 	Emitter trail;
 	const WeaponClass *weapon; // Weapon that fired this
+	// Seeking bullets: current target (index into gActors and UID) and
+	// ticks until the next retarget
+	int seekTargetId;
+	int seekTargetUID;
+	int seekCounter;
 	bool isInUse;
 } TMobileObject;
 typedef int (*MobObjUpdateFunc)(TMobileObject *, int);
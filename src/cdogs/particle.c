@@ -30,67 +30,71 @@
 #include "actors.h"
 #include "collision/collision.h"
 #include "font.h"
-#include "game_events.h"
 #include "gamedata.h"
 #include "objs.h"
 
-CArray gParticles;
-#define MAX_PARTICLES 4096
+ParticlePool gParticles;
+#define MAX_PARTICLES 16384
+// Particles that live at least this many ticks use the long-lived budget
+#define PARTICLE_LONG_LIVED_TICKS 1000
 
 // Particles get darker when below this height
 #define PARTICLE_DARKEN_Z BULLET_Z
 
-void ParticlesInit(CArray *particles)
+void ParticlesInit(ParticlePool *pool)
 {
-	CArrayInit(particles, sizeof(Particle));
-	CArrayReserve(particles, 256);
-}
-void ParticlesTerminate(CArray *particles)
-{
-	for (int i = 0; i < (int)particles->size; i++)
+	CArrayInit(&pool->slots, sizeof(Particle));
+	CArrayReserve(&pool->slots, 256);
+	CArrayInit(&pool->live, sizeof(int));
+	CArrayReserve(&pool->live, 256);
+	CArrayInit(&pool->freeIds, sizeof(int));
+	for (int i = 0; i < PARTICLE_BUDGET_COUNT; i++)
 	{
-		Particle *p = CArrayGet(particles, i);
-		if (p->isInUse)
+		ParticleRing *r = &pool->rings[i];
+		r->size = MAX_PARTICLES / PARTICLE_BUDGET_COUNT;
+		CMALLOC(r->entries, r->size * sizeof *r->entries);
+		for (int j = 0; j < r->size; j++)
 		{
-			ParticleDestroy(particles, i);
+			r->entries[j].Id = -1;
 		}
+		r->head = 0;
 	}
-	CArrayTerminate(particles);
+	pool->nextUID = 0;
 }
-
-static bool ParticleUpdate(Particle *p, const int ticks);
-void ParticlesUpdate(CArray *particles, const int ticks)
+void ParticlesTerminate(ParticlePool *pool)
 {
-	int maxParticleAge = -1;
-	int maxParticleId = -1;
-	int numParticles = 0;
-	CA_FOREACH(Particle, p, *particles)
-	if (!p->isInUse)
+	while (pool->live.size > 0)
 	{
-		continue;
+		ParticleDestroy(
+			pool, *(int *)CArrayGet(&pool->live, pool->live.size - 1));
 	}
-	if (!ParticleUpdate(p, ticks))
+	CArrayTerminate(&pool->slots);
+	CArrayTerminate(&pool->live);
+	CArrayTerminate(&pool->freeIds);
+	for (int i = 0; i < PARTICLE_BUDGET_COUNT; i++)
 	{
-		GameEvent e = GameEventNew(GAME_EVENT_PARTICLE_REMOVE);
-		e.u.ParticleRemoveId = _ca_index;
-		GameEventsEnqueue(&gGameEvents, e);
+		CFREE(pool->rings[i].entries);
+		pool->rings[i].entries = NULL;
 	}
-	else
+}
+
+Particle *ParticleGet(const ParticlePool *pool, const int id)
+{
+	return CArrayGet(&pool->slots, id);
+}
+
+static bool ParticleUpdate(Particle *p, const int ticks);
+void ParticlesUpdate(ParticlePool *pool, const int ticks)
+{
+	// Iterate backwards so that destroyed particles, which are swapped with
+	// the last live particle, don't cause any to be skipped
+	for (int i = (int)pool->live.size - 1; i >= 0; i--)
 	{
-		if (p->Count > maxParticleAge)
+		const int id = *(int *)CArrayGet(&pool->live, i);
+		if (!ParticleUpdate(ParticleGet(pool, id), ticks))
 		{
-			maxParticleAge = p->Count;
-			maxParticleId = _ca_index;
+			ParticleDestroy(pool, id);
 		}
-		numParticles++;
-	}
-	CA_FOREACH_END()
-	// Remove oldest particle if we have too many
-	if (numParticles > MAX_PARTICLES && maxParticleId >= 0)
-	{
-		GameEvent e = GameEventNew(GAME_EVENT_PARTICLE_REMOVE);
-		e.u.ParticleRemoveId = maxParticleId;
-		GameEventsEnqueue(&gGameEvents, e);
 	}
 }
 
@@ -209,8 +213,7 @@ static void SetClosestCollision(
 	HitWallData *data, const struct vec2 col, const struct vec2 normal);
 static bool CheckWall(const struct vec2i tilePos)
 {
-	const Tile *t = MapGetTile(&gMap, tilePos);
-	return t == NULL || TileIsShootable(t);
+	return !MapIsTileIn(&gMap, tilePos) || MapTileIsShootable(&gMap, tilePos);
 }
 static bool HitWallFunc(
 	const struct vec2i tilePos, void *data, const struct vec2 col,
@@ -236,30 +239,47 @@ static void SetClosestCollision(
 
 static void DrawParticle(
 	const struct vec2i pos, const ThingDrawFuncData *data);
-int ParticleAdd(CArray *particles, const AddParticle add)
+int ParticleAdd(ParticlePool *pool, const AddParticle add)
 {
-	// Find an empty slot in list
-	Particle *p = NULL;
-	int i;
-	for (i = 0; i < (int)particles->size; i++)
+	// Evict the oldest particle of the same budget if we have too many
+	const ParticleBudget budget =
+		add.Class->RangeLow >= PARTICLE_LONG_LIVED_TICKS
+			? PARTICLE_BUDGET_LONG
+			: PARTICLE_BUDGET_SHORT;
+	ParticleRing *ring = &pool->rings[budget];
+	const ParticleRingEntry *oldest = &ring->entries[ring->head];
+	if (oldest->Id >= 0)
 	{
-		Particle *pSlot = CArrayGet(particles, i);
-		if (!pSlot->isInUse)
+		const Particle *pOld = ParticleGet(pool, oldest->Id);
+		if (pOld->isInUse && pOld->UID == oldest->UID)
 		{
-			p = pSlot;
-			break;
+			ParticleDestroy(pool, oldest->Id);
 		}
 	}
-	// If no empty slots, add a new one
-	if (p == NULL)
+
+	// Reuse a free slot if available, otherwise add a new one
+	int i;
+	if (pool->freeIds.size > 0)
+	{
+		i = *(int *)CArrayGet(&pool->freeIds, pool->freeIds.size - 1);
+		CArrayPopBack(&pool->freeIds);
+	}
+	else
 	{
 		Particle pNew;
 		memset(&pNew, 0, sizeof pNew);
-		CArrayPushBack(particles, &pNew);
-		i = (int)particles->size - 1;
-		p = CArrayGet(particles, i);
+		CArrayPushBack(&pool->slots, &pNew);
+		i = (int)pool->slots.size - 1;
 	}
+	Particle *p = ParticleGet(pool, i);
 	memset(p, 0, sizeof *p);
+	p->UID = pool->nextUID++;
+	p->liveIndex = (int)pool->live.size;
+	CArrayPushBack(&pool->live, &i);
+	ring->entries[ring->head].Id = i;
+	ring->entries[ring->head].UID = p->UID;
+	ring->head = (ring->head + 1) % ring->size;
+
 	p->Class = add.Class;
 	switch (p->Class->Type)
 	{
@@ -286,7 +306,7 @@ int ParticleAdd(CArray *particles, const AddParticle add)
 	p->Angle = add.Angle;
 	p->DZ = (float)add.DZ;
 	p->Spin = add.Spin;
-	p->Range = RAND_INT(add.Class->RangeLow, add.Class->RangeHigh);
+	p->Range = RandInt(RNG_FX, add.Class->RangeLow, add.Class->RangeHigh);
 	p->isInUse = true;
 	p->thing.Pos.x = p->thing.Pos.y = -1;
 	p->thing.Vel = add.Vel;
@@ -312,9 +332,9 @@ int ParticleAdd(CArray *particles, const AddParticle add)
 	MapTryMoveThing(&gMap, &p->thing, add.Pos);
 	return i;
 }
-void ParticleDestroy(CArray *particles, const int id)
+void ParticleDestroy(ParticlePool *pool, const int id)
 {
-	Particle *p = CArrayGet(particles, id);
+	Particle *p = ParticleGet(pool, id);
 	if (!p->isInUse)
 	{
 		return;
@@ -329,11 +349,18 @@ void ParticleDestroy(CArray *particles, const int id)
 		break;
 	}
 	p->isInUse = false;
+
+	// Swap-remove from the live list
+	const int lastId = *(int *)CArrayGet(&pool->live, pool->live.size - 1);
+	CArraySet(&pool->live, p->liveIndex, &lastId);
+	ParticleGet(pool, lastId)->liveIndex = p->liveIndex;
+	CArrayPopBack(&pool->live);
+	CArrayPushBack(&pool->freeIds, &id);
 }
 
 static void DrawParticle(const struct vec2i pos, const ThingDrawFuncData *data)
 {
-	const Particle *p = CArrayGet(&gParticles, data->MobObjId);
+	const Particle *p = ParticleGet(&gParticles, data->MobObjId);
 	CASSERT(p->isInUse, "Cannot draw non-existent particle");
 	// Special case: don't draw mid-air, non-falling particles
 	// if they are on an open door - this is for bulletmarks
@@ -341,9 +368,9 @@ static void DrawParticle(const struct vec2i pos, const ThingDrawFuncData *data)
 		svec2_is_zero(p->thing.Vel))
 	{
 		const struct vec2i t = Vec2iToTile(svec2i_assign_vec2(p->Pos));
-		const Tile *tAbove = MapGetTile(&gMap, svec2i(t.x, t.y - 1));
-		if (tAbove != NULL && tAbove->Class->Type == TILE_CLASS_DOOR &&
-			!TileIsShootable(tAbove))
+		const struct vec2i above = svec2i(t.x, t.y - 1);
+		if (MapTileIsDoor(&gMap, above) &&
+			!MapTileIsShootable(&gMap, above))
 		{
 			return;
 		}
@@ -48,9 +48,41 @@ typedef struct
 	int Range;
 	Thing thing;
 	bool isAttached;
+	int UID;
+	int liveIndex; // index into ParticlePool.live
 	bool isInUse;
 } Particle;
-extern CArray gParticles; // of Particle
+
+typedef struct
+{
+	int Id;
+	int UID;
+} ParticleRingEntry;
+// Particles in order of creation; once full, the next particle added
+// evicts the oldest one
+typedef struct
+{
+	ParticleRingEntry *entries;
+	int size;
+	int head;
+} ParticleRing;
+// Long-lived particles (blood, brass, bullet holes...) have their own
+// budget, so that spamming short-lived effects doesn't evict them
+typedef enum
+{
+	PARTICLE_BUDGET_SHORT,
+	PARTICLE_BUDGET_LONG,
+	PARTICLE_BUDGET_COUNT
+} ParticleBudget;
+typedef struct
+{
+	CArray slots;	// of Particle; indexed by particle id
+	CArray live;	// of int; dense list of in-use particle ids
+	CArray freeIds; // of int; unused slots
+	ParticleRing rings[PARTICLE_BUDGET_COUNT];
+	int nextUID;
+} ParticlePool;
+extern ParticlePool gParticles;
 
 typedef struct
 {
@@ -68,9 +100,12 @@ typedef struct
 	bool IsAttached;
 } AddParticle;
 
-void ParticlesInit(CArray *particles);
-void ParticlesTerminate(CArray *particles);
-void ParticlesUpdate(CArray *particles, const int ticks);
+void ParticlesInit(ParticlePool *pool);
+void ParticlesTerminate(ParticlePool *pool);
+void ParticlesUpdate(ParticlePool *pool, const int ticks);
 
-int ParticleAdd(CArray *particles, const AddParticle add);
-void ParticleDestroy(CArray *particles, const int id);
+Particle *ParticleGet(const ParticlePool *pool, const int id);
+// Particles are cosmetic and local-only; they can be added and removed
+// directly without going through game events
+int ParticleAdd(ParticlePool *pool, const AddParticle add);
+void ParticleDestroy(ParticlePool *pool, const int id);
@@ -27,6 +27,7 @@
 */
 #include "particle_class.h"
 
+#include "json_stream.h"
 #include "json_utils.h"
 #include "log.h"
 #include "pic_manager.h"
@@ -44,8 +45,6 @@ ParticleType StrParticleType(const char *s)
 	return PARTICLE_PIC;
 }
 
-static void LoadParticleClass(
-	ParticleClass *c, json_t *node, const int version);
 void ParticleClassesInit(ParticleClasses *classes, const char *filename)
 {
 	CArrayInit(&classes->Classes, sizeof(ParticleClass));
@@ -53,45 +52,94 @@ void ParticleClassesInit(ParticleClasses *classes, const char *filename)
 
 	char buf[CDOGS_PATH_MAX];
 	GetDataFilePath(buf, filename);
-	FILE *f = fopen(buf, "r");
-	json_t *root = NULL;
-	if (f == NULL)
+	if (!ParticleClassesLoadFile(&classes->Classes, buf))
 	{
 		LOG(LM_MAIN, LL_ERROR, "Error: cannot load particles file %s", buf);
-		goto bail;
-	}
-	enum json_error e = json_stream_parse(f, &root);
-	if (e != JSON_OK)
-	{
-		LOG(LM_MAIN, LL_ERROR, "Error parsing particles file %s", buf);
-		goto bail;
 	}
-	ParticleClassesLoadJSON(&classes->Classes, root);
+}
 
-bail:
-	if (f != NULL)
-	{
-		fclose(f);
-	}
-	json_free_value(&root);
+// Particle class being streamed, with its version-dependent fields
+typedef struct
+{
+	ParticleClass c;
+	json_t *node;
+} ParticleClassLoad;
+static const JSONField particleClassFields[] = {
+	JSON_FIELD("Name", JSON_FIELD_STRING, ParticleClassLoad, c.Name),
+	JSON_FIELD(
+		"GravityFactor", JSON_FIELD_FLOAT, ParticleClassLoad,
+		c.GravityFactor),
+	JSON_FIELD("HitsWalls", JSON_FIELD_BOOL, ParticleClassLoad, c.HitsWalls),
+	JSON_FIELD("Bounces", JSON_FIELD_BOOL, ParticleClassLoad, c.Bounces),
+	JSON_FIELD(
+		"BounceFriction", JSON_FIELD_FLOAT, ParticleClassLoad,
+		c.BounceFriction),
+	JSON_FIELD(
+		"WallBounces", JSON_FIELD_BOOL, ParticleClassLoad, c.WallBounces),
+	JSON_FIELD("ZDarken", JSON_FIELD_BOOL, ParticleClassLoad, c.ZDarken),
+	JSON_FIELD("DrawBelow", JSON_FIELD_BOOL, ParticleClassLoad, c.DrawBelow),
+	JSON_FIELD("DrawAbove", JSON_FIELD_BOOL, ParticleClassLoad, c.DrawAbove),
+	// Type- and version-dependent fields, loaded by LoadParticleNode
+	JSON_FIELD("Type", JSON_FIELD_NODE, ParticleClassLoad, node),
+	JSON_FIELD("Pic", JSON_FIELD_NODE, ParticleClassLoad, node),
+	JSON_FIELD("Text", JSON_FIELD_NODE, ParticleClassLoad, node),
+	JSON_FIELD("TextMask", JSON_FIELD_NODE, ParticleClassLoad, node),
+	JSON_FIELD("CharSprite", JSON_FIELD_NODE, ParticleClassLoad, node),
+	JSON_FIELD("Sprites", JSON_FIELD_NODE, ParticleClassLoad, node),
+	JSON_FIELD("Mask", JSON_FIELD_NODE, ParticleClassLoad, node),
+	JSON_FIELD("TicksPerFrame", JSON_FIELD_NODE, ParticleClassLoad, node),
+	JSON_FIELD("Range", JSON_FIELD_NODE, ParticleClassLoad, node),
+	JSON_FIELD("RangeLow", JSON_FIELD_NODE, ParticleClassLoad, node),
+	JSON_FIELD("RangeHigh", JSON_FIELD_NODE, ParticleClassLoad, node),
+	JSON_FIELDS_END};
+static void ParticleClassFree(ParticleClass *c);
+static void LoadParticleNode(
+	ParticleClass *c, json_t *node, const int version);
+static void ParticleClassInit(void *data, void *classes)
+{
+	UNUSED(classes);
+	ParticleClassLoad *l = data;
+	l->c.Bounces = true;
+	l->c.WallBounces = true;
 }
-void ParticleClassesLoadJSON(CArray *classes, json_t *root)
+static void ParticleClassAdd(void *data, const int version, void *classes)
 {
-	int version;
-	LoadInt(&version, root, "Version");
-	if (version > VERSION || version <= 0)
+	ParticleClassLoad *l = data;
+	if (l->node == NULL)
 	{
-		CASSERT(false, "cannot read particles file version");
-		return;
+		l->node = json_new_object();
 	}
-
-	json_t *particlesNode = json_find_first_label(root, "Particles")->child;
-	for (json_t *child = particlesNode->child; child; child = child->next)
+	LoadParticleNode(&l->c, l->node, version);
+	json_free_value(&l->node);
+	CArrayPushBack(classes, &l->c);
+}
+static void ParticleClassTerminate(void *data)
+{
+	ParticleClassLoad *l = data;
+	ParticleClassFree(&l->c);
+	json_free_value(&l->node);
+}
+bool ParticleClassesLoadFile(CArray *classes, const char *path)
+{
+	FILE *f = fopen(path, "r");
+	if (f == NULL)
 	{
-		ParticleClass c;
-		LoadParticleClass(&c, child, version);
-		CArrayPushBack(classes, &c);
+		return false;
 	}
+	const JSONClassSchema schema = {
+		"Particles",
+		particleClassFields,
+		sizeof(ParticleClassLoad),
+		VERSION,
+		ParticleClassInit,
+		ParticleClassAdd,
+		ParticleClassTerminate,
+		classes,
+		NULL,
+		NULL};
+	const int version = JSONStreamLoadClasses(&schema, f);
+	fclose(f);
+	return version > 0;
 }
 void ParticleClassesTerminate(ParticleClasses *classes)
 {
@@ -104,30 +152,31 @@ void ParticleClassesClear(CArray *classes)
 {
 	for (int i = 0; i < (int)classes->size; i++)
 	{
-		ParticleClass *c = CArrayGet(classes, i);
-		CFREE(c->Name);
-		switch (c->Type)
-		{
-		case PARTICLE_TEXT:
-			CFREE(c->u.Text.Value);
-			break;
-		case PARTICLE_CHAR_SPRITE:
-			CFREE(c->u.CharSprite);
-			break;
-		default:
-			break;
-		}
+		ParticleClassFree(CArrayGet(classes, i));
 	}
 	CArrayClear(classes);
 }
-static void LoadParticleClass(
+static void ParticleClassFree(ParticleClass *c)
+{
+	CFREE(c->Name);
+	switch (c->Type)
+	{
+	case PARTICLE_TEXT:
+		CFREE(c->u.Text.Value);
+		break;
+	case PARTICLE_CHAR_SPRITE:
+		CFREE(c->u.CharSprite);
+		break;
+	default:
+		break;
+	}
+}
+// Load the fields captured in the class's node, once the version is known
+static void LoadParticleNode(
 	ParticleClass *c, json_t *node, const int version)
 {
-	memset(c, 0, sizeof *c);
 	char *tmp;
 
-	c->Name = GetString(node, "Name");
-
 	c->Type = PARTICLE_PIC;
 	if (version < 2)
 	{
@@ -225,16 +274,6 @@ static void LoadParticleClass(
 	}
 	c->RangeLow = MIN(c->RangeLow, c->RangeHigh);
 	c->RangeHigh = MAX(c->RangeLow, c->RangeHigh);
-	LoadFloat(&c->GravityFactor, node, "GravityFactor");
-	LoadBool(&c->HitsWalls, node, "HitsWalls");
-	c->Bounces = true;
-	LoadBool(&c->Bounces, node, "Bounces");
-	LoadFloat(&c->BounceFriction, node, "BounceFriction");
-	c->WallBounces = true;
-	LoadBool(&c->WallBounces, node, "WallBounces");
-	LoadBool(&c->ZDarken, node, "ZDarken");
-	LoadBool(&c->DrawBelow, node, "DrawBelow");
-	LoadBool(&c->DrawAbove, node, "DrawAbove");
 }
 
 const ParticleClass *StrParticleClass(
@@ -73,7 +73,7 @@ typedef struct
 extern ParticleClasses gParticleClasses;
 
 void ParticleClassesInit(ParticleClasses *classes, const char *filename);
-void ParticleClassesLoadJSON(CArray *classes, json_t *root);
+bool ParticleClassesLoadFile(CArray *classes, const char *path);
 void ParticleClassesTerminate(ParticleClasses *classes);
 void ParticleClassesClear(CArray *classes);
 const ParticleClass *StrParticleClass(
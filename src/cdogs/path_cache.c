@@ -28,16 +28,33 @@
 #include "path_cache.h"
 
 #include <math.h>
-#include <time.h>
 
+#include "actors.h"
 #include "ai_utils.h"
+#include "alloc.h"
 #include "log.h"
+#include "profiler.h"
 
 #define PATH_CACHE_MAX 128
+// Past this many tile changes, rebuilding the flow fields is cheaper than
+// repairing them
+#define FLOW_FIELD_MAX_CHANGES 64
 
 PathCache gPathCache;
+// Ref counts are allocated for every path found, and freed with the path
+// Paths can outlive the cache (e.g. held by AI), so the pool lives for the
+// whole program
+static Pool sRefsPool;
 
 
+void CachedPathsTerminate(void)
+{
+	if (sRefsPool.elemSize != 0)
+	{
+		PoolTerminate(&sRefsPool);
+	}
+}
+
 static CachedPath CachedPathCopy(CachedPath *c)
 {
 	CachedPath copy;
@@ -56,7 +73,7 @@ void CachedPathDestroy(CachedPath *c)
 	if (*c->refs == 0)
 	{
 		ASPathDestroy(c->Path);
-		CFREE(c->refs);
+		PoolFree(&sRefsPool, c->refs);
 	}
 }
 
@@ -72,14 +89,21 @@ void PathCacheInit(PathCache *pc, Map *m)
 	CArrayInit(&pc->paths, sizeof(CachedPath));
 	pc->head = 0;
 	pc->map = m;
+	CArrayInit(&pc->flowFields, sizeof(FlowField));
+	CArrayInit(&pc->changes, sizeof(struct vec2i));
 }
 void PathCacheTerminate(PathCache *pc)
 {
 	PathCacheClear(pc);
 	CArrayTerminate(&pc->paths);
+	CA_FOREACH(FlowField, f, pc->flowFields)
+	CArrayTerminate(&f->dist);
+	CA_FOREACH_END()
+	CArrayTerminate(&pc->flowFields);
+	CArrayTerminate(&pc->changes);
 }
 
-void PathCacheClear(PathCache *pc)
+static void ClearPaths(PathCache *pc)
 {
 	CA_FOREACH(CachedPath, c, pc->paths)
 		CachedPathDestroy(c);
@@ -87,6 +111,24 @@ void PathCacheClear(PathCache *pc)
 	CArrayClear(&pc->paths);
 	pc->head = 0;
 }
+void PathCacheClear(PathCache *pc)
+{
+	ClearPaths(pc);
+	CA_FOREACH(FlowField, f, pc->flowFields)
+	f->isValid = false;
+	CA_FOREACH_END()
+	CArrayClear(&pc->changes);
+}
+void PathCacheTileChanged(PathCache *pc, const struct vec2i tile)
+{
+	if (pc->changes.size >= FLOW_FIELD_MAX_CHANGES)
+	{
+		PathCacheClear(pc);
+		return;
+	}
+	ClearPaths(pc);
+	CArrayPushBack(&pc->changes, &tile);
+}
 
 typedef struct
 {
@@ -116,15 +158,20 @@ CachedPath PathCacheCreate(
 
 	LOG(LM_PATH, LL_TRACE, "find path (%d, %d) to (%d, %d)...",
 		from.x, from.y, to.x, to.y);
-	const clock_t start = clock();
 
 	// Cached path not found; find the path now
 	CachedPath cp;
 	AStarContext ac;
 	ac.Map = pc->map;
 	ac.IsTileOk = ignoreObjects ? IsTileWalkable : IsTileWalkableAroundObjects;
+	PROFILE_BEGIN("Pathfind");
 	cp.Path = ASPathCreate(&cPathNodeSource, &ac, &from, &to);
-	CMALLOC(cp.refs, sizeof *cp.refs);
+	PROFILE_END();
+	if (sRefsPool.elemSize == 0)
+	{
+		PoolInit(&sRefsPool, sizeof *cp.refs, PATH_CACHE_MAX * 2);
+	}
+	cp.refs = PoolAlloc(&sRefsPool);
 	(*cp.refs) = 1;
 	cp.from = from;
 	cp.to = to;
@@ -152,9 +199,6 @@ CachedPath PathCacheCreate(
 		}
 		LOG(LM_PATH, LL_TRACE, "Cached %d paths", (int)pc->paths.size);
 	}
-	const clock_t diff = clock() - start;
-	const int ms = (int)(diff * 1000 / CLOCKS_PER_SEC);
-	LOG(LM_PATH, LL_DEBUG, "Pathfind time %dms", ms);
 	return cp;
 }
 
@@ -221,3 +265,349 @@ static float AStarHeuristic(void *fromNode, void *toNode, void *context)
 	return CHEBYSHEV_DISTANCE(
 		(float)v1->x, (float)v1->y, (float)v2->x, (float)v2->y);
 }
+
+// Integer versions of the A* costs above
+#define FLOW_COST_X (TILE_WIDTH * 10)
+#define FLOW_COST_Y (TILE_HEIGHT * 10)
+#define FLOW_COST_DIAGONAL (TILE_WIDTH * 11)
+typedef struct
+{
+	int dist;
+	int idx;
+} FlowNode;
+static void FlowHeapPush(CArray *heap, const FlowNode n)
+{
+	CArrayPushBack(heap, &n);
+	FlowNode *nodes = heap->data;
+	for (int i = (int)heap->size - 1; i > 0;)
+	{
+		const int parent = (i - 1) / 2;
+		if (nodes[parent].dist <= nodes[i].dist)
+		{
+			break;
+		}
+		const FlowNode tmp = nodes[parent];
+		nodes[parent] = nodes[i];
+		nodes[i] = tmp;
+		i = parent;
+	}
+}
+static FlowNode FlowHeapPop(CArray *heap)
+{
+	FlowNode *nodes = heap->data;
+	const FlowNode top = nodes[0];
+	nodes[0] = nodes[heap->size - 1];
+	CArrayPopBack(heap);
+	const int size = (int)heap->size;
+	for (int i = 0;;)
+	{
+		const int l = 2 * i + 1;
+		const int r = l + 1;
+		int smallest = i;
+		if (l < size && nodes[l].dist < nodes[smallest].dist)
+		{
+			smallest = l;
+		}
+		if (r < size && nodes[r].dist < nodes[smallest].dist)
+		{
+			smallest = r;
+		}
+		if (smallest == i)
+		{
+			break;
+		}
+		const FlowNode tmp = nodes[smallest];
+		nodes[smallest] = nodes[i];
+		nodes[i] = tmp;
+		i = smallest;
+	}
+	return top;
+}
+// Same rules as AddTileNeighbors: diagonal moves need the axis-aligned
+// neighbours to be clear too
+static bool CanFlowStep(
+	Map *map, const struct vec2i from, const struct vec2i to)
+{
+	return MapIsTileIn(map, to) && IsTileWalkable(map, to) &&
+		   IsTileWalkable(map, svec2i(from.x, to.y)) &&
+		   IsTileWalkable(map, svec2i(to.x, from.y));
+}
+static int FlowCost(const struct vec2i d)
+{
+	if (d.x != 0 && d.y != 0)
+	{
+		return FLOW_COST_DIAGONAL;
+	}
+	return d.x != 0 ? FLOW_COST_X : FLOW_COST_Y;
+}
+// Run Dijkstra from the nodes in the heap, lowering distances as it goes
+static void FlowFieldPropagate(int *dist, Map *map, CArray *heap)
+{
+	const int w = map->Size.x;
+	while (heap->size > 0)
+	{
+		const FlowNode n = FlowHeapPop(heap);
+		if (n.dist > dist[n.idx])
+		{
+			// Stale entry
+			continue;
+		}
+		const struct vec2i v = svec2i(n.idx % w, n.idx / w);
+		struct vec2i d;
+		for (d.y = -1; d.y <= 1; d.y++)
+		{
+			for (d.x = -1; d.x <= 1; d.x++)
+			{
+				if (d.x == 0 && d.y == 0)
+				{
+					continue;
+				}
+				const struct vec2i u = svec2i_add(v, d);
+				if (!CanFlowStep(map, v, u))
+				{
+					continue;
+				}
+				const FlowNode next = {n.dist + FlowCost(d), u.y * w + u.x};
+				if (next.dist < dist[next.idx])
+				{
+					dist[next.idx] = next.dist;
+					FlowHeapPush(heap, next);
+				}
+			}
+		}
+	}
+}
+// Moving the target changes the distance of nearly every tile, so this is a
+// full recalculation; it is shared by everyone heading for the target, and
+// only happens when the target enters a new tile
+static void FlowFieldCalc(FlowField *f, PathCache *pc)
+{
+	PROFILE_BEGIN("FlowField");
+	Map *map = pc->map;
+	const int w = map->Size.x;
+	CArrayClear(&f->dist);
+	const int unreachable = FLOW_FIELD_UNREACHABLE;
+	CArrayResize(&f->dist, w * map->Size.y, &unreachable);
+	int *dist = f->dist.data;
+	CArray heap;
+	CArrayInit(&heap, sizeof(FlowNode));
+	const FlowNode start = {0, f->target.y * w + f->target.x};
+	dist[start.idx] = 0;
+	FlowHeapPush(&heap, start);
+	FlowFieldPropagate(dist, map, &heap);
+	CArrayTerminate(&heap);
+	f->isValid = true;
+	f->changesApplied = pc->changes.size;
+	PROFILE_END();
+}
+// Lowest distance to x through one of its neighbours
+static int FlowBestFromNeighbours(
+	const int *dist, Map *map, const struct vec2i x)
+{
+	const int w = map->Size.x;
+	int best = FLOW_FIELD_UNREACHABLE;
+	struct vec2i d;
+	for (d.y = -1; d.y <= 1; d.y++)
+	{
+		for (d.x = -1; d.x <= 1; d.x++)
+		{
+			const struct vec2i u = svec2i_add(x, d);
+			if ((d.x == 0 && d.y == 0) || !MapIsTileIn(map, u) ||
+				!CanFlowStep(map, u, x))
+			{
+				continue;
+			}
+			const int du = dist[u.y * w + u.x];
+			if (du != FLOW_FIELD_UNREACHABLE)
+			{
+				best = MIN(best, du + FlowCost(d));
+			}
+		}
+	}
+	return best;
+}
+static void FlowPushAround(CArray *tiles, Map *map, const struct vec2i v)
+{
+	RECT_FOREACH(Rect2iNew(svec2i_subtract(v, svec2i(1, 1)), svec2i(3, 3)))
+	if (MapIsTileIn(map, _v))
+	{
+		const int idx = _v.y * map->Size.x + _v.x;
+		CArrayPushBack(tiles, &idx);
+	}
+	RECT_FOREACH_END()
+}
+// Repair a field after some tiles have changed walkability, for the same
+// target. Only tiles around the changes, and tiles whose shortest path went
+// through them, are recalculated:
+// - Tiles that no longer have a neighbour on a shortest path are reset,
+//   and their neighbours checked in turn
+// - The reset tiles, and the tiles around the changes (which may have gained
+//   a shorter path), are requeued from their neighbours' distances
+static void FlowFieldRepair(
+	FlowField *f, Map *map, const struct vec2i *changes, const size_t n)
+{
+	PROFILE_BEGIN("FlowFieldRepair");
+	const int w = map->Size.x;
+	int *dist = f->dist.data;
+	const int targetIdx = f->target.y * w + f->target.x;
+	CArray check; // of int; tiles that may have lost their shortest path
+	CArrayInit(&check, sizeof(int));
+	CArray requeue; // of int
+	CArrayInit(&requeue, sizeof(int));
+	for (size_t i = 0; i < n; i++)
+	{
+		FlowPushAround(&check, map, changes[i]);
+	}
+	CArrayCopy(&requeue, &check);
+	while (check.size > 0)
+	{
+		const int idx = *(int *)CArrayGet(&check, check.size - 1);
+		CArrayPopBack(&check);
+		if (idx == targetIdx || dist[idx] == FLOW_FIELD_UNREACHABLE)
+		{
+			continue;
+		}
+		const struct vec2i v = svec2i(idx % w, idx / w);
+		if (FlowBestFromNeighbours(dist, map, v) <= dist[idx])
+		{
+			continue;
+		}
+		dist[idx] = FLOW_FIELD_UNREACHABLE;
+		CArrayPushBack(&requeue, &idx);
+		FlowPushAround(&check, map, v);
+	}
+	CArray heap;
+	CArrayInit(&heap, sizeof(FlowNode));
+	CA_FOREACH(const int, idx, requeue)
+	if (*idx == targetIdx)
+	{
+		continue;
+	}
+	const FlowNode node = {
+		FlowBestFromNeighbours(dist, map, svec2i(*idx % w, *idx / w)), *idx};
+	if (node.dist < dist[node.idx])
+	{
+		dist[node.idx] = node.dist;
+		FlowHeapPush(&heap, node);
+	}
+	CA_FOREACH_END()
+	FlowFieldPropagate(dist, map, &heap);
+	CArrayTerminate(&heap);
+	CArrayTerminate(&check);
+	CArrayTerminate(&requeue);
+	PROFILE_END();
+}
+// Fields for actors that have been removed will never be used again
+static void PruneFlowFields(PathCache *pc)
+{
+	for (int i = (int)pc->flowFields.size - 1; i >= 0; i--)
+	{
+		FlowField *f = CArrayGet(&pc->flowFields, i);
+		const TActor *a = ActorGetByUID(f->uid);
+		if (a == NULL || !a->isInUse)
+		{
+			CArrayTerminate(&f->dist);
+			CArrayDelete(&pc->flowFields, i);
+		}
+	}
+}
+static FlowField *GetFlowField(
+	PathCache *pc, const int uid, const struct vec2i target)
+{
+	FlowField *f = NULL;
+	CA_FOREACH(FlowField, ff, pc->flowFields)
+	if (ff->uid == uid)
+	{
+		f = ff;
+		break;
+	}
+	CA_FOREACH_END()
+	if (f == NULL)
+	{
+		PruneFlowFields(pc);
+		FlowField ff;
+		memset(&ff, 0, sizeof ff);
+		ff.uid = uid;
+		CArrayInit(&ff.dist, sizeof(int));
+		f = CArrayPushBack(&pc->flowFields, &ff);
+	}
+	if (!f->isValid || !svec2i_is_equal(f->target, target))
+	{
+		f->target = target;
+		LOG(LM_PATH, LL_TRACE, "flow field for %d to (%d, %d)", uid,
+			target.x, target.y);
+		FlowFieldCalc(f, pc);
+	}
+	else if (f->changesApplied < pc->changes.size)
+	{
+		FlowFieldRepair(
+			f, pc->map, CArrayGet(&pc->changes, f->changesApplied),
+			pc->changes.size - f->changesApplied);
+		f->changesApplied = pc->changes.size;
+		// Forget the changes once every field has them
+		bool allApplied = true;
+		CA_FOREACH(const FlowField, ff, pc->flowFields)
+		if (ff->isValid && ff->changesApplied < pc->changes.size)
+		{
+			allApplied = false;
+			break;
+		}
+		CA_FOREACH_END()
+		if (allApplied)
+		{
+			CArrayClear(&pc->changes);
+			CA_FOREACH(FlowField, ff, pc->flowFields)
+			ff->changesApplied = 0;
+			CA_FOREACH_END()
+		}
+	}
+	return f;
+}
+bool PathCacheFlowStep(
+	PathCache *pc, const int uid, const struct vec2i target,
+	const struct vec2i from, struct vec2i *next)
+{
+	if (!MapIsTileIn(pc->map, target) || !MapIsTileIn(pc->map, from))
+	{
+		return false;
+	}
+	const FlowField *f = GetFlowField(pc, uid, target);
+	const int w = pc->map->Size.x;
+	const int *dist = f->dist.data;
+	const int distFrom = dist[from.y * w + from.x];
+	if (distFrom == FLOW_FIELD_UNREACHABLE)
+	{
+		return false;
+	}
+	*next = from;
+	if (distFrom == 0)
+	{
+		return true;
+	}
+	// Step along the shortest path, i.e. the neighbour whose distance plus
+	// the cost to get there is lowest
+	int best = FLOW_FIELD_UNREACHABLE;
+	struct vec2i d;
+	for (d.y = -1; d.y <= 1; d.y++)
+	{
+		for (d.x = -1; d.x <= 1; d.x++)
+		{
+			const struct vec2i u = svec2i_add(from, d);
+			if ((d.x == 0 && d.y == 0) || !CanFlowStep(pc->map, from, u))
+			{
+				continue;
+			}
+			const int du = dist[u.y * w + u.x];
+			if (du == FLOW_FIELD_UNREACHABLE)
+			{
+				continue;
+			}
+			if (du + FlowCost(d) < best)
+			{
+				best = du + FlowCost(d);
+				*next = u;
+			}
+		}
+	}
+	return true;
+}
@@ -27,6 +27,8 @@
 */
 #pragma once
 
+#include <limits.h>
+
 #include "AStar.h"
 #include "c_array.h"
 #include "map.h"
@@ -42,11 +44,26 @@ typedef struct
 	struct vec2i to;
 } CachedPath;
 
+// Dijkstra distances from every tile to a target tile, so that any number
+// of actors heading for the same target can find their next step cheaply
+typedef struct
+{
+	int uid; // of the actor being targeted
+	struct vec2i target;
+	bool isValid;
+	CArray dist; // of int; FLOW_FIELD_UNREACHABLE if no path
+	size_t changesApplied; // count of PathCache.changes repaired for
+} FlowField;
+#define FLOW_FIELD_UNREACHABLE INT_MAX
+
 typedef struct
 {
 	CArray paths;	// of CachedPath
 	size_t head;
 	Map *map;
+	CArray flowFields; // of FlowField
+	// Tiles whose walkability changed, for repairing the flow fields
+	CArray changes; // of struct vec2i
 } PathCache;
 
 // Cache of A* paths so similar paths don't need to be recalculated
@@ -55,15 +72,31 @@ typedef struct
 extern PathCache gPathCache;
 
 void CachedPathDestroy(CachedPath *c);
+// Free the memory for all path ref counts; call after all paths are destroyed
+void CachedPathsTerminate(void);
 
 void PathCacheInit(PathCache *pc, Map *m);
 void PathCacheTerminate(PathCache *pc);
 
-// Clear all entries in cache
+// Clear all entries in cache, and invalidate flow fields
 // This is done when the underlying map changes, changing paths
 // e.g. keys
 void PathCacheClear(PathCache *pc);
 
+// A single tile changed walkability, e.g. an object blocking it was
+// destroyed; flow fields are repaired around it instead of recalculated
+void PathCacheTileChanged(PathCache *pc, const struct vec2i tile);
+
 CachedPath PathCacheCreate(
 	PathCache *pc, struct vec2i from, struct vec2i to,
 	const bool ignoreObjects, const bool cache);
+
+// Find the next tile to step to from "from" to reach an actor, using a flow
+// field shared by everyone heading for that actor (e.g. a player)
+// The field is recalculated when the actor moves to a different tile, or the
+// cache is cleared, and repaired around any changed tiles
+// Only considers walls, doors and dangerous objects (as IsTileWalkable)
+// Returns false if the actor can't be reached from "from"
+bool PathCacheFlowStep(
+	PathCache *pc, const int uid, const struct vec2i target,
+	const struct vec2i from, struct vec2i *next);
@@ -68,6 +68,20 @@ static struct vec2i PicPixelSize(const Pic *p)
 
 void PicLoad(
 	Pic *p, const struct vec2i size, const struct vec2i offset, const SDL_Surface *image, const bool isHD)
+{
+	PicLoadPixels(p, size, offset, image, isHD);
+	if (p->Data == NULL)
+	{
+		return;
+	}
+	if (!PicTryMakeTex(p))
+	{
+		PicFree(p);
+	}
+}
+void PicLoadPixels(
+	Pic *p, const struct vec2i size, const struct vec2i offset,
+	const SDL_Surface *image, const bool isHD)
 {
 	memset(p, 0, sizeof *p);
 	p->size = size;
@@ -106,15 +120,6 @@ void PicLoad(
 			srcI += image->w - size.x;
 		}
 	}
-
-	if (!PicTryMakeTex(p))
-	{
-		goto bail;
-	}
-	return;
-
-bail:
-	PicFree(p);
 }
 bool PicTryMakeTex(Pic *p)
 {
@@ -314,7 +319,7 @@ color_t PicGetRandomColor(const Pic *p)
 	const struct vec2i size = PicPixelSize(p);
 	for (;;)
 	{
-		const uint32_t px = p->Data[rand() % (size.x * size.y)];
+		const uint32_t px = p->Data[RandInt(RNG_FX, 0, size.x * size.y)];
 		const color_t c = PIXEL2COLOR(px);
 		if (c.a > 0)
 		{
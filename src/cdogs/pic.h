@@ -50,6 +50,11 @@ Uint32 ColorToPixel(
 void PicLoad(
 	Pic *p, const struct vec2i size, const struct vec2i offset,
 	const SDL_Surface *image, const bool isHD);
+// Load the pixels only, without creating the texture
+// Unlike PicLoad, this is safe to call from worker threads
+void PicLoadPixels(
+	Pic *p, const struct vec2i size, const struct vec2i offset,
+	const SDL_Surface *image, const bool isHD);
 bool PicTryMakeTex(Pic *p);
 Pic PicCopy(const Pic *src);
 void PicFree(Pic *pic);
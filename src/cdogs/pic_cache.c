@@ -0,0 +1,384 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "pic_cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "files.h"
+#include "grafx.h"
+#include "log.h"
+#include "utils.h"
+
+#define PIC_CACHE_MAGIC 0x43495043 // "CPIC"
+#define PIC_CACHE_VERSION 1
+
+// File layout, in native byte order since the cache is machine-local:
+// - PicCacheHeader
+// - PicCacheEntry[NumEntries], sorted by path hash then path
+// - NUL-terminated source paths
+// - pixel data, 4-byte aligned; each entry has NumPics slices of W x H
+typedef struct
+{
+	uint32_t Magic;
+	uint32_t Version;
+	// Cached pixels are in the graphics device's format
+	uint32_t PixelFormat;
+	uint32_t NumEntries;
+} PicCacheHeader;
+struct PicCacheEntry
+{
+	uint32_t PathHash;
+	uint32_t PathOffset;
+	int64_t MTime;
+	uint64_t FileSize;
+	// Size of each slice, in pixels
+	uint32_t W;
+	uint32_t H;
+	uint32_t NumPics;
+	uint32_t DataOffset;
+};
+typedef struct PicCacheEntry PicCacheEntry;
+
+static uint32_t HashPath(const char *path)
+{
+	// FNV-1a
+	uint32_t h = 2166136261u;
+	for (const char *c = path; *c; c++)
+	{
+		h ^= (uint8_t)*c;
+		h *= 16777619u;
+	}
+	return h;
+}
+
+static uint32_t GetPixelFormat(void)
+{
+	return gGraphicsDevice.Format != NULL ? gGraphicsDevice.Format->format
+										  : SDL_PIXELFORMAT_UNKNOWN;
+}
+
+bool PicCacheStatFile(PicCacheStat *s, const char *path)
+{
+	struct stat st;
+	if (stat(path, &st) != 0)
+	{
+		return false;
+	}
+	s->MTime = (int64_t)st.st_mtime;
+	s->FileSize = (uint64_t)st.st_size;
+	return true;
+}
+
+bool PicCacheOpen(PicCache *c, const char *filename)
+{
+	memset(c, 0, sizeof *c);
+	if (!FileMapOpen(&c->file, filename))
+	{
+		return false;
+	}
+
+	const PicCacheHeader *h = c->file.Data;
+	if (c->file.Size < sizeof *h || h->Magic != PIC_CACHE_MAGIC ||
+		h->Version != PIC_CACHE_VERSION ||
+		h->PixelFormat != GetPixelFormat() ||
+		(c->file.Size - sizeof *h) / sizeof(PicCacheEntry) < h->NumEntries)
+	{
+		LOG(LM_MAIN, LL_INFO, "Ignoring outdated pic cache %s", filename);
+		PicCacheTerminate(c);
+		return false;
+	}
+	c->numEntries = h->NumEntries;
+	c->entries = (const PicCacheEntry *)(h + 1);
+	return true;
+}
+void PicCacheTerminate(PicCache *c)
+{
+	FileMapClose(&c->file);
+	memset(c, 0, sizeof *c);
+}
+
+int PicCacheCount(const PicCache *c)
+{
+	return (int)c->numEntries;
+}
+
+static const char *EntryPath(const PicCache *c, const PicCacheEntry *e)
+{
+	if (e->PathOffset >= c->file.Size)
+	{
+		return NULL;
+	}
+	const char *path = (const char *)c->file.Data + e->PathOffset;
+	if (memchr(path, '\0', c->file.Size - e->PathOffset) == NULL)
+	{
+		return NULL;
+	}
+	return path;
+}
+static const PicCacheEntry *FindEntry(const PicCache *c, const char *path)
+{
+	const uint32_t hash = HashPath(path);
+	// Binary search for the first entry with this hash
+	uint32_t lo = 0;
+	uint32_t hi = c->numEntries;
+	while (lo < hi)
+	{
+		const uint32_t mid = lo + (hi - lo) / 2;
+		if (c->entries[mid].PathHash < hash)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	for (; lo < c->numEntries && c->entries[lo].PathHash == hash; lo++)
+	{
+		const char *entryPath = EntryPath(c, &c->entries[lo]);
+		if (entryPath != NULL && strcmp(entryPath, path) == 0)
+		{
+			return &c->entries[lo];
+		}
+	}
+	return NULL;
+}
+bool PicCacheGet(
+	const PicCache *c, const char *path, const PicCacheStat *s,
+	const bool isHD, CArray *out)
+{
+	if (c->file.Data == NULL)
+	{
+		return false;
+	}
+	const PicCacheEntry *e = FindEntry(c, path);
+	if (e == NULL || e->MTime != s->MTime || e->FileSize != s->FileSize)
+	{
+		return false;
+	}
+	const uint64_t picSize = (uint64_t)e->W * e->H * sizeof(Uint32);
+	if (e->NumPics == 0 || picSize == 0 ||
+		(uint64_t)e->DataOffset + picSize * e->NumPics > c->file.Size)
+	{
+		return false;
+	}
+	const Uint32 *data =
+		(const Uint32 *)((const char *)c->file.Data + e->DataOffset);
+	for (uint32_t i = 0; i < e->NumPics; i++)
+	{
+		Pic p;
+		memset(&p, 0, sizeof p);
+		p.size = svec2i((int)e->W, (int)e->H);
+		// Pretend to be half the size for HD pics
+		p.isHD = isHD;
+		if (isHD)
+		{
+			p.size = svec2i_scale_divide(p.size, 2);
+		}
+		CMALLOC(p.Data, (size_t)picSize);
+		memcpy(p.Data, data + i * e->W * e->H, (size_t)picSize);
+		CArrayPushBack(out, &p);
+	}
+	return true;
+}
+
+typedef struct
+{
+	char *Path;
+	uint32_t PathHash;
+	PicCacheStat Stat;
+	const CArray *Pics;
+} PicCacheItem;
+
+void PicCacheWriterInit(PicCacheWriter *w)
+{
+	CArrayInit(&w->items, sizeof(PicCacheItem));
+}
+void PicCacheWriterTerminate(PicCacheWriter *w)
+{
+	CA_FOREACH(PicCacheItem, item, w->items)
+	CFREE(item->Path);
+	CA_FOREACH_END()
+	CArrayTerminate(&w->items);
+}
+
+void PicCacheWriterAdd(
+	PicCacheWriter *w, const char *path, const PicCacheStat *s,
+	const CArray *pics)
+{
+	if (pics->size == 0)
+	{
+		return;
+	}
+	PicCacheItem item;
+	CSTRDUP(item.Path, path);
+	item.PathHash = HashPath(path);
+	item.Stat = *s;
+	item.Pics = pics;
+	CArrayPushBack(&w->items, &item);
+}
+
+static int CompareItems(const void *v1, const void *v2)
+{
+	const PicCacheItem *i1 = v1;
+	const PicCacheItem *i2 = v2;
+	if (i1->PathHash != i2->PathHash)
+	{
+		return i1->PathHash < i2->PathHash ? -1 : 1;
+	}
+	return strcmp(i1->Path, i2->Path);
+}
+static struct vec2i PicPixelSize(const Pic *p)
+{
+	return p->isHD ? svec2i_scale(p->size, 2) : p->size;
+}
+bool PicCacheWriterSave(const PicCacheWriter *w, const char *filename)
+{
+	bool res = false;
+	char tmpFilename[CDOGS_PATH_MAX];
+	sprintf(tmpFilename, "%s.tmp", filename);
+	CArray items;
+	CArrayInit(&items, sizeof(PicCacheItem));
+	CArrayCopy(&items, &w->items);
+	if (items.size > 0)
+	{
+		qsort(items.data, items.size, items.elemSize, CompareItems);
+	}
+	FILE *f = fopen(tmpFilename, "wb");
+	if (f == NULL)
+	{
+		LOG(LM_MAIN, LL_ERROR, "Cannot write pic cache %s", tmpFilename);
+		goto bail;
+	}
+
+	PicCacheHeader h;
+	h.Magic = PIC_CACHE_MAGIC;
+	h.Version = PIC_CACHE_VERSION;
+	h.PixelFormat = GetPixelFormat();
+	h.NumEntries = (uint32_t)items.size;
+	if (fwrite(&h, sizeof h, 1, f) != 1)
+	{
+		goto bail;
+	}
+
+	// Lay out paths after the entries, then pixel data after the paths
+	size_t pathOffset = sizeof h + items.size * sizeof(PicCacheEntry);
+	size_t dataOffset = pathOffset;
+	CA_FOREACH(const PicCacheItem, item, items)
+	dataOffset += strlen(item->Path) + 1;
+	CA_FOREACH_END()
+	const size_t padding = (4 - dataOffset % 4) % 4;
+	dataOffset += padding;
+	CA_FOREACH(const PicCacheItem, item, items)
+	const struct vec2i size = PicPixelSize(CArrayGet(item->Pics, 0));
+	PicCacheEntry e;
+	memset(&e, 0, sizeof e);
+	e.PathHash = item->PathHash;
+	e.PathOffset = (uint32_t)pathOffset;
+	e.MTime = item->Stat.MTime;
+	e.FileSize = item->Stat.FileSize;
+	e.W = (uint32_t)size.x;
+	e.H = (uint32_t)size.y;
+	e.NumPics = (uint32_t)item->Pics->size;
+	e.DataOffset = (uint32_t)dataOffset;
+	if (fwrite(&e, sizeof e, 1, f) != 1)
+	{
+		goto bail;
+	}
+	pathOffset += strlen(item->Path) + 1;
+	dataOffset += e.W * e.H * e.NumPics * sizeof(Uint32);
+	CA_FOREACH_END()
+	CA_FOREACH(const PicCacheItem, item, items)
+	if (fwrite(item->Path, strlen(item->Path) + 1, 1, f) != 1)
+	{
+		goto bail;
+	}
+	CA_FOREACH_END()
+	const char zeros[4] = {0, 0, 0, 0};
+	if (padding > 0 && fwrite(zeros, padding, 1, f) != 1)
+	{
+		goto bail;
+	}
+	CA_FOREACH(const PicCacheItem, item, items)
+	for (int i = 0; i < (int)item->Pics->size; i++)
+	{
+		const Pic *pic = CArrayGet(item->Pics, i);
+		const struct vec2i size = PicPixelSize(pic);
+		const size_t n = (size_t)(size.x * size.y);
+		if (pic->Data == NULL)
+		{
+			// Keep the layout consistent for pics that failed to load
+			const Uint32 empty = 0;
+			for (size_t j = 0; j < n; j++)
+			{
+				if (fwrite(&empty, sizeof empty, 1, f) != 1)
+				{
+					goto bail;
+				}
+			}
+			continue;
+		}
+		if (fwrite(pic->Data, sizeof(Uint32), n, f) != n)
+		{
+			goto bail;
+		}
+	}
+	CA_FOREACH_END()
+
+	if (fclose(f) != 0)
+	{
+		f = NULL;
+		goto bail;
+	}
+	f = NULL;
+	remove(filename);
+	if (rename(tmpFilename, filename) != 0)
+	{
+		LOG(LM_MAIN, LL_ERROR, "Cannot rename pic cache to %s", filename);
+		goto bail;
+	}
+	LOG(LM_MAIN, LL_INFO, "Saved pic cache %s (%d files)", filename,
+		(int)items.size);
+	res = true;
+
+bail:
+	if (f != NULL)
+	{
+		fclose(f);
+	}
+	if (!res)
+	{
+		remove(tmpFilename);
+	}
+	CArrayTerminate(&items);
+	return res;
+}
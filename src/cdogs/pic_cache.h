@@ -0,0 +1,80 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "c_array.h"
+#include "files.h"
+#include "pic.h"
+
+// On-disk cache of decoded, converted and sliced pics, so that cold starts
+// don't have to decode every PNG again
+// The file is memory-mapped where possible and read-only once opened, so it
+// can be queried from the image loader threads
+#define PIC_CACHE_FILE "pics.cache"
+
+typedef struct
+{
+	FileMapping file;
+	uint32_t numEntries;
+	const struct PicCacheEntry *entries;
+} PicCache;
+
+// Source file stats that the cache entries are keyed on, along with the path
+typedef struct
+{
+	int64_t MTime;
+	uint64_t FileSize;
+} PicCacheStat;
+
+bool PicCacheStatFile(PicCacheStat *s, const char *path);
+
+// Returns false if the cache doesn't exist or is invalid
+bool PicCacheOpen(PicCache *c, const char *filename);
+void PicCacheTerminate(PicCache *c);
+int PicCacheCount(const PicCache *c);
+// Load all the pics cached for the file at path, if they are up to date
+// Pics are pushed into out (of Pic), without textures
+bool PicCacheGet(
+	const PicCache *c, const char *path, const PicCacheStat *s,
+	const bool isHD, CArray *out);
+
+typedef struct
+{
+	CArray items; // of PicCacheItem
+} PicCacheWriter;
+void PicCacheWriterInit(PicCacheWriter *w);
+void PicCacheWriterTerminate(PicCacheWriter *w);
+// pics must remain valid until the writer is saved
+void PicCacheWriterAdd(
+	PicCacheWriter *w, const char *path, const PicCacheStat *s,
+	const CArray *pics);
+bool PicCacheWriterSave(const PicCacheWriter *w, const char *filename);
@@ -31,6 +31,7 @@
 
 #include "files.h"
 #include "log.h"
+#include "pic_cache.h"
 
 #define GRAPHICS_DIR "graphics"
 #define GRAPHICS_HD_DIR "graphics_hd"
@@ -58,129 +59,194 @@ void PicManagerInit(PicManager *pm)
 static NamedPic *AddNamedPic(map_t pics, const char *name, const Pic *p);
 static NamedSprites *AddNamedSprites(map_t sprites, const char *name);
 static void AfterAdd(PicManager *pm);
-static void PicManagerAdd(
-	map_t pics, map_t sprites, const char *name, SDL_Surface *imageIn,
-	const bool isHD)
+
+// Loading is split in two phases:
+// - decoding, format conversion, slicing and char colour conversion, which is
+//   CPU heavy and done on worker threads
+// - adding to the maps and creating textures, which is done on the main
+//   thread, in the same order as the files were found
+#define PIC_LOAD_MAX_THREADS 8
+typedef struct
+{
+	char path[CDOGS_PATH_MAX];
+	char name[CDOGS_FILENAME_MAX];
+	map_t pics;
+	map_t sprites;
+	bool isHD;
+	bool isSpritesheet;
+	struct vec2i size;
+	// Results
+	bool loaded;
+	bool statOk;
+	PicCacheStat stat;
+	bool cached;
+	CArray loadedPics; // of Pic
+} PicLoadJob;
+static void PicLoadJobInit(
+	PicLoadJob *j, const char *path, const char *name, map_t pics,
+	map_t sprites, const bool isHD)
 {
-	char buf[CDOGS_FILENAME_MAX];
+	memset(j, 0, sizeof *j);
+	strcpy(j->path, path);
 	const char *dot = strrchr(name, '.');
 	if (dot)
 	{
-		strncpy(buf, name, dot - name);
-		buf[dot - name] = '\0';
+		strncpy(j->name, name, dot - name);
+		j->name[dot - name] = '\0';
 	}
 	else
 	{
-		strcpy(buf, name);
+		strcpy(j->name, name);
 	}
+	j->pics = pics;
+	j->sprites = sprites;
+	j->isHD = isHD;
 	// TODO: check if name already exists
 	// Special case: if the file name is in the form foobar_WxH.ext,
 	// this is a spritesheet where each sprite is W wide by H high
 	// Load multiple images from this single sheet
-	struct vec2i size = svec2i(imageIn->w, imageIn->h);
-	bool isSpritesheet = false;
-	char *underscore = strrchr(buf, '_');
-	const char *x = strrchr(buf, 'x');
+	char *underscore = strrchr(j->name, '_');
+	const char *x = strrchr(j->name, 'x');
 	if (underscore != NULL && x != NULL && underscore + 1 < x &&
-		x + 1 < buf + strlen(buf))
+		x + 1 < j->name + strlen(j->name) &&
+		sscanf(underscore, "_%dx%d", &j->size.x, &j->size.y) == 2)
+	{
+		*underscore = '\0';
+		j->isSpritesheet = true;
+	}
+	CArrayInit(&j->loadedPics, sizeof(Pic));
+}
+
+static void ConvertCharPic(Pic *pic, const char *name)
+{
+	// All head parts use hair color, so determine
+	// which head part we are looking at
+	const char *subfolder = name + strlen("chars/");
+	CharColorType headPartColor = CHAR_COLOR_HAIR;
+	if (strncmp("facehairs/", subfolder, strlen("facehairs/")) == 0)
+	{
+		headPartColor = CHAR_COLOR_FACEHAIR;
+	}
+	else if (strncmp("hats/", subfolder, strlen("hats/")) == 0)
 	{
-		if (sscanf(underscore, "_%dx%d", &size.x, &size.y) != 2)
+		headPartColor = CHAR_COLOR_HAT;
+	}
+	else if (strncmp("glasses/", subfolder, strlen("glasses/")) == 0)
+	{
+		headPartColor = CHAR_COLOR_GLASSES;
+	}
+	// Convert char pics to multichannel version
+	for (int i = 0; i < pic->size.x * pic->size.y; i++)
+	{
+		color_t c = PIXEL2COLOR(pic->Data[i]);
+		// Don't bother if the alpha has already been modified; it
+		// means we have already processed this pixel
+		if (c.a != 255)
 		{
-			size = svec2i(imageIn->w, imageIn->h);
+			continue;
 		}
-		else
+		// Convert character color keyed color to
+		// greyscale + special alpha
+		const CharColorType colorType =
+			CharColorTypeFromColor(c, headPartColor);
+		color_t converted = c;
+		if (colorType != CHAR_COLOR_COUNT)
 		{
-			*underscore = '\0';
-			isSpritesheet = true;
+			const uint8_t value = MAX(MAX(c.r, c.g), c.b);
+			converted.r = converted.g = converted.b = value;
+			converted.a = CharColorTypeAlpha(colorType);
 		}
+		pic->Data[i] = COLOR2PIXEL(converted);
 	}
-	NamedSprites *nsp = NULL;
-	NamedPic *np = NULL;
-	if (isSpritesheet)
+}
+
+// Runs on worker threads; must not touch the maps, textures or log
+static void PicLoadJobRun(PicLoadJob *j, const PicCache *cache)
+{
+	j->statOk = PicCacheStatFile(&j->stat, j->path);
+	if (cache != NULL && j->statOk &&
+		PicCacheGet(cache, j->path, &j->stat, j->isHD, &j->loadedPics))
 	{
-		nsp = AddNamedSprites(sprites, buf);
+		j->loaded = true;
+		j->cached = true;
+		return;
 	}
-	else
+	SDL_Surface *imageIn = LoadImgToSurface(j->path);
+	if (imageIn == NULL)
 	{
-		np = AddNamedPic(pics, buf, NULL);
+		return;
 	}
+	const struct vec2i size =
+		j->isSpritesheet ? j->size : svec2i(imageIn->w, imageIn->h);
 	// Use 32-bit image
 	SDL_Surface *image =
 		SDL_ConvertSurfaceFormat(imageIn, SDL_PIXELFORMAT_RGBA8888, 0);
+	SDL_FreeSurface(imageIn);
+	if (image == NULL)
+	{
+		return;
+	}
+	const bool isChar = strncmp("chars/", j->name, strlen("chars/")) == 0;
 	SDL_LockSurface(image);
 	struct vec2i offset;
 	for (offset.y = 0; offset.y < image->h; offset.y += size.y)
 	{
 		for (offset.x = 0; offset.x < image->w; offset.x += size.x)
 		{
-			Pic *pic;
-			if (isSpritesheet)
+			Pic pic;
+			PicLoadPixels(&pic, size, offset, image, j->isHD);
+			if (isChar)
 			{
-				Pic p;
-				memset(&p, 0, sizeof p);
-				CArrayPushBack(&nsp->pics, &p);
-				pic = CArrayGet(&nsp->pics, nsp->pics.size - 1);
-			}
-			else
-			{
-				pic = &np->pic;
-			}
-			PicLoad(pic, size, offset, image, isHD);
-
-			if (strncmp("chars/", buf, strlen("chars/")) == 0)
-			{
-				// All head parts use hair color, so determine
-				// which head part we are looking at
-				const char *subfolder = buf + strlen("chars/");
-				CharColorType headPartColor = CHAR_COLOR_HAIR;
-				if (strncmp("facehairs/", subfolder, strlen("facehairs/")) ==
-					0)
-				{
-					headPartColor = CHAR_COLOR_FACEHAIR;
-				}
-				else if (strncmp("hats/", subfolder, strlen("hats/")) == 0)
-				{
-					headPartColor = CHAR_COLOR_HAT;
-				}
-				else if (
-					strncmp("glasses/", subfolder, strlen("glasses/")) == 0)
-				{
-					headPartColor = CHAR_COLOR_GLASSES;
-				}
-				// Convert char pics to multichannel version
-				for (int i = 0; i < pic->size.x * pic->size.y; i++)
-				{
-					color_t c = PIXEL2COLOR(pic->Data[i]);
-					// Don't bother if the alpha has already been modified; it
-					// means we have already processed this pixel
-					if (c.a != 255)
-					{
-						continue;
-					}
-					// Convert character color keyed color to
-					// greyscale + special alpha
-					const CharColorType colorType =
-						CharColorTypeFromColor(c, headPartColor);
-					color_t converted = c;
-					if (colorType != CHAR_COLOR_COUNT)
-					{
-						const uint8_t value = MAX(MAX(c.r, c.g), c.b);
-						converted.r = converted.g = converted.b = value;
-						converted.a = CharColorTypeAlpha(colorType);
-					}
-					pic->Data[i] = COLOR2PIXEL(converted);
-				}
+				ConvertCharPic(&pic, j->name);
 			}
+			CArrayPushBack(&j->loadedPics, &pic);
 		}
 	}
 	SDL_UnlockSurface(image);
 	SDL_FreeSurface(image);
+	j->loaded = true;
+}
 
-	AfterAdd(&gPicManager);
+static void PicLoadJobAdd(PicLoadJob *j)
+{
+	if (!j->loaded)
+	{
+		LOG(LM_MAIN, LL_ERROR, "Cannot load image %s", j->path);
+		return;
+	}
+	if (j->isSpritesheet)
+	{
+		NamedSprites *nsp = AddNamedSprites(j->sprites, j->name);
+		CA_FOREACH(Pic, pic, j->loadedPics)
+		if (nsp == NULL)
+		{
+			PicFree(pic);
+			continue;
+		}
+		if (!PicTryMakeTex(pic))
+		{
+			PicFree(pic);
+		}
+		CArrayPushBack(&nsp->pics, pic);
+		CA_FOREACH_END()
+	}
+	else
+	{
+		Pic *pic = CArrayGet(&j->loadedPics, 0);
+		if (!PicTryMakeTex(pic))
+		{
+			PicFree(pic);
+		}
+		if (AddNamedPic(j->pics, j->name, pic) == NULL)
+		{
+			PicFree(pic);
+		}
+	}
+	CArrayTerminate(&j->loadedPics);
 }
 
-void PicManagerLoadDir(
-	PicManager *pm, const char *path, const char *prefix, map_t pics,
+static void EnumerateDir(
+	CArray *jobs, const char *path, const char *prefix, map_t pics,
 	map_t sprites, const bool isHD)
 {
 	tinydir_dir dir;
@@ -205,26 +271,20 @@ void PicManagerLoadDir(
 		}
 		if (file.is_reg && Stricmp(file.extension, "png") == 0)
 		{
-			SDL_Surface *data = LoadImgToSurface(file.path);
-			if (!data)
+			char buf[CDOGS_PATH_MAX];
+			if (prefix)
 			{
-				LOG(LM_MAIN, LL_ERROR, "Cannot load image");
+				char buf1[CDOGS_PATH_MAX];
+				sprintf(buf1, "%s/%s", prefix, file.name);
+				PathGetWithoutExtension(buf, buf1);
 			}
 			else
 			{
-				char buf[CDOGS_PATH_MAX];
-				if (prefix)
-				{
-					char buf1[CDOGS_PATH_MAX];
-					sprintf(buf1, "%s/%s", prefix, file.name);
-					PathGetWithoutExtension(buf, buf1);
-				}
-				else
-				{
-					PathGetBasenameWithoutExtension(buf, file.name);
-				}
-				PicManagerAdd(pics, sprites, buf, data, isHD);
+				PathGetBasenameWithoutExtension(buf, file.name);
 			}
+			PicLoadJob j;
+			PicLoadJobInit(&j, file.path, buf, pics, sprites, isHD);
+			CArrayPushBack(jobs, &j);
 		}
 		else if (file.is_dir && file.name[0] != '.')
 		{
@@ -232,12 +292,12 @@ void PicManagerLoadDir(
 			{
 				char buf[CDOGS_PATH_MAX];
 				sprintf(buf, "%s/%s", prefix, file.name);
-				PicManagerLoadDir(pm, file.path, buf, pics, sprites, isHD);
+				EnumerateDir(jobs, file.path, buf, pics, sprites, isHD);
 			}
 			else
 			{
-				PicManagerLoadDir(
-					pm, file.path, file.name, pics, sprites, isHD);
+				EnumerateDir(
+					jobs, file.path, file.name, pics, sprites, isHD);
 			}
 		}
 	}
@@ -245,13 +305,135 @@ void PicManagerLoadDir(
 bail:
 	tinydir_close(&dir);
 }
+
+typedef struct
+{
+	CArray *jobs;
+	const PicCache *cache;
+	SDL_atomic_t next;
+} PicLoadWork;
+static int PicLoadWorker(void *data)
+{
+	PicLoadWork *w = data;
+	for (;;)
+	{
+		const int i = SDL_AtomicAdd(&w->next, 1);
+		if (i >= (int)w->jobs->size)
+		{
+			break;
+		}
+		PicLoadJobRun(CArrayGet(w->jobs, i), w->cache);
+	}
+	return 0;
+}
+// Returns the number of threads used, including the calling thread
+static int RunPicLoadJobs(CArray *jobs, const PicCache *cache)
+{
+	PicLoadWork w;
+	w.jobs = jobs;
+	w.cache = cache;
+	SDL_AtomicSet(&w.next, 0);
+	// Don't bother spinning up threads for a handful of images
+	const int numWorkers = CLAMP(
+		MIN(SDL_GetCPUCount() - 1, (int)jobs->size / 16), 0,
+		PIC_LOAD_MAX_THREADS - 1);
+	SDL_Thread *threads[PIC_LOAD_MAX_THREADS];
+	int numThreads = 0;
+	for (int i = 0; i < numWorkers; i++)
+	{
+		SDL_Thread *t = SDL_CreateThread(PicLoadWorker, "PicLoad", &w);
+		if (t == NULL)
+		{
+			LOG(LM_MAIN, LL_WARN, "Cannot create image loader thread: %s",
+				SDL_GetError());
+			break;
+		}
+		threads[numThreads++] = t;
+	}
+	// Help out on this thread too
+	PicLoadWorker(&w);
+	for (int i = 0; i < numThreads; i++)
+	{
+		SDL_WaitThread(threads[i], NULL);
+	}
+	return numThreads + 1;
+}
+
+static void AddPicJobs(PicManager *pm, CArray *jobs)
+{
+	CA_FOREACH(PicLoadJob, j, *jobs)
+	PicLoadJobAdd(j);
+	CA_FOREACH_END()
+	// Only rebuild the style indices once, after everything is added
+	AfterAdd(pm);
+}
+
+void PicManagerLoadDir(
+	PicManager *pm, const char *path, const char *prefix, map_t pics,
+	map_t sprites, const bool isHD)
+{
+	CArray jobs;
+	CArrayInit(&jobs, sizeof(PicLoadJob));
+	EnumerateDir(&jobs, path, prefix, pics, sprites, isHD);
+	RunPicLoadJobs(&jobs, NULL);
+	AddPicJobs(pm, &jobs);
+	CArrayTerminate(&jobs);
+}
+static void SavePicCache(const char *filename, const CArray *jobs)
+{
+	PicCacheWriter w;
+	PicCacheWriterInit(&w);
+	CA_FOREACH(const PicLoadJob, j, *jobs)
+	if (j->loaded && j->statOk)
+	{
+		PicCacheWriterAdd(&w, j->path, &j->stat, &j->loadedPics);
+	}
+	CA_FOREACH_END()
+	PicCacheWriterSave(&w, filename);
+	PicCacheWriterTerminate(&w);
+}
 void PicManagerLoad(PicManager *pm)
 {
+	const Uint64 start = SDL_GetPerformanceCounter();
+	CArray jobs;
+	CArrayInit(&jobs, sizeof(PicLoadJob));
 	char buf[CDOGS_PATH_MAX];
 	GetDataFilePath(buf, GRAPHICS_DIR);
-	PicManagerLoadDir(pm, buf, NULL, pm->pics, pm->sprites, false);
+	EnumerateDir(&jobs, buf, NULL, pm->pics, pm->sprites, false);
 	GetDataFilePath(buf, GRAPHICS_HD_DIR);
-	PicManagerLoadDir(pm, buf, NULL, pm->pics, pm->sprites, true);
+	EnumerateDir(&jobs, buf, NULL, pm->pics, pm->sprites, true);
+
+	char cachePath[CDOGS_PATH_MAX];
+	strcpy(cachePath, GetConfigFilePath(PIC_CACHE_FILE));
+	PicCache cache;
+	const bool hasCache = PicCacheOpen(&cache, cachePath);
+	const int numThreads = RunPicLoadJobs(&jobs, hasCache ? &cache : NULL);
+	int numCached = 0;
+	CA_FOREACH(const PicLoadJob, j, jobs)
+	if (j->cached)
+	{
+		numCached++;
+	}
+	CA_FOREACH_END()
+	// Rewrite the cache if any file was added, changed or removed
+	const bool isStale = numCached != (int)jobs.size ||
+						 (hasCache && PicCacheCount(&cache) != numCached);
+	if (hasCache)
+	{
+		PicCacheTerminate(&cache);
+	}
+	if (isStale)
+	{
+		SavePicCache(cachePath, &jobs);
+	}
+
+	AddPicJobs(pm, &jobs);
+	const Uint64 elapsedMs = (SDL_GetPerformanceCounter() - start) * 1000 /
+							 SDL_GetPerformanceFrequency();
+	LOG(LM_MAIN, LL_INFO,
+		"Loaded %d images (%d cached) in %dms using %d threads",
+		(int)jobs.size, numCached, (int)elapsedMs, numThreads);
+	CArrayTerminate(&jobs);
 }
 
 static void FindStylePics(
@@ -29,6 +29,7 @@
 
 #include "ammo.h"
 #include "game_events.h"
+#include "json_stream.h"
 #include "json_utils.h"
 #include "log.h"
 #include "mission.h"
@@ -245,55 +246,86 @@ void PickupClassesInit(
 
 	char buf[CDOGS_PATH_MAX];
 	GetDataFilePath(buf, filename);
-	FILE *f = fopen(buf, "r");
-	json_t *root = NULL;
-	if (f == NULL)
+	if (!PickupClassesLoadFile(&classes->Classes, buf))
 	{
 		LOG(LM_MAIN, LL_ERROR, "Error: cannot load pickups file %s", buf);
-		goto bail;
-	}
-	enum json_error e = json_stream_parse(f, &root);
-	if (e != JSON_OK)
-	{
-		LOG(LM_MAIN, LL_ERROR, "Error parsing pickups file %s", buf);
-		goto bail;
+		return;
 	}
-	PickupClassesLoadJSON(&classes->Classes, root);
 	PickupClassesLoadAmmo(&classes->Classes, &ammo->Ammo);
 	PickupClassesLoadGuns(&classes->Classes, &guns->Guns);
 	PickupClassesLoadKeys(&classes->KeyClasses);
-
-bail:
-	if (f != NULL)
-	{
-		fclose(f);
-	}
-	json_free_value(&root);
 }
-static void LoadPickupclass(PickupClass *c, json_t *node, const int version);
-void PickupClassesLoadJSON(CArray *classes, json_t *root)
-{
-	int version = -1;
-	LoadInt(&version, root, "Version");
-	if (version > VERSION || version <= 0)
-	{
-		CASSERT(false, "cannot read pickups file version");
-		return;
-	}
 
-	json_t *pickupsNode = json_find_first_label(root, "Pickups")->child;
-	for (json_t *child = pickupsNode->child; child; child = child->next)
+// Pickup class being streamed, with its effects and pic
+typedef struct
+{
+	PickupClass c;
+	json_t *node;
+} PickupClassLoad;
+// Before version 3 the single effect's fields are in the class itself
+static const JSONField pickupClassFields[] = {
+	JSON_FIELD("Name", JSON_FIELD_STRING, PickupClassLoad, c.Name),
+	JSON_FIELD("Effects", JSON_FIELD_NODE, PickupClassLoad, node),
+	JSON_FIELD("Pic", JSON_FIELD_NODE, PickupClassLoad, node),
+	JSON_FIELD("Sound", JSON_FIELD_NODE, PickupClassLoad, node),
+	JSON_FIELD("Type", JSON_FIELD_NODE, PickupClassLoad, node),
+	JSON_FIELD("Score", JSON_FIELD_NODE, PickupClassLoad, node),
+	JSON_FIELD("Health", JSON_FIELD_NODE, PickupClassLoad, node),
+	JSON_FIELD("ExceedMax", JSON_FIELD_NODE, PickupClassLoad, node),
+	JSON_FIELD("Ammo", JSON_FIELD_NODE, PickupClassLoad, node),
+	JSON_FIELD("Amount", JSON_FIELD_NODE, PickupClassLoad, node),
+	JSON_FIELD("Lives", JSON_FIELD_NODE, PickupClassLoad, node),
+	JSON_FIELD("Menu", JSON_FIELD_NODE, PickupClassLoad, node),
+	JSON_FIELDS_END};
+static void LoadPickupNode(PickupClass *c, json_t *node, const int version);
+static void PickupClassLoadInit(void *data, void *classes)
+{
+	UNUSED(classes);
+	PickupClassInit(&((PickupClassLoad *)data)->c);
+}
+static void PickupClassLoadAdd(void *data, const int version, void *classes)
+{
+	PickupClassLoad *l = data;
+	if (l->node == NULL)
+	{
+		l->node = json_new_object();
+	}
+	LoadPickupNode(&l->c, l->node, version);
+	json_free_value(&l->node);
+	CArrayPushBack(classes, &l->c);
+}
+static void PickupClassLoadTerminate(void *data)
+{
+	PickupClassLoad *l = data;
+	PickupClassTerminate(&l->c);
+	json_free_value(&l->node);
+}
+bool PickupClassesLoadFile(CArray *classes, const char *path)
+{
+	FILE *f = fopen(path, "r");
+	if (f == NULL)
 	{
-		PickupClass c;
-		LoadPickupclass(&c, child, version);
-		CArrayPushBack(classes, &c);
-	}
+		return false;
+	}
+	const JSONClassSchema schema = {
+		"Pickups",
+		pickupClassFields,
+		sizeof(PickupClassLoad),
+		VERSION,
+		PickupClassLoadInit,
+		PickupClassLoadAdd,
+		PickupClassLoadTerminate,
+		classes,
+		NULL,
+		NULL};
+	const int version = JSONStreamLoadClasses(&schema, f);
+	fclose(f);
+	return version > 0;
 }
 static PickupEffect LoadPickupEffect(json_t *node, const int version);
-static void LoadPickupclass(PickupClass *c, json_t *node, const int version)
+// Load the fields captured in the class's node, once the version is known
+static void LoadPickupNode(PickupClass *c, json_t *node, const int version)
 {
-	PickupClassInit(c);
-
 	if (version < 3)
 	{
 		PickupEffect p = LoadPickupEffect(node, version);
@@ -345,7 +377,6 @@ static void LoadPickupclass(PickupClass *c, json_t *node, const int version)
 			}
 		}
 	}
-	c->Name = GetString(node, "Name");
 	json_t *picNode = json_find_first_label(node, "Pic")->child;
 	if (version < 2)
 	{
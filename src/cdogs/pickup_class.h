@@ -116,7 +116,7 @@ void PickupEffectTerminate(PickupEffect *e);
 void PickupClassesInit(
 	PickupClasses *classes, const char *filename, const AmmoClasses *ammo,
 	const WeaponClasses *guns);
-void PickupClassesLoadJSON(CArray *classes, json_t *root);
+bool PickupClassesLoadFile(CArray *classes, const char *path);
 void PickupClassesLoadAmmo(CArray *classes, const CArray *ammoClasses);
 void PickupClassesLoadGuns(CArray *classes, const CArray *gunClasses);
 void PickupClassesLoadKeys(CArray *classes);
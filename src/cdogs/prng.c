@@ -0,0 +1,142 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "prng.h"
+
+// Arbitrary non-zero state so the streams are usable before being seeded
+PRNG gRandStreams[RNG_COUNT] = {
+	{{0x9E3779B9, 0x243F6A88, 0xB7E15162, 0x1}},
+	{{0x9E3779B9, 0x243F6A88, 0xB7E15162, 0x2}},
+	{{0x9E3779B9, 0x243F6A88, 0xB7E15162, 0x3}},
+};
+
+static uint64_t SplitMix64(uint64_t *x)
+{
+	uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+void PRNGSeed(PRNG *r, const uint64_t seed)
+{
+	// Expand the seed with splitmix64, as recommended for xoshiro
+	uint64_t x = seed;
+	const uint64_t a = SplitMix64(&x);
+	const uint64_t b = SplitMix64(&x);
+	r->s[0] = (uint32_t)a;
+	r->s[1] = (uint32_t)(a >> 32);
+	r->s[2] = (uint32_t)b;
+	r->s[3] = (uint32_t)(b >> 32);
+	if (r->s[0] == 0 && r->s[1] == 0 && r->s[2] == 0 && r->s[3] == 0)
+	{
+		// All-zero state is invalid
+		r->s[0] = 1;
+	}
+}
+
+static uint32_t Rotl(const uint32_t x, const int k)
+{
+	return (x << k) | (x >> (32 - k));
+}
+uint32_t PRNGNext(PRNG *r)
+{
+	const uint32_t result = Rotl(r->s[1] * 5, 7) * 9;
+	const uint32_t t = r->s[1] << 9;
+	r->s[2] ^= r->s[0];
+	r->s[3] ^= r->s[1];
+	r->s[1] ^= r->s[2];
+	r->s[0] ^= r->s[3];
+	r->s[2] ^= t;
+	r->s[3] = Rotl(r->s[3], 11);
+	return result;
+}
+
+int PRNGInt(PRNG *r, const int low, const int high)
+{
+	if (low == high)
+	{
+		return low;
+	}
+	// Use 31 bits so the result is non-negative, like rand()
+	const int x = (int)(PRNGNext(r) >> 1);
+	return low + x % (high - low);
+}
+double PRNGDouble(PRNG *r, const double low, const double high)
+{
+	return low + (double)PRNGNext(r) / UINT32_MAX * (high - low);
+}
+bool PRNGBool(PRNG *r)
+{
+	return PRNGNext(r) >> 31;
+}
+uint32_t PRNGChecksum(const PRNG *r)
+{
+	// FNV-1a over the state words
+	uint32_t h = 2166136261u;
+	for (int i = 0; i < 4; i++)
+	{
+		h = (h ^ r->s[i]) * 16777619u;
+	}
+	return h;
+}
+
+void RandSeed(const uint64_t seed)
+{
+	for (int i = 0; i < RNG_COUNT; i++)
+	{
+		RandSeedStream((RandStream)i, seed);
+	}
+}
+void RandSeedStream(const RandStream s, const uint64_t seed)
+{
+	PRNGSeedStream(&gRandStreams[s], s, seed);
+}
+void PRNGSeedStream(PRNG *r, const RandStream s, const uint64_t seed)
+{
+	// Mix in the stream index so streams with the same seed are independent
+	PRNGSeed(r, seed ^ ((uint64_t)(s + 1) << 56));
+}
+int RandInt(const RandStream s, const int low, const int high)
+{
+	return PRNGInt(&gRandStreams[s], low, high);
+}
+float RandFloat(const RandStream s, const float low, const float high)
+{
+	return (float)PRNGDouble(&gRandStreams[s], low, high);
+}
+double RandDouble(const RandStream s, const double low, const double high)
+{
+	return PRNGDouble(&gRandStreams[s], low, high);
+}
+bool RandBool(const RandStream s)
+{
+	return PRNGBool(&gRandStreams[s]);
+}
+uint32_t RandChecksum(const RandStream s)
+{
+	return PRNGChecksum(&gRandStreams[s]);
+}
@@ -0,0 +1,72 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Small, fast pseudo-random number generator (xoshiro128**)
+// State is explicit so that results are reproducible and independent of
+// libc rand(), which is shared global state (and locked on some platforms)
+typedef struct
+{
+	uint32_t s[4];
+} PRNG;
+
+void PRNGSeed(PRNG *r, const uint64_t seed);
+uint32_t PRNGNext(PRNG *r);
+// Random int in [low, high); returns low if low == high
+int PRNGInt(PRNG *r, const int low, const int high);
+// Random double in [low, high]
+double PRNGDouble(PRNG *r, const double low, const double high);
+bool PRNGBool(PRNG *r);
+// Hash of the current state, for checking that two simulations are in sync
+uint32_t PRNGChecksum(const PRNG *r);
+
+// Separate random streams so that e.g. cosmetic effects, which may differ
+// between client and server or depend on frame rate, do not perturb the
+// simulation
+typedef enum
+{
+	RNG_SIM, // game simulation; AI, weapons, spawning
+	RNG_FX,	 // cosmetic effects; particles, animations, sounds
+	RNG_MAP, // map generation
+	RNG_COUNT
+} RandStream;
+extern PRNG gRandStreams[RNG_COUNT];
+
+// Seed all streams, e.g. at the start of a mission
+void RandSeed(const uint64_t seed);
+void RandSeedStream(const RandStream s, const uint64_t seed);
+// Seed a generator the same way as a stream, without touching the stream
+void PRNGSeedStream(PRNG *r, const RandStream s, const uint64_t seed);
+int RandInt(const RandStream s, const int low, const int high);
+float RandFloat(const RandStream s, const float low, const float high);
+double RandDouble(const RandStream s, const double low, const double high);
+bool RandBool(const RandStream s);
+uint32_t RandChecksum(const RandStream s);
@@ -0,0 +1,231 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "profiler.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <SDL_timer.h>
+
+#include "log.h"
+#include "utils.h"
+
+Profiler gProfiler;
+
+void ProfilerInit(Profiler *p)
+{
+	memset(p, 0, sizeof *p);
+	CCALLOC(p->frames, PROFILER_FRAMES * sizeof *p->frames);
+	p->frequency = SDL_GetPerformanceFrequency();
+	p->origin = SDL_GetPerformanceCounter();
+}
+void ProfilerTerminate(Profiler *p)
+{
+	CFREE(p->frames);
+	memset(p, 0, sizeof *p);
+}
+
+void ProfilerFrameBegin(Profiler *p)
+{
+	const uint64_t now = SDL_GetPerformanceCounter();
+	if (p->active)
+	{
+		// Close any zones left open, then the frame itself
+		while (p->depth > 0)
+		{
+			ProfilerZoneEnd(p);
+		}
+		p->frames[p->frameIndex].End = now;
+		p->frameIndex = (p->frameIndex + 1) % PROFILER_FRAMES;
+		p->numFrames = MIN(p->numFrames + 1, PROFILER_FRAMES);
+	}
+	p->active = p->Enabled && p->frames != NULL;
+	if (p->active)
+	{
+		ProfilerFrame *f = &p->frames[p->frameIndex];
+		f->Start = now;
+		f->End = 0;
+		f->NumEvents = 0;
+		p->depth = 0;
+	}
+}
+
+void ProfilerZoneBegin(Profiler *p, const char *name)
+{
+	if (p->depth == PROFILER_MAX_DEPTH)
+	{
+		return;
+	}
+	ProfilerFrame *f = &p->frames[p->frameIndex];
+	if (f->NumEvents == PROFILER_MAX_EVENTS)
+	{
+		// Out of space; still track depth so the zones stay balanced
+		p->stack[p->depth] = -1;
+		p->depth++;
+		return;
+	}
+	ProfilerEvent *e = &f->Events[f->NumEvents];
+	e->Name = name;
+	e->Depth = p->depth;
+	e->End = 0;
+	p->stack[p->depth] = f->NumEvents;
+	p->depth++;
+	f->NumEvents++;
+	// Read the timer last so the bookkeeping isn't counted
+	e->Start = SDL_GetPerformanceCounter();
+}
+void ProfilerZoneEnd(Profiler *p)
+{
+	const uint64_t now = SDL_GetPerformanceCounter();
+	if (p->depth == 0)
+	{
+		return;
+	}
+	p->depth--;
+	const int idx = p->stack[p->depth];
+	if (idx >= 0)
+	{
+		p->frames[p->frameIndex].Events[idx].End = now;
+	}
+}
+
+void ProfilerToggleOverlay(Profiler *p)
+{
+	p->ShowOverlay = !p->ShowOverlay;
+	// Keep profiling if it was enabled from the command line
+	if (p->ShowOverlay)
+	{
+		p->Enabled = true;
+	}
+	LOG(LM_MAIN, LL_INFO, "profiler overlay %s",
+		p->ShowOverlay ? "on" : "off");
+}
+
+static double ToMs(const Profiler *p, const uint64_t ticks)
+{
+	return (double)ticks * 1000.0 / (double)p->frequency;
+}
+// Get the recorded frames, oldest first
+static const ProfilerFrame *GetFrame(const Profiler *p, const int i)
+{
+	const int idx =
+		(p->frameIndex - p->numFrames + i + PROFILER_FRAMES) % PROFILER_FRAMES;
+	return &p->frames[idx];
+}
+
+int ProfilerGetStats(const Profiler *p, ProfilerZoneStats *stats)
+{
+	int numZones = 0;
+	for (int i = 0; i < p->numFrames; i++)
+	{
+		const ProfilerFrame *f = GetFrame(p, i);
+		double frameMs[PROFILER_MAX_ZONES];
+		memset(frameMs, 0, sizeof frameMs);
+		for (int j = 0; j < f->NumEvents; j++)
+		{
+			const ProfilerEvent *e = &f->Events[j];
+			if (e->End == 0)
+			{
+				continue;
+			}
+			int z;
+			for (z = 0; z < numZones; z++)
+			{
+				if (stats[z].Name == e->Name)
+				{
+					break;
+				}
+			}
+			if (z == numZones)
+			{
+				if (numZones == PROFILER_MAX_ZONES)
+				{
+					continue;
+				}
+				stats[z].Name = e->Name;
+				stats[z].Depth = e->Depth;
+				stats[z].AvgMs = 0;
+				stats[z].MaxMs = 0;
+				numZones++;
+			}
+			frameMs[z] += ToMs(p, e->End - e->Start);
+		}
+		for (int z = 0; z < numZones; z++)
+		{
+			stats[z].AvgMs += frameMs[z];
+			stats[z].MaxMs = MAX(stats[z].MaxMs, frameMs[z]);
+		}
+	}
+	for (int z = 0; z < numZones; z++)
+	{
+		stats[z].AvgMs /= p->numFrames;
+	}
+	return numZones;
+}
+
+static void WriteTraceEvent(
+	FILE *f, const Profiler *p, const char *name, const uint64_t start,
+	const uint64_t end, bool *first)
+{
+	fprintf(
+		f, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+		   "\"ts\":%.3f,\"dur\":%.3f}",
+		*first ? "" : ",", name, ToMs(p, start - p->origin) * 1000.0,
+		ToMs(p, end - start) * 1000.0);
+	*first = false;
+}
+bool ProfilerSaveTrace(const Profiler *p, const char *filename)
+{
+	FILE *f = fopen(filename, "w");
+	if (f == NULL)
+	{
+		LOG(LM_MAIN, LL_ERROR, "cannot open profiler trace %s", filename);
+		return false;
+	}
+	fprintf(f, "{\"traceEvents\":[");
+	bool first = true;
+	for (int i = 0; i < p->numFrames; i++)
+	{
+		const ProfilerFrame *frame = GetFrame(p, i);
+		WriteTraceEvent(f, p, "Frame", frame->Start, frame->End, &first);
+		for (int j = 0; j < frame->NumEvents; j++)
+		{
+			const ProfilerEvent *e = &frame->Events[j];
+			if (e->End == 0)
+			{
+				continue;
+			}
+			WriteTraceEvent(f, p, e->Name, e->Start, e->End, &first);
+		}
+	}
+	fprintf(f, "\n]}\n");
+	fclose(f);
+	LOG(LM_MAIN, LL_INFO, "saved profiler trace %s (%d frames)", filename,
+		p->numFrames);
+	return true;
+}
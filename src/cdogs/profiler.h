@@ -0,0 +1,120 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PROFILER_TRACE_FILE "profile.json"
+
+// Number of frames of timings to keep
+#define PROFILER_FRAMES 120
+// Max zones recorded per frame; the rest are dropped
+#define PROFILER_MAX_EVENTS 256
+#define PROFILER_MAX_DEPTH 16
+// Max distinct zones shown in stats
+#define PROFILER_MAX_ZONES 32
+
+typedef struct
+{
+	const char *Name;
+	uint64_t Start;
+	uint64_t End;
+	int Depth;
+} ProfilerEvent;
+
+typedef struct
+{
+	uint64_t Start;
+	uint64_t End;
+	int NumEvents;
+	ProfilerEvent Events[PROFILER_MAX_EVENTS];
+} ProfilerFrame;
+
+typedef struct
+{
+	const char *Name;
+	int Depth;
+	double AvgMs; // average per frame
+	double MaxMs;
+} ProfilerZoneStats;
+
+// Lightweight frame profiler
+// Instrumented code marks zones with PROFILE_BEGIN/PROFILE_END, which are
+// timed with the high resolution counter and stored in a ring buffer of the
+// last PROFILER_FRAMES frames. The frames can be summarised for an on-screen
+// overlay or dumped in Chrome's trace event format (chrome://tracing).
+typedef struct
+{
+	bool Enabled;
+	bool ShowOverlay;
+	// Whether the current frame is being recorded; only changes at frame
+	// boundaries so that zones are always balanced
+	bool active;
+	ProfilerFrame *frames;
+	int frameIndex;
+	int numFrames;
+	int stack[PROFILER_MAX_DEPTH];
+	int depth;
+	uint64_t origin;
+	uint64_t frequency;
+} Profiler;
+extern Profiler gProfiler;
+
+void ProfilerInit(Profiler *p);
+void ProfilerTerminate(Profiler *p);
+
+// Finish the previous frame and start a new one
+void ProfilerFrameBegin(Profiler *p);
+void ProfilerZoneBegin(Profiler *p, const char *name);
+void ProfilerZoneEnd(Profiler *p);
+
+// Zone names must be string literals, as they are stored by pointer
+#define PROFILE_BEGIN(_name)                                                  \
+	do                                                                        \
+	{                                                                         \
+		if (gProfiler.active)                                                 \
+		{                                                                     \
+			ProfilerZoneBegin(&gProfiler, _name);                             \
+		}                                                                     \
+	} while (0)
+#define PROFILE_END()                                                         \
+	do                                                                        \
+	{                                                                         \
+		if (gProfiler.active)                                                 \
+		{                                                                     \
+			ProfilerZoneEnd(&gProfiler);                                      \
+		}                                                                     \
+	} while (0)
+
+void ProfilerToggleOverlay(Profiler *p);
+// Summarise zones over the recorded frames, in order of first appearance
+// Returns the number of zones
+int ProfilerGetStats(const Profiler *p, ProfilerZoneStats *stats);
+// Write recorded frames as a Chrome trace JSON file
+bool ProfilerSaveTrace(const Profiler *p, const char *filename);
@@ -74,7 +74,7 @@ static struct vec2i GenerateRandomPairPartitionWithRestrictions(
 	// Must be at most max, or total - min
 	xLow = MAX(min, total - max);
 	xHigh = MIN(max, total - min);
-	v.x = xLow + (rand() % (xHigh - xLow + 1));
+	v.x = RAND_INT(xLow, xHigh + 1);
 	v.y = total - v.x;
 	assert(v.x >= min);
 	assert(v.y >= min);
@@ -166,26 +166,26 @@ static void SetupQuickPlayEnemy(
 	}
 	if (WeaponClassIsShortRange(enemy->Gun))
 	{
-		enemy->bot->probabilityToMove = 35 + (rand() % 35);
+		enemy->bot->probabilityToMove = 35 + RAND_INT(0, 35);
 	}
 	else
 	{
-		enemy->bot->probabilityToMove = 30 + (rand() % 30);
+		enemy->bot->probabilityToMove = 30 + RAND_INT(0, 30);
 	}
-	enemy->bot->probabilityToTrack = 10 + (rand() % 60);
+	enemy->bot->probabilityToTrack = 10 + RAND_INT(0, 60);
 	if (!WeaponClassCanShoot(enemy->Gun))
 	{
 		enemy->bot->probabilityToShoot = 0;
 	}
 	else if (WeaponClassIsHighDPS(enemy->Gun))
 	{
-		enemy->bot->probabilityToShoot = 1 + (rand() % 3);
+		enemy->bot->probabilityToShoot = 1 + RAND_INT(0, 3);
 	}
 	else
 	{
-		enemy->bot->probabilityToShoot = 1 + (rand() % 6);
+		enemy->bot->probabilityToShoot = 1 + RAND_INT(0, 6);
 	}
-	enemy->bot->actionDelay = rand() % (50 + 1);
+	enemy->bot->actionDelay = RAND_INT(0, 50 + 1);
 	enemy->maxHealth = GenerateQuickPlayParam(
 		ConfigGetEnum(&gConfig, "QuickPlay.EnemyHealth"), 10, 20, 40, 60);
 	enemy->excessHealth = enemy->maxHealth * 2;
@@ -210,7 +210,7 @@ static void SetupQuickPlayEnemies(
 		for (;;)
 		{
 			wc = CArrayGet(
-				&gWeaponClasses.Guns, rand() % (int)gWeaponClasses.Guns.size);
+				&gWeaponClasses.Guns, RAND_INT(0, gWeaponClasses.Guns.size));
 			if (!wc->IsRealGun)
 			{
 				continue;
@@ -300,7 +300,7 @@ static void AddMission(
 	}
 	do
 	{
-		m.Type = (MapType)(rand() % MAPTYPE_COUNT);
+		m.Type = (MapType)RAND_INT(0, MAPTYPE_COUNT);
 	}
 	// Can't randomly generate static maps
 	while (m.Type == MAPTYPE_STATIC);
@@ -312,7 +312,7 @@ static void AddMission(
 			ConfigGetEnum(&gConfig, "QuickPlay.WallCount"), 0, 5, 15, 30);
 		m.u.Classic.WallLength = GenerateQuickPlayParam(
 			ConfigGetEnum(&gConfig, "QuickPlay.WallLength"), 1, 3, 6, 12);
-		m.u.Classic.CorridorWidth = rand() % 3 + 1;
+		m.u.Classic.CorridorWidth = RAND_INT(0, 3) + 1;
 		m.u.Classic.Rooms = RandomRoomParams();
 		m.u.Classic.Squares = GenerateQuickPlayParam(
 			ConfigGetEnum(&gConfig, "QuickPlay.SquareCount"), 0, 1, 3, 6);
@@ -320,18 +320,18 @@ static void AddMission(
 		m.u.Classic.Doors.Enabled = RAND_BOOL();
 		m.u.Classic.Doors.Min = 1;
 		m.u.Classic.Doors.Max = 6;
-		m.u.Classic.Pillars.Count = rand() % 5;
-		m.u.Classic.Pillars.Min = rand() % 3 + 1;
-		m.u.Classic.Pillars.Max = rand() % 3 + m.u.Classic.Pillars.Min;
+		m.u.Classic.Pillars.Count = RAND_INT(0, 5);
+		m.u.Classic.Pillars.Min = RAND_INT(0, 3) + 1;
+		m.u.Classic.Pillars.Max = RAND_INT(0, 3) + m.u.Classic.Pillars.Min;
 		break;
 	case MAPTYPE_CAVE:
 		// TODO: quickplay configs for cave type
 		RandomMissionTileClasses(&m.u.Cave.TileClasses, pm);
-		m.u.Cave.FillPercent = rand() % 40 + 10;
-		m.u.Cave.Repeat = rand() % 6;
-		m.u.Cave.R1 = rand() % 2 + 4;
-		m.u.Cave.R2 = rand() % 5 - 1;
-		m.u.Cave.CorridorWidth = rand() % 3 + 1;
+		m.u.Cave.FillPercent = RAND_INT(0, 40) + 10;
+		m.u.Cave.Repeat = RAND_INT(0, 6);
+		m.u.Cave.R1 = RAND_INT(0, 2) + 4;
+		m.u.Cave.R2 = RAND_INT(0, 5) - 1;
+		m.u.Cave.CorridorWidth = RAND_INT(0, 3) + 1;
 		m.u.Cave.Rooms = RandomRoomParams();
 		m.u.Cave.Squares = GenerateQuickPlayParam(
 			ConfigGetEnum(&gConfig, "QuickPlay.SquareCount"), 0, 1, 3, 6);
@@ -341,15 +341,15 @@ static void AddMission(
 	case MAPTYPE_INTERIOR:
 		// TODO: quickplay configs for interior type
 		RandomMissionTileClasses(&m.u.Interior.TileClasses, pm);
-		m.u.Interior.CorridorWidth = rand() % 3 + 1;
+		m.u.Interior.CorridorWidth = RAND_INT(0, 3) + 1;
 		m.u.Interior.Rooms = RandomRoomParams();
 		m.u.Interior.ExitEnabled = RAND_BOOL();
 		m.u.Interior.Doors.Enabled = RAND_BOOL();
 		m.u.Interior.Doors.Min = 1;
 		m.u.Interior.Doors.Max = 6;
-		m.u.Interior.Pillars.Count = rand() % 5;
-		m.u.Interior.Pillars.Min = rand() % 3 + 1;
-		m.u.Interior.Pillars.Max = rand() % 3 + m.u.Interior.Pillars.Min;
+		m.u.Interior.Pillars.Count = RAND_INT(0, 5);
+		m.u.Interior.Pillars.Min = RAND_INT(0, 3) + 1;
+		m.u.Interior.Pillars.Max = RAND_INT(0, 3) + m.u.Interior.Pillars.Min;
 		break;
 	default:
 		CASSERT(false, "unknown map type");
@@ -384,7 +384,7 @@ static void AddMission(
 	for (int i = 0; i < c; i++)
 	{
 		MapObjectDensity mop;
-		mop.M = IndexMapObject(rand() % MapObjectsCount(&gMapObjects));
+		mop.M = IndexMapObject(RAND_INT(0, MapObjectsCount(&gMapObjects)));
 		if (mop.M->Type == MAP_OBJECT_TYPE_PICKUP_SPAWNER)
 		{
 			mop.Density = 1;
@@ -435,26 +435,26 @@ static RoomParams RandomRoomParams(void)
 	RoomParams r;
 	r.Count = GenerateQuickPlayParam(
 		ConfigGetEnum(&gConfig, "QuickPlay.RoomCount"), 0, 2, 5, 12);
-	r.Min = rand() % 10 + 5;
-	r.Max = rand() % 10 + r.Min;
+	r.Min = RAND_INT(0, 10) + 5;
+	r.Max = RAND_INT(0, 10) + r.Min;
 	r.Edge = 1;
 	r.Overlap = 1;
-	r.Walls = rand() % 5;
-	r.WallLength = rand() % 6 + 1;
-	r.WallPad = rand() % 4 + 1;
+	r.Walls = RAND_INT(0, 5);
+	r.WallLength = RAND_INT(0, 6) + 1;
+	r.WallPad = RAND_INT(0, 4) + 1;
 	return r;
 }
 static void RandomStyle(char *style, const CArray *styleNames)
 {
-	const int idx = rand() % styleNames->size;
+	const int idx = RAND_INT(0, styleNames->size);
 	strcpy(style, *(char **)CArrayGet(styleNames, idx));
 }
 static color_t RandomBGColor(void)
 {
 	color_t c;
-	c.r = rand() % 128;
-	c.g = rand() % 128;
-	c.b = rand() % 128;
+	c.r = RAND_INT(0, 128);
+	c.g = RAND_INT(0, 128);
+	c.b = RAND_INT(0, 128);
 	c.a = 255;
 	return c;
 }
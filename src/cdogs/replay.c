@@ -0,0 +1,405 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "replay.h"
+
+#include <stdio.h>
+
+#include <SDL_endian.h>
+#include <SDL_timer.h>
+
+#include "config.h"
+#include "files.h"
+#include "log.h"
+#include "net_client.h"
+#include "net_util.h"
+#include "proto/nanopb/pb_decode.h"
+#include "proto/nanopb/pb_encode.h"
+#include "utils.h"
+
+Replay gReplay;
+
+void ReplayInit(Replay *r)
+{
+	memset(r, 0, sizeof *r);
+	CArrayInit(&r->Players, sizeof(ReplayPlayer));
+	CArrayInit(&r->Frames, sizeof(ReplayFrame));
+	r->DesyncFrame = -1;
+}
+void ReplayTerminate(Replay *r)
+{
+	CFREE(r->CampaignPath);
+	CArrayTerminate(&r->Players);
+	CArrayTerminate(&r->Frames);
+	memset(r, 0, sizeof *r);
+}
+
+static bool Write32(FILE *f, const uint32_t x)
+{
+	const uint32_t le = SDL_SwapLE32(x);
+	return fwrite(&le, sizeof le, 1, f) == 1;
+}
+static bool Read32(FILE *f, uint32_t *x)
+{
+	uint32_t le;
+	if (fread(&le, sizeof le, 1, f) != 1)
+	{
+		return false;
+	}
+	*x = SDL_SwapLE32(le);
+	return true;
+}
+static bool ReadInt(FILE *f, int *x)
+{
+	uint32_t u;
+	if (!Read32(f, &u))
+	{
+		return false;
+	}
+	*x = (int)u;
+	return true;
+}
+
+bool ReplaySave(const Replay *r, const char *filename)
+{
+	bool res = false;
+	uint8_t *buf = NULL;
+	FILE *f = fopen(filename, "wb");
+	if (f == NULL)
+	{
+		LOG(LM_MAIN, LL_ERROR, "cannot open replay file %s for writing",
+			filename);
+		goto bail;
+	}
+	const uint32_t pathLen =
+		r->CampaignPath != NULL ? (uint32_t)strlen(r->CampaignPath) : 0;
+	if (!Write32(f, REPLAY_MAGIC) || !Write32(f, REPLAY_VERSION) ||
+		!Write32(f, pathLen) ||
+		fwrite(r->CampaignPath, 1, pathLen, f) != pathLen ||
+		!Write32(f, (uint32_t)r->GameMode) ||
+		!Write32(f, (uint32_t)r->MissionIndex) ||
+		!Write32(f, (uint32_t)r->RandomSeed) || !Write32(f, r->QuickPlaySeed) ||
+		!Write32(f, (uint32_t)r->PVPSeed) ||
+		!Write32(f, (uint32_t)(r->PVPSeed >> 32)) ||
+		!Write32(f, (uint32_t)r->Players.size))
+	{
+		goto bail;
+	}
+	CMALLOC(buf, NPlayerData_size);
+	CA_FOREACH(const ReplayPlayer, p, r->Players)
+	pb_ostream_t stream = pb_ostream_from_buffer(buf, NPlayerData_size);
+	if (!pb_encode(&stream, NPlayerData_fields, &p->Data))
+	{
+		LOG(LM_MAIN, LL_ERROR, "failed to encode replay player: %s",
+			PB_GET_ERROR(&stream));
+		goto bail;
+	}
+	if (!Write32(f, (uint32_t)p->InputDevice) ||
+		!Write32(f, (uint32_t)p->DeviceIndex) ||
+		!Write32(f, (uint32_t)stream.bytes_written) ||
+		fwrite(buf, 1, stream.bytes_written, f) != stream.bytes_written)
+	{
+		goto bail;
+	}
+	CA_FOREACH_END()
+	if (!Write32(f, (uint32_t)r->Frames.size))
+	{
+		goto bail;
+	}
+	CA_FOREACH(const ReplayFrame, frame, r->Frames)
+	for (int i = 0; i < MAX_LOCAL_PLAYERS; i++)
+	{
+		if (!Write32(f, (uint32_t)frame->Cmds[i]))
+		{
+			goto bail;
+		}
+	}
+	if (!Write32(f, frame->Checksum))
+	{
+		goto bail;
+	}
+	CA_FOREACH_END()
+	res = true;
+
+bail:
+	if (!res && f != NULL)
+	{
+		LOG(LM_MAIN, LL_ERROR, "failed to write replay file %s", filename);
+	}
+	CFREE(buf);
+	if (f != NULL)
+	{
+		fclose(f);
+	}
+	return res;
+}
+
+bool ReplayLoad(Replay *r, const char *filename)
+{
+	bool res = false;
+	uint8_t *buf = NULL;
+	FILE *f = fopen(filename, "rb");
+	if (f == NULL)
+	{
+		LOG(LM_MAIN, LL_ERROR, "cannot open replay file %s", filename);
+		goto bail;
+	}
+	uint32_t magic, version, pathLen;
+	if (!Read32(f, &magic) || magic != REPLAY_MAGIC)
+	{
+		LOG(LM_MAIN, LL_ERROR, "%s is not a replay file", filename);
+		goto bail;
+	}
+	if (!Read32(f, &version) || version != REPLAY_VERSION)
+	{
+		LOG(LM_MAIN, LL_ERROR, "unsupported replay version %u", version);
+		goto bail;
+	}
+	if (!Read32(f, &pathLen) || pathLen >= CDOGS_PATH_MAX)
+	{
+		goto bail;
+	}
+	CFREE(r->CampaignPath);
+	CCALLOC(r->CampaignPath, pathLen + 1);
+	uint32_t gameMode, pvpSeedLow, pvpSeedHigh, numPlayers;
+	if (fread(r->CampaignPath, 1, pathLen, f) != pathLen ||
+		!Read32(f, &gameMode) || !ReadInt(f, &r->MissionIndex) ||
+		!ReadInt(f, &r->RandomSeed) || !Read32(f, &r->QuickPlaySeed) ||
+		!Read32(f, &pvpSeedLow) || !Read32(f, &pvpSeedHigh) ||
+		!Read32(f, &numPlayers) || numPlayers > MAX_LOCAL_PLAYERS)
+	{
+		goto bail;
+	}
+	r->GameMode = (GameMode)gameMode;
+	r->PVPSeed = ((uint64_t)pvpSeedHigh << 32) | pvpSeedLow;
+	CArrayClear(&r->Players);
+	CMALLOC(buf, NPlayerData_size);
+	for (int i = 0; i < (int)numPlayers; i++)
+	{
+		ReplayPlayer p;
+		memset(&p, 0, sizeof p);
+		uint32_t size;
+		if (!ReadInt(f, &p.InputDevice) || !ReadInt(f, &p.DeviceIndex) ||
+			!Read32(f, &size) || size > NPlayerData_size ||
+			fread(buf, 1, size, f) != size)
+		{
+			goto bail;
+		}
+		pb_istream_t stream = pb_istream_from_buffer(buf, size);
+		if (!pb_decode(&stream, NPlayerData_fields, &p.Data))
+		{
+			LOG(LM_MAIN, LL_ERROR, "failed to decode replay player: %s",
+				PB_GET_ERROR(&stream));
+			goto bail;
+		}
+		CArrayPushBack(&r->Players, &p);
+	}
+	uint32_t numFrames;
+	if (!Read32(f, &numFrames))
+	{
+		goto bail;
+	}
+	CArrayClear(&r->Frames);
+	CArrayReserve(&r->Frames, numFrames);
+	for (int i = 0; i < (int)numFrames; i++)
+	{
+		ReplayFrame frame;
+		for (int j = 0; j < MAX_LOCAL_PLAYERS; j++)
+		{
+			if (!ReadInt(f, &frame.Cmds[j]))
+			{
+				goto bail;
+			}
+		}
+		if (!Read32(f, &frame.Checksum))
+		{
+			goto bail;
+		}
+		CArrayPushBack(&r->Frames, &frame);
+	}
+	LOG(LM_MAIN, LL_INFO, "loaded replay %s: campaign(%s) mission(%d) "
+		"players(%d) frames(%d)",
+		filename, r->CampaignPath, r->MissionIndex, (int)r->Players.size,
+		(int)r->Frames.size);
+	res = true;
+
+bail:
+	if (!res && f != NULL)
+	{
+		LOG(LM_MAIN, LL_ERROR, "failed to read replay file %s", filename);
+	}
+	CFREE(buf);
+	if (f != NULL)
+	{
+		fclose(f);
+	}
+	return res;
+}
+
+void ReplayRecordStart(Replay *r, const Campaign *co, const uint64_t pvpSeed)
+{
+	if (r->Mode != REPLAY_MODE_RECORD)
+	{
+		return;
+	}
+	CFREE(r->CampaignPath);
+	r->CampaignPath = NULL;
+	if (co->Entry.Path != NULL)
+	{
+		// Entry paths are relative to the data dir, which may not hold for
+		// campaigns loaded from elsewhere; store the full path instead
+		char buf[CDOGS_PATH_MAX];
+		GetDataFilePath(buf, co->Entry.Path);
+		CSTRDUP(r->CampaignPath, buf);
+	}
+	r->GameMode = co->Entry.Mode;
+	r->MissionIndex = co->MissionIndex;
+	r->RandomSeed = ConfigGetInt(&gConfig, "Game.RandomSeed");
+	r->QuickPlaySeed = co->QuickPlaySeed;
+	r->PVPSeed = pvpSeed;
+	CArrayClear(&r->Players);
+	CA_FOREACH(const PlayerData, pd, gPlayerDatas)
+	if (!pd->IsLocal)
+	{
+		continue;
+	}
+	ReplayPlayer p;
+	p.InputDevice = (int)pd->inputDevice;
+	p.DeviceIndex = pd->deviceIndex;
+	p.Data = NMakePlayerData(pd);
+	CArrayPushBack(&r->Players, &p);
+	CA_FOREACH_END()
+	CArrayClear(&r->Frames);
+	LOG(LM_MAIN, LL_INFO, "recording replay to %s", r->Filename);
+}
+void ReplayRecordFrame(Replay *r, const int cmds[MAX_LOCAL_PLAYERS])
+{
+	if (r->Mode != REPLAY_MODE_RECORD)
+	{
+		return;
+	}
+	ReplayFrame frame;
+	memcpy(frame.Cmds, cmds, sizeof frame.Cmds);
+	frame.Checksum = RandChecksum(RNG_SIM);
+	CArrayPushBack(&r->Frames, &frame);
+}
+void ReplayRecordEnd(Replay *r)
+{
+	if (r->Mode != REPLAY_MODE_RECORD)
+	{
+		return;
+	}
+	if (ReplaySave(r, r->Filename))
+	{
+		LOG(LM_MAIN, LL_INFO, "saved replay %s (%d frames)", r->Filename,
+			(int)r->Frames.size);
+	}
+	r->Mode = REPLAY_MODE_NONE;
+}
+
+bool ReplayPlayStart(Replay *r, Campaign *co, struct MissionOptions *mo)
+{
+	CampaignEntry entry;
+	if (r->GameMode == GAME_MODE_QUICK_PLAY)
+	{
+		CampaignEntryInit(&entry, "Quick play", GAME_MODE_QUICK_PLAY);
+	}
+	else
+	{
+		char buf[CDOGS_PATH_MAX];
+		GetDataFilePath(buf, r->CampaignPath);
+		if (!CampaignEntryTryLoad(&entry, buf, r->GameMode))
+		{
+			LOG(LM_MAIN, LL_ERROR, "failed to load replay campaign %s", buf);
+			return false;
+		}
+	}
+	co->Entry.Mode = r->GameMode;
+	co->QuickPlaySeed = r->QuickPlaySeed;
+	const bool loaded = CampaignLoad(co, &entry);
+	CampaignEntryTerminate(&entry);
+	if (!loaded)
+	{
+		return false;
+	}
+	if (r->MissionIndex >= (int)co->Setting.Missions.size)
+	{
+		LOG(LM_MAIN, LL_ERROR, "replay mission %d not in campaign",
+			r->MissionIndex);
+		return false;
+	}
+	co->MissionIndex = r->MissionIndex;
+	ConfigSetInt(&gConfig, "Game.RandomSeed", r->RandomSeed);
+	CampaignAndMissionSetup(co, mo);
+
+	CA_FOREACH(const ReplayPlayer, p, r->Players)
+	PlayerDataAddOrUpdate(p->Data);
+	PlayerData *pd = PlayerDataGetByUID((int)p->Data.UID);
+	pd->inputDevice = (input_device_e)p->InputDevice;
+	pd->deviceIndex = p->DeviceIndex;
+	CA_FOREACH_END()
+
+	r->FrameIndex = 0;
+	r->DesyncFrame = -1;
+	r->StartCounter = SDL_GetPerformanceCounter();
+	return true;
+}
+bool ReplayPlayFrame(Replay *r, int cmds[MAX_LOCAL_PLAYERS])
+{
+	if (r->FrameIndex >= (int)r->Frames.size)
+	{
+		return false;
+	}
+	const ReplayFrame *frame = CArrayGet(&r->Frames, r->FrameIndex);
+	memcpy(cmds, frame->Cmds, sizeof frame->Cmds);
+	r->FrameIndex++;
+	return true;
+}
+void ReplayPlayCheckFrame(Replay *r)
+{
+	if (r->DesyncFrame != -1 || r->FrameIndex == 0)
+	{
+		return;
+	}
+	const ReplayFrame *frame = CArrayGet(&r->Frames, r->FrameIndex - 1);
+	if (frame->Checksum != RandChecksum(RNG_SIM))
+	{
+		r->DesyncFrame = r->FrameIndex - 1;
+		LOG(LM_MAIN, LL_WARN, "replay desync at frame %d", r->DesyncFrame);
+	}
+}
+void ReplayPlayEnd(Replay *r)
+{
+	const double elapsedMs = (double)(SDL_GetPerformanceCounter() -
+									  r->StartCounter) *
+							 1000.0 / (double)SDL_GetPerformanceFrequency();
+	LOG(LM_MAIN, LL_INFO, "replay finished: %d/%d frames, %s, %.1fms (%.1f "
+		"frames/s)",
+		r->FrameIndex, (int)r->Frames.size,
+		r->DesyncFrame == -1 ? "in sync" : "desynced", elapsedMs,
+		elapsedMs > 0 ? r->FrameIndex * 1000.0 / elapsedMs : 0.0);
+}
@@ -0,0 +1,132 @@
+/*
+	C-Dogs SDL
+	A port of the legendary (and fun) action/arcade cdogs.
+	Copyright (c) 2026 Cong Xu
+	All rights reserved.
+
+	Redistribution and use in source and binary forms, with or without
+	modification, are permitted provided that the following conditions are met:
+
+	Redistributions of source code must retain the above copyright notice, this
+	list of conditions and the following disclaimer.
+	Redistributions in binary form must reproduce the above copyright notice,
+	this list of conditions and the following disclaimer in the documentation
+	and/or other materials provided with the distribution.
+
+	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+	ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+	LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+	CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+	SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+	INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+	CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+	ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+	POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "c_array.h"
+#include "campaigns.h"
+#include "player.h"
+#include "proto/msg.pb.h"
+#include "sys_specifics.h"
+
+/*
+Replays record the local players' commands for every simulated tick of a
+single mission, along with everything needed to rebuild the starting state:
+the campaign, mission, random seeds and player loadouts.
+Playback re-runs the simulation with the recorded commands, so it relies on
+the simulation being deterministic (see prng.h) and on the same data files
+and config being used.
+
+File format (little endian):
+- REPLAY_MAGIC (4)
+- REPLAY_VERSION (4)
+- Campaign path length (4), campaign path (absolute, or relative to data
+  dir in older recordings)
+- Game mode (4)
+- Mission index (4)
+- Random seed (4), the Game.RandomSeed config
+- Quick play seed (4)
+- PVP seed (8)
+- Player count (4), for each player:
+  - Input device (4), device index (4)
+  - NPlayerData size (4), NPlayerData (protobuf)
+- Frame count (4), for each frame:
+  - Commands (4 * MAX_LOCAL_PLAYERS)
+  - Simulation random stream checksum (4)
+*/
+#define REPLAY_MAGIC 0x50524443 // "CDRP"
+#define REPLAY_VERSION 1
+
+typedef enum
+{
+	REPLAY_MODE_NONE,
+	REPLAY_MODE_RECORD,
+	REPLAY_MODE_PLAY
+} ReplayMode;
+
+typedef struct
+{
+	int InputDevice;
+	int DeviceIndex;
+	NPlayerData Data;
+} ReplayPlayer;
+
+typedef struct
+{
+	int Cmds[MAX_LOCAL_PLAYERS];
+	// Checksum of the simulation random stream at the time of this frame's
+	// commands, to detect desyncs during playback
+	uint32_t Checksum;
+} ReplayFrame;
+
+typedef struct
+{
+	ReplayMode Mode;
+	// Play back as fast as possible without drawing
+	bool Headless;
+	char Filename[CDOGS_PATH_MAX];
+
+	char *CampaignPath;
+	GameMode GameMode;
+	int MissionIndex;
+	int RandomSeed;
+	uint32_t QuickPlaySeed;
+	uint64_t PVPSeed;
+	CArray Players; // of ReplayPlayer
+	CArray Frames;	// of ReplayFrame
+
+	// Playback state
+	int FrameIndex;
+	int DesyncFrame; // -1 if in sync
+	uint64_t StartCounter;
+} Replay;
+extern Replay gReplay;
+
+void ReplayInit(Replay *r);
+void ReplayTerminate(Replay *r);
+
+bool ReplayLoad(Replay *r, const char *filename);
+bool ReplaySave(const Replay *r, const char *filename);
+
+// Capture the starting state of the mission about to be played
+void ReplayRecordStart(Replay *r, const Campaign *co, const uint64_t pvpSeed);
+void ReplayRecordFrame(Replay *r, const int cmds[MAX_LOCAL_PLAYERS]);
+// Save the recording, if recording; only the first mission is recorded
+void ReplayRecordEnd(Replay *r);
+
+// Load the recorded campaign, mission and players, ready to start the game
+bool ReplayPlayStart(Replay *r, Campaign *co, struct MissionOptions *mo);
+// Get the commands for the next frame; returns false if there are no more
+bool ReplayPlayFrame(Replay *r, int cmds[MAX_LOCAL_PLAYERS]);
+// Compare the simulation state against the recording; call at the same
+// point in the frame as ReplayRecordFrame
+void ReplayPlayCheckFrame(Replay *r);
+// Log playback results, e.g. desyncs and (for headless) timings
+void ReplayPlayEnd(Replay *r);
@@ -66,6 +66,6 @@ ScreenShake ScreenShakeUpdate(ScreenShake s, int ticks)
 	s.Delta =
 		maxDelta == 0 ?
 		svec2_zero() :
-		svec2(RAND_FLOAT(0, maxDelta), RAND_FLOAT(0, maxDelta));
+		svec2(RandFloat(RNG_FX, 0, maxDelta), RandFloat(RNG_FX, 0, maxDelta));
 	return s;
 }
@@ -95,7 +95,206 @@ int OpenAudio(int frequency, Uint16 format, int channels, int chunkSize)
 	return 0;
 }
 
-static Mix_Chunk *LoadSound(const char *path);
+// A sound file that is indexed but only decoded when needed
+// Since weapon and other classes hold on to the Mix_Chunk pointers, the
+// chunk itself stays put; only its sample buffer is loaded and evicted
+typedef struct
+{
+	Mix_Chunk chunk; // Must be first
+	char *path;
+	Uint32 lastUsed;
+	bool failed;
+} SoundLazyChunk;
+
+static int FindLazyChunkIndex(const SoundDevice *s, const void *chunk)
+{
+	// Binary search for the first chunk not less than this address
+	int lo = 0;
+	int hi = (int)s->lazyChunks.size;
+	while (lo < hi)
+	{
+		const int mid = lo + (hi - lo) / 2;
+		const SoundLazyChunk *const *lc = CArrayGet(&s->lazyChunks, mid);
+		if ((uintptr_t)*lc < (uintptr_t)chunk)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	return lo;
+}
+static SoundLazyChunk *FindLazyChunk(
+	const SoundDevice *s, const Mix_Chunk *chunk)
+{
+	const int i = FindLazyChunkIndex(s, chunk);
+	if (i == (int)s->lazyChunks.size)
+	{
+		return NULL;
+	}
+	SoundLazyChunk **lc = CArrayGet(&s->lazyChunks, i);
+	return &(*lc)->chunk == chunk ? *lc : NULL;
+}
+static Mix_Chunk *LazyChunkNew(SoundDevice *s, const char *path)
+{
+	SoundLazyChunk *lc;
+	CCALLOC(lc, sizeof *lc);
+	lc->chunk.volume = MIX_MAX_VOLUME;
+	CSTRDUP(lc->path, path);
+	CArrayInsert(&s->lazyChunks, FindLazyChunkIndex(s, lc), &lc);
+	return &lc->chunk;
+}
+static bool IsChunkPlaying(const SoundDevice *s, const Mix_Chunk *chunk)
+{
+	for (int i = 0; i < s->channels; i++)
+	{
+		if (Mix_Playing(i) && Mix_GetChunk(i) == chunk)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+// Must be called with lazyLock held
+static void LazyChunkInstall(
+	SoundDevice *s, SoundLazyChunk *lc, Mix_Chunk *decoded)
+{
+	// Take over the decoded samples, and free the rest
+	lc->chunk.abuf = decoded->abuf;
+	lc->chunk.alen = decoded->alen;
+	lc->chunk.allocated = decoded->allocated;
+	decoded->allocated = 0;
+	Mix_FreeChunk(decoded);
+	CArrayPushBack(&s->loadedChunks, &lc);
+	s->loadedBytes += lc->chunk.alen;
+}
+// Must be called with lazyLock held
+static void LazyChunkUnload(SoundDevice *s, SoundLazyChunk *lc)
+{
+	if (lc->chunk.abuf == NULL)
+	{
+		return;
+	}
+	for (int i = 0; i < s->channels; i++)
+	{
+		if (Mix_GetChunk(i) == &lc->chunk)
+		{
+			Mix_HaltChannel(i);
+		}
+	}
+	if (lc->chunk.allocated)
+	{
+		SDL_free(lc->chunk.abuf);
+	}
+	s->loadedBytes -= lc->chunk.alen;
+	lc->chunk.abuf = NULL;
+	lc->chunk.alen = 0;
+	lc->chunk.allocated = 0;
+	CA_FOREACH(SoundLazyChunk *, loaded, s->loadedChunks)
+	if (*loaded == lc)
+	{
+		CArrayDelete(&s->loadedChunks, _ca_index);
+		break;
+	}
+	CA_FOREACH_END()
+}
+static void LazyChunkFree(SoundDevice *s, Mix_Chunk *chunk)
+{
+	SoundLazyChunk *lc = FindLazyChunk(s, chunk);
+	if (lc == NULL)
+	{
+		return;
+	}
+	SDL_LockMutex(s->lazyLock);
+	LazyChunkUnload(s, lc);
+	SDL_UnlockMutex(s->lazyLock);
+	CArrayDelete(&s->lazyChunks, FindLazyChunkIndex(s, lc));
+	CFREE(lc->path);
+	CFREE(lc);
+}
+static bool LazyChunkLoad(SoundDevice *s, SoundLazyChunk *lc)
+{
+	SDL_LockMutex(s->lazyLock);
+	bool loaded = lc->chunk.abuf != NULL;
+	if (!loaded && !lc->failed)
+	{
+		LOG(LM_SOUND, LL_TRACE, "loading sound file %s", lc->path);
+		Mix_Chunk *decoded = Mix_LoadWAV(lc->path);
+		if (decoded == NULL)
+		{
+			LOG(LM_SOUND, LL_ERROR, "Cannot load sound %s: %s", lc->path,
+				Mix_GetError());
+			lc->failed = true;
+		}
+		else
+		{
+			LazyChunkInstall(s, lc, decoded);
+			loaded = true;
+		}
+	}
+	SDL_UnlockMutex(s->lazyLock);
+	return loaded;
+}
+static void SoundCacheEvict(SoundDevice *s, const SoundLazyChunk *keep)
+{
+	SDL_LockMutex(s->lazyLock);
+	while (s->loadedBytes > SOUND_CACHE_BUDGET)
+	{
+		// Evict the least recently used chunk that isn't playing
+		SoundLazyChunk *lru = NULL;
+		CA_FOREACH(SoundLazyChunk *, lc, s->loadedChunks)
+		if (*lc == keep || (lru != NULL && (*lc)->lastUsed >= lru->lastUsed))
+		{
+			continue;
+		}
+		if (!IsChunkPlaying(s, &(*lc)->chunk))
+		{
+			lru = *lc;
+		}
+		CA_FOREACH_END()
+		if (lru == NULL)
+		{
+			break;
+		}
+		LOG(LM_SOUND, LL_TRACE, "evicting sound %s", lru->path);
+		LazyChunkUnload(s, lru);
+	}
+	SDL_UnlockMutex(s->lazyLock);
+}
+// Make sure that the chunk is ready to play, decoding it if necessary
+static bool SoundChunkLoad(SoundDevice *s, const Mix_Chunk *chunk)
+{
+	SoundLazyChunk *lc = FindLazyChunk(s, chunk);
+	if (lc == NULL)
+	{
+		return true;
+	}
+	s->lazyTick++;
+	lc->lastUsed = s->lazyTick;
+	if (!LazyChunkLoad(s, lc))
+	{
+		return false;
+	}
+	SoundCacheEvict(s, lc);
+	return true;
+}
+
+static bool IsSoundFile(const char *path)
+{
+	// Only load sounds from known extensions
+	const char *ext = strrchr(path, '.');
+	if (ext == NULL ||
+		!(strcmp(ext, ".ogg") == 0 || strcmp(ext, ".OGG") == 0 ||
+		  strcmp(ext, ".wav") == 0 || strcmp(ext, ".WAV") == 0 ||
+		  strcmp(ext, ".mp3") == 0 || strcmp(ext, ".MP3") == 0))
+	{
+		return false;
+	}
+	struct stat st;
+	return stat(path, &st) == 0;
+}
 static void SoundLoad(map_t sounds, const char *name, const char *path)
 {
 	// If the sound basename is a number, it is part of a group of random
@@ -125,6 +324,7 @@ static void SoundLoad(map_t sounds, const char *name, const char *path)
 		SoundData *sound;
 		CCALLOC(sound, sizeof *sound);
 		sound->Type = SOUND_RANDOM;
+		sound->isLazy = true;
 		CArrayInit(&sound->u.random.sounds, sizeof(Mix_Chunk *));
 		// Remove "0.<ext>" from path
 		const char *ext = StrGetFileExt(path);
@@ -137,41 +337,24 @@ static void SoundLoad(map_t sounds, const char *name, const char *path)
 		{
 			char buf[CDOGS_PATH_MAX];
 			sprintf(buf, fmt, i);
-			Mix_Chunk *data = LoadSound(buf);
-			if (data == NULL)
+			if (!IsSoundFile(buf))
 				break;
+			Mix_Chunk *data = LazyChunkNew(&gSoundDevice, buf);
 			CArrayPushBack(&sound->u.random.sounds, &data);
 		}
 		// Remove "/0" from name and add
 		*strrchr(nameNoExt, '/') = '\0';
 		SoundAdd(sounds, nameNoExt, sound);
 	}
-	else
+	else if (IsSoundFile(path))
 	{
-		Mix_Chunk *data = LoadSound(path);
-		if (data != NULL)
-		{
-			SoundData *sound;
-			CMALLOC(sound, sizeof *sound);
-			sound->Type = SOUND_NORMAL;
-			sound->u.normal = data;
-			SoundAdd(sounds, nameNoExt, sound);
-		}
-	}
-}
-static Mix_Chunk *LoadSound(const char *path)
-{
-	// Only load sounds from known extensions
-	const char *ext = strrchr(path, '.');
-	if (ext == NULL ||
-		!(strcmp(ext, ".ogg") == 0 || strcmp(ext, ".OGG") == 0 ||
-		  strcmp(ext, ".wav") == 0 || strcmp(ext, ".WAV") == 0 ||
-		  strcmp(ext, ".mp3") == 0 || strcmp(ext, ".MP3") == 0))
-	{
-		return NULL;
+		SoundData *sound;
+		CCALLOC(sound, sizeof *sound);
+		sound->Type = SOUND_NORMAL;
+		sound->isLazy = true;
+		sound->u.normal = LazyChunkNew(&gSoundDevice, path);
+		SoundAdd(sounds, nameNoExt, sound);
 	}
-	LOG(LM_MAIN, LL_TRACE, "loading sound file %s", path);
-	return Mix_LoadWAV(path);
 }
 static void SoundDataTerminate(any_t data);
 void SoundAdd(map_t sounds, const char *name, SoundData *sound)
@@ -191,9 +374,15 @@ void SoundInitialize(SoundDevice *device, const char *path)
 
 	device->sounds = hashmap_new();
 	device->customSounds = hashmap_new();
+	CArrayInit(&device->lazyChunks, sizeof(SoundLazyChunk *));
+	CArrayInit(&device->loadedChunks, sizeof(SoundLazyChunk *));
+	CArrayInit(&device->prewarmChunks, sizeof(SoundLazyChunk *));
+	device->lazyLock = SDL_CreateMutex();
 	char buf[CDOGS_PATH_MAX];
 	GetDataFilePath(buf, path);
 	SoundLoadDir(device->sounds, buf, NULL);
+	LOG(LM_SOUND, LL_INFO, "Indexed %d sound files",
+		(int)device->lazyChunks.size);
 	MusicPlayerInit(&device->music);
 }
 void SoundLoadDir(map_t sounds, const char *path, const char *prefix)
@@ -202,6 +391,8 @@ void SoundLoadDir(map_t sounds, const char *path, const char *prefix)
 	{
 		return;
 	}
+	// The prewarm list holds on to lazy chunks
+	SoundPrewarmCancel(&gSoundDevice);
 	tinydir_dir dir;
 	if (tinydir_open(&dir, path) == -1)
 	{
@@ -279,6 +470,8 @@ void SoundReconfigure(SoundDevice *s)
 		printf("Couldn't allocate channels!\n");
 		return;
 	}
+	// Keep the music channel out of the way of sound effects
+	Mix_ReserveChannels(MUSIC_CHUNK_CHANNEL + 1);
 
 	const int sVol = ConfigGetInt(&gConfig, "Sound.SoundVolume");
 	Mix_Volume(-1, sVol);
@@ -300,20 +493,27 @@ void SoundReopen(SoundDevice *s)
 		return;
 	}
 
-	s->channels = 64;
+	s->channels = SOUND_MAX_VOICES + 1;
+	memset(s->voices, 0, sizeof s->voices);
 	SoundReconfigure(s);
 }
 
 void SoundClear(map_t sounds)
 {
+	SoundPrewarmCancel(&gSoundDevice);
 	hashmap_clear(sounds, SoundDataTerminate);
 }
 void SoundTerminate(SoundDevice *device, const bool waitForSoundsComplete)
 {
+	SoundPrewarmCancel(device);
 	SoundClose(device, waitForSoundsComplete);
 
 	hashmap_destroy(device->sounds, SoundDataTerminate);
 	hashmap_destroy(device->customSounds, SoundDataTerminate);
+	CArrayTerminate(&device->lazyChunks);
+	CArrayTerminate(&device->loadedChunks);
+	CArrayTerminate(&device->prewarmChunks);
+	SDL_DestroyMutex(device->lazyLock);
 
 	MusicPlayerTerminate(&device->music);
 }
@@ -323,11 +523,25 @@ static void SoundDataTerminate(any_t data)
 	switch (s->Type)
 	{
 	case SOUND_NORMAL:
-		Mix_FreeChunk(s->u.normal);
+		if (s->isLazy)
+		{
+			LazyChunkFree(&gSoundDevice, s->u.normal);
+		}
+		else
+		{
+			Mix_FreeChunk(s->u.normal);
+		}
 		break;
 	case SOUND_RANDOM:
 		CA_FOREACH(Mix_Chunk *, chunk, s->u.random.sounds)
-		Mix_FreeChunk(*chunk);
+		if (s->isLazy)
+		{
+			LazyChunkFree(&gSoundDevice, *chunk);
+		}
+		else
+		{
+			Mix_FreeChunk(*chunk);
+		}
 		CA_FOREACH_END()
 		CArrayTerminate(&s->u.random.sounds);
 		break;
@@ -339,26 +553,35 @@ static void SoundDataTerminate(any_t data)
 }
 
 #define OUT_OF_SIGHT_DISTANCE_PLUS 100
-static int GetChannel(SoundDevice *s, Mix_Chunk *data);
+static int GetChannel(SoundDevice *s, Mix_Chunk *data, const int score);
+// Muffled sounds go through a one-pole low-pass filter:
+// y[n] = y[n-1] + (x[n] - y[n-1]) / 2^MUFFLE_SHIFT
+#define MUFFLE_SHIFT 2
 static void MuffleEffect(int chan, void *stream, int len, void *udata)
 {
 	UNUSED(chan);
-	UNUSED(udata);
-	const int channels = 2;
-	const int chunk = channels * 2;
-	for (int i = 0; i < len / chunk - 2; i++)
+	SoundVoice *v = udata;
+	int16_t *samples = stream;
+	const int n = len / (int)sizeof *samples;
+	// Filter both stereo channels in lockstep, in fixed point
+	int32_t l = v->muffle[0];
+	int32_t r = v->muffle[1];
+	for (int i = 0; i + 1 < n; i += CDOGS_SND_CHANNELS)
 	{
-		int16_t *samples = (int16_t *)((char *)stream + i * chunk);
-		samples[0] = (samples[0] + samples[2] + samples[4]) / 3;
-		samples[1] = (samples[1] + samples[3] + samples[5]) / 3;
+		l += (samples[i] - l) >> MUFFLE_SHIFT;
+		r += (samples[i + 1] - r) >> MUFFLE_SHIFT;
+		samples[i] = (int16_t)l;
+		samples[i + 1] = (int16_t)r;
 	}
+	v->muffle[0] = l;
+	v->muffle[1] = r;
 }
 static void SetSoundEffect(
-	const int channel, const Sint16 bearingDegrees, const Uint8 distance,
-	const bool isMuffled);
+	SoundDevice *s, const int channel, const Sint16 bearingDegrees,
+	const Uint8 distance, const bool isMuffled);
 static int SoundPlayAtPosition(
 	SoundDevice *device, Mix_Chunk *data, const struct vec2 dp,
-	const bool isMuffled)
+	const bool isMuffled, const SoundPriority priority)
 {
 	if (!device->isInitialised || data == NULL)
 	{
@@ -411,46 +634,101 @@ static int SoundPlayAtPosition(
 	LOG(LM_SOUND, LL_TRACE, "distance(%d) bearing(%d)", distance,
 		bearingDegrees);
 
+	const int score = (int)priority * 256 + 255 - distance;
+
+	// If the same sound has already started this frame, e.g. a shotgun
+	// spread hitting a wall, play it once at the loudest position
+	for (int i = MUSIC_CHUNK_CHANNEL + 1; i < device->channels; i++)
+	{
+		SoundVoice *v = &device->voices[i];
+		if (v->chunk != data || v->startTick != device->tick ||
+			!Mix_Playing(i))
+		{
+			continue;
+		}
+		if (score > v->score)
+		{
+			if (v->isMuffled)
+			{
+				Mix_UnregisterAllEffects(i);
+			}
+			SetSoundEffect(
+				device, i, bearingDegrees, (Uint8)distance, isMuffled);
+			v->score = score;
+			v->isMuffled = isMuffled;
+		}
+		return i;
+	}
+
+	if (!SoundChunkLoad(device, data))
+	{
+		return -1;
+	}
+
 	// Get sound channel to play sound
-	const int channel = GetChannel(device, data);
+	const int channel = GetChannel(device, data, score);
 	if (channel < 0)
 	{
 		return -1;
 	}
 
-	SetSoundEffect(channel, bearingDegrees, (Uint8)distance, isMuffled);
+	SetSoundEffect(
+		device, channel, bearingDegrees, (Uint8)distance, isMuffled);
+	SoundVoice *v = &device->voices[channel];
+	v->chunk = data;
+	v->score = score;
+	v->startTick = device->tick;
+	v->isMuffled = isMuffled;
 
 	return channel;
 }
-static int GetChannel(SoundDevice *s, Mix_Chunk *data)
+static int GetChannel(SoundDevice *s, Mix_Chunk *data, const int score)
 {
-	for (;;)
+	// Use a free voice if there is one, otherwise steal the least important
+	// one, preferring the oldest
+	int channel = -1;
+	for (int i = MUSIC_CHUNK_CHANNEL + 1; i < s->channels; i++)
 	{
-		const int channel = Mix_PlayChannel(-1, data, 0);
-		if (channel >= 0 || s->channels > 128)
+		if (!Mix_Playing(i))
 		{
-			return channel;
+			channel = i;
+			break;
 		}
-		// Check if we cannot play the sound; allocate more channels
-		s->channels *= 2;
-		if (Mix_AllocateChannels(s->channels) != s->channels)
+		const SoundVoice *v = &s->voices[i];
+		if (channel == -1 || v->score < s->voices[channel].score ||
+			(v->score == s->voices[channel].score &&
+			 v->startTick < s->voices[channel].startTick))
 		{
-			LOG(LM_SOUND, LL_ERROR, "Cannot allocate channels");
+			channel = i;
+		}
+	}
+	if (channel == -1)
+	{
+		return -1;
+	}
+	if (Mix_Playing(channel))
+	{
+		if (s->voices[channel].score > score)
+		{
+			LOG(LM_SOUND, LL_TRACE, "dropping sound, all voices busy");
 			return -1;
 		}
-		// When allocating new channels, need to reset their volume
-		Mix_Volume(-1, ConfigGetInt(&gConfig, "Sound.SoundVolume"));
+		LOG(LM_SOUND, LL_TRACE, "stealing voice %d", channel);
+		Mix_HaltChannel(channel);
 	}
+	return Mix_PlayChannel(channel, data, 0);
 }
 static void SetSoundEffect(
-	const int channel, const Sint16 bearingDegrees, const Uint8 distance,
-	const bool isMuffled)
+	SoundDevice *s, const int channel, const Sint16 bearingDegrees,
+	const Uint8 distance, const bool isMuffled)
 {
 #ifndef __EMSCRIPTEN__
 	Mix_SetPosition(channel, bearingDegrees, (Uint8)distance);
 	if (isMuffled)
 	{
-		if (!Mix_RegisterEffect(channel, MuffleEffect, NULL, NULL))
+		SoundVoice *v = &s->voices[channel];
+		memset(v->muffle, 0, sizeof v->muffle);
+		if (!Mix_RegisterEffect(channel, MuffleEffect, NULL, v))
 		{
 			fprintf(stderr, "Mix_RegisterEffect: %s\n", Mix_GetError());
 		}
@@ -458,6 +736,8 @@ static void SetSoundEffect(
 #else
 	// Mix_SetPosition and Mix_RegisterEffect not supported by emscripten;
 	// use plain panning instead
+	UNUSED(s);
+	UNUSED(isMuffled);
 
 	// Calculate left/right channel as values from 0-180
 	int left;
@@ -474,6 +754,11 @@ static void SetSoundEffect(
 #endif
 }
 
+void SoundTick(SoundDevice *s)
+{
+	s->tick++;
+}
+
 void SoundPlay(SoundDevice *device, Mix_Chunk *data)
 {
 	if (!device->isInitialised)
@@ -481,7 +766,8 @@ void SoundPlay(SoundDevice *device, Mix_Chunk *data)
 		return;
 	}
 
-	SoundPlayAtPosition(device, data, svec2_zero(), false);
+	SoundPlayAtPosition(
+		device, data, svec2_zero(), false, SOUND_PRIORITY_HIGH);
 }
 
 void SoundSetEar(const bool isLeft, const int idx, const struct vec2 pos)
@@ -527,10 +813,32 @@ int SoundPlayAt(SoundDevice *device, Mix_Chunk *data, const struct vec2 pos)
 	return SoundPlayAtPlusDistance(device, data, pos, 0);
 }
 
-static bool IsPosNoSee(void *data, struct vec2i pos)
+static bool IsMuffled(
+	SoundDevice *s, const struct vec2 pos, const struct vec2 origin)
 {
-	const Tile *t = MapGetTile(data, Vec2iToTile(pos));
-	return t != NULL && TileIsOpaque(t);
+	// Always trace from the ear; the sound's tile being visible to some
+	// player doesn't mean this ear can hear it unobstructed
+	const struct vec2i src = Vec2ToTile(pos);
+	const struct vec2i ear = Vec2ToTile(origin);
+	const unsigned hash = ((unsigned)ear.x * 73856093u) ^
+						  ((unsigned)ear.y * 19349663u) ^
+						  ((unsigned)src.x * 83492791u) ^
+						  ((unsigned)src.y * 2654435761u);
+	SoundOcclusion *o =
+		&s->occlusion[hash & (SOUND_OCCLUSION_CACHE_SIZE - 1)];
+	if (o->isValid && o->tick == s->tick && svec2i_is_equal(o->ear, ear) &&
+		svec2i_is_equal(o->src, src))
+	{
+		return o->isMuffled;
+	}
+	o->ear = ear;
+	o->src = src;
+	o->tick = s->tick;
+	o->isValid = true;
+	o->isMuffled = !HasClearLineJMRaytraceGrid(
+		&gMap.opaque, svec2i(TILE_WIDTH, TILE_HEIGHT),
+		svec2i_assign_vec2(pos), svec2i_assign_vec2(origin));
+	return o->isMuffled;
 }
 int SoundPlayAtPlusDistance(
 	SoundDevice *device, Mix_Chunk *data, const struct vec2 pos,
@@ -569,24 +877,18 @@ int SoundPlayAtPlusDistance(
 	// This is for player's own sounds like footsteps
 	if (svec2_distance_squared(pos, origin) > SQUARED(TILE_WIDTH))
 	{
-		HasClearLineData lineData;
-		lineData.IsBlocked = IsPosNoSee;
-		lineData.data = &gMap;
-		if (!HasClearLineJMRaytrace(
-				svec2i_assign_vec2(pos), svec2i_assign_vec2(origin),
-				&lineData))
-		{
-			isMuffled = true;
-		}
+		isMuffled = IsMuffled(device, pos, origin);
 	}
 	const struct vec2 dp = svec2_subtract(pos, origin);
+	// Sounds made quieter on purpose, like footsteps, are less important
+	const SoundPriority priority =
+		plusDistance > 0 ? SOUND_PRIORITY_LOW : SOUND_PRIORITY_NORMAL;
 	return SoundPlayAtPosition(
 		&gSoundDevice, data, svec2(dp.x, fabsf(dp.y) + plusDistance),
-		isMuffled);
+		isMuffled, priority);
 }
 
-static Mix_Chunk *SoundDataGet(SoundData *s);
-Mix_Chunk *StrSound(const char *s)
+static SoundData *StrSoundData(const char *s)
 {
 	if (s == NULL || strlen(s) == 0 || !gSoundDevice.isInitialised)
 	{
@@ -596,15 +898,25 @@ Mix_Chunk *StrSound(const char *s)
 	int error = hashmap_get(gSoundDevice.customSounds, s, (any_t *)&sound);
 	if (error == MAP_OK)
 	{
-		return SoundDataGet(sound);
+		return sound;
 	}
 	error = hashmap_get(gSoundDevice.sounds, s, (any_t *)&sound);
 	if (error == MAP_OK)
 	{
-		return SoundDataGet(sound);
+		return sound;
 	}
 	return NULL;
 }
+static Mix_Chunk *SoundDataGet(SoundData *s);
+Mix_Chunk *StrSound(const char *s)
+{
+	SoundData *sound = StrSoundData(s);
+	if (sound == NULL)
+	{
+		return NULL;
+	}
+	return SoundDataGet(sound);
+}
 static Mix_Chunk *SoundDataGet(SoundData *s)
 {
 	switch (s->Type)
@@ -623,7 +935,7 @@ static Mix_Chunk *SoundDataGet(SoundData *s)
 			while ((int)s->u.random.sounds.size > 1 &&
 				   idx == s->u.random.lastPlayed)
 			{
-				idx = rand() % s->u.random.sounds.size;
+				idx = RandInt(RNG_FX, 0, (int)s->u.random.sounds.size);
 			}
 			Mix_Chunk **sound = CArrayGet(&s->u.random.sounds, idx);
 			s->u.random.lastPlayed = idx;
@@ -634,3 +946,115 @@ static Mix_Chunk *SoundDataGet(SoundData *s)
 		return NULL;
 	}
 }
+
+void SoundPrewarmAdd(SoundDevice *s, const Mix_Chunk *chunk)
+{
+	SoundLazyChunk *lc = FindLazyChunk(s, chunk);
+	if (lc == NULL)
+	{
+		return;
+	}
+	if (s->prewarmThread != NULL)
+	{
+		SoundPrewarmCancel(s);
+	}
+	s->lazyTick++;
+	lc->lastUsed = s->lazyTick;
+	CA_FOREACH(SoundLazyChunk *, pending, s->prewarmChunks)
+	if (*pending == lc)
+	{
+		return;
+	}
+	CA_FOREACH_END()
+	CArrayPushBack(&s->prewarmChunks, &lc);
+}
+void SoundPrewarmAddName(SoundDevice *s, const char *name)
+{
+	const SoundData *sound = StrSoundData(name);
+	if (sound == NULL || !sound->isLazy)
+	{
+		return;
+	}
+	switch (sound->Type)
+	{
+	case SOUND_NORMAL:
+		SoundPrewarmAdd(s, sound->u.normal);
+		break;
+	case SOUND_RANDOM:
+		CA_FOREACH(Mix_Chunk *const, chunk, sound->u.random.sounds)
+		SoundPrewarmAdd(s, *chunk);
+		CA_FOREACH_END()
+		break;
+	default:
+		CASSERT(false, "Unknown sound data type");
+		break;
+	}
+}
+static int PrewarmThread(void *data)
+{
+	SoundDevice *s = data;
+	// Note: no logging or mixer channel access from this thread
+	CA_FOREACH(SoundLazyChunk *, lcp, s->prewarmChunks)
+	if (SDL_AtomicGet(&s->prewarmCancel))
+	{
+		break;
+	}
+	SoundLazyChunk *lc = *lcp;
+	SDL_LockMutex(s->lazyLock);
+	const bool isFull = s->loadedBytes >= SOUND_CACHE_BUDGET;
+	const bool skip = lc->chunk.abuf != NULL || lc->failed;
+	SDL_UnlockMutex(s->lazyLock);
+	if (isFull)
+	{
+		break;
+	}
+	if (skip)
+	{
+		continue;
+	}
+	Mix_Chunk *decoded = Mix_LoadWAV(lc->path);
+	SDL_LockMutex(s->lazyLock);
+	if (decoded == NULL)
+	{
+		lc->failed = true;
+	}
+	else if (lc->chunk.abuf == NULL)
+	{
+		LazyChunkInstall(s, lc, decoded);
+	}
+	else
+	{
+		// Loaded on the main thread in the meantime
+		Mix_FreeChunk(decoded);
+	}
+	SDL_UnlockMutex(s->lazyLock);
+	CA_FOREACH_END()
+	return 0;
+}
+void SoundPrewarmStart(SoundDevice *s)
+{
+	if (s->prewarmThread != NULL || s->prewarmChunks.size == 0)
+	{
+		return;
+	}
+	SDL_AtomicSet(&s->prewarmCancel, 0);
+	LOG(LM_SOUND, LL_DEBUG, "Prewarming %d sounds",
+		(int)s->prewarmChunks.size);
+	s->prewarmThread = SDL_CreateThread(PrewarmThread, "SoundPrewarm", s);
+	if (s->prewarmThread == NULL)
+	{
+		LOG(LM_SOUND, LL_WARN, "Cannot create sound prewarm thread: %s",
+			SDL_GetError());
+		CArrayClear(&s->prewarmChunks);
+	}
+}
+void SoundPrewarmCancel(SoundDevice *s)
+{
+	if (s->prewarmThread != NULL)
+	{
+		SDL_AtomicSet(&s->prewarmCancel, 1);
+		SDL_WaitThread(s->prewarmThread, NULL);
+		s->prewarmThread = NULL;
+	}
+	CArrayClear(&s->prewarmChunks);
+}
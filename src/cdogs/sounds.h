@@ -69,6 +69,13 @@
 #define CDOGS_SND_RATE 44100
 #define CDOGS_SND_FMT AUDIO_S16SYS
 #define CDOGS_SND_CHANNELS 2
+// Sounds loaded from files are only indexed on startup, and decoded when
+// first played; decoded sounds are evicted least-recently-used once they
+// take up more than this many bytes
+#define SOUND_CACHE_BUDGET (32 * 1024 * 1024)
+// Fixed number of mixer channels for sound effects; when they are all busy,
+// new sounds steal the voice of the least important sound playing
+#define SOUND_MAX_VOICES 32
 
 typedef enum
 {
@@ -87,8 +94,42 @@ typedef struct
 			int lastPlayed;
 		} random;
 	} u;
+	// Whether the chunks are indexed files that are decoded on demand,
+	// as opposed to chunks already in memory
+	bool isLazy;
 } SoundData;
 
+// More important sounds can steal voices from less important ones
+typedef enum
+{
+	SOUND_PRIORITY_LOW,	   // quiet sounds, e.g. footsteps
+	SOUND_PRIORITY_NORMAL, // in-game sounds
+	SOUND_PRIORITY_HIGH	   // non-positional sounds, e.g. menus
+} SoundPriority;
+
+typedef struct
+{
+	const Mix_Chunk *chunk;
+	// Priority combined with loudness; the lowest score is stolen first
+	int score;
+	Uint32 startTick;
+	bool isMuffled;
+	// Low-pass filter state for muffled sounds, per stereo channel
+	int32_t muffle[CDOGS_SND_CHANNELS];
+} SoundVoice;
+
+// Whether sounds between two tiles are muffled, cached for the current tick
+// since many sounds (e.g. gunfire) come from the same few places
+#define SOUND_OCCLUSION_CACHE_SIZE 256
+typedef struct
+{
+	struct vec2i ear;
+	struct vec2i src;
+	Uint32 tick;
+	bool isValid;
+	bool isMuffled;
+} SoundOcclusion;
+
 typedef struct
 {
 	MusicPlayer music;
@@ -103,6 +144,23 @@ typedef struct
 
 	map_t sounds;		// of SoundData
 	map_t customSounds; // of SoundData
+
+	// Indexed by mixer channel; the first channel is reserved for music
+	SoundVoice voices[SOUND_MAX_VOICES + 1];
+	Uint32 tick;
+	SoundOcclusion occlusion[SOUND_OCCLUSION_CACHE_SIZE];
+
+	// Lazily-loaded chunks
+	CArray lazyChunks;	 // of SoundLazyChunk *, sorted by address
+	CArray loadedChunks; // of SoundLazyChunk *, those currently decoded
+	size_t loadedBytes;
+	Uint32 lazyTick;
+	// Protects the decoded state of lazy chunks, which the prewarm thread
+	// can change
+	SDL_mutex *lazyLock;
+	SDL_Thread *prewarmThread;
+	SDL_atomic_t prewarmCancel;
+	CArray prewarmChunks; // of SoundLazyChunk *
 } SoundDevice;
 
 extern SoundDevice gSoundDevice;
@@ -114,6 +172,9 @@ void SoundReconfigure(SoundDevice *s);
 void SoundReopen(SoundDevice *s);
 void SoundClear(map_t sounds);
 void SoundTerminate(SoundDevice *device, const bool waitForSoundsComplete);
+// Call once per frame; identical sounds started in the same frame are only
+// played once
+void SoundTick(SoundDevice *s);
 void SoundPlay(SoundDevice *device, Mix_Chunk *data);
 void SoundSetEarsSide(const bool isLeft, const struct vec2 pos);
 void SoundSetEar(const bool isLeft, const int idx, const struct vec2 pos);
@@ -127,3 +188,11 @@ int SoundPlayAtPlusDistance(
 	const int plusDistance);
 
 Mix_Chunk *StrSound(const char *s);
+
+// Decode sounds on a background thread ahead of time, e.g. the ones used by
+// the next mission, so they don't cause hitches when first played
+// Add sounds with SoundPrewarmAdd/SoundPrewarmAddName, then start
+void SoundPrewarmAdd(SoundDevice *s, const Mix_Chunk *chunk);
+void SoundPrewarmAddName(SoundDevice *s, const char *name);
+void SoundPrewarmStart(SoundDevice *s);
+void SoundPrewarmCancel(SoundDevice *s);
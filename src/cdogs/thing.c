@@ -45,8 +45,8 @@
 #define DRAW_SHAKE_FACTOR 0.3f
 #define DRAW_SHAKE_DECAY 0.8f
 #define ZERO_DRAW_SHAKE svec2(\
-	RAND_FLOAT(-DRAW_SHAKE_MAX, DRAW_SHAKE_MAX) * 0.7f,\
-	RAND_FLOAT(-DRAW_SHAKE_MAX, DRAW_SHAKE_MAX) * 0.7f)
+	RandFloat(RNG_FX, -DRAW_SHAKE_MAX, DRAW_SHAKE_MAX) * 0.7f,\
+	RandFloat(RNG_FX, -DRAW_SHAKE_MAX, DRAW_SHAKE_MAX) * 0.7f)
 
 
 bool IsThingInsideTile(const Thing *i, const struct vec2i tilePos)
@@ -147,7 +147,7 @@ Thing *ThingIdGetThing(const ThingId *tid)
 		ti = &((TActor *)CArrayGet(&gActors, tid->Id))->thing;
 		break;
 	case KIND_PARTICLE:
-		ti = &((Particle *)CArrayGet(&gParticles, tid->Id))->thing;
+		ti = &ParticleGet(&gParticles, tid->Id)->thing;
 		break;
 	case KIND_MOBILEOBJECT:
 		ti = &((TMobileObject *)CArrayGet(
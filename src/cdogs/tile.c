@@ -69,11 +69,13 @@ void TileInit(Tile *t)
 	memset(t, 0, sizeof *t);
 	CArrayInit(&t->triggers, sizeof(Trigger *));
 	CArrayInit(&t->things, sizeof(ThingId));
+	CArrayInit(&t->watches, sizeof(int));
 }
 void TileDestroy(Tile *t)
 {
 	CArrayTerminate(&t->triggers);
 	CArrayTerminate(&t->things);
+	CArrayTerminate(&t->watches);
 }
 
 void TileUpdate(Tile *t)
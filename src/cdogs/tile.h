@@ -68,6 +68,7 @@ typedef struct
 	DoorState Door;
 	CArray triggers; // of Trigger *
 	CArray things;	 // of ThingId
+	CArray watches;	 // of int, gWatches index; watches with conditions here
 	// flags for drawing
 	bool outOfSight;
 	bool isVisited;
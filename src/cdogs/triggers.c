@@ -47,6 +47,7 @@
     POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 #include "triggers.h"
@@ -58,6 +59,19 @@
 
 CArray gWatches;	// of TWatch
 static int watchIndex = 1;
+// Ticks since the watches were initialised
+static int watchTicks = 0;
+typedef struct
+{
+	int Tick;
+	int Idx; // into gWatches
+} WatchWake;
+// Watches that will wake, ordered by tick (min-heap)
+// Entries are not removed when the watch's WakeTick changes; stale ones are
+// skipped when popped, see TWatch.QueuedTick
+static CArray sWakeQueue; // of WatchWake
+// Watches still due after running, to wake again next update
+static CArray sWakeAgain; // of int, gWatches index
 
 // Number of frames to wait before repeating the "cannot activate" event
 #define CANNOT_ACTIVATE_LOCK 50
@@ -92,6 +106,8 @@ TWatch *WatchNew(void)
 	CArrayInit(&t.actions, sizeof(Action));
 	CArrayInit(&t.conditions, sizeof(Condition));
 	t.active = false;
+	t.WakeTick = INT_MAX;
+	t.QueuedTick = INT_MAX;
 	CArrayPushBack(&gWatches, &t);
 	return CArrayGet(&gWatches, gWatches.size - 1);
 }
@@ -115,6 +131,102 @@ Action *WatchAddAction(TWatch *w)
 	return CArrayGet(&w->actions, w->actions.size - 1);
 }
 
+void WatchAddTile(const TWatch *w, Tile *t)
+{
+	const int idx = (int)(w - (const TWatch *)gWatches.data);
+	if (t->watches.size > 0 &&
+		*(const int *)CArrayGet(&t->watches, t->watches.size - 1) == idx)
+	{
+		return;
+	}
+	CArrayPushBack(&t->watches, &idx);
+}
+
+static void WakeQueuePush(const WatchWake ww)
+{
+	CArrayPushBack(&sWakeQueue, &ww);
+	WatchWake *wakes = sWakeQueue.data;
+	for (int i = (int)sWakeQueue.size - 1; i > 0;)
+	{
+		const int parent = (i - 1) / 2;
+		if (wakes[parent].Tick <= wakes[i].Tick)
+		{
+			break;
+		}
+		const WatchWake tmp = wakes[parent];
+		wakes[parent] = wakes[i];
+		wakes[i] = tmp;
+		i = parent;
+	}
+}
+static WatchWake WakeQueuePop(void)
+{
+	WatchWake *wakes = sWakeQueue.data;
+	const WatchWake top = wakes[0];
+	wakes[0] = wakes[sWakeQueue.size - 1];
+	CArrayPopBack(&sWakeQueue);
+	const int size = (int)sWakeQueue.size;
+	for (int i = 0;;)
+	{
+		const int l = 2 * i + 1;
+		const int r = l + 1;
+		int smallest = i;
+		if (l < size && wakes[l].Tick < wakes[smallest].Tick)
+		{
+			smallest = l;
+		}
+		if (r < size && wakes[r].Tick < wakes[smallest].Tick)
+		{
+			smallest = r;
+		}
+		if (smallest == i)
+		{
+			break;
+		}
+		const WatchWake tmp = wakes[smallest];
+		wakes[smallest] = wakes[i];
+		wakes[i] = tmp;
+		i = smallest;
+	}
+	return top;
+}
+static void WatchQueueWake(TWatch *w)
+{
+	if (w->WakeTick == INT_MAX || w->WakeTick == w->QueuedTick)
+	{
+		return;
+	}
+	w->QueuedTick = w->WakeTick;
+	const WatchWake ww = {w->WakeTick, (int)(w - (TWatch *)gWatches.data)};
+	WakeQueuePush(ww);
+}
+
+static bool ConditionIsMet(const Condition *c)
+{
+	switch (c->Type)
+	{
+	case CONDITION_TILECLEAR:
+	{
+		Tile *tile = MapGetTile(&gMap, c->Pos);
+		return tile != NULL && !TileHasCharacter(tile);
+	}
+	}
+	return false;
+}
+static void WatchUpdateWakeTick(TWatch *w)
+{
+	w->WakeTick = 0;
+	CA_FOREACH(const Condition, c, w->conditions)
+		if (!c->IsMet)
+		{
+			w->WakeTick = INT_MAX;
+			return;
+		}
+		w->WakeTick = MAX(w->WakeTick, c->MetSince + c->CounterMax);
+	CA_FOREACH_END()
+	WatchQueueWake(w);
+}
+
 static void ActivateWatch(int idx)
 {
 	CA_FOREACH(TWatch, w, gWatches)
@@ -126,8 +238,10 @@ static void ActivateWatch(int idx)
 			for (int j = 0; j < (int)w->conditions.size; j++)
 			{
 				Condition *c = CArrayGet(&w->conditions, j);
-				c->Counter = 0;
+				c->IsMet = ConditionIsMet(c);
+				c->MetSince = watchTicks;
 			}
+			WatchUpdateWakeTick(w);
 			return;
 		}
 	CA_FOREACH_END()
@@ -149,6 +263,35 @@ static void DeactivateWatch(int idx)
 void WatchesInit(void)
 {
 	CArrayInit(&gWatches, sizeof(TWatch));
+	CArrayInit(&sWakeQueue, sizeof(WatchWake));
+	CArrayInit(&sWakeAgain, sizeof(int));
+	watchTicks = 0;
+}
+void WatchesOnTileChanged(
+	const Tile *t, const struct vec2i pos, const bool hasCharacter)
+{
+	CA_FOREACH(const int, idx, t->watches)
+		TWatch *w = CArrayGet(&gWatches, *idx);
+		if (!w->active) continue;
+		bool changed = false;
+		for (int j = 0; j < (int)w->conditions.size; j++)
+		{
+			Condition *c = CArrayGet(&w->conditions, j);
+			if (c->Type != CONDITION_TILECLEAR ||
+				!svec2i_is_equal(c->Pos, pos) || c->IsMet != hasCharacter)
+			{
+				continue;
+			}
+			// Restart the condition's counter
+			c->IsMet = !hasCharacter;
+			c->MetSince = watchTicks;
+			changed = true;
+		}
+		if (changed)
+		{
+			WatchUpdateWakeTick(w);
+		}
+	CA_FOREACH_END()
 }
 void WatchesTerminate(void)
 {
@@ -157,6 +300,8 @@ void WatchesTerminate(void)
 		CArrayTerminate(&w->actions);
 	CA_FOREACH_END()
 	CArrayTerminate(&gWatches);
+	CArrayTerminate(&sWakeQueue);
+	CArrayTerminate(&sWakeAgain);
 }
 
 static void ActionRun(Action *a, CArray *mapTriggers)
@@ -204,37 +349,6 @@ static void ActionRun(Action *a, CArray *mapTriggers)
 	}
 }
 
-static bool ConditionsMet(CArray *conditions, const int ticks)
-{
-	bool allConditionsMet = true;
-	for (int i = 0; i < (int)conditions->size; i++)
-	{
-		Condition *c = CArrayGet(conditions, i);
-		bool conditionMet = false;
-		switch (c->Type)
-		{
-		case CONDITION_TILECLEAR:
-		{
-			Tile *tile = MapGetTile(&gMap, c->Pos);
-			conditionMet = tile != NULL && !TileHasCharacter(tile);
-			break;
-		}
-		}
-		if (conditionMet)
-		{
-			c->Counter += ticks;
-			allConditionsMet =
-				allConditionsMet && c->Counter >= c->CounterMax;
-		}
-		else
-		{
-			c->Counter = 0;
-			allConditionsMet = false;
-		}
-	}
-	return allConditionsMet;
-}
-
 bool TriggerTryActivate(Trigger *t, const int flags, const struct vec2i tilePos)
 {
 	const bool canActivate =
@@ -275,14 +389,37 @@ void TriggerActivate(Trigger *t, CArray *mapTriggers)
 
 void UpdateWatches(CArray *mapTriggers, const int ticks)
 {
-	CA_FOREACH(TWatch, w, gWatches)
-		if (!w->active) continue;
-		if (ConditionsMet(&w->conditions, ticks))
+	// Conditions are kept up to date by tile events; only run the watches
+	// whose conditions have been fulfilled for long enough
+	watchTicks += ticks;
+	CArrayClear(&sWakeAgain);
+	while (sWakeQueue.size > 0 &&
+		   ((const WatchWake *)sWakeQueue.data)->Tick <= watchTicks)
+	{
+		const WatchWake ww = WakeQueuePop();
+		TWatch *w = CArrayGet(&gWatches, ww.Idx);
+		if (ww.Tick != w->QueuedTick)
 		{
-			for (int j = 0; j < (int)w->actions.size; j++)
-			{
-				ActionRun(CArrayGet(&w->actions, j), mapTriggers);
-			}
+			// Stale; the watch has been queued again since
+			continue;
+		}
+		w->QueuedTick = INT_MAX;
+		if (!w->active || w->WakeTick > watchTicks)
+		{
+			continue;
 		}
+		for (int j = 0; j < (int)w->actions.size; j++)
+		{
+			ActionRun(CArrayGet(&w->actions, j), mapTriggers);
+		}
+		// Keep running the watch every update until it is deactivated
+		if (w->active && w->QueuedTick == INT_MAX &&
+			w->WakeTick <= watchTicks)
+		{
+			CArrayPushBack(&sWakeAgain, &ww.Idx);
+		}
+	}
+	CA_FOREACH(const int, idx, sWakeAgain)
+		WatchQueueWake(CArrayGet(&gWatches, *idx));
 	CA_FOREACH_END()
 }
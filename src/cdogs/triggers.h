@@ -59,6 +59,7 @@
 #include "game_events.h"
 #include "pic.h"
 #include "proto/msg.pb.h"
+#include "tile.h"
 
 typedef enum
 {
@@ -101,9 +102,10 @@ typedef enum
 typedef struct
 {
 	ConditionType Type;
-	// How many ticks has this condition been fulfilled
-	// Reset to 0 when condition failed
-	int Counter;
+	bool IsMet;
+	// Watch clock tick at which this condition was last fulfilled
+	int MetSince;
+	// How many ticks the condition needs to be fulfilled for
 	int CounterMax;
 	struct vec2i Pos;
 } Condition;
@@ -115,6 +117,13 @@ typedef struct
 	CArray conditions;	// of Condition
 	CArray actions;		// of Action
 	bool active;
+	// Watch clock tick at which all conditions will have been fulfilled
+	// for long enough; INT_MAX if any condition isn't fulfilled
+	// Updated when the conditions change, so that the watch doesn't need to
+	// be checked every tick
+	int WakeTick;
+	// WakeTick of the watch's entry in the wake queue; INT_MAX if none
+	int QueuedTick;
 } TWatch;
 
 
@@ -135,3 +144,9 @@ Condition *WatchAddCondition(
 	TWatch *w, const ConditionType type, const int counterMax,
 	const struct vec2i pos);
 Action *WatchAddAction(TWatch *w);
+// Subscribe the watch to changes in a tile its conditions depend on
+void WatchAddTile(const TWatch *w, Tile *t);
+// Notify the tile's watches that a character has entered or left it
+// (see Map.watchTiles)
+void WatchesOnTileChanged(
+	const Tile *t, const struct vec2i pos, const bool hasCharacter);
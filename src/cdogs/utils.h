@@ -57,6 +57,7 @@
 #include <SDL.h>
 
 #include "color.h"
+#include "prng.h"
 #include "sys_specifics.h"
 
 // Global variables so their address can be taken (passed into void * funcs)
@@ -209,12 +210,11 @@ bool IntsEqual(const void *v1, const void *v2);
 		return _type;                                                         \
 	}
 
-#define RAND_INT(_low, _high)                                                 \
-	((_low) == (_high) ? (_low) : (_low) + (rand() % ((_high) - (_low))))
+// Random numbers for the game simulation; see prng.h for other streams
+#define RAND_INT(_low, _high) RandInt(RNG_SIM, (int)(_low), (int)(_high))
 #define RAND_FLOAT(_low, _high) (float)RAND_DOUBLE(_low, _high)
-#define RAND_DOUBLE(_low, _high)                                              \
-	((_low) + ((double)rand() / RAND_MAX * ((_high) - (_low))))
-#define RAND_BOOL() (rand() > RAND_MAX / 2)
+#define RAND_DOUBLE(_low, _high) RandDouble(RNG_SIM, (_low), (_high))
+#define RAND_BOOL() RandBool(RNG_SIM)
 
 typedef enum
 {
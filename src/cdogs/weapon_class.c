@@ -29,6 +29,7 @@
 
 #include "ammo.h"
 #include "game_events.h"
+#include "json_stream.h"
 #include "json_utils.h"
 #include "log.h"
 #include "net_util.h"
@@ -76,15 +77,109 @@ void GunTypeGetSlotStartEnd(const GunType gt, int *start, int *end)
 }
 static void LoadWeaponClass(WeaponClass *wc, json_t *node, const int version);
 static void WeaponClassTerminate(WeaponClass *wc);
-void WeaponClassesLoadJSON(WeaponClasses *wcs, CArray *classes, json_t *root)
+// A gun as it is loaded, with its placement and deferred fields
+typedef struct
+{
+	WeaponClass wc;
+	int index;
+	json_t *node;
+} WeaponClassLoad;
+static const JSONField weaponClassFields[] = {
+	JSON_FIELD("Name", JSON_FIELD_STRING, WeaponClassLoad, wc.name),
+	JSON_FIELD(
+		"Description", JSON_FIELD_STRING, WeaponClassLoad, wc.Description),
+	JSON_FIELD(
+		"Prerequisite", JSON_FIELD_STRING, WeaponClassLoad, wc.Prerequisite),
+	JSON_FIELD("Lock", JSON_FIELD_INT, WeaponClassLoad, wc.Lock),
+	JSON_FIELD("DropGun", JSON_FIELD_STRING, WeaponClassLoad, wc.DropGun),
+	JSON_FIELD("Price", JSON_FIELD_INT, WeaponClassLoad, wc.Price),
+	JSON_FIELD(
+		"OverheatTicks", JSON_FIELD_INT, WeaponClassLoad, wc.OverheatTicks),
+	JSON_FIELD("Index", JSON_FIELD_INT, WeaponClassLoad, index),
+	// Fields whose defaults depend on the gun type, which is only known
+	// once the whole gun is read; loaded by LoadWeaponClass
+	JSON_FIELD("Guns", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("CanShoot", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("IsGrenade", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("Icon", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("SwitchSound", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("CanDrop", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("Pic", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("Grips", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("Bullet", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("Bullets", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("Ammo", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("Cost", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("ReloadLead", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("Sound", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("ReloadSound", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("SoundLockLength", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("Recoil", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("SpreadCount", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("SpreadWidth", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("AngleOffset", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("MuzzleHeight", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("Elevation", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("ElevationLow", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("ElevationHigh", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD(
+		"MuzzleFlashParticle", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("Brass", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("ShakeAmount", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("Shake", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELD("Auto", JSON_FIELD_NODE, WeaponClassLoad, node),
+	JSON_FIELDS_END};
+typedef struct
+{
+	WeaponClasses *wcs;
+	CArray *classes;
+	bool isRealGun;
+} WeaponClassLoadData;
+static void WeaponClassInit(void *data, void *loadData)
+{
+	UNUSED(loadData);
+	WeaponClassLoad *g = data;
+	g->wc.OverheatTicks = FPS_FRAMELIMIT; // default 1 second overheating
+	g->index = -1;
+}
+static void WeaponClassAdd(void *data, const int version, void *loadData)
+{
+	WeaponClassLoad *g = data;
+	const WeaponClassLoadData *d = loadData;
+	if (g->node == NULL)
+	{
+		g->node = json_new_object();
+	}
+	LoadWeaponClass(&g->wc, g->node, version);
+	json_free_value(&g->node);
+	g->wc.IsRealGun = d->isRealGun;
+	// Only allow index for non-custom guns
+	if (d->isRealGun && d->classes == &d->wcs->Guns && g->index >= 0 &&
+		g->index < GUN_COUNT)
+	{
+		WeaponClass *gExisting = CArrayGet(&d->wcs->Guns, g->index);
+		WeaponClassTerminate(gExisting);
+		memcpy(gExisting, &g->wc, sizeof g->wc);
+	}
+	else
+	{
+		CArrayPushBack(d->classes, &g->wc);
+	}
+}
+static void WeaponClassLoadTerminate(void *data)
+{
+	WeaponClassLoad *g = data;
+	WeaponClassTerminate(&g->wc);
+	json_free_value(&g->node);
+}
+bool WeaponClassesLoadFile(
+	WeaponClasses *wcs, CArray *classes, const char *path)
 {
 	LOG(LM_MAP, LL_DEBUG, "loading weapons");
-	int version;
-	LoadInt(&version, root, "Version");
-	if (version > VERSION || version <= 0)
+	FILE *f = fopen(path, "r");
+	if (f == NULL)
 	{
-		CASSERT(false, "cannot read guns file version");
-		return;
+		return false;
 	}
 
 	if (classes == &wcs->Guns)
@@ -97,44 +192,35 @@ void WeaponClassesLoadJSON(WeaponClasses *wcs, CArray *classes, json_t *root)
 			CArrayPushBack(&wcs->Guns, &gd);
 		}
 	}
-	json_t *gunsNode = json_find_first_label(root, "Guns")->child;
-	for (json_t *child = gunsNode->child; child; child = child->next)
-	{
-		WeaponClass gd;
-		LoadWeaponClass(&gd, child, version);
-		int idx = -1;
-		// Only allow index for non-custom guns
-		if (classes == &wcs->Guns)
-		{
-			LoadInt(&idx, child, "Index");
-		}
-		if (idx >= 0 && idx < GUN_COUNT)
-		{
-			WeaponClass *gExisting = CArrayGet(&wcs->Guns, idx);
-			WeaponClassTerminate(gExisting);
-			memcpy(gExisting, &gd, sizeof gd);
-		}
-		else
-		{
-			CArrayPushBack(classes, &gd);
-		}
-	}
-	json_t *pseudoGunsNode = json_find_first_label(root, "PseudoGuns");
-	if (pseudoGunsNode != NULL)
-	{
-		for (json_t *child = pseudoGunsNode->child->child; child;
-			 child = child->next)
-		{
-			WeaponClass gd;
-			LoadWeaponClass(&gd, child, version);
-			gd.IsRealGun = false;
-			CArrayPushBack(classes, &gd);
-		}
-	}
+	WeaponClassLoadData data = {wcs, classes, true};
+	JSONClassSchema schema = {
+		"Guns",
+		weaponClassFields,
+		sizeof(WeaponClassLoad),
+		VERSION,
+		WeaponClassInit,
+		WeaponClassAdd,
+		WeaponClassLoadTerminate,
+		&data,
+		NULL,
+		NULL};
+	bool ok = JSONStreamLoadClasses(&schema, f) > 0;
+	// Pseudo guns are in a second root array; the file is small so just
+	// stream it again
+	if (ok)
+	{
+		rewind(f);
+		schema.ArrayName = "PseudoGuns";
+		data.isRealGun = false;
+		ok = JSONStreamLoadClasses(&schema, f) > 0;
+	}
+	fclose(f);
+	return ok;
 }
+// Load the type-dependent fields of a gun, on top of the fields that were
+// streamed directly into it
 static void LoadWeaponClass(WeaponClass *wc, json_t *node, const int version)
 {
-	memset(wc, 0, sizeof *wc);
 
 	const json_t *gunsNode = json_find_first_label(node, "Guns");
 	if (gunsNode)
@@ -182,38 +268,10 @@ static void LoadWeaponClass(WeaponClass *wc, json_t *node, const int version)
 		wc->Icon = icon;
 	}
 
-	tmp = NULL;
-	LoadStr(&tmp, node, "Name");
-	if (tmp != NULL)
-	{
-		CFREE(wc->name);
-		wc->name = tmp;
-	}
-
-	tmp = NULL;
-	LoadStr(&tmp, node, "Description");
-	if (tmp != NULL)
-	{
-		CFREE(wc->Description);
-		wc->Description = tmp;
-	}
-
-	tmp = NULL;
-	LoadStr(&tmp, node, "Prerequisite");
-	if (tmp != NULL)
-	{
-		CFREE(wc->Prerequisite);
-		wc->Prerequisite = tmp;
-	}
-
-	LoadInt(&wc->Lock, node, "Lock");
-
 	LoadSoundFromNode(&wc->SwitchSound, node, "SwitchSound");
 
 	LoadBool(&wc->CanDrop, node, "CanDrop");
 
-	LoadStr(&wc->DropGun, node, "DropGun");
-
 	if (wc->Type == GUNTYPE_MULTI)
 	{
 		int i = 0;
@@ -356,10 +414,6 @@ static void LoadWeaponClass(WeaponClass *wc, json_t *node, const int version)
 		}
 	}
 
-	LoadInt(&wc->Price, node, "Price");
-	wc->OverheatTicks = FPS_FRAMELIMIT;	// default 1 second overheating
-	LoadInt(&wc->OverheatTicks, node, "OverheatTicks");
-
 	LOG(LM_MAP, LL_DEBUG, "loaded %s name(%s) lock(%d)...",
 		GunTypeStr(wc->Type), wc->name, wc->Lock);
 	LOG(LM_MAP, LL_DEBUG, "...canDrop(%s)", wc->CanDrop ? "true" : "false");
@@ -530,11 +584,11 @@ void WeaponClassAddBrass(
 	e.u.AddParticle.Z = (float)wc->u.Normal.MuzzleHeight;
 	e.u.AddParticle.Vel =
 		svec2_scale(Vec2FromRadians(radians + MPI_2), 0.333333f);
-	e.u.AddParticle.Vel.x += RAND_FLOAT(-0.25f, 0.25f);
-	e.u.AddParticle.Vel.y += RAND_FLOAT(-0.25f, 0.25f);
-	e.u.AddParticle.Angle = RAND_DOUBLE(0, MPI * 2);
-	e.u.AddParticle.DZ = (float)((rand() % 6) + 6);
-	e.u.AddParticle.Spin = RAND_DOUBLE(-0.1, 0.1);
+	e.u.AddParticle.Vel.x += RandFloat(RNG_FX, -0.25f, 0.25f);
+	e.u.AddParticle.Vel.y += RandFloat(RNG_FX, -0.25f, 0.25f);
+	e.u.AddParticle.Angle = RandDouble(RNG_FX, 0, MPI * 2);
+	e.u.AddParticle.DZ = (float)RandInt(RNG_FX, 6, 12);
+	e.u.AddParticle.Spin = RandDouble(RNG_FX, -0.1, 0.1);
 	GameEventsEnqueue(&gGameEvents, e);
 }
 
@@ -727,64 +781,21 @@ void BulletAndWeaponInitialize(
 	BulletClasses *b, WeaponClasses *wcs, const char *bpath, const char *gpath)
 {
 	BulletInitialize(b);
+	WeaponClassesInitialize(wcs);
 
-	FILE *bf = NULL;
-	FILE *gf = NULL;
-	json_t *broot = NULL;
-	json_t *groot = NULL;
-	enum json_error e;
-
-	// 2-pass bullet loading will free root for us
-	bool freeBRoot = true;
 	char buf[CDOGS_PATH_MAX];
 	GetDataFilePath(buf, bpath);
-	bf = fopen(buf, "r");
-	if (bf == NULL)
+	if (!BulletLoadFile(b, &b->Classes, buf))
 	{
 		LOG(LM_MAP, LL_ERROR, "Error: cannot load bullets file %s", buf);
-		goto bail;
-	}
-	e = json_stream_parse(bf, &broot);
-	if (e != JSON_OK)
-	{
-		LOG(LM_MAP, LL_ERROR, "Error parsing bullets file %s [error %d]", buf,
-			(int)e);
-		goto bail;
+		return;
 	}
-	BulletLoadJSON(b, &b->Classes, broot);
 
-	WeaponClassesInitialize(wcs);
 	GetDataFilePath(buf, gpath);
-	gf = fopen(buf, "r");
-	if (gf == NULL)
+	if (!WeaponClassesLoadFile(wcs, &wcs->Guns, buf))
 	{
 		LOG(LM_MAP, LL_ERROR, "Error: cannot load guns file %s", buf);
-		goto bail;
-	}
-	e = json_stream_parse(gf, &groot);
-	if (e != JSON_OK)
-	{
-		LOG(LM_MAP, LL_ERROR, "Error parsing guns file %s [error %d]", buf,
-			(int)e);
-		goto bail;
 	}
-	WeaponClassesLoadJSON(wcs, &wcs->Guns, groot);
 
 	BulletLoadWeapons(b);
-	freeBRoot = false;
-
-bail:
-	if (bf)
-	{
-		fclose(bf);
-	}
-	if (gf)
-	{
-		fclose(gf);
-	}
-	if (freeBRoot)
-	{
-		json_free_value(&broot);
-	}
-	json_free_value(&groot);
 }
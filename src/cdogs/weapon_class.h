@@ -133,7 +133,8 @@ const char *GunTypeStr(const GunType t);
 void GunTypeGetSlotStartEnd(const GunType gt, int *start, int *end);
 
 void WeaponClassesInitialize(WeaponClasses *wcs);
-void WeaponClassesLoadJSON(WeaponClasses *wcs, CArray *classes, json_t *root);
+bool WeaponClassesLoadFile(
+	WeaponClasses *wcs, CArray *classes, const char *path);
 void WeaponClassesClear(CArray *classes);
 void WeaponClassesTerminate(WeaponClasses *wcs);
 const WeaponClass *StrWeaponClass(const char *s);
@@ -468,6 +468,8 @@ static bool TryOpen(const char *filename)
 	bool loaded = false;
 	if (!MapNewLoad(buf, &gCampaign.Setting))
 	{
+		// The editor needs every mission, including lazily-loaded ones
+		CampaignSettingLoadAllMissions(&gCampaign.Setting);
 		Setup(true);
 		strcpy(lastFile, filename);
 		loaded = true;
@@ -1353,6 +1355,7 @@ int main(int argc, char *argv[])
 			RealPath(argv[i], lastFile);
 			if (MapNewLoad(lastFile, &gCampaign.Setting) == 0)
 			{
+				CampaignSettingLoadAllMissions(&gCampaign.Setting);
 				loaded = 1;
 				ReloadUI();
 				LOG(LM_EDIT, LL_INFO, "Loaded map %s", lastFile);
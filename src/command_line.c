@@ -34,7 +34,11 @@
 
 #include <cdogs/XGetopt.h>
 #include <cdogs/config.h>
+#include <cdogs/job_system.h>
 #include <cdogs/log.h>
+#include <cdogs/map_compiled.h>
+#include <cdogs/profiler.h>
+#include <cdogs/replay.h>
 #include <cdogs/sys_config.h>
 #include <cdogs/utils.h>
 
@@ -94,7 +98,20 @@ void PrintHelp(void)
 		"%s\n",
 		"Other:\n"
 		"    --connect=host   (Experimental) connect to a game server\n"
-		"    --demo           (Experimental) run game for 30 seconds\n");
+		"    --demo           (Experimental) run game for 30 seconds\n"
+		"    --record=F       Record the next mission played to replay file F\n"
+		"    --replay=F       Play back replay file F\n"
+		"    --headless       Play back the replay as fast as possible without\n"
+		"                       drawing, and print timings\n"
+		"    --profile        Enable the frame profiler, and save a trace of\n"
+		"                       the last frames to the config dir on exit\n"
+		"                       In game: F11 toggles the profiler overlay,\n"
+		"                       F12 saves a trace\n"
+		"    --jobs=n         Use n worker threads for parallel work\n"
+		"                       Default: one per extra CPU core\n"
+		"    --compile-campaign=D\n"
+		"                     Compile campaign dir D (.cdogscpn) to the\n"
+		"                       binary format for faster loading, and exit\n");
 }
 
 void ProcessCommandLine(char *buf, const int argc, char *argv[])
@@ -130,6 +147,12 @@ bool ParseArgs(
 		{"log", required_argument, NULL, 1000},
 		{"logfile", required_argument, NULL, 1001},
 		{"demo", no_argument, NULL, 1002},
+		{"record", required_argument, NULL, 1003},
+		{"replay", required_argument, NULL, 1004},
+		{"headless", no_argument, NULL, 1005},
+		{"profile", no_argument, NULL, 1006},
+		{"compile-campaign", required_argument, NULL, 1007},
+		{"jobs", required_argument, NULL, 1008},
 		{"help", no_argument, NULL, 'h'},
 		{0, 0, NULL, 0}};
 	int opt = 0;
@@ -200,6 +223,34 @@ bool ParseArgs(
 			*demoQuitTimer = 30 * 1000;
 			printf("Entering demo mode; will auto-quit in 30 seconds\n");
 			break;
+		case 1003:
+			gReplay.Mode = REPLAY_MODE_RECORD;
+			strncpy(gReplay.Filename, optarg, CDOGS_PATH_MAX - 1);
+			break;
+		case 1004:
+			gReplay.Mode = REPLAY_MODE_PLAY;
+			strncpy(gReplay.Filename, optarg, CDOGS_PATH_MAX - 1);
+			break;
+		case 1005:
+			gReplay.Headless = true;
+			break;
+		case 1006:
+			gProfiler.Enabled = true;
+			break;
+		case 1007:
+			if (MapCompiledSave(optarg))
+			{
+				printf("Compiled campaign %s\n", optarg);
+			}
+			else
+			{
+				printf("Failed to compile campaign %s\n", optarg);
+			}
+			return false;
+		case 1008:
+			gJobSystem.NumWorkers = MAX(atoi(optarg), 0);
+			printf("Job worker threads: %d\n", gJobSystem.NumWorkers);
+			break;
 		case 'x':
 			if (enet_address_set_host(connectAddr, optarg) != 0)
 			{
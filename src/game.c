@@ -62,11 +62,14 @@
 #include <cdogs/log.h>
 #include <cdogs/los.h>
 #include <cdogs/map_build.h>
+#include <cdogs/map_prep.h>
 #include <cdogs/music.h>
 #include <cdogs/net_client.h>
 #include <cdogs/net_server.h>
 #include <cdogs/objs.h>
 #include <cdogs/pickup.h>
+#include <cdogs/profiler.h>
+#include <cdogs/replay.h>
 
 #include "briefing_screens.h"
 #include "loading_screens.h"
@@ -155,17 +158,17 @@ static void RunGameOnEnter(GameLoopData *data)
 
 	RunGameReset(rData);
 
-	CampaignSeedRandom(rData->co);
-	MapBuild(
-		rData->map, rData->m->missionData, !rData->co->IsClient,
-		rData->m->index, rData->co->Entry.Mode,
-		&rData->co->Setting.characters);
+	MapPrepBuild(
+		&gMapPrep, rData->map, rData->co, rData->m, !rData->co->IsClient);
 
 	// Seed random if PVP mode (otherwise players will always spawn in same
 	// position)
+	uint64_t pvpSeed = 0;
 	if (IsPVP(rData->co->Entry.Mode))
 	{
-		srand((unsigned int)time(NULL));
+		pvpSeed = gReplay.Mode == REPLAY_MODE_PLAY ? gReplay.PVPSeed
+												   : (uint64_t)time(NULL);
+		RandSeedStream(RNG_SIM, pvpSeed);
 	}
 
 	if (!rData->co->IsClient)
@@ -188,6 +191,7 @@ static void RunGameOnEnter(GameLoopData *data)
 		CA_FOREACH_END()
 		// Process the events to force add the players
 		HandleGameEvents(&gGameEvents, NULL, NULL, NULL, NULL);
+		ReplayRecordStart(&gReplay, rData->co, pvpSeed);
 
 		// Note: place players first,
 		// as bad guys are placed away from players
@@ -268,6 +272,12 @@ static void RunGameOnExit(GameLoopData *data)
 
 	LOG(LM_MAIN, LL_INFO, "Game finished");
 
+	ReplayRecordEnd(&gReplay);
+	if (gReplay.Mode == REPLAY_MODE_PLAY)
+	{
+		ReplayPlayEnd(&gReplay);
+	}
+
 	// Flush events
 	HandleGameEvents(&gGameEvents, NULL, NULL, NULL, NULL);
 
@@ -394,6 +404,16 @@ static void RunGameInput(GameLoopData *data)
 	}
 
 	CameraInput(&rData->Camera, rData->cmds[0], rData->lastCmds[0]);
+
+	// Profiler hotkeys
+	if (KeyIsPressed(&gEventHandlers.keyboard, SDL_SCANCODE_F11))
+	{
+		ProfilerToggleOverlay(&gProfiler);
+	}
+	if (KeyIsPressed(&gEventHandlers.keyboard, SDL_SCANCODE_F12))
+	{
+		ProfilerSaveTrace(&gProfiler, GetConfigFilePath(PROFILER_TRACE_FILE));
+	}
 }
 static void NextLoop(RunGameData *rData, LoopRunner *l);
 static void CheckMissionCompletion(const struct MissionOptions *mo);
@@ -506,9 +526,36 @@ static GameLoopResult RunGameUpdate(GameLoopData *data, LoopRunner *l)
 
 	const int ticksPerFrame = 1;
 
+	int replayCmds[MAX_LOCAL_PLAYERS];
+	memset(replayCmds, 0, sizeof replayCmds);
+	if (gReplay.Mode == REPLAY_MODE_PLAY &&
+		!ReplayPlayFrame(&gReplay, replayCmds) && !rData->m->isDone)
+	{
+		// End of replay; quit the mission
+		GameEvent e = GameEventNew(GAME_EVENT_MISSION_END);
+		e.u.MissionEnd.IsQuit = true;
+		GameEventsEnqueue(&gGameEvents, e);
+	}
+
 	if (gPlayerDatas.size > 0)
 	{
+		// Calculate LOS for all players alive or dying, so that AI players
+		// can perceive what all players see before anyone moves
+		PROFILE_BEGIN("LOS");
 		LOSReset(&gMap.LOS);
+		CA_FOREACH(const PlayerData, p, gPlayerDatas)
+		if (p->ActorUID == -1)
+		{
+			continue;
+		}
+		const TActor *player = ActorGetByUID(p->ActorUID);
+		LOSCalcFrom(
+			&gMap, Vec2ToTile(player->thing.Pos), !gCampaign.IsClient);
+		CA_FOREACH_END()
+		PROFILE_END();
+		PROFILE_BEGIN("AIThinkPlayers");
+		AIThinkPlayers();
+		PROFILE_END();
 		for (int i = 0, idx = 0; i < (int)gPlayerDatas.size; i++, idx++)
 		{
 			const PlayerData *p = CArrayGet(&gPlayerDatas, i);
@@ -516,10 +563,6 @@ static GameLoopResult RunGameUpdate(GameLoopData *data, LoopRunner *l)
 				continue;
 			TActor *player = ActorGetByUID(p->ActorUID);
 
-			// Calculate LOS for all players alive or dying
-			LOSCalcFrom(
-				&gMap, Vec2ToTile(player->thing.Pos), !gCampaign.IsClient);
-
 			if (player->dead)
 				continue;
 
@@ -533,14 +576,29 @@ static GameLoopResult RunGameUpdate(GameLoopData *data, LoopRunner *l)
 			{
 				rData->cmds[idx] = AICoopGetCmd(player, ticksPerFrame);
 			}
+			if (gReplay.Mode == REPLAY_MODE_PLAY)
+			{
+				rData->cmds[idx] = replayCmds[idx];
+			}
+			replayCmds[idx] = rData->cmds[idx];
 			PlayerSpecialCommands(player, rData->cmds[idx]);
 			rData->cmds[idx] =
 				CommandActor(player, rData->cmds[idx], ticksPerFrame);
 		}
 	}
+	if (!gCampaign.IsClient)
+	{
+		ReplayRecordFrame(&gReplay, replayCmds);
+	}
+	if (gReplay.Mode == REPLAY_MODE_PLAY)
+	{
+		ReplayPlayCheckFrame(&gReplay);
+	}
 
 	// Disable sounds on the first frame
-	GameUpdate(rData, ticksPerFrame, data->Frames == 0 ? NULL : &gSoundDevice);
+	GameUpdate(
+		rData, ticksPerFrame,
+		data->Frames == 0 || gReplay.Headless ? NULL : &gSoundDevice);
 
 	CameraUpdate(&rData->Camera, ticksPerFrame, 1000 / data->FPS);
 
@@ -549,6 +607,13 @@ static GameLoopResult RunGameUpdate(GameLoopData *data, LoopRunner *l)
 static void PersistPlayerWeaponsAndAmmo(PlayerData *p);
 static void NextLoop(RunGameData *rData, LoopRunner *l)
 {
+	if (gReplay.Mode == REPLAY_MODE_PLAY)
+	{
+		// Replays are of a single mission; quit once it is over
+		LoopRunnerPop(l);
+		return;
+	}
+
 	// Find the next screen to switch to
 	const bool hasLocalPlayers = GetNumPlayers(PLAYER_ANY, false, true) > 0;
 	const int survivingPlayers = GetNumPlayers(PLAYER_ALIVE, false, false);
@@ -710,9 +775,11 @@ void GameInit(
 void GameUpdate(RunGameData *data, const int ticksPerFrame, SoundDevice *sd)
 {
 	// Update all the things in the game
+	PROFILE_BEGIN("GameUpdate");
 
 	if (!gCampaign.IsClient)
 	{
+		PROFILE_BEGIN("AI");
 		data->aiUpdateCounter -= ticksPerFrame;
 		if (data->aiUpdateCounter <= 0)
 		{
@@ -724,14 +791,27 @@ void GameUpdate(RunGameData *data, const int ticksPerFrame, SoundDevice *sd)
 		{
 			AICommandLast(ticksPerFrame);
 		}
+		PROFILE_END();
 	}
 
+	PROFILE_BEGIN("UpdateAllActors");
 	UpdateAllActors(ticksPerFrame);
+	PROFILE_END();
+	PROFILE_BEGIN("UpdateObjects");
 	UpdateObjects(ticksPerFrame);
+	PROFILE_END();
+	PROFILE_BEGIN("UpdateMobileObjects");
 	UpdateMobileObjects(ticksPerFrame);
+	PROFILE_END();
+	PROFILE_BEGIN("PickupsUpdate");
 	PickupsUpdate(&gPickups, ticksPerFrame);
+	PROFILE_END();
+	PROFILE_BEGIN("ParticlesUpdate");
 	ParticlesUpdate(&gParticles, ticksPerFrame);
+	PROFILE_END();
+	PROFILE_BEGIN("MapUpdate");
 	MapUpdate(data->map);
+	PROFILE_END();
 
 	UpdateWatches(&data->map->triggers, ticksPerFrame);
 
@@ -751,11 +831,14 @@ void GameUpdate(RunGameData *data, const int ticksPerFrame, SoundDevice *sd)
 		MissionDone(&gMission, me);
 	}
 
+	PROFILE_BEGIN("HandleGameEvents");
 	HandleGameEvents(
 		&gGameEvents, &data->Camera, &data->healthSpawner, &data->ammoSpawners,
 		sd);
+	PROFILE_END();
 
 	data->m->time += ticksPerFrame;
+	PROFILE_END();
 
 	if (gEventHandlers.HasResolutionChanged)
 	{
@@ -30,10 +30,12 @@
 
 #include <SDL_timer.h>
 
+#include "alloc.h"
 #include "config.h"
 #include "events.h"
 #include "net_client.h"
 #include "net_server.h"
+#include "profiler.h"
 #include "sounds.h"
 
 #ifdef __EMSCRIPTEN__
@@ -155,6 +157,7 @@ LoopRunner LoopRunnerNew(void)
 {
 	LoopRunner l;
 	CArrayInit(&l.Loops, sizeof(GameLoopData *));
+	l.Headless = false;
 	return l;
 }
 static void GameLoopTerminate(GameLoopData *data);
@@ -192,25 +195,35 @@ bool LoopRunnerRunInner(LoopRunInnerData *ctx)
 {
 #ifndef __EMSCRIPTEN__
 	// Frame rate control
-	if (LoopRunParamsShouldSleep(&(ctx->p)))
+	if (!ctx->l->Headless && LoopRunParamsShouldSleep(&(ctx->p)))
 	{
 		SDL_Delay(1);
 		return true;
 	}
 #endif
 
+	ProfilerFrameBegin(&gProfiler);
+	FrameAllocReset(&gFrameAlloc);
+
 	// Input
+	PROFILE_BEGIN("Input");
 	EventPoll(&gEventHandlers, ctx->p.TicksElapsed, NULL);
 	if (ctx->data->InputFunc)
 	{
 		ctx->data->InputFunc(ctx->data);
 	}
+	PROFILE_END();
 
+	PROFILE_BEGIN("NetPoll");
 	NetClientPoll(&gNetClient);
 	NetServerPoll(&gNetServer);
+	PROFILE_END();
 
 	// Update
+	SoundTick(&gSoundDevice);
+	PROFILE_BEGIN("Update");
 	ctx->p.Result = ctx->data->UpdateFunc(ctx->data, ctx->l);
+	PROFILE_END();
 	GameLoopData *newData = GetCurrentLoop(ctx->l);
 	if (newData == NULL)
 	{
@@ -237,8 +250,10 @@ bool LoopRunnerRunInner(LoopRunInnerData *ctx)
 		return true;
 	}
 
+	PROFILE_BEGIN("NetFlush");
 	NetServerFlush(&gNetServer);
 	NetClientFlush(&gNetClient);
+	PROFILE_END();
 
 	bool draw = !ctx->data->HasDrawnFirst;
 	switch (ctx->p.Result)
@@ -256,15 +271,16 @@ bool LoopRunnerRunInner(LoopRunInnerData *ctx)
 	ctx->data->Frames++;
 #ifndef __EMSCRIPTEN__
 	// frame skip
-	if (LoopRunParamsShouldSkip(&(ctx->p)))
+	if (!ctx->l->Headless && LoopRunParamsShouldSkip(&(ctx->p)))
 	{
 		return true;
 	}
 #endif
 
 	// Draw
-	if (draw)
+	if (draw && !ctx->l->Headless)
 	{
+		PROFILE_BEGIN("Draw");
 		WindowContextPreRender(&gGraphicsDevice.gameWindow);
 		if (gGraphicsDevice.cachedConfig.SecondWindow)
 		{
@@ -289,6 +305,7 @@ bool LoopRunnerRunInner(LoopRunInnerData *ctx)
 			WindowContextPostRender(&gGraphicsDevice.secondWindow);
 		}
 		ctx->data->HasDrawnFirst = true;
+		PROFILE_END();
 	}
 
 	return true;
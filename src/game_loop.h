@@ -43,6 +43,8 @@ typedef enum
 typedef struct
 {
 	CArray Loops; // of GameLoopData *
+	// Run as fast as possible without drawing, e.g. for headless replays
+	bool Headless;
 } LoopRunner;
 
 // Generic game loop manager, with callbacks for update/draw
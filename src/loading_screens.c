@@ -70,7 +70,7 @@ static void LazyLoad(LoadingScreen *l)
 			{
 				CArrayPushBack(&l->panelIndices, &i);
 			}
-			CArrayShuffle(&l->panelIndices);
+			CArrayShuffle(&l->panelIndices, &gRandStreams[RNG_FX]);
 		}
 	}
 
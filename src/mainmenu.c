@@ -120,7 +120,8 @@ static void GenerateLiveBackground(MainMenuData *data)
 	PlacePlayer(&gMap, p, svec2_zero(), true);
 	CA_FOREACH_END()
 
-	const HSV tint = {rand() * 360.0 / RAND_MAX, rand() * 1.0 / RAND_MAX, 0.5};
+	const HSV tint = {
+		RandDouble(RNG_FX, 0.0, 360.0), RandDouble(RNG_FX, 0.0, 1.0), 0.5};
 	data->bgTint = tint;
 	DrawBufferInit(&data->buffer, svec2i(X_TILES, Y_TILES), data->graphics);
 	InitializeBadGuys();
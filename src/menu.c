@@ -1184,7 +1184,8 @@ static bool KeyAvailable(
 	const SDL_Scancode key, const key_code_e code, const int playerIndex)
 {
 	if (key == SDL_SCANCODE_ESCAPE || key == SDL_SCANCODE_F9 ||
-		key == SDL_SCANCODE_F10)
+		key == SDL_SCANCODE_F10 || key == SDL_SCANCODE_F11 ||
+		key == SDL_SCANCODE_F12)
 	{
 		return false;
 	}
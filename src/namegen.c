@@ -80,8 +80,10 @@ void NameGenMake(const NameGen *g, char *buf)
 {
 	for (;;)
 	{
-		char **prefix = CArrayGet(&g->prefixes, rand() % g->prefixes.size);
-		int suffixIndex = rand() % (g->suffixes.size + g->suffixNames.size);
+		char **prefix = CArrayGet(
+			&g->prefixes, RandInt(RNG_FX, 0, (int)g->prefixes.size));
+		int suffixIndex = RandInt(
+			RNG_FX, 0, (int)(g->suffixes.size + g->suffixNames.size));
 		char **suffix;
 		if (suffixIndex < (int)g->suffixes.size)
 		{
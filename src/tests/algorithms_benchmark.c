@@ -0,0 +1,109 @@
+// Times the grid raytracing against the callback version; not a test.
+// Built with -DBUILD_BENCHMARKS=ON
+#include <stdio.h>
+#include <time.h>
+
+#include <algorithms.h>
+#include <prng.h>
+#include <utils.h>
+
+
+#define GRID_W 100
+#define GRID_H 80
+#define NUM_LINES 100000
+#define NUM_RUNS 5
+
+typedef struct
+{
+	const BitGrid *g;
+	struct vec2i cellSize;
+} GridLineData;
+static bool IsGridBlocked(void *data, struct vec2i pos)
+{
+	const GridLineData *gld = data;
+	return BitGridGet(
+		gld->g, svec2i(pos.x / gld->cellSize.x, pos.y / gld->cellSize.y));
+}
+
+typedef struct
+{
+	BitGrid g;
+	struct vec2i cellSize;
+	struct vec2i from;
+	struct vec2i ends[NUM_LINES];
+	bool clear[NUM_LINES];
+} Lines;
+
+static double TimeCallback(Lines *l)
+{
+	GridLineData gld = {&l->g, l->cellSize};
+	HasClearLineData data;
+	data.IsBlocked = IsGridBlocked;
+	data.data = &gld;
+	const clock_t start = clock();
+	for (int i = 0; i < NUM_LINES; i++)
+	{
+		l->clear[i] = HasClearLineJMRaytrace(l->from, l->ends[i], &data);
+	}
+	return (double)(clock() - start) * 1000 / CLOCKS_PER_SEC;
+}
+static double TimeGrid(Lines *l)
+{
+	const clock_t start = clock();
+	for (int i = 0; i < NUM_LINES; i++)
+	{
+		l->clear[i] = HasClearLineJMRaytraceGrid(
+			&l->g, l->cellSize, l->from, l->ends[i]);
+	}
+	return (double)(clock() - start) * 1000 / CLOCKS_PER_SEC;
+}
+static double TimeBatch(Lines *l)
+{
+	const clock_t start = clock();
+	JMRaytraceGridBatch(
+		&l->g, l->cellSize, l->from, l->ends, NUM_LINES, l->clear, NULL);
+	return (double)(clock() - start) * 1000 / CLOCKS_PER_SEC;
+}
+
+int main(void)
+{
+	static Lines l;
+	PRNG r;
+	PRNGSeed(&r, 5);
+	BitGridInit(&l.g, svec2i(GRID_W, GRID_H));
+	struct vec2i v;
+	for (v.y = 0; v.y < GRID_H; v.y++)
+	{
+		for (v.x = 0; v.x < GRID_W; v.x++)
+		{
+			BitGridSet(&l.g, v, PRNGInt(&r, 0, 100) < 5);
+		}
+	}
+	// Pixel lines over tiles, as used by AI sight and sound occlusion
+	l.cellSize = svec2i(16, 12);
+	const struct vec2i size =
+		svec2i(GRID_W * l.cellSize.x - 1, GRID_H * l.cellSize.y - 1);
+	l.from = svec2i(PRNGInt(&r, 0, size.x), PRNGInt(&r, 0, size.y));
+	for (int i = 0; i < NUM_LINES; i++)
+	{
+		l.ends[i] = svec2i(PRNGInt(&r, 0, size.x), PRNGInt(&r, 0, size.y));
+	}
+
+	// Report the best of a few runs of each
+	double callbackMs = -1, gridMs = -1, batchMs = -1;
+	for (int i = 0; i < NUM_RUNS; i++)
+	{
+		const double c = TimeCallback(&l);
+		const double g = TimeGrid(&l);
+		const double b = TimeBatch(&l);
+		callbackMs = callbackMs < 0 ? c : MIN(callbackMs, c);
+		gridMs = gridMs < 0 ? g : MIN(gridMs, g);
+		batchMs = batchMs < 0 ? b : MIN(batchMs, b);
+	}
+	printf(
+		"%d lines: callback %.1fms, grid %.1fms, batch %.1fms\n", NUM_LINES,
+		callbackMs, gridMs, batchMs);
+
+	BitGridTerminate(&l.g);
+	return 0;
+}
@@ -0,0 +1,174 @@
+#include <cbehave/cbehave.h>
+
+#include <algorithms.h>
+#include <prng.h>
+#include <utils.h>
+
+
+#define GRID_W 100
+#define GRID_H 80
+
+typedef struct
+{
+	const BitGrid *g;
+	struct vec2i cellSize;
+} GridLineData;
+static bool IsGridBlocked(void *data, struct vec2i pos)
+{
+	const GridLineData *gld = data;
+	return BitGridGet(
+		gld->g, svec2i(pos.x / gld->cellSize.x, pos.y / gld->cellSize.y));
+}
+static bool HasClearLineCallback(
+	const BitGrid *g, const struct vec2i cellSize, const struct vec2i from,
+	const struct vec2i to)
+{
+	GridLineData gld = {g, cellSize};
+	HasClearLineData data;
+	data.IsBlocked = IsGridBlocked;
+	data.data = &gld;
+	return HasClearLineJMRaytrace(from, to, &data);
+}
+
+static void FillRandom(BitGrid *g, PRNG *r, const int percent)
+{
+	BitGridInit(g, svec2i(GRID_W, GRID_H));
+	struct vec2i v;
+	for (v.y = 0; v.y < g->size.y; v.y++)
+	{
+		for (v.x = 0; v.x < g->size.x; v.x++)
+		{
+			BitGridSet(g, v, PRNGInt(r, 0, 100) < percent);
+		}
+	}
+}
+static struct vec2i RandomPoint(PRNG *r, const struct vec2i cellSize)
+{
+	return svec2i(
+		PRNGInt(r, 0, GRID_W * cellSize.x - 1),
+		PRNGInt(r, 0, GRID_H * cellSize.y - 1));
+}
+// Returns the number of lines whose result differs from the callback version
+static int GridMismatches(
+	const uint64_t seed, const struct vec2i cellSize, const int percent)
+{
+	PRNG r;
+	PRNGSeed(&r, seed);
+	BitGrid g;
+	FillRandom(&g, &r, percent);
+	int mismatches = 0;
+	for (int i = 0; i < 2000; i++)
+	{
+		const struct vec2i from = RandomPoint(&r, cellSize);
+		const struct vec2i to = RandomPoint(&r, cellSize);
+		if (HasClearLineJMRaytraceGrid(&g, cellSize, from, to) !=
+			HasClearLineCallback(&g, cellSize, from, to))
+		{
+			mismatches++;
+		}
+	}
+	BitGridTerminate(&g);
+	return mismatches;
+}
+
+FEATURE(JMRaytraceGrid, "Raytracing over a grid")
+	SCENARIO("Same as the callback version in cells")
+		GIVEN("random grids")
+			const struct vec2i cellSize = svec2i(1, 1);
+
+		WHEN("I trace random lines")
+			const int sparse = GridMismatches(1, cellSize, 3);
+			const int dense = GridMismatches(2, cellSize, 30);
+
+		THEN("the results should be the same as the callback version")
+			SHOULD_INT_EQUAL(sparse, 0);
+			SHOULD_INT_EQUAL(dense, 0);
+	SCENARIO_END
+
+	SCENARIO("Same as the callback version in sub-cell units")
+		GIVEN("random grids with cells of many points")
+			const struct vec2i cellSize = svec2i(16, 12);
+
+		WHEN("I trace random lines")
+			const int sparse = GridMismatches(3, cellSize, 3);
+			const int dense = GridMismatches(4, cellSize, 30);
+
+		THEN("the results should be the same as the callback version")
+			SHOULD_INT_EQUAL(sparse, 0);
+			SHOULD_INT_EQUAL(dense, 0);
+	SCENARIO_END
+
+	SCENARIO("Batch")
+		GIVEN("a grid with a wall")
+			// .....
+			// .....
+			// ..#..
+			// .....
+			// .....
+			BitGrid g;
+			BitGridInit(&g, svec2i(5, 5));
+			BitGridSet(&g, svec2i(2, 2), true);
+			BitGrid visited;
+			BitGridInit(&visited, svec2i(5, 5));
+
+		WHEN("I cast lines from one side, past and through the wall")
+			const struct vec2i ends[] = {
+				{4, 2}, {4, 0}, {4, 4}, {1, 2}};
+			bool clear[4];
+			JMRaytraceGridBatch(
+				&g, svec2i(1, 1), svec2i(0, 2), ends, 4, clear, &visited);
+
+		THEN("only the line through the wall should be blocked")
+			SHOULD_BE_FALSE(clear[0]);
+			SHOULD_BE_TRUE(clear[1]);
+			SHOULD_BE_TRUE(clear[2]);
+			SHOULD_BE_TRUE(clear[3]);
+		AND("the wall should be visited but not the cell behind it")
+			SHOULD_BE_TRUE(BitGridGet(&visited, svec2i(0, 2)));
+			SHOULD_BE_TRUE(BitGridGet(&visited, svec2i(2, 2)));
+			SHOULD_BE_FALSE(BitGridGet(&visited, svec2i(3, 2)));
+			BitGridTerminate(&g);
+			BitGridTerminate(&visited);
+	SCENARIO_END
+
+	SCENARIO("Batch of random lines")
+		GIVEN("a random grid and many lines from one point")
+			const int n = 10000;
+			const struct vec2i cellSize = svec2i(16, 12);
+			PRNG r;
+			PRNGSeed(&r, 5);
+			BitGrid g;
+			FillRandom(&g, &r, 5);
+			const struct vec2i from = RandomPoint(&r, cellSize);
+			struct vec2i *ends;
+			CMALLOC(ends, n * sizeof *ends);
+			for (int i = 0; i < n; i++)
+			{
+				ends[i] = RandomPoint(&r, cellSize);
+			}
+			bool *clear;
+			CMALLOC(clear, n * sizeof *clear);
+
+		WHEN("I trace them as a batch")
+			JMRaytraceGridBatch(&g, cellSize, from, ends, n, clear, NULL);
+
+		THEN("the results should be the same as the callback version")
+			int mismatches = 0;
+			for (int i = 0; i < n; i++)
+			{
+				const bool expected =
+					HasClearLineCallback(&g, cellSize, from, ends[i]);
+				if (clear[i] != expected)
+				{
+					mismatches++;
+				}
+			}
+			SHOULD_INT_EQUAL(mismatches, 0);
+		CFREE(ends);
+		CFREE(clear);
+		BitGridTerminate(&g);
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"Algorithms features are:", TEST_FEATURE(JMRaytraceGrid))
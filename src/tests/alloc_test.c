@@ -0,0 +1,132 @@
+#include <cbehave/cbehave.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <alloc.h>
+
+
+FEATURE(FrameAlloc, "Frame allocator")
+	SCENARIO("Aligned allocations")
+		GIVEN("a frame allocator")
+			FrameAllocator fa;
+			FrameAllocInit(&fa);
+
+		WHEN("I make allocations of odd sizes")
+			char *a = FrameAlloc(&fa, 3);
+			char *b = FrameAlloc(&fa, 7);
+			char *s = FrameStrDup(&fa, "hello");
+
+		THEN("they should be aligned and not overlap")
+			SHOULD_INT_EQUAL((int)((uintptr_t)a % 16), 0);
+			SHOULD_INT_EQUAL((int)((uintptr_t)b % 16), 0);
+			SHOULD_BE_TRUE(b >= a + 3);
+			SHOULD_STR_EQUAL(s, "hello");
+			SHOULD_INT_EQUAL(fa.stats.FrameAllocs, 3);
+			FrameAllocTerminate(&fa);
+	SCENARIO_END
+
+	SCENARIO("Memory is reused after reset")
+		GIVEN("a frame allocator with an allocation")
+			FrameAllocator fa;
+			FrameAllocInit(&fa);
+			void *a = FrameAlloc(&fa, 100);
+
+		WHEN("I reset it and allocate again")
+			FrameAllocReset(&fa);
+			void *b = FrameAlloc(&fa, 100);
+
+		THEN("the same memory should be returned, and stats recorded")
+			SHOULD_BE_TRUE(a == b);
+			SHOULD_INT_EQUAL((int)fa.blocks.size, 1);
+			SHOULD_INT_EQUAL(fa.LastStats.FrameAllocs, 1);
+			SHOULD_INT_EQUAL((int)fa.LastStats.FrameBytes, 100);
+			SHOULD_INT_EQUAL(fa.stats.FrameAllocs, 1);
+			FrameAllocTerminate(&fa);
+	SCENARIO_END
+
+	SCENARIO("Allocations larger than a block")
+		GIVEN("a frame allocator")
+			FrameAllocator fa;
+			FrameAllocInit(&fa);
+
+		WHEN("I allocate more than a block's worth")
+			const size_t big = FRAME_ALLOC_BLOCK_SIZE * 2;
+			char *a = FrameCalloc(&fa, big);
+			char *b = FrameAlloc(&fa, 16);
+			FrameAllocReset(&fa);
+			char *c = FrameAlloc(&fa, big);
+
+		THEN("they should succeed and reuse the big block")
+			SHOULD_BE_TRUE(a != NULL && b != NULL);
+			SHOULD_INT_EQUAL(a[big - 1], 0);
+			SHOULD_INT_EQUAL((int)fa.blocks.size, 2);
+			SHOULD_BE_TRUE(c == a);
+		AND("only the first frame should allocate from the heap")
+			SHOULD_INT_EQUAL(fa.LastStats.HeapAllocs, 2);
+			SHOULD_INT_EQUAL(fa.stats.HeapAllocs, 0);
+			FrameAllocTerminate(&fa);
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(Pool, "Object pool")
+	SCENARIO("Freed objects are recycled")
+		GIVEN("a pool with an allocated object")
+			Pool p;
+			PoolInit(&p, 24, 4);
+			char *a = PoolAlloc(&p);
+			memset(a, 0xff, 24);
+
+		WHEN("I free it and allocate again")
+			PoolFree(&p, a);
+			char *b = PoolAlloc(&p);
+
+		THEN("the same zeroed memory should be returned")
+			SHOULD_BE_TRUE(a == b);
+			SHOULD_INT_EQUAL(b[0], 0);
+			SHOULD_INT_EQUAL(b[23], 0);
+			SHOULD_INT_EQUAL(p.numLive, 1);
+			PoolFree(&p, b);
+			PoolTerminate(&p);
+	SCENARIO_END
+
+	SCENARIO("Pool grows by blocks")
+		GIVEN("a pool with small blocks")
+			Pool p;
+			PoolInit(&p, 8, 4);
+
+		WHEN("I allocate more objects than a block holds")
+			void *elems[10];
+			for (int i = 0; i < 10; i++)
+			{
+				elems[i] = PoolAlloc(&p);
+			}
+
+		THEN("all objects should be distinct")
+			SHOULD_INT_EQUAL((int)p.blocks.size, 3);
+			SHOULD_INT_EQUAL(p.numLive, 10);
+			int dupes = 0;
+			for (int i = 0; i < 10; i++)
+			{
+				for (int j = i + 1; j < 10; j++)
+				{
+					if (elems[i] == elems[j])
+					{
+						dupes++;
+					}
+				}
+			}
+			SHOULD_INT_EQUAL(dupes, 0);
+			for (int i = 0; i < 10; i++)
+			{
+				PoolFree(&p, elems[i]);
+			}
+			PoolTerminate(&p);
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"Allocator features are:",
+	TEST_FEATURE(FrameAlloc),
+	TEST_FEATURE(Pool)
+)
@@ -0,0 +1,215 @@
+#include <cbehave/cbehave.h>
+
+#include <bit_grid.h>
+#include <prng.h>
+
+
+static void FillRandom(BitGrid *g, const uint64_t seed, const int percent)
+{
+	PRNG r;
+	PRNGSeed(&r, seed);
+	struct vec2i v;
+	for (v.y = 0; v.y < g->size.y; v.y++)
+	{
+		for (v.x = 0; v.x < g->size.x; v.x++)
+		{
+			BitGridSet(g, v, PRNGInt(&r, 0, 100) < percent);
+		}
+	}
+}
+static int NaiveCount(const BitGrid *g, const struct vec2i v, const int d)
+{
+	int c = 0;
+	for (int y = v.y - d; y <= v.y + d; y++)
+	{
+		for (int x = v.x - d; x <= v.x + d; x++)
+		{
+			const struct vec2i n = svec2i(x, y);
+			if (x < 0 || y < 0 || x >= g->size.x || y >= g->size.y ||
+				BitGridGet(g, n))
+			{
+				c++;
+			}
+		}
+	}
+	return c;
+}
+// Returns number of cells that differ from a per-cell count
+static int AutomatonMismatches(
+	const struct vec2i size, const int r1, const int r2)
+{
+	BitGrid src, dst;
+	BitGridInit(&src, size);
+	BitGridInit(&dst, size);
+	FillRandom(&src, 42, 45);
+	BitGridAutomatonStep(&dst, &src, r1, r2, 0, size.y);
+	int mismatches = 0;
+	struct vec2i v;
+	for (v.y = 0; v.y < size.y; v.y++)
+	{
+		for (v.x = 0; v.x < size.x; v.x++)
+		{
+			const bool expected =
+				NaiveCount(&src, v, 1) >= r1 || NaiveCount(&src, v, 2) <= r2;
+			if (BitGridGet(&dst, v) != expected)
+			{
+				mismatches++;
+			}
+		}
+	}
+	BitGridTerminate(&src);
+	BitGridTerminate(&dst);
+	return mismatches;
+}
+
+FEATURE(BitGridAutomatonStep, "Cellular automaton step")
+	SCENARIO("Multi-word rows")
+		GIVEN("a random grid wider than a word")
+			const struct vec2i size = svec2i(150, 37);
+
+		WHEN("I run a step with typical cave rules")
+			const int mismatches = AutomatonMismatches(size, 5, 2);
+
+		THEN("it should match counting each cell's neighbours")
+			SHOULD_INT_EQUAL(mismatches, 0);
+	SCENARIO_END
+
+	SCENARIO("Extreme rules")
+		GIVEN("a small random grid")
+			const struct vec2i size = svec2i(7, 9);
+
+		WHEN("I run steps with rules that are always or never met")
+			const int m1 = AutomatonMismatches(size, 0, -1);
+			const int m2 = AutomatonMismatches(size, 10, 25);
+			const int m3 = AutomatonMismatches(size, 9, 0);
+
+		THEN("they should match counting each cell's neighbours")
+			SHOULD_INT_EQUAL(m1, 0);
+			SHOULD_INT_EQUAL(m2, 0);
+			SHOULD_INT_EQUAL(m3, 0);
+	SCENARIO_END
+
+	SCENARIO("Bands of rows")
+		GIVEN("a random grid")
+			const struct vec2i size = svec2i(64, 20);
+			BitGrid src, whole, bands;
+			BitGridInit(&src, size);
+			BitGridInit(&whole, size);
+			BitGridInit(&bands, size);
+			FillRandom(&src, 7, 50);
+
+		WHEN("I run a step over the whole grid, and separately in bands")
+			BitGridAutomatonStep(&whole, &src, 5, 2, 0, size.y);
+			BitGridAutomatonStep(&bands, &src, 5, 2, 13, size.y);
+			BitGridAutomatonStep(&bands, &src, 5, 2, 0, 13);
+
+		THEN("the results should be the same")
+			int diff = 0;
+			struct vec2i v;
+			for (v.y = 0; v.y < size.y; v.y++)
+			{
+				for (v.x = 0; v.x < size.x; v.x++)
+				{
+					if (BitGridGet(&whole, v) != BitGridGet(&bands, v))
+					{
+						diff++;
+					}
+				}
+			}
+			SHOULD_INT_EQUAL(diff, 0);
+			BitGridTerminate(&src);
+			BitGridTerminate(&whole);
+			BitGridTerminate(&bands);
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(BitGridLabelClear, "Labelling clear areas")
+	SCENARIO("Areas in scan order")
+		GIVEN("a grid with a U-shaped area and a separate area")
+			// .#.#.
+			// .#.##
+			// ...#.
+			BitGrid g;
+			BitGridInit(&g, svec2i(5, 3));
+			BitGridSet(&g, svec2i(1, 0), true);
+			BitGridSet(&g, svec2i(3, 0), true);
+			BitGridSet(&g, svec2i(1, 1), true);
+			BitGridSet(&g, svec2i(3, 1), true);
+			BitGridSet(&g, svec2i(4, 1), true);
+			BitGridSet(&g, svec2i(3, 2), true);
+
+		WHEN("I label the clear areas")
+			int labels[15];
+			const int count = BitGridLabelClear(&g, labels);
+
+		THEN("the U should be one area, numbered by first cell")
+			SHOULD_INT_EQUAL(count, 3);
+			SHOULD_INT_EQUAL(labels[0], 1);
+			SHOULD_INT_EQUAL(labels[1], -1);
+			SHOULD_INT_EQUAL(labels[2], 1);
+			SHOULD_INT_EQUAL(labels[4], 2);
+			SHOULD_INT_EQUAL(labels[14], 3);
+			SHOULD_INT_EQUAL(labels[11], 1);
+			BitGridTerminate(&g);
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(BitGridRowQueries, "Row queries")
+	SCENARIO("Ranges across words")
+		GIVEN("a grid with a run of set cells crossing a word boundary")
+			BitGrid g;
+			BitGridInit(&g, svec2i(150, 2));
+			for (int x = 60; x < 130; x++)
+			{
+				BitGridSet(&g, svec2i(x, 1), true);
+			}
+
+		WHEN("I query ranges of the row")
+			const bool allInside = BitGridRowAll(&g, 1, 60, 130);
+			const bool allOver = BitGridRowAll(&g, 1, 59, 130);
+			const bool allOut = BitGridRowAll(&g, 1, 140, 151);
+			const bool anyInside = BitGridRowAny(&g, 1, 129, 140);
+			const bool anyOutside = BitGridRowAny(&g, 1, 130, 200);
+			const bool anyOtherRow = BitGridRowAny(&g, 0, 0, 150);
+
+		THEN("they should only match the set cells")
+			SHOULD_BE_TRUE(allInside);
+			SHOULD_BE_FALSE(allOver);
+			SHOULD_BE_FALSE(allOut);
+			SHOULD_BE_TRUE(anyInside);
+			SHOULD_BE_FALSE(anyOutside);
+			SHOULD_BE_FALSE(anyOtherRow);
+			BitGridTerminate(&g);
+	SCENARIO_END
+
+	SCENARIO("Rectangles")
+		GIVEN("a grid with a filled rectangle")
+			BitGrid g;
+			BitGridInit(&g, svec2i(70, 10));
+			for (int y = 2; y <= 5; y++)
+			{
+				for (int x = 62; x <= 66; x++)
+				{
+					BitGridSet(&g, svec2i(x, y), true);
+				}
+			}
+
+		WHEN("I query rectangles")
+			const bool inside =
+				BitGridRectAll(&g, svec2i(62, 2), svec2i(66, 5));
+			const bool overlap =
+				BitGridRectAll(&g, svec2i(62, 2), svec2i(66, 6));
+
+		THEN("only the rectangle within the filled area should be all set")
+			SHOULD_BE_TRUE(inside);
+			SHOULD_BE_FALSE(overlap);
+			BitGridTerminate(&g);
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"BitGrid features are:",
+	TEST_FEATURE(BitGridAutomatonStep),
+	TEST_FEATURE(BitGridLabelClear),
+	TEST_FEATURE(BitGridRowQueries)
+)
@@ -0,0 +1,198 @@
+#include <cbehave/cbehave.h>
+
+#include <job_system.h>
+#include <utils.h>
+
+
+#define NUM_ITEMS 10000
+
+static void MarkItems(
+	JobContext *ctx, void *data, const int start, const int end)
+{
+	UNUSED(ctx);
+	int *items = data;
+	for (int i = start; i < end; i++)
+	{
+		items[i]++;
+	}
+}
+// Returns number of items not visited exactly once
+static int ParallelForMisses(const int numWorkers, const int batchSize)
+{
+	JobSystem js;
+	JobSystemInit(&js);
+	js.NumWorkers = numWorkers;
+	JobSystemStart(&js);
+	int *items = calloc(NUM_ITEMS, sizeof *items);
+	JobSystemParallelFor(&js, NUM_ITEMS, batchSize, MarkItems, items);
+	int misses = 0;
+	for (int i = 0; i < NUM_ITEMS; i++)
+	{
+		if (items[i] != 1)
+		{
+			misses++;
+		}
+	}
+	free(items);
+	JobSystemTerminate(&js);
+	return misses;
+}
+
+static void Increment(JobContext *ctx, void *data)
+{
+	UNUSED(ctx);
+	SDL_AtomicAdd(data, 1);
+}
+
+typedef struct
+{
+	JobSystem *js;
+	SDL_atomic_t count;
+} NestedData;
+static void SubmitAndWait(JobContext *ctx, void *data)
+{
+	UNUSED(ctx);
+	NestedData *nd = data;
+	JobGroup g;
+	JobGroupInit(&g);
+	for (int i = 0; i < 10; i++)
+	{
+		JobSystemSubmit(nd->js, &g, Increment, &nd->count);
+	}
+	JobSystemWait(nd->js, &g);
+}
+
+typedef struct
+{
+	int allocated;
+	int aligned;
+	int tooBig;
+} ScratchData;
+static void AllocScratch(JobContext *ctx, void *data)
+{
+	ScratchData *sd = data;
+	// Each job should start with all of the scratch memory
+	for (int i = 0; i < 4; i++)
+	{
+		char *p = JobScratchAlloc(ctx, JOB_SCRATCH_SIZE / 4 - 16);
+		if (p != NULL)
+		{
+			sd->allocated++;
+			p[0] = 1;
+			if (((size_t)p & 15) == 0)
+			{
+				sd->aligned++;
+			}
+		}
+	}
+	if (JobScratchAlloc(ctx, JOB_SCRATCH_SIZE / 4) == NULL)
+	{
+		sd->tooBig++;
+	}
+}
+
+FEATURE(JobSystemParallelFor, "Parallel for")
+	SCENARIO("No worker threads")
+		GIVEN("a job system without workers")
+		WHEN("I run a parallel for")
+			const int misses = ParallelForMisses(0, 64);
+		THEN("every item should be visited once, on the calling thread")
+			SHOULD_INT_EQUAL(misses, 0);
+	SCENARIO_END
+
+	SCENARIO("Worker threads")
+		GIVEN("a job system with workers")
+		WHEN("I run parallel fors with various batch sizes")
+			const int m1 = ParallelForMisses(3, 1);
+			const int m2 = ParallelForMisses(3, 7);
+			const int m3 = ParallelForMisses(3, NUM_ITEMS * 2);
+		THEN("every item should be visited once")
+			SHOULD_INT_EQUAL(m1, 0);
+			SHOULD_INT_EQUAL(m2, 0);
+			SHOULD_INT_EQUAL(m3, 0);
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(JobGroup, "Job groups")
+	SCENARIO("Wait for a group")
+		GIVEN("a job system with workers")
+			JobSystem js;
+			JobSystemInit(&js);
+			js.NumWorkers = 2;
+			JobSystemStart(&js);
+
+		WHEN("I submit jobs to a group and wait on it")
+			SDL_atomic_t count;
+			SDL_AtomicSet(&count, 0);
+			JobGroup g;
+			JobGroupInit(&g);
+			for (int i = 0; i < 100; i++)
+			{
+				JobSystemSubmit(&js, &g, Increment, &count);
+			}
+			JobSystemWait(&js, &g);
+
+		THEN("all the jobs should have run")
+			SHOULD_INT_EQUAL(SDL_AtomicGet(&count), 100);
+			JobSystemTerminate(&js);
+	SCENARIO_END
+
+	SCENARIO("Wait from inside jobs")
+		GIVEN("a job system with fewer workers than jobs")
+			JobSystem js;
+			JobSystemInit(&js);
+			js.NumWorkers = 1;
+			JobSystemStart(&js);
+
+		WHEN("jobs submit more jobs and wait on them")
+			NestedData nd;
+			nd.js = &js;
+			SDL_AtomicSet(&nd.count, 0);
+			JobGroup g;
+			JobGroupInit(&g);
+			for (int i = 0; i < 8; i++)
+			{
+				JobSystemSubmit(&js, &g, SubmitAndWait, &nd);
+			}
+			JobSystemWait(&js, &g);
+
+		THEN("all the nested jobs should have run")
+			SHOULD_INT_EQUAL(SDL_AtomicGet(&nd.count), 80);
+			JobSystemTerminate(&js);
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(JobScratchAlloc, "Scratch memory")
+	SCENARIO("Released after each job")
+		GIVEN("a job system without workers")
+			JobSystem js;
+			JobSystemInit(&js);
+			js.NumWorkers = 0;
+			JobSystemStart(&js);
+
+		WHEN("jobs each allocate all of the scratch memory")
+			ScratchData sd;
+			memset(&sd, 0, sizeof sd);
+			JobGroup g;
+			JobGroupInit(&g);
+			for (int i = 0; i < 3; i++)
+			{
+				JobSystemSubmit(&js, &g, AllocScratch, &sd);
+			}
+			JobSystemWait(&js, &g);
+
+		THEN("every job's allocations should succeed and be aligned")
+			SHOULD_INT_EQUAL(sd.allocated, 12);
+			SHOULD_INT_EQUAL(sd.aligned, 12);
+		AND("allocations beyond the scratch memory should fail")
+			SHOULD_INT_EQUAL(sd.tooBig, 3);
+			JobSystemTerminate(&js);
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"Job system features are:",
+	TEST_FEATURE(JobSystemParallelFor),
+	TEST_FEATURE(JobGroup),
+	TEST_FEATURE(JobScratchAlloc)
+)
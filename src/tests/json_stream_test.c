@@ -0,0 +1,379 @@
+#define SDL_MAIN_HANDLED
+#include <cbehave/cbehave.h>
+
+#include <json_stream.h>
+#include <json_utils.h>
+
+#include <config.h>
+
+
+// Stubs
+Mix_Chunk *StrSound(const char *s)
+{
+	UNUSED(s);
+	return NULL;
+}
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+bool ConfigGetBool(Config *c, const char *name)
+{
+	UNUSED(c);
+	UNUSED(name);
+	return false;
+}
+int ConfigGetJSONVersion(FILE *f)
+{
+	UNUSED(f);
+	return 0;
+}
+bool ConfigIsOld(FILE *f)
+{
+	UNUSED(f);
+	return false;
+}
+int PicManagerGetPic(void) { return 0; }
+int StrWeaponClass(void) { return 0; }
+int gPicManager;
+
+
+typedef struct
+{
+	char *Name;
+	int Mass;
+	float Speed;
+	bool Vehicle;
+	char *Sprites;
+	color_t Color;
+	json_t *node;
+} TestClass;
+static const JSONField headFields[] = {
+	JSON_FIELD("Sprites", JSON_FIELD_STRING, TestClass, Sprites),
+	JSON_FIELDS_END};
+static const JSONField testFields[] = {
+	JSON_FIELD("Name", JSON_FIELD_STRING, TestClass, Name),
+	JSON_FIELD("Mass", JSON_FIELD_INT, TestClass, Mass),
+	JSON_FIELD("Speed", JSON_FIELD_FLOAT, TestClass, Speed),
+	JSON_FIELD("Vehicle", JSON_FIELD_BOOL, TestClass, Vehicle),
+	JSON_FIELD_OBJ("Head", headFields),
+	JSON_FIELD("Color", JSON_FIELD_COLOR, TestClass, Color),
+	JSON_FIELDS_END};
+static void TestClassInit(void *data, void *classes)
+{
+	UNUSED(classes);
+	TestClass *c = data;
+	c->Mass = 100;
+}
+static void TestClassAdd(void *data, const int version, void *classes)
+{
+	UNUSED(version);
+	CArrayPushBack(classes, data);
+}
+static int numTerminated = 0;
+static void TestClassTerminate(void *data)
+{
+	TestClass *c = data;
+	CFREE(c->Name);
+	CFREE(c->Sprites);
+	numTerminated++;
+}
+static JSONClassSchema MakeSchema(CArray *classes)
+{
+	const JSONClassSchema s = {
+		"Classes",	   testFields,	  sizeof(TestClass),  2,
+		TestClassInit, TestClassAdd, TestClassTerminate, classes,
+		NULL,		   NULL};
+	return s;
+}
+// Classes with captured nodes and a default class
+static const JSONField nodeFields[] = {
+	JSON_FIELD("Name", JSON_FIELD_STRING, TestClass, Name),
+	JSON_FIELD("Mass", JSON_FIELD_INT, TestClass, Mass),
+	JSON_FIELD("Stats", JSON_FIELD_NODE, TestClass, node),
+	JSON_FIELD("Tags", JSON_FIELD_NODE, TestClass, node),
+	JSON_FIELDS_END};
+static TestClass defaultClass;
+static int defaultVersion = 0;
+static void NodeClassInit(void *data, void *classes)
+{
+	UNUSED(classes);
+	TestClass *c = data;
+	c->Mass = defaultClass.Mass;
+}
+static void NodeClassSetDefault(void *data, const int version, void *classes)
+{
+	UNUSED(classes);
+	defaultClass = *(TestClass *)data;
+	defaultVersion = version;
+}
+static void NodeClassTerminate(void *data)
+{
+	TestClass *c = data;
+	TestClassTerminate(c);
+	json_free_value(&c->node);
+}
+static JSONClassSchema MakeNodeSchema(CArray *classes)
+{
+	const JSONClassSchema s = {
+		"Classes",		  nodeFields,		   sizeof(TestClass),
+		2,				  NodeClassInit,	   TestClassAdd,
+		NodeClassTerminate, classes,		   "DefaultClass",
+		NodeClassSetDefault};
+	return s;
+}
+static void TestClassesTerminate(CArray *classes)
+{
+	CA_FOREACH(TestClass, c, *classes)
+	TestClassTerminate(c);
+	CA_FOREACH_END()
+	CArrayTerminate(classes);
+}
+
+// Generate a class file with many classes
+static char *MakeClassFile(const int n)
+{
+	const char *fmt = "{\"Name\": \"Class%d\", \"Mass\": %d, \"Speed\": 1.5, "
+					  "\"Vehicle\": true, \"Unused1\": \"foo\", "
+					  "\"Unused2\": [1, 2, 3], \"Head\": {\"Sprites\": "
+					  "\"chars/heads/%d\"}, \"Color\": \"ff8000\"}";
+	char *buf;
+	CMALLOC(buf, 64 + (size_t)n * 256);
+	char *p = buf + sprintf(buf, "{\"Version\": 2, \"Classes\": [");
+	for (int i = 0; i < n; i++)
+	{
+		p += sprintf(p, "%s", i > 0 ? ", " : "");
+		p += sprintf(p, fmt, i, i, i);
+	}
+	sprintf(p, "]}");
+	return buf;
+}
+// The DOM loading path, as used by the other class loaders
+static void LoadClassesDOM(CArray *classes, const char *text)
+{
+	json_t *root = NULL;
+	json_parse_document(&root, text);
+	json_t *node = json_find_first_label(root, "Classes")->child;
+	for (json_t *child = node->child; child; child = child->next)
+	{
+		TestClass c;
+		memset(&c, 0, sizeof c);
+		TestClassInit(&c, NULL);
+		LoadStr(&c.Name, child, "Name");
+		LoadInt(&c.Mass, child, "Mass");
+		LoadFloat(&c.Speed, child, "Speed");
+		LoadBool(&c.Vehicle, child, "Vehicle");
+		json_t *head = json_find_first_label(child, "Head");
+		if (head != NULL)
+		{
+			LoadStr(&c.Sprites, head->child, "Sprites");
+		}
+		LoadColor(&c.Color, child, "Color");
+		CArrayPushBack(classes, &c);
+	}
+	json_free_value(&root);
+}
+
+
+FEATURE(json_stream_load, "Load classes")
+	SCENARIO("Load fields")
+		GIVEN("a class file with nested and unknown fields")
+			const char *text =
+				"{\"Version\": 2, \"Extra\": {\"Classes\": [{\"Name\": \"no\"}]},"
+				"\"Classes\": ["
+				"{\"Name\": \"A\", \"Mass\": 5, \"Speed\": 1.5, \"Vehicle\": true,"
+				"\"Head\": {\"Sprites\": \"s\", \"Unknown\": [1, {}]},"
+				"\"Ignored\": {\"Name\": \"x\"}, \"Color\": \"ff0000\"},"
+				"{\"Name\": \"B\"}]}";
+			CArray classes;
+			CArrayInit(&classes, sizeof(TestClass));
+			const JSONClassSchema schema = MakeSchema(&classes);
+
+		WHEN("I load the file")
+			const int version =
+				JSONStreamLoadClassesString(&schema, text, strlen(text));
+
+		THEN("the version and classes should be loaded")
+			SHOULD_INT_EQUAL(version, 2);
+			SHOULD_INT_EQUAL((int)classes.size, 2);
+		AND("the fields should be loaded")
+			const TestClass *a = CArrayGet(&classes, 0);
+			SHOULD_STR_EQUAL(a->Name, "A");
+			SHOULD_INT_EQUAL(a->Mass, 5);
+			SHOULD_BE_TRUE(a->Speed == 1.5f);
+			SHOULD_BE_TRUE(a->Vehicle);
+			SHOULD_STR_EQUAL(a->Sprites, "s");
+			SHOULD_INT_EQUAL(a->Color.r, 255);
+			SHOULD_INT_EQUAL(a->Color.g, 0);
+		AND("missing fields should keep their defaults")
+			const TestClass *b = CArrayGet(&classes, 1);
+			SHOULD_STR_EQUAL(b->Name, "B");
+			SHOULD_INT_EQUAL(b->Mass, 100);
+			SHOULD_BE_TRUE(b->Sprites == NULL);
+		TestClassesTerminate(&classes);
+	SCENARIO_END
+
+	SCENARIO("Capture nested fields and load defaults")
+		GIVEN("a class file with defaults and nested fields")
+			const char *text =
+				"{\"Version\": 2, \"DefaultClass\": {\"Mass\": 7},"
+				"\"Classes\": ["
+				"{\"Name\": \"A\", \"Stats\": {\"Speed\": 2.5, "
+				"\"Sub\": {\"Say\": \"a\\\"b\"}}, \"Tags\": [1, \"x\", null],"
+				"\"Mass\": 3},"
+				"{\"Name\": \"B\"}]}";
+			CArray classes;
+			CArrayInit(&classes, sizeof(TestClass));
+			const JSONClassSchema schema = MakeNodeSchema(&classes);
+			memset(&defaultClass, 0, sizeof defaultClass);
+
+		WHEN("I load the file")
+			const int version =
+				JSONStreamLoadClassesString(&schema, text, strlen(text));
+
+		THEN("the defaults should be loaded first")
+			SHOULD_INT_EQUAL(version, 2);
+			SHOULD_INT_EQUAL(defaultVersion, 2);
+			SHOULD_INT_EQUAL(defaultClass.Mass, 7);
+			const TestClass *b = CArrayGet(&classes, 1);
+			SHOULD_INT_EQUAL(b->Mass, 7);
+			SHOULD_BE_TRUE(b->node == NULL);
+		AND("the nested fields should be captured into the node")
+			const TestClass *a = CArrayGet(&classes, 0);
+			SHOULD_INT_EQUAL(a->Mass, 3);
+			SHOULD_BE_TRUE(a->node != NULL);
+			json_t *stats = json_find_first_label(a->node, "Stats")->child;
+			float speed = 0;
+			LoadFloat(&speed, stats, "Speed");
+			SHOULD_BE_TRUE(speed == 2.5f);
+			json_t *sub = json_find_first_label(stats, "Sub")->child;
+			char *say = GetString(sub, "Say");
+			SHOULD_STR_EQUAL(say, "a\"b");
+			CFREE(say);
+			json_t *tags = json_find_first_label(a->node, "Tags")->child;
+			SHOULD_INT_EQUAL(tags->type, JSON_ARRAY);
+			SHOULD_STR_EQUAL(tags->child->text, "1");
+			SHOULD_STR_EQUAL(tags->child->next->text, "x");
+			SHOULD_INT_EQUAL(tags->child->next->next->type, JSON_NULL);
+		CA_FOREACH(TestClass, c, classes)
+		NodeClassTerminate(c);
+		CA_FOREACH_END()
+		CArrayTerminate(&classes);
+	SCENARIO_END
+
+	SCENARIO("Defaults before the version")
+		GIVEN("a class file with defaults before its version")
+			const char *text =
+				"{\"DefaultClass\": {\"Mass\": 9, \"Stats\": {\"Speed\": 1}},"
+				"\"Version\": 2, \"Classes\": [{\"Name\": \"A\"}]}";
+			CArray classes;
+			CArrayInit(&classes, sizeof(TestClass));
+			const JSONClassSchema schema = MakeNodeSchema(&classes);
+			memset(&defaultClass, 0, sizeof defaultClass);
+			defaultVersion = 0;
+
+		WHEN("I load the file")
+			const int version =
+				JSONStreamLoadClassesString(&schema, text, strlen(text));
+
+		THEN("the defaults should be set once the version is read")
+			SHOULD_INT_EQUAL(version, 2);
+			SHOULD_INT_EQUAL(defaultVersion, 2);
+			SHOULD_INT_EQUAL(defaultClass.Mass, 9);
+		AND("the classes should use the defaults")
+			SHOULD_INT_EQUAL((int)classes.size, 1);
+			const TestClass *a = CArrayGet(&classes, 0);
+			SHOULD_INT_EQUAL(a->Mass, 9);
+		CA_FOREACH(TestClass, c, classes)
+		NodeClassTerminate(c);
+		CA_FOREACH_END()
+		CArrayTerminate(&classes);
+		json_free_value(&defaultClass.node);
+	SCENARIO_END
+
+	SCENARIO("Defaults without a version")
+		GIVEN("a class file with defaults and classes but no version")
+			const char *text =
+				"{\"DefaultClass\": {\"Mass\": 9},"
+				"\"Classes\": [{\"Name\": \"A\"}]}";
+			CArray classes;
+			CArrayInit(&classes, sizeof(TestClass));
+			const JSONClassSchema schema = MakeNodeSchema(&classes);
+			defaultVersion = 0;
+
+		WHEN("I load the file")
+			const int version =
+				JSONStreamLoadClassesString(&schema, text, strlen(text));
+
+		THEN("loading should fail")
+			SHOULD_INT_EQUAL(version, -1);
+		AND("the defaults should not be set")
+			SHOULD_INT_EQUAL(defaultVersion, 0);
+		AND("no classes should be added")
+			SHOULD_INT_EQUAL((int)classes.size, 0);
+		CArrayTerminate(&classes);
+	SCENARIO_END
+
+	SCENARIO("Unsupported version")
+		GIVEN("a class file with a newer version")
+			const char *text =
+				"{\"Classes\": [{\"Name\": \"A\"}, {\"Name\": \"B\"}], "
+				"\"Version\": 3}";
+			CArray classes;
+			CArrayInit(&classes, sizeof(TestClass));
+			const JSONClassSchema schema = MakeSchema(&classes);
+			numTerminated = 0;
+
+		WHEN("I load the file")
+			const int version =
+				JSONStreamLoadClassesString(&schema, text, strlen(text));
+
+		THEN("loading should fail")
+			SHOULD_INT_EQUAL(version, -1);
+		AND("no classes should be added")
+			SHOULD_INT_EQUAL((int)classes.size, 0);
+		AND("the loaded classes should be freed")
+			SHOULD_INT_EQUAL(numTerminated, 2);
+		CArrayTerminate(&classes);
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(json_stream_dom, "Compare with DOM loading")
+	SCENARIO("Load a large file")
+		GIVEN("a large class file")
+			const int n = 1000;
+			char *text = MakeClassFile(n);
+			CArray domClasses;
+			CArrayInit(&domClasses, sizeof(TestClass));
+			CArray streamClasses;
+			CArrayInit(&streamClasses, sizeof(TestClass));
+			const JSONClassSchema schema = MakeSchema(&streamClasses);
+
+		WHEN("I load it using the DOM and the streaming loader")
+			LoadClassesDOM(&domClasses, text);
+			JSONStreamLoadClassesString(&schema, text, strlen(text));
+
+		THEN("both should load the same classes")
+			SHOULD_INT_EQUAL((int)streamClasses.size, (int)domClasses.size);
+			bool same = true;
+			for (int i = 0; i < n; i++)
+			{
+				const TestClass *d = CArrayGet(&domClasses, i);
+				const TestClass *s = CArrayGet(&streamClasses, i);
+				same = same && strcmp(d->Name, s->Name) == 0 &&
+					   d->Mass == s->Mass && d->Speed == s->Speed &&
+					   d->Vehicle == s->Vehicle &&
+					   strcmp(d->Sprites, s->Sprites) == 0 &&
+					   d->Color.g == s->Color.g;
+			}
+			SHOULD_BE_TRUE(same);
+		CFREE(text);
+		TestClassesTerminate(&domClasses);
+		TestClassesTerminate(&streamClasses);
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"JSON streaming features are:", TEST_FEATURE(json_stream_load),
+	TEST_FEATURE(json_stream_dom))
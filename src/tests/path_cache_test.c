@@ -0,0 +1,165 @@
+#include <cbehave/cbehave.h>
+
+#include <map.h>
+#include <path_cache.h>
+#include <prng.h>
+
+#define MAP_SIZE 40
+#define TARGET_UID 1
+
+// A map of empty tiles whose walkability is set directly
+static void TestMapInit(Map *m)
+{
+	memset(m, 0, sizeof *m);
+	m->Size = svec2i(MAP_SIZE, MAP_SIZE);
+	CArrayInit(&m->Tiles, sizeof(Tile));
+	for (int i = 0; i < MAP_SIZE * MAP_SIZE; i++)
+	{
+		Tile t;
+		TileInit(&t);
+		CArrayPushBack(&m->Tiles, &t);
+	}
+	BitGridInit(&m->walkable, m->Size);
+	BitGridInit(&m->door, m->Size);
+}
+static void TestMapTerminate(Map *m)
+{
+	CA_FOREACH(Tile, t, m->Tiles)
+	TileDestroy(t);
+	CA_FOREACH_END()
+	CArrayTerminate(&m->Tiles);
+	BitGridTerminate(&m->walkable);
+	BitGridTerminate(&m->door);
+}
+static void SetWalkable(
+	Map *m, PathCache *pc, const struct vec2i v, const bool walkable)
+{
+	BitGridSet(&m->walkable, v, walkable);
+	PathCacheTileChanged(pc, v);
+}
+static struct vec2i RandomTile(PRNG *r)
+{
+	return svec2i(PRNGInt(r, 0, MAP_SIZE), PRNGInt(r, 0, MAP_SIZE));
+}
+
+// Flip random tiles on random maps, and count the times that the repaired
+// flow field differs from a recalculated one
+static int RepairMismatches(const uint64_t seed, const int maps)
+{
+	PRNG r;
+	PRNGSeed(&r, seed);
+	Map m;
+	TestMapInit(&m);
+	PathCache pc;
+	PathCacheInit(&pc, &m);
+	CArray repaired;
+	CArrayInit(&repaired, sizeof(int));
+	int mismatches = 0;
+	for (int i = 0; i < maps; i++)
+	{
+		RECT_FOREACH(Rect2iNew(svec2i_zero(), m.Size))
+		BitGridSet(&m.walkable, _v, PRNGInt(&r, 0, 4) != 0);
+		RECT_FOREACH_END()
+		PathCacheClear(&pc);
+		const struct vec2i target = RandomTile(&r);
+		struct vec2i next;
+		PathCacheFlowStep(&pc, TARGET_UID, target, target, &next);
+		for (int j = 0; j < 10; j++)
+		{
+			const int changes = PRNGInt(&r, 1, 6);
+			for (int k = 0; k < changes; k++)
+			{
+				const struct vec2i v = RandomTile(&r);
+				SetWalkable(&m, &pc, v, !BitGridGet(&m.walkable, v));
+			}
+			PathCacheFlowStep(&pc, TARGET_UID, target, target, &next);
+			FlowField *f = CArrayGet(&pc.flowFields, 0);
+			CArrayCopy(&repaired, &f->dist);
+			f->isValid = false;
+			PathCacheFlowStep(&pc, TARGET_UID, target, target, &next);
+			const size_t size = f->dist.size * f->dist.elemSize;
+			if (memcmp(repaired.data, f->dist.data, size) != 0)
+			{
+				mismatches++;
+			}
+		}
+	}
+	CArrayTerminate(&repaired);
+	PathCacheTerminate(&pc);
+	TestMapTerminate(&m);
+	return mismatches;
+}
+
+
+FEATURE(PathCacheFlowStep, "Flow field steps")
+	SCENARIO("Step towards the target")
+		GIVEN("an open map")
+			Map m;
+			TestMapInit(&m);
+			RECT_FOREACH(Rect2iNew(svec2i_zero(), m.Size))
+			BitGridSet(&m.walkable, _v, true);
+			RECT_FOREACH_END()
+			PathCache pc;
+			PathCacheInit(&pc, &m);
+
+		WHEN("I step from a tile along a row towards the target")
+			struct vec2i next;
+			const bool found = PathCacheFlowStep(
+				&pc, TARGET_UID, svec2i(10, 5), svec2i(5, 5), &next);
+
+		THEN("the step should be the next tile along the row")
+			SHOULD_BE_TRUE(found);
+			SHOULD_INT_EQUAL(next.x, 6);
+			SHOULD_INT_EQUAL(next.y, 5);
+		PathCacheTerminate(&pc);
+		TestMapTerminate(&m);
+	SCENARIO_END
+
+	SCENARIO("Walls built and removed")
+		GIVEN("an open map")
+			Map m;
+			TestMapInit(&m);
+			RECT_FOREACH(Rect2iNew(svec2i_zero(), m.Size))
+			BitGridSet(&m.walkable, _v, true);
+			RECT_FOREACH_END()
+			PathCache pc;
+			PathCacheInit(&pc, &m);
+			const struct vec2i target = svec2i(30, 20);
+			const struct vec2i from = svec2i(5, 20);
+			struct vec2i next;
+			PathCacheFlowStep(&pc, TARGET_UID, target, from, &next);
+
+		WHEN("I build a wall across the map between them")
+			for (int y = 0; y < MAP_SIZE; y++)
+			{
+				SetWalkable(&m, &pc, svec2i(20, y), false);
+			}
+
+		THEN("the target should be unreachable")
+			SHOULD_BE_FALSE(
+				PathCacheFlowStep(&pc, TARGET_UID, target, from, &next));
+
+		WHEN("I remove a tile of the wall")
+			SetWalkable(&m, &pc, svec2i(20, 3), true);
+
+		THEN("the target should be reachable again")
+			SHOULD_BE_TRUE(
+				PathCacheFlowStep(&pc, TARGET_UID, target, from, &next));
+		PathCacheTerminate(&pc);
+		TestMapTerminate(&m);
+	SCENARIO_END
+
+	SCENARIO("Repair the same as recalculating")
+		GIVEN("random maps with random tiles changing")
+			int mismatches = 0;
+
+		WHEN("I repair the flow fields after the changes")
+			mismatches = RepairMismatches(1, 200);
+
+		THEN("the fields should be the same as recalculated ones")
+			SHOULD_INT_EQUAL(mismatches, 0);
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"Path cache features are:", TEST_FEATURE(PathCacheFlowStep))
@@ -0,0 +1,167 @@
+#include <cbehave/cbehave.h>
+
+#include <prng.h>
+
+
+FEATURE(PRNGSeed, "Seeding")
+	SCENARIO("Same seed")
+		GIVEN("two generators with the same seed")
+			PRNG r1, r2;
+			PRNGSeed(&r1, 1234);
+			PRNGSeed(&r2, 1234);
+
+		WHEN("I draw numbers from both")
+			bool same = true;
+			for (int i = 0; i < 1000; i++)
+			{
+				if (PRNGNext(&r1) != PRNGNext(&r2))
+				{
+					same = false;
+				}
+			}
+
+		THEN("the sequences should be the same")
+			SHOULD_BE_TRUE(same);
+			SHOULD_INT_EQUAL((int)PRNGChecksum(&r1), (int)PRNGChecksum(&r2));
+	SCENARIO_END
+
+	SCENARIO("Different seeds")
+		GIVEN("two generators with different seeds")
+			PRNG r1, r2;
+			PRNGSeed(&r1, 1234);
+			PRNGSeed(&r2, 1235);
+
+		WHEN("I draw numbers from both")
+			int same = 0;
+			for (int i = 0; i < 1000; i++)
+			{
+				if (PRNGNext(&r1) == PRNGNext(&r2))
+				{
+					same++;
+				}
+			}
+
+		THEN("the sequences should be different")
+			SHOULD_INT_EQUAL(same, 0);
+	SCENARIO_END
+
+	SCENARIO("Zero seed")
+		GIVEN("a generator seeded with zero")
+			PRNG r;
+			PRNGSeed(&r, 0);
+
+		WHEN("I draw numbers")
+			uint32_t x = 0;
+			for (int i = 0; i < 10; i++)
+			{
+				x |= PRNGNext(&r);
+			}
+
+		THEN("the numbers should not all be zero")
+			SHOULD_BE_TRUE(x != 0);
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(PRNGInt, "Random int")
+	SCENARIO("In range")
+		GIVEN("a generator")
+			PRNG r;
+			PRNGSeed(&r, 42);
+
+		WHEN("I draw ints in a range")
+			bool inRange = true;
+			bool seenLow = false;
+			bool seenHigh = false;
+			for (int i = 0; i < 1000; i++)
+			{
+				const int x = PRNGInt(&r, -3, 4);
+				if (x < -3 || x >= 4)
+				{
+					inRange = false;
+				}
+				seenLow = seenLow || x == -3;
+				seenHigh = seenHigh || x == 3;
+			}
+
+		THEN("the ints should be in [low, high)")
+			SHOULD_BE_TRUE(inRange);
+			SHOULD_BE_TRUE(seenLow);
+			SHOULD_BE_TRUE(seenHigh);
+	SCENARIO_END
+
+	SCENARIO("Empty range")
+		GIVEN("a generator")
+			PRNG r;
+			PRNGSeed(&r, 42);
+
+		WHEN("I draw an int where low equals high")
+			const int x = PRNGInt(&r, 5, 5);
+
+		THEN("the result should be low")
+			SHOULD_INT_EQUAL(x, 5);
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(RandStreams, "Random streams")
+	SCENARIO("Independent streams")
+		GIVEN("seeded streams")
+			RandSeed(99);
+			const uint32_t simBefore = RandChecksum(RNG_SIM);
+
+		WHEN("I draw from another stream")
+			for (int i = 0; i < 100; i++)
+			{
+				RandInt(RNG_FX, 0, 100);
+			}
+
+		THEN("the simulation stream should be unaffected")
+			SHOULD_INT_EQUAL((int)RandChecksum(RNG_SIM), (int)simBefore);
+	SCENARIO_END
+
+	SCENARIO("Cosmetic effects")
+		GIVEN("seeded streams")
+			RandSeed(99);
+			const uint32_t simBefore = RandChecksum(RNG_SIM);
+
+		WHEN("I draw effect positions like damage text and particles do")
+			for (int i = 0; i < 100; i++)
+			{
+				RandFloat(RNG_FX, -3, 3);
+				RandDouble(RNG_FX, 0, 1);
+				RandBool(RNG_FX);
+			}
+
+		THEN("the simulation stream should be unaffected")
+			SHOULD_INT_EQUAL((int)RandChecksum(RNG_SIM), (int)simBefore);
+	SCENARIO_END
+
+	SCENARIO("Streams differ")
+		GIVEN("streams seeded with the same seed")
+			RandSeed(99);
+
+		WHEN("I compare the streams")
+
+		THEN("they should have different states")
+			SHOULD_BE_TRUE(RandChecksum(RNG_SIM) != RandChecksum(RNG_FX));
+			SHOULD_BE_TRUE(RandChecksum(RNG_SIM) != RandChecksum(RNG_MAP));
+	SCENARIO_END
+
+	SCENARIO("Seed a generator like a stream")
+		GIVEN("a stream and a generator seeded the same way")
+			RandSeedStream(RNG_MAP, 7);
+			PRNG r;
+			PRNGSeedStream(&r, RNG_MAP, 7);
+
+		WHEN("I compare them")
+
+		THEN("they should have the same state")
+			SHOULD_INT_EQUAL((int)PRNGChecksum(&r), (int)RandChecksum(RNG_MAP));
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"PRNG features are:",
+	TEST_FEATURE(PRNGSeed),
+	TEST_FEATURE(PRNGInt),
+	TEST_FEATURE(RandStreams)
+)
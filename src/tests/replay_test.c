@@ -0,0 +1,126 @@
+#define SDL_MAIN_HANDLED
+#include <cbehave/cbehave.h>
+
+#include <replay.h>
+
+#include <string.h>
+
+
+static void MakeRecording(Replay *r)
+{
+	ReplayInit(r);
+	CSTRDUP(r->CampaignPath, "/data/missions/test.cdogscpn");
+	r->GameMode = GAME_MODE_NORMAL;
+	r->MissionIndex = 3;
+	r->RandomSeed = 42;
+	r->QuickPlaySeed = 1234;
+	r->PVPSeed = 0x123456789abcdefULL;
+	ReplayPlayer p;
+	memset(&p, 0, sizeof p);
+	p.InputDevice = 2;
+	p.DeviceIndex = 1;
+	strcpy(p.Data.Name, "Player");
+	p.Data.UID = 7;
+	p.Data.Lives = 2;
+	CArrayPushBack(&r->Players, &p);
+	for (int i = 0; i < 5; i++)
+	{
+		ReplayFrame frame;
+		for (int j = 0; j < MAX_LOCAL_PLAYERS; j++)
+		{
+			frame.Cmds[j] = i * 16 + j;
+		}
+		frame.Checksum = 0xdeadbeef + i;
+		CArrayPushBack(&r->Frames, &frame);
+	}
+}
+
+FEATURE(replay_save_and_load, "Save and load replays")
+	SCENARIO("Save and load")
+		GIVEN("a recorded replay")
+			Replay r1;
+			MakeRecording(&r1);
+
+		WHEN("I save it, and load it back")
+			const bool saved = ReplaySave(&r1, "tmp");
+			Replay r2;
+			ReplayInit(&r2);
+			const bool loaded = ReplayLoad(&r2, "tmp");
+
+		THEN("the starting state should be the same")
+			SHOULD_BE_TRUE(saved);
+			SHOULD_BE_TRUE(loaded);
+			SHOULD_STR_EQUAL(r2.CampaignPath, r1.CampaignPath);
+			SHOULD_INT_EQUAL(r2.GameMode, r1.GameMode);
+			SHOULD_INT_EQUAL(r2.MissionIndex, r1.MissionIndex);
+			SHOULD_INT_EQUAL(r2.RandomSeed, r1.RandomSeed);
+			SHOULD_INT_EQUAL((int)r2.QuickPlaySeed, (int)r1.QuickPlaySeed);
+			SHOULD_BE_TRUE(r2.PVPSeed == r1.PVPSeed);
+		AND("the players should be the same")
+			SHOULD_INT_EQUAL((int)r2.Players.size, 1);
+			const ReplayPlayer *p = CArrayGet(&r2.Players, 0);
+			SHOULD_INT_EQUAL(p->InputDevice, 2);
+			SHOULD_INT_EQUAL(p->DeviceIndex, 1);
+			SHOULD_STR_EQUAL(p->Data.Name, "Player");
+			SHOULD_INT_EQUAL((int)p->Data.UID, 7);
+			SHOULD_INT_EQUAL((int)p->Data.Lives, 2);
+		AND("the frames should be the same")
+			SHOULD_INT_EQUAL((int)r2.Frames.size, (int)r1.Frames.size);
+			SHOULD_MEM_EQUAL(
+				r2.Frames.data, r1.Frames.data,
+				r1.Frames.size * r1.Frames.elemSize);
+			ReplayTerminate(&r1);
+			ReplayTerminate(&r2);
+	SCENARIO_END
+
+	SCENARIO("Reject other files")
+		GIVEN("a file that isn't a replay")
+			FILE *f = fopen("tmp", "wb");
+			fputs("not a replay", f);
+			fclose(f);
+
+		WHEN("I load it")
+			Replay r;
+			ReplayInit(&r);
+			const bool loaded = ReplayLoad(&r, "tmp");
+
+		THEN("loading should fail")
+			SHOULD_BE_FALSE(loaded);
+			ReplayTerminate(&r);
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(replay_playback, "Play back replays")
+	SCENARIO("Play back recorded commands")
+		GIVEN("a loaded replay")
+			Replay r1;
+			MakeRecording(&r1);
+			ReplaySave(&r1, "tmp");
+			Replay r2;
+			ReplayInit(&r2);
+			ReplayLoad(&r2, "tmp");
+
+		WHEN("I play back every frame")
+			int frames = 0;
+			bool same = true;
+			int cmds[MAX_LOCAL_PLAYERS];
+			while (ReplayPlayFrame(&r2, cmds))
+			{
+				const ReplayFrame *frame = CArrayGet(&r1.Frames, frames);
+				same = same && memcmp(cmds, frame->Cmds, sizeof cmds) == 0;
+				frames++;
+			}
+
+		THEN("the commands should be the recorded ones, in order")
+			SHOULD_INT_EQUAL(frames, (int)r1.Frames.size);
+			SHOULD_BE_TRUE(same);
+			ReplayTerminate(&r1);
+			ReplayTerminate(&r2);
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"Replay features are:",
+	TEST_FEATURE(replay_save_and_load),
+	TEST_FEATURE(replay_playback)
+)
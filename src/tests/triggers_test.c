@@ -0,0 +1,182 @@
+#include <cbehave/cbehave.h>
+
+#include <map.h>
+#include <triggers.h>
+
+#define DOOR_OPEN_TICKS 10
+
+// A vertical doorway at (1, 1), with a trigger that opens it and a watch
+// that closes it, wired up like the doors made by the map builder
+typedef struct
+{
+	CArray triggers; // of Trigger *
+	Trigger *open;
+	TWatch *close;
+} Door;
+static void DoorInit(Door *d)
+{
+	gMap.Size = svec2i(3, 3);
+	CArrayInit(&gMap.Tiles, sizeof(Tile));
+	for (int i = 0; i < gMap.Size.x * gMap.Size.y; i++)
+	{
+		Tile t;
+		TileInit(&t);
+		CArrayPushBack(&gMap.Tiles, &t);
+	}
+	WatchesInit();
+
+	CArrayInit(&d->triggers, sizeof(Trigger *));
+	d->open = TriggerNew();
+	d->open->id = 1;
+	CArrayPushBack(&d->triggers, &d->open);
+	d->close = WatchNew();
+	for (int y = 0; y < gMap.Size.y; y++)
+	{
+		const struct vec2i v = svec2i(1, y);
+		WatchAddCondition(d->close, CONDITION_TILECLEAR, DOOR_OPEN_TICKS, v);
+		WatchAddTile(d->close, MapGetTile(&gMap, v));
+	}
+
+	Action *a = TriggerAddAction(d->open);
+	a->Type = ACTION_CLEARTRIGGER;
+	a->u.index = d->open->id;
+	a = TriggerAddAction(d->open);
+	a->Type = ACTION_ACTIVATEWATCH;
+	a->u.index = d->close->index;
+	a = WatchAddAction(d->close);
+	a->Type = ACTION_DEACTIVATEWATCH;
+	a->u.index = d->close->index;
+	a = WatchAddAction(d->close);
+	a->Type = ACTION_SETTRIGGER;
+	a->u.index = d->open->id;
+}
+static void DoorTerminate(Door *d)
+{
+	TriggerTerminate(d->open);
+	CArrayTerminate(&d->triggers);
+	WatchesTerminate();
+	CA_FOREACH(Tile, t, gMap.Tiles)
+	TileDestroy(t);
+	CA_FOREACH_END()
+	CArrayTerminate(&gMap.Tiles);
+}
+static bool DoorIsClosed(const Door *d)
+{
+	return d->open->isActive;
+}
+static void SetCharacter(const struct vec2i v, const bool hasCharacter)
+{
+	Tile *t = MapGetTile(&gMap, v);
+	if (hasCharacter)
+	{
+		ThingId tid;
+		tid.Id = 0;
+		tid.Kind = KIND_CHARACTER;
+		CArrayPushBack(&t->things, &tid);
+	}
+	else
+	{
+		CArrayClear(&t->things);
+	}
+	WatchesOnTileChanged(t, v, hasCharacter);
+}
+
+FEATURE(door_close_watch, "Closing doors")
+	SCENARIO("Close once the doorway has been clear for long enough")
+		Door d;
+		GIVEN("an open door with nobody in the doorway")
+			DoorInit(&d);
+			TriggerActivate(d.open, &d.triggers);
+
+		WHEN("almost enough time passes")
+			UpdateWatches(&d.triggers, DOOR_OPEN_TICKS - 1);
+
+		THEN("the door should still be open")
+			SHOULD_BE_FALSE(DoorIsClosed(&d));
+
+		WHEN("one more tick passes")
+			UpdateWatches(&d.triggers, 1);
+
+		THEN("the door should be closed")
+			SHOULD_BE_TRUE(DoorIsClosed(&d));
+			DoorTerminate(&d);
+	SCENARIO_END
+
+	SCENARIO("Stay open while a character stands in the doorway")
+		Door d;
+		GIVEN("an open door")
+			DoorInit(&d);
+			TriggerActivate(d.open, &d.triggers);
+
+		WHEN("a character stands in the doorway for a long time")
+			SetCharacter(svec2i(1, 1), true);
+			UpdateWatches(&d.triggers, DOOR_OPEN_TICKS * 10);
+
+		THEN("the door should still be open")
+			SHOULD_BE_FALSE(DoorIsClosed(&d));
+
+		WHEN("the character leaves and almost enough time passes")
+			SetCharacter(svec2i(1, 1), false);
+			UpdateWatches(&d.triggers, DOOR_OPEN_TICKS - 1);
+
+		THEN("the door should still be open")
+			SHOULD_BE_FALSE(DoorIsClosed(&d));
+
+		WHEN("one more tick passes")
+			UpdateWatches(&d.triggers, 1);
+
+		THEN("the door should be closed")
+			SHOULD_BE_TRUE(DoorIsClosed(&d));
+			DoorTerminate(&d);
+	SCENARIO_END
+
+	SCENARIO("Passing through the doorway between updates keeps it open")
+		Door d;
+		GIVEN("an open door that has been clear for a while")
+			DoorInit(&d);
+			TriggerActivate(d.open, &d.triggers);
+			UpdateWatches(&d.triggers, DOOR_OPEN_TICKS / 2);
+
+		WHEN("a character passes beside the door before the next update")
+			SetCharacter(svec2i(1, 2), true);
+			SetCharacter(svec2i(1, 2), false);
+			UpdateWatches(&d.triggers, DOOR_OPEN_TICKS / 2);
+
+		THEN("the door should still be open")
+			SHOULD_BE_FALSE(DoorIsClosed(&d));
+
+		WHEN("the doorway stays clear for long enough after that")
+			UpdateWatches(&d.triggers, DOOR_OPEN_TICKS / 2);
+
+		THEN("the door should be closed")
+			SHOULD_BE_TRUE(DoorIsClosed(&d));
+			DoorTerminate(&d);
+	SCENARIO_END
+
+	SCENARIO("Reopening restarts the wait")
+		Door d;
+		GIVEN("a door that was opened and closed")
+			DoorInit(&d);
+			TriggerActivate(d.open, &d.triggers);
+			UpdateWatches(&d.triggers, DOOR_OPEN_TICKS);
+
+		WHEN("it is opened again and almost enough time passes")
+			TriggerActivate(d.open, &d.triggers);
+			UpdateWatches(&d.triggers, DOOR_OPEN_TICKS - 1);
+
+		THEN("the door should still be open")
+			SHOULD_BE_FALSE(DoorIsClosed(&d));
+
+		WHEN("one more tick passes")
+			UpdateWatches(&d.triggers, 1);
+
+		THEN("the door should be closed")
+			SHOULD_BE_TRUE(DoorIsClosed(&d));
+			DoorTerminate(&d);
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"Trigger features are:",
+	TEST_FEATURE(door_close_watch)
+)